@@ -49,15 +49,26 @@ float powf(const float x, const float y) {
  *  @param  value
  */
 void Adafruit_TCS34725::write8(uint8_t reg, uint32_t value) {
-  _wire->beginTransmission(_i2caddr);
-#if ARDUINO >= 100
-  _wire->write(TCS34725_COMMAND_BIT | reg);
-  _wire->write(value & 0xFF);
-#else
-  _wire->send(TCS34725_COMMAND_BIT | reg);
-  _wire->send(value & 0xFF);
-#endif
-  _wire->endTransmission();
+  uint8_t buffer[2] = {(uint8_t)(TCS34725_COMMAND_BIT | reg),
+                       (uint8_t)(value & 0xFF)};
+  uint16_t bit = (reg < TCS34725_SHADOW_SIZE) ? (1U << reg) : 0;
+
+  /* Skip the transfer if the register is known to hold this value already */
+  if ((_shadowValid & bit) && _shadow[reg] == buffer[1]) {
+    return;
+  }
+
+  boolean ok = _bus->transfer(_i2caddr, buffer, 2, NULL, 0);
+  if (!ok) {
+    _busFault = true;
+  }
+  if (ok && bit) {
+    _shadow[reg] = buffer[1];
+    _shadowValid |= bit;
+  } else {
+    /* After a failed write the register's contents are unknown */
+    _shadowValid &= ~bit;
+  }
 }
 
 /*!
@@ -66,59 +77,72 @@ void Adafruit_TCS34725::write8(uint8_t reg, uint32_t value) {
  *  @return value
  */
 uint8_t Adafruit_TCS34725::read8(uint8_t reg) {
-  _wire->beginTransmission(_i2caddr);
-#if ARDUINO >= 100
-  _wire->write(TCS34725_COMMAND_BIT | reg);
-#else
-  _wire->send(TCS34725_COMMAND_BIT | reg);
-#endif
-  _wire->endTransmission();
+  uint8_t command = TCS34725_COMMAND_BIT | reg;
+  uint8_t value = 0;
+
+  if (!_bus->transfer(_i2caddr, &command, 1, &value, 1)) {
+    _busFault = true;
+  } else if (reg < TCS34725_SHADOW_SIZE) {
+    _shadow[reg] = value;
+    _shadowValid |= (1U << reg);
+  }
+  return value;
+}
 
-  _wire->requestFrom(_i2caddr, (uint8_t)1);
-#if ARDUINO >= 100
-  return _wire->read();
-#else
-  return _wire->receive();
-#endif
+/*!
+ *  @brief  Gets the value of a configuration register, from the shadow copy
+ *          if it is known, or else by reading it over I2C
+ *  @param  reg
+ *  @return value
+ */
+uint8_t Adafruit_TCS34725::readShadow(uint8_t reg) {
+  if (reg < TCS34725_SHADOW_SIZE && (_shadowValid & (1U << reg))) {
+    return _shadow[reg];
+  }
+  return read8(reg);
 }
 
+/*!
+ *  @brief  Forgets the shadow copies of the configuration registers, so that
+ *          they are read and written over I2C again. This must be called if
+ *          the sensor may have been reset, as after a bus fault
+ */
+void Adafruit_TCS34725::invalidateShadow() { _shadowValid = 0; }
+
 /*!
  *  @brief  Reads a 16 bit values over I2C
  *  @param  reg
  *  @return value
  */
 uint16_t Adafruit_TCS34725::read16(uint8_t reg) {
-  uint16_t x;
-  uint16_t t;
-
-  _wire->beginTransmission(_i2caddr);
-#if ARDUINO >= 100
-  _wire->write(TCS34725_COMMAND_BIT | reg);
-#else
-  _wire->send(TCS34725_COMMAND_BIT | reg);
-#endif
-  _wire->endTransmission();
-
-  _wire->requestFrom(_i2caddr, (uint8_t)2);
-#if ARDUINO >= 100
-  t = _wire->read();
-  x = _wire->read();
-#else
-  t = _wire->receive();
-  x = _wire->receive();
-#endif
-  x <<= 8;
-  x |= t;
-  return x;
+  uint8_t command = TCS34725_COMMAND_BIT | reg;
+  uint8_t buffer[2] = {0, 0};
+
+  if (!_bus->transfer(_i2caddr, &command, 1, buffer, 2)) {
+    _busFault = true;
+  }
+  return ((uint16_t)buffer[1] << 8) | buffer[0];
 }
 
 /*!
  *  @brief  Enables the device
  */
 void Adafruit_TCS34725::enable() {
-  write8(TCS34725_ENABLE, TCS34725_ENABLE_PON);
-  delay(3);
-  write8(TCS34725_ENABLE, TCS34725_ENABLE_PON | TCS34725_ENABLE_AEN);
+  uint8_t reg = readShadow(TCS34725_ENABLE);
+
+  /* Nothing to do, and no need to wait, if the ADC is already running */
+  if ((reg & (TCS34725_ENABLE_PON | TCS34725_ENABLE_AEN)) ==
+      (TCS34725_ENABLE_PON | TCS34725_ENABLE_AEN)) {
+    return;
+  }
+
+  /* The oscillator needs 2.4ms to warm up after power on */
+  if (!(reg & TCS34725_ENABLE_PON)) {
+    reg |= TCS34725_ENABLE_PON;
+    write8(TCS34725_ENABLE, reg);
+    delay(3);
+  }
+  write8(TCS34725_ENABLE, reg | TCS34725_ENABLE_AEN);
   /* Set a delay for the integration time.
     This is only necessary in the case where enabling and then
     immediately trying to read values back. This is because setting
@@ -152,8 +176,7 @@ void Adafruit_TCS34725::enable() {
  */
 void Adafruit_TCS34725::disable() {
   /* Turn the device off to save power */
-  uint8_t reg = 0;
-  reg = read8(TCS34725_ENABLE);
+  uint8_t reg = readShadow(TCS34725_ENABLE);
   write8(TCS34725_ENABLE, reg & ~(TCS34725_ENABLE_PON | TCS34725_ENABLE_AEN));
 }
 
@@ -166,6 +189,10 @@ void Adafruit_TCS34725::disable() {
  */
 Adafruit_TCS34725::Adafruit_TCS34725(tcs34725IntegrationTime_t it,
                                      tcs34725Gain_t gain) {
+  _bus = &_twoWire;
+  _i2caddr = TCS34725_ADDRESS;
+  _shadowValid = 0;
+  _busFault = false;
   _tcs34725Initialised = false;
   _tcs34725IntegrationTime = it;
   _tcs34725Gain = gain;
@@ -179,7 +206,8 @@ Adafruit_TCS34725::Adafruit_TCS34725(tcs34725IntegrationTime_t it,
  */
 boolean Adafruit_TCS34725::begin(uint8_t addr) {
   _i2caddr = addr;
-  _wire = &Wire;
+  _twoWire.set_wire(&Wire);
+  _bus = &_twoWire;
 
   return init();
 }
@@ -194,7 +222,24 @@ boolean Adafruit_TCS34725::begin(uint8_t addr) {
  */
 boolean Adafruit_TCS34725::begin(uint8_t addr, TwoWire *theWire) {
   _i2caddr = addr;
-  _wire = theWire;
+  _twoWire.set_wire(theWire);
+  _bus = &_twoWire;
+
+  return init();
+}
+
+/*!
+ *  @brief  Initializes I2C and configures the sensor, with all transfers
+ *          carried by the given transport
+ *  @param  addr
+ *          i2c address
+ *  @param  *bus
+ *          The transport, such as an AsyncI2CTransport
+ *  @return True if initialization was successful, otherwise false.
+ */
+boolean Adafruit_TCS34725::begin(uint8_t addr, I2CTransport *bus) {
+  _i2caddr = addr;
+  _bus = bus;
 
   return init();
 }
@@ -205,7 +250,8 @@ boolean Adafruit_TCS34725::begin(uint8_t addr, TwoWire *theWire) {
  */
 boolean Adafruit_TCS34725::begin() {
   _i2caddr = TCS34725_ADDRESS;
-  _wire = &Wire;
+  _twoWire.set_wire(&Wire);
+  _bus = &_twoWire;
 
   return init();
 }
@@ -215,7 +261,26 @@ boolean Adafruit_TCS34725::begin() {
  *  @return True if initialization was successful, otherwise false.
  */
 boolean Adafruit_TCS34725::init() {
-  _wire->begin();
+  if (!identify()) {
+    return false;
+  }
+
+  /* Note: by default, the device is in power down mode on bootup */
+  enable();
+
+  return true;
+}
+
+/*!
+ *  @brief  Checks that the sensor answers with its ID and sets its
+ *          integration time and gain, without powering it up or waiting
+ *  @return True if the sensor answered, otherwise false.
+ */
+boolean Adafruit_TCS34725::identify() {
+  _bus->begin();
+
+  /* The sensor may have been reset, so its registers are unknown */
+  invalidateShadow();
 
   /* Make sure we're actually connected */
   uint8_t x = read8(TCS34725_ID);
@@ -228,12 +293,60 @@ boolean Adafruit_TCS34725::init() {
   setIntegrationTime(_tcs34725IntegrationTime);
   setGain(_tcs34725Gain);
 
-  /* Note: by default, the device is in power down mode on bootup */
-  enable();
-
   return true;
 }
 
+/*!
+ *  @brief  Checks the sensor's ID and sets it up like begin(), but leaves it
+ *          powered down and doesn't wait, so several sensors can be started
+ *          at once with powerOn(), startADC() and dataValid()
+ *  @param  addr
+ *          i2c address
+ *  @param  *bus
+ *          The transport, such as an AsyncI2CTransport
+ *  @return True if the sensor answered, otherwise false.
+ */
+boolean Adafruit_TCS34725::probe(uint8_t addr, I2CTransport *bus) {
+  _i2caddr = addr;
+  _bus = bus;
+
+  return identify();
+}
+
+/*!
+ *  @brief  Turns on the sensor's oscillator without waiting. The ADC may be
+ *          started with startADC() 2.4ms later
+ */
+void Adafruit_TCS34725::powerOn() {
+  write8(TCS34725_ENABLE, readShadow(TCS34725_ENABLE) | TCS34725_ENABLE_PON);
+}
+
+/*!
+ *  @brief  Starts the RGBC ADC without waiting for the first integration;
+ *          dataValid() tells when it's done
+ */
+void Adafruit_TCS34725::startADC() {
+  write8(TCS34725_ENABLE, readShadow(TCS34725_ENABLE) | TCS34725_ENABLE_PON |
+                              TCS34725_ENABLE_AEN);
+}
+
+/*!
+ *  @brief  Stops the RGBC ADC but leaves the oscillator on, so that
+ *          startADC() begins a fresh integration at once
+ */
+void Adafruit_TCS34725::stopADC() {
+  write8(TCS34725_ENABLE, readShadow(TCS34725_ENABLE) & ~TCS34725_ENABLE_AEN);
+}
+
+/*!
+ *  @brief  Checks whether an integration has finished since the ADC was
+ *          started, from the AVALID bit of the status register
+ *  @return True if the RGBC data is valid
+ */
+boolean Adafruit_TCS34725::dataValid() {
+  return (read8(TCS34725_STATUS) & TCS34725_STATUS_AVALID) != 0;
+}
+
 /*!
  *  @brief  Sets the integration time for the TC34725
  *  @param  it
@@ -241,7 +354,7 @@ boolean Adafruit_TCS34725::init() {
  */
 void Adafruit_TCS34725::setIntegrationTime(tcs34725IntegrationTime_t it) {
   if (!_tcs34725Initialised)
-    begin();
+    init();
 
   /* Update the timing register */
   write8(TCS34725_ATIME, it);
@@ -257,7 +370,7 @@ void Adafruit_TCS34725::setIntegrationTime(tcs34725IntegrationTime_t it) {
  */
 void Adafruit_TCS34725::setGain(tcs34725Gain_t gain) {
   if (!_tcs34725Initialised)
-    begin();
+    init();
 
   /* Update the timing register */
   write8(TCS34725_CONTROL, gain);
@@ -280,7 +393,7 @@ void Adafruit_TCS34725::setGain(tcs34725Gain_t gain) {
 void Adafruit_TCS34725::getRawData(uint16_t *r, uint16_t *g, uint16_t *b,
                                    uint16_t *c) {
   if (!_tcs34725Initialised)
-    begin();
+    init();
 
   *c = read16(TCS34725_CDATAL);
   *r = read16(TCS34725_RDATAL);
@@ -310,6 +423,34 @@ void Adafruit_TCS34725::getRawData(uint16_t *r, uint16_t *g, uint16_t *b,
   }
 }
 
+/*!
+ *  @brief  Reads the raw red, green, blue and clear channel values without
+ *          waiting for the next integration to finish afterwards. The caller
+ *          is responsible for pacing reads to the integration time.
+ *  @param  *r
+ *          Red value
+ *  @param  *g
+ *          Green value
+ *  @param  *b
+ *          Blue value
+ *  @param  *c
+ *          Clear channel value
+ *  @return True if every transfer worked, false if any failed or the sensor
+ *          hasn't been started, in which case the values mean nothing
+ */
+boolean Adafruit_TCS34725::getRawDataNoDelay(uint16_t *r, uint16_t *g,
+                                             uint16_t *b, uint16_t *c) {
+  if (!_tcs34725Initialised)
+    return false;
+
+  _busFault = false;
+  *c = read16(TCS34725_CDATAL);
+  *r = read16(TCS34725_RDATAL);
+  *g = read16(TCS34725_GDATAL);
+  *b = read16(TCS34725_BDATAL);
+  return !_busFault;
+}
+
 /*!
  *  @brief  Reads the raw red, green, blue and clear channel values in
  *          one-shot mode (e.g., wakes from sleep, takes measurement, enters
@@ -326,7 +467,7 @@ void Adafruit_TCS34725::getRawData(uint16_t *r, uint16_t *g, uint16_t *b,
 void Adafruit_TCS34725::getRawDataOneShot(uint16_t *r, uint16_t *g, uint16_t *b,
                                           uint16_t *c) {
   if (!_tcs34725Initialised)
-    begin();
+    init();
 
   enable();
   getRawData(r, g, b, c);
@@ -427,25 +568,7 @@ uint16_t Adafruit_TCS34725::calculateColorTemperature_dn40(uint16_t r,
     return 0;
   }
 
-  /* Analog/Digital saturation:
-   *
-   * (a) As light becomes brighter, the clear channel will tend to
-   *     saturate first since R+G+B is approximately equal to C.
-   * (b) The TCS34725 accumulates 1024 counts per 2.4ms of integration
-   *     time, up to a maximum values of 65535. This means analog
-   *     saturation can occur up to an integration time of 153.6ms
-   *     (64*2.4ms=153.6ms).
-   * (c) If the integration time is > 153.6ms, digital saturation will
-   *     occur before analog saturation. Digital saturation occurs when
-   *     the count reaches 65535.
-   */
-  if ((256 - _tcs34725IntegrationTime) > 63) {
-    /* Track digital saturation */
-    sat = 65535;
-  } else {
-    /* Track analog saturation */
-    sat = 1024 * (256 - _tcs34725IntegrationTime);
-  }
+  sat = saturation(_tcs34725IntegrationTime);
 
   /* Ripple rejection:
    *
@@ -454,20 +577,7 @@ uint16_t Adafruit_TCS34725::calculateColorTemperature_dn40(uint16_t r,
    * (b) If an integration time faster than 50ms is required, you may need
    *     to average a number of samples over a 50ms period to reject ripple
    *     from fluorescent and incandescent light sources.
-   *
-   * Ripple saturation notes:
-   *
-   * (a) If there is ripple in the received signal, the value read from C
-   *     will be less than the max, but still have some effects of being
-   *     saturated. This means that you can be below the 'sat' value, but
-   *     still be saturating. At integration times >150ms this can be
-   *     ignored, but <= 150ms you should calculate the 75% saturation
-   *     level to avoid this problem.
    */
-  if ((256 - _tcs34725IntegrationTime) <= 63) {
-    /* Adjust sat to 75% to avoid analog saturation if atime < 153.6ms */
-    sat -= sat / 4;
-  }
 
   /* Check for saturation and mark the sample as invalid if true */
   if (c >= sat) {
@@ -495,6 +605,53 @@ uint16_t Adafruit_TCS34725::calculateColorTemperature_dn40(uint16_t r,
   return cct;
 }
 
+/*!
+ *  @brief  Computes the clear channel count above which a reading taken with
+ *          the given integration time should be treated as saturated
+ *  @param  it
+ *          Integration Time
+ *  @return Saturation level in counts
+ */
+uint16_t Adafruit_TCS34725::saturation(tcs34725IntegrationTime_t it) {
+  uint16_t sat; /* Digital saturation level */
+
+  /* Analog/Digital saturation:
+   *
+   * (a) As light becomes brighter, the clear channel will tend to
+   *     saturate first since R+G+B is approximately equal to C.
+   * (b) The TCS34725 accumulates 1024 counts per 2.4ms of integration
+   *     time, up to a maximum values of 65535. This means analog
+   *     saturation can occur up to an integration time of 153.6ms
+   *     (64*2.4ms=153.6ms).
+   * (c) If the integration time is > 153.6ms, digital saturation will
+   *     occur before analog saturation. Digital saturation occurs when
+   *     the count reaches 65535.
+   */
+  if ((256 - it) > 63) {
+    /* Track digital saturation */
+    sat = 65535;
+  } else {
+    /* Track analog saturation */
+    sat = 1024 * (256 - it);
+  }
+
+  /* Ripple saturation notes:
+   *
+   * (a) If there is ripple in the received signal, the value read from C
+   *     will be less than the max, but still have some effects of being
+   *     saturated. This means that you can be below the 'sat' value, but
+   *     still be saturating. At integration times >150ms this can be
+   *     ignored, but <= 150ms you should calculate the 75% saturation
+   *     level to avoid this problem.
+   */
+  if ((256 - it) <= 63) {
+    /* Adjust sat to 75% to avoid analog saturation if atime < 153.6ms */
+    sat -= sat / 4;
+  }
+
+  return sat;
+}
+
 /*!
  *  @brief  Converts the raw R/G/B values to lux
  *  @param  r
@@ -521,7 +678,7 @@ uint16_t Adafruit_TCS34725::calculateLux(uint16_t r, uint16_t g, uint16_t b) {
  *          Interrupt (True/False)
  */
 void Adafruit_TCS34725::setInterrupt(boolean i) {
-  uint8_t r = read8(TCS34725_ENABLE);
+  uint8_t r = readShadow(TCS34725_ENABLE);
   if (i) {
     r |= TCS34725_ENABLE_AIEN;
   } else {
@@ -534,13 +691,9 @@ void Adafruit_TCS34725::setInterrupt(boolean i) {
  *  @brief  Clears inerrupt for TCS34725
  */
 void Adafruit_TCS34725::clearInterrupt() {
-  _wire->beginTransmission(_i2caddr);
-#if ARDUINO >= 100
-  _wire->write(TCS34725_COMMAND_BIT | 0x66);
-#else
-  _wire->send(TCS34725_COMMAND_BIT | 0x66);
-#endif
-  _wire->endTransmission();
+  uint8_t command = TCS34725_COMMAND_BIT | 0x66;
+
+  _bus->transfer(_i2caddr, &command, 1, NULL, 0);
 }
 
 /*!
@@ -556,3 +709,43 @@ void Adafruit_TCS34725::setIntLimits(uint16_t low, uint16_t high) {
   write8(0x06, high & 0xFF);
   write8(0x07, high >> 8);
 }
+
+/*!
+ *  @brief  Turns the wait state between RGBC cycles on or off. With the wait
+ *          state on the sensor sleeps for the wait time after each cycle,
+ *          which saves power when readings are only needed now and then
+ *  @param  w
+ *          Wait state (True/False)
+ */
+void Adafruit_TCS34725::setWait(boolean w) {
+  uint8_t r = readShadow(TCS34725_ENABLE);
+  if (w) {
+    r |= TCS34725_ENABLE_WEN;
+  } else {
+    r &= ~TCS34725_ENABLE_WEN;
+  }
+  write8(TCS34725_ENABLE, r);
+}
+
+/*!
+ *  @brief  Sets the wait time used when the wait state is on
+ *  @param  wtime
+ *          Wait time register value, such as TCS34725_WTIME_204MS; each step
+ *          below 256 adds 2.4 ms
+ *  @param  longWait
+ *          True to make each step twelve times longer (WLONG)
+ */
+void Adafruit_TCS34725::setWaitTime(uint8_t wtime, boolean longWait) {
+  write8(TCS34725_WTIME, wtime);
+  write8(TCS34725_CONFIG, longWait ? TCS34725_CONFIG_WLONG : 0);
+}
+
+/*!
+ *  @brief  Sets how many clear channel readings in a row must be outside the
+ *          interrupt limits before an interrupt is raised
+ *  @param  pers
+ *          Persistence setting, such as TCS34725_PERS_2_CYCLE
+ */
+void Adafruit_TCS34725::setPersistence(uint8_t pers) {
+  write8(TCS34725_PERS, pers);
+}
@@ -41,6 +41,8 @@
 
 #include <Wire.h>
 
+#include "i2ctransport.h"
+
 #define TCS34725_ADDRESS (0x29)     /**< I2C address **/
 #define TCS34725_COMMAND_BIT (0x80) /**< Command bit **/
 #define TCS34725_ENABLE (0x00)      /**< Interrupt Enable register */
@@ -136,6 +138,9 @@
 #define TCS34725_GDATAH (0x19) /**< Green channel data high byte */
 #define TCS34725_BDATAL (0x1A) /**< Blue channel data low byte */
 #define TCS34725_BDATAH (0x1B) /**< Blue channel data high byte */
+#define TCS34725_SHADOW_SIZE                                                   \
+  (0x10) /**< Registers below this address are configuration registers which \
+            the driver keeps shadow copies of */
 
 /** Integration time settings for TCS34725 */
 typedef enum {
@@ -171,30 +176,62 @@ public:
                     tcs34725Gain_t = TCS34725_GAIN_1X);
 
   boolean begin(uint8_t addr, TwoWire *theWire);
+  boolean begin(uint8_t addr, I2CTransport *bus);
   boolean begin(uint8_t addr);
   boolean begin();
   boolean init();
+  boolean probe(uint8_t addr, I2CTransport *bus);
+  void powerOn();
+  void startADC();
+  void stopADC();
+  boolean dataValid();
 
   void setIntegrationTime(tcs34725IntegrationTime_t it);
   void setGain(tcs34725Gain_t gain);
+  /*!
+   *  @brief  Gets the integration time most recently set
+   *  @return Integration Time
+   */
+  tcs34725IntegrationTime_t getIntegrationTime() {
+    return _tcs34725IntegrationTime;
+  }
+  /*!
+   *  @brief  Gets the gain most recently set
+   *  @return Gain
+   */
+  tcs34725Gain_t getGain() { return _tcs34725Gain; }
   void getRawData(uint16_t *r, uint16_t *g, uint16_t *b, uint16_t *c);
+  boolean getRawDataNoDelay(uint16_t *r, uint16_t *g, uint16_t *b,
+                            uint16_t *c);
   void getRGB(float *r, float *g, float *b);
   void getRawDataOneShot(uint16_t *r, uint16_t *g, uint16_t *b, uint16_t *c);
   uint16_t calculateColorTemperature(uint16_t r, uint16_t g, uint16_t b);
   uint16_t calculateColorTemperature_dn40(uint16_t r, uint16_t g, uint16_t b,
                                           uint16_t c);
   uint16_t calculateLux(uint16_t r, uint16_t g, uint16_t b);
+  static uint16_t saturation(tcs34725IntegrationTime_t it);
   void write8(uint8_t reg, uint32_t value);
   uint8_t read8(uint8_t reg);
   uint16_t read16(uint8_t reg);
+  uint8_t readShadow(uint8_t reg);
+  void invalidateShadow();
   void setInterrupt(boolean flag);
   void clearInterrupt();
   void setIntLimits(uint16_t l, uint16_t h);
+  void setWait(boolean w);
+  void setWaitTime(uint8_t wtime, boolean longWait);
+  void setPersistence(uint8_t pers);
   void enable();
   void disable();
 
 private:
-  TwoWire *_wire;
+  boolean identify();
+
+  I2CTransport *_bus;
+  TwoWireTransport _twoWire;
+  uint8_t _shadow[TCS34725_SHADOW_SIZE];
+  uint16_t _shadowValid;
+  boolean _busFault;
   uint8_t _i2caddr;
   boolean _tcs34725Initialised;
   tcs34725Gain_t _tcs34725Gain;
@@ -0,0 +1,176 @@
+//*****************************************************************************
+/** @file    autoexposure.cpp
+ *  @brief   Source code of the color sensor's automatic exposure controller.
+ *  @details This file contains the ladder of sensor settings and the methods
+ *           of class @c AutoExposure.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include "autoexposure.h"                   // Header for this class
+
+
+/** @brief   Settings from least to most sensitive.
+ *  @details Gain is raised first because it costs no time; integration times
+ *           longer than 154 ms are not used as they are too slow for sorting.
+ *           Each setting's sensitivity is worked out by @c sensitivity(), so
+ *           that it's the same number which is used to scale readings taken
+ *           outside the ladder.
+ */
+static const ExposureStep ladder[] =
+{
+    {TCS34725_INTEGRATIONTIME_2_4MS, TCS34725_GAIN_1X},
+    {TCS34725_INTEGRATIONTIME_2_4MS, TCS34725_GAIN_4X},
+    {TCS34725_INTEGRATIONTIME_2_4MS, TCS34725_GAIN_16X},
+    {TCS34725_INTEGRATIONTIME_2_4MS, TCS34725_GAIN_60X},
+    {TCS34725_INTEGRATIONTIME_24MS,  TCS34725_GAIN_60X},
+    {TCS34725_INTEGRATIONTIME_50MS,  TCS34725_GAIN_60X},
+    {TCS34725_INTEGRATIONTIME_101MS, TCS34725_GAIN_60X},
+    {TCS34725_INTEGRATIONTIME_154MS, TCS34725_GAIN_60X}
+};
+
+/// The number of settings in the ladder
+#define LADDER_SIZE (sizeof (ladder) / sizeof (ladder[0]))
+
+
+/** @brief   Find the sensitivity of one setting in the ladder.
+ *  @param   step The setting's place in the ladder
+ *  @return  The setting's gain times its integration cycles
+ */
+static uint16_t step_sensitivity (uint8_t step)
+{
+    return AutoExposure::sensitivity (ladder[step].atime, ladder[step].gain);
+}
+
+
+/** @brief   Find the least sensitive setting which gives a share of its full
+ *           scale at a given light level.
+ *  @param   level The light level, in counts per unit of sensitivity with
+ *           eight fraction bits
+ *  @param   fraction The share of full scale wanted is one over this
+ *  @return  The setting's place in the ladder, or the most sensitive setting
+ *           if none gives that much
+ */
+static uint8_t least_step (uint32_t level, uint8_t fraction)
+{
+    for (uint8_t step = 0; step < LADDER_SIZE; step++)
+    {
+        uint32_t predicted = (level * step_sensitivity (step)) >> 8;
+        if (predicted >= Adafruit_TCS34725::saturation (ladder[step].atime)
+                         / fraction)
+        {
+            return step;
+        }
+    }
+    return LADDER_SIZE - 1;
+}
+
+
+/** @brief   Create a controller starting with the least sensitive setting.
+ *  @details The least sensitive setting is what the sensor driver uses by
+ *           default, so the controller and sensor agree at startup.
+ */
+AutoExposure::AutoExposure (void)
+{
+    index = 0;
+}
+
+
+/** @brief   Look at a reading's clear count and choose new settings if needed.
+ *  @param   clear The clear channel count of a reading taken with the
+ *           settings most recently returned by this controller
+ *  @return  True if the settings have changed and must be sent to the sensor
+ */
+bool AutoExposure::update (uint16_t clear)
+{
+    uint8_t old_index = index;
+
+    // A saturated reading says nothing about how bright the light is, so go
+    // to the bottom of the ladder; the next reading will be in range
+    if (clear >= Adafruit_TCS34725::saturation (ladder[index].atime))
+    {
+        index = 0;
+        return (index != old_index);
+    }
+
+    // Estimate the light level as counts per unit of sensitivity, keeping
+    // eight fraction bits. Zero counts are treated as one so that a totally
+    // dark reading climbs the ladder
+    uint32_t level = ((uint32_t)(clear ? clear : 1) << 8)
+                     / step_sensitivity (index);
+
+    // Find the least sensitive setting which gives at least 1/8 full scale
+    uint8_t wanted = least_step (level, 8);
+
+    // Unless the reading is getting close to saturation, only give up
+    // sensitivity for a setting which would have twice the minimum signal,
+    // so that noise near a boundary doesn't make the setting flip back and
+    // forth. Gain steps of four mean that any reading which could move down
+    // a step is already over half of saturation, so close to saturation
+    // means three quarters of it
+    if (wanted < index && clear < get_saturation () / 4 * 3)
+    {
+        wanted = least_step (level, 4);
+        if (wanted > index)
+        {
+            wanted = index;
+        }
+    }
+    index = wanted;
+
+    return (index != old_index);
+}
+
+
+/** @brief   Return the integration time which should be used now.
+ *  @return  The integration time setting to give the sensor
+ */
+tcs34725IntegrationTime_t AutoExposure::get_integration_time (void) const
+{
+    return ladder[index].atime;
+}
+
+
+/** @brief   Return the gain which should be used now.
+ *  @return  The gain setting to give the sensor
+ */
+tcs34725Gain_t AutoExposure::get_gain (void) const
+{
+    return ladder[index].gain;
+}
+
+
+/** @brief   Return the clear count at which the current setting saturates.
+ *  @return  The saturation level in counts, as used by the DN40 method
+ */
+uint16_t AutoExposure::get_saturation (void) const
+{
+    return Adafruit_TCS34725::saturation (ladder[index].atime);
+}
+
+
+/** @brief   Return the current setting's gain times its integration cycles.
+ *  @details Raw counts are roughly proportional to this number, so it can be
+ *           used to compare readings taken with different settings.
+ *  @return  The sensitivity of the current setting
+ */
+uint16_t AutoExposure::get_sensitivity (void) const
+{
+    return step_sensitivity (index);
+}
+
+
+/** @brief   Compute the gain times integration cycles of any setting.
+ *  @param   atime The integration time setting
+ *  @param   gain The gain setting
+ *  @return  The sensitivity of that setting, in the units of the ladder
+ */
+uint16_t AutoExposure::sensitivity (tcs34725IntegrationTime_t atime,
+                                    tcs34725Gain_t gain)
+{
+    static const uint8_t gain_multiplier[] = {1, 4, 16, 60};
+    uint32_t product = (uint32_t)gain_multiplier[gain & 0x03] * (256 - atime);
+
+    return (product > 0xFFFF) ? 0xFFFF : product;
+}
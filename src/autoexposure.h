@@ -0,0 +1,82 @@
+//*****************************************************************************
+/** @file    autoexposure.h
+ *  @brief   Automatic gain and integration time control for the color sensor.
+ *  @details This file contains a controller which watches the clear channel
+ *           of each reading and chooses the sensor's gain and integration
+ *           time so that readings are neither saturated nor too small to be
+ *           useful. Of the settings which give a usable signal it picks the
+ *           one with the shortest integration time, which gives the most
+ *           readings per second; gain is raised before integration time is.
+ *
+ *           The controller only does arithmetic; the caller applies its
+ *           settings with @c Adafruit_TCS34725::setGain() and
+ *           @c Adafruit_TCS34725::setIntegrationTime().
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _AUTOEXPOSURE_H_
+#define _AUTOEXPOSURE_H_
+
+#include <stdint.h>
+#include "Adafruit_TCS34725.h"
+
+
+/** @brief   One gain and integration time setting the controller may choose.
+ */
+struct ExposureStep
+{
+    tcs34725IntegrationTime_t atime;        ///< Integration time setting
+    tcs34725Gain_t gain;                    ///< Gain setting
+};
+
+
+/** @brief   Class which chooses gain and integration time from clear counts.
+ *  @details The controller has a ladder of settings, from least to most
+ *           sensitive, in which gain is stepped through at the shortest
+ *           integration time before longer integration times are used. Each
+ *           reading's clear count is given to @c update(). A saturated
+ *           reading drops the sensitivity to the bottom of the ladder; an
+ *           unsaturated one is used to estimate the light level and jump
+ *           straight to the least sensitive setting which gives at least
+ *           1/8 of full scale. Some hysteresis keeps the setting from
+ *           flipping back and forth when the light is near a boundary.
+ */
+class AutoExposure
+{
+protected:
+    uint8_t index;                          ///< Current place on the ladder
+
+public:
+    // Create a controller starting with the least sensitive setting
+    AutoExposure (void);
+
+    // Look at a reading's clear count and choose new settings if needed
+    bool update (uint16_t clear);
+
+    // Return the integration time which should be used now
+    tcs34725IntegrationTime_t get_integration_time (void) const;
+
+    // Return the gain which should be used now
+    tcs34725Gain_t get_gain (void) const;
+
+    // Return the clear count at which the current setting saturates
+    uint16_t get_saturation (void) const;
+
+    // Return the current setting's gain times its integration cycles
+    uint16_t get_sensitivity (void) const;
+
+    // Compute the gain times integration cycles of any setting
+    static uint16_t sensitivity (tcs34725IntegrationTime_t atime,
+                                 tcs34725Gain_t gain);
+
+    /// Return the current place on the ladder, 0 being least sensitive
+    uint8_t get_index (void) const
+    {
+        return index;
+    }
+};
+
+#endif // _AUTOEXPOSURE_H_
@@ -0,0 +1,227 @@
+//*****************************************************************************
+/** @file    bootseq.cpp
+ *  @brief   Source code of the startup sequence.
+ *  @details This file contains the methods of classes @c BootSequence and
+ *           @c SensorStartup.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <PrintStream.h>
+#include "bootseq.h"                        // Header for these classes
+
+
+/// Microseconds the sensor's oscillator needs after it's turned on
+#define BOOT_WARM_UP_US 2400
+
+/// Microseconds between transfers asking a sensor whether it's ready
+#define BOOT_ASK_US 500
+
+
+/** @brief   Create a sequence with no stages.
+ *  @param   p_name A name for the sequence, used when it's printed
+ */
+BootSequence::BootSequence (const char* p_name)
+    : BaseShare (p_name)
+{
+    num_stages = 0;
+    started = false;
+    begin_us = 0;
+    total_us = 0;
+}
+
+
+/** @brief   Add a stage to the sequence.
+ *  @param   p_stage_name A name for the stage, used when it's printed
+ *  @param   p_poll The function which does the stage's work and says whether
+ *           it's ready
+ *  @param   p_context A pointer given to the function
+ *  @param   timeout_us The longest the stage may take before it has failed
+ *  @return  The number of the stage, or -1 if there's no more room
+ */
+int8_t BootSequence::add (const char* p_stage_name,
+                          BootState (*p_poll) (void* p_context,
+                                               uint32_t now_us),
+                          void* p_context, uint32_t timeout_us)
+{
+    if (num_stages >= BOOT_MAX_STAGES || p_poll == NULL)
+    {
+        return -1;
+    }
+    Stage& stage = stages[num_stages];
+    stage.p_name = p_stage_name;
+    stage.p_poll = p_poll;
+    stage.p_context = p_context;
+    stage.timeout_us = timeout_us;
+    stage.start_us = 0;
+    stage.time_us = 0;
+    stage.state = BOOT_WAITING;
+    return num_stages++;
+}
+
+
+/** @brief   Poll each stage which isn't finished once.
+ *  @details The first poll begins every stage. A stage which is still
+ *           waiting when its time is up has failed.
+ *  @param   now_us The time now, in microseconds
+ *  @return  True once every stage is ready or has failed
+ */
+bool BootSequence::poll (uint32_t now_us)
+{
+    if (!started)
+    {
+        started = true;
+        begin_us = now_us;
+        for (uint8_t index = 0; index < num_stages; index++)
+        {
+            stages[index].start_us = now_us;
+        }
+    }
+
+    bool finished = true;
+    for (uint8_t index = 0; index < num_stages; index++)
+    {
+        Stage& stage = stages[index];
+        if (stage.state != BOOT_WAITING)
+        {
+            continue;
+        }
+        stage.state = stage.p_poll (stage.p_context, now_us);
+        stage.time_us = now_us - stage.start_us;
+        if (stage.state == BOOT_WAITING && stage.time_us >= stage.timeout_us)
+        {
+            stage.state = BOOT_FAILED;
+        }
+        finished = finished && (stage.state != BOOT_WAITING);
+    }
+    total_us = now_us - begin_us;
+    return finished;
+}
+
+
+/** @brief   Get how far a stage has got.
+ *  @param   stage The number of the stage
+ *  @return  The stage's state, or @c BOOT_FAILED if there's no such stage
+ */
+BootState BootSequence::get_state (uint8_t stage) const
+{
+    return (stage < num_stages) ? stages[stage].state : BOOT_FAILED;
+}
+
+
+/** @brief   Get the time a stage took, so far if it isn't finished.
+ *  @param   stage The number of the stage
+ *  @return  The time in microseconds, or 0 if there's no such stage
+ */
+uint32_t BootSequence::get_time_us (uint8_t stage) const
+{
+    return (stage < num_stages) ? stages[stage].time_us : 0;
+}
+
+
+/** @brief   Print the time each stage took.
+ *  @details The time from reset to the first poll is printed first, then
+ *           each stage on a line of its own, then the time until every stage
+ *           had finished.
+ *  @param   printer Reference to a serial device on which to print
+ */
+void BootSequence::print_stages (Print& printer)
+{
+    printer << "started " << begin_us << " us after reset, all done in "
+            << total_us << " us" << endl;
+    for (uint8_t index = 0; index < num_stages; index++)
+    {
+        const Stage& stage = stages[index];
+        printer.printf ("%-16s", "");
+        printer << stage.p_name << ' ' << stage.time_us << " us"
+                << ((stage.state == BOOT_READY) ? "" : " (failed)") << endl;
+    }
+}
+
+
+/** @brief   Print the stage times within the list of shares.
+ *  @param   printer Reference to a serial device on which to print
+ */
+void BootSequence::print_in_list (Print& printer)
+{
+    // Print this sequence's name and pad it to 16 characters
+    printer.printf ("%-16sboot\t", name);
+    print_stages (printer);
+
+    // Call the next item
+    if (p_next != NULL)
+    {
+        p_next->print_in_list (printer);
+    }
+}
+
+
+/** @brief   Create a startup for the sensor in one of a scheduler's lanes.
+ *  @param   a_scheduler The scheduler to which the sensor has been added
+ *  @param   a_lane The sensor's lane
+ */
+SensorStartup::SensorStartup (I2CBusScheduler& a_scheduler, uint8_t a_lane)
+    : scheduler (a_scheduler)
+{
+    lane = a_lane;
+    step = PROBE;
+    begun = false;
+    step_us = 0;
+    asked_us = 0;
+}
+
+
+/** @brief   Do the next bit of starting the sensor.
+ *  @details At most one short transfer is done on each call, and the sensor
+ *           is asked whether it's ready no more often than every
+ *           @c BOOT_ASK_US, so that several sensors on one bus can be
+ *           started at once.
+ *  @param   now_us The time now, in microseconds
+ *  @return  @c BOOT_READY once the first integration is valid,
+ *           @c BOOT_FAILED if there's no such lane, else @c BOOT_WAITING
+ */
+BootState SensorStartup::poll (uint32_t now_us)
+{
+    Adafruit_TCS34725* p_sensor = scheduler.get_sensor (lane);
+
+    if (p_sensor == NULL)
+    {
+        return BOOT_FAILED;
+    }
+    if (begun && now_us - asked_us < BOOT_ASK_US)
+    {
+        return BOOT_WAITING;
+    }
+    begun = true;
+    asked_us = now_us;
+
+    switch (step)
+    {
+        case PROBE:
+            if (p_sensor->probe (TCS34725_ADDRESS, scheduler.get_port (lane)))
+            {
+                p_sensor->powerOn ();
+                step = WARM_UP;
+                step_us = now_us;
+            }
+            break;
+
+        case WARM_UP:
+            if (now_us - step_us >= BOOT_WARM_UP_US)
+            {
+                p_sensor->startADC ();
+                step = INTEGRATE;
+                step_us = now_us;
+            }
+            break;
+
+        case INTEGRATE:
+            if (p_sensor->dataValid ())
+            {
+                return BOOT_READY;
+            }
+            break;
+    }
+    return BOOT_WAITING;
+}
@@ -0,0 +1,150 @@
+//*****************************************************************************
+/** @file    bootseq.h
+ *  @brief   Startup sequence which brings up the devices side by side.
+ *  @details Starting the sorter used to mean a fixed wait for the serial
+ *           port, then starting each color sensor in turn with fixed waits
+ *           for its oscillator and its first integration. This file contains
+ *           a sequence of startup stages which are all begun together and
+ *           polled in turn, each one until it's ready, has failed or has run
+ *           out of time. A stage waits only for its device to say it's
+ *           ready, so the time to start up is that of the slowest device
+ *           rather than the sum of every fixed wait.
+ *
+ *           The time each stage took is kept and printed by
+ *           @c print_all_shares(). Times are given to the sequence rather
+ *           than read from the clock, so it can be run with simulated
+ *           devices.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _BOOTSEQ_H_
+#define _BOOTSEQ_H_
+
+#include <Arduino.h>
+#include "baseshare.h"                      // Base class for shared data items
+#include "i2cscheduler.h"                   // Schedules reads of the sensors
+
+
+/// The most stages a startup sequence can have
+#define BOOT_MAX_STAGES 8
+
+
+/// How far a startup stage has got
+enum BootState
+{
+    BOOT_WAITING,                           ///< Not ready yet
+    BOOT_READY,                             ///< Finished and working
+    BOOT_FAILED                             ///< Gave up or ran out of time
+};
+
+
+/** @brief   Class which runs startup stages side by side and times them.
+ *  @details Each stage is a function which is called with a context pointer
+ *           and the time, does a little work without waiting, and says
+ *           whether its device is ready. The first call begins the stage.
+ *           Stages are polled in the order they were added, so a stage which
+ *           others rely on, such as the serial port, should be added first
+ *           and should be ready on its first call.
+ */
+class BootSequence : public BaseShare
+{
+protected:
+    /// One stage of the startup sequence
+    struct Stage
+    {
+        const char* p_name;                 ///< Name shown in printouts
+        BootState (*p_poll) (void* p_context, uint32_t now_us);
+        void* p_context;                    ///< Passed to the function
+        uint32_t timeout_us;                ///< Longest the stage may take
+        uint32_t start_us;                  ///< Time of the first poll
+        uint32_t time_us;                   ///< Time the stage took
+        BootState state;                    ///< How far the stage has got
+    };
+
+    Stage stages[BOOT_MAX_STAGES];          ///< The stages in polling order
+    uint8_t num_stages;                     ///< How many stages were added
+    bool started;                           ///< True once polling has begun
+    uint32_t begin_us;                      ///< Time of the first poll
+    uint32_t total_us;                      ///< Time until all were done
+
+public:
+    // Create a sequence with no stages
+    BootSequence (const char* p_name = NULL);
+
+    // Add a stage to the sequence
+    int8_t add (const char* p_stage_name,
+                BootState (*p_poll) (void* p_context, uint32_t now_us),
+                void* p_context, uint32_t timeout_us);
+
+    // Poll each stage which isn't finished once
+    bool poll (uint32_t now_us);
+
+    // Get how far a stage has got
+    BootState get_state (uint8_t stage) const;
+
+    // Get the time a stage took, so far if it isn't finished
+    uint32_t get_time_us (uint8_t stage) const;
+
+    /// Return the time from the first poll until every stage was finished
+    uint32_t get_total_us (void) const
+    {
+        return total_us;
+    }
+
+    // Print the time each stage took
+    void print_stages (Print& printer);
+
+    // Print the stage times within the list of shares
+    void print_in_list (Print& printer);
+};
+
+
+/** @brief   Class which starts a TCS34725 color sensor without fixed waits.
+ *  @details The sensor is asked for its ID until it answers, its oscillator
+ *           is turned on, its ADC is started once the oscillator has warmed
+ *           up for 2.4 ms, and the sensor is ready when its status register
+ *           shows that the first integration is valid. Give @c poll_stage()
+ *           and a pointer to this object to @c BootSequence::add(). The lane
+ *           isn't scheduled; call @c I2CBusScheduler::start_lane() once the
+ *           sequence is over.
+ */
+class SensorStartup
+{
+protected:
+    /// Steps in starting the sensor
+    enum Step
+    {
+        PROBE,                              ///< Asking for the sensor's ID
+        WARM_UP,                            ///< Waiting for the oscillator
+        INTEGRATE                           ///< Waiting for AVALID
+    };
+
+    I2CBusScheduler& scheduler;             ///< Has the sensor's lane
+    uint8_t lane;                           ///< The sensor's lane
+    Step step;                              ///< Current step
+    bool begun;                             ///< True once polling has begun
+    uint32_t step_us;                       ///< Time the step began
+    uint32_t asked_us;                      ///< Time of the latest transfer
+
+public:
+    // Create a startup for the sensor in one of a scheduler's lanes
+    SensorStartup (I2CBusScheduler& a_scheduler, uint8_t a_lane);
+
+    // Do the next bit of starting the sensor
+    BootState poll (uint32_t now_us);
+
+    /** @brief   Do the next bit of starting a sensor, for a boot sequence.
+     *  @param   p_context Pointer to the @c SensorStartup
+     *  @param   now_us The time now, in microseconds
+     *  @return  How far the sensor has got
+     */
+    static BootState poll_stage (void* p_context, uint32_t now_us)
+    {
+        return ((SensorStartup*)p_context)->poll (now_us);
+    }
+};
+
+#endif // _BOOTSEQ_H_
@@ -0,0 +1,223 @@
+//*****************************************************************************
+/** @file    colorcal.cpp
+ *  @brief   Source code of the color sensor's dark and white calibration.
+ *  @details This file contains the methods of classes @c FrameAverager and
+ *           @c ColorCalibration.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include "colorcal.h"                       // Header for these classes
+#include "nvstore.h"                        // Emulated EEPROM storage
+
+
+/// Value which marks a calibration record in emulated EEPROM ("CC")
+#define CAL_MAGIC 0x4343
+
+/// Layout version of the calibration record
+#define CAL_VERSION 1
+
+/// Least white-minus-dark count for which a gain is believable
+#define CAL_MIN_SIGNAL 16
+
+
+/** @brief   Begin averaging the given number of readings.
+ *  @param   num_frames The number of readings to be averaged
+ */
+void FrameAverager::start (uint16_t num_frames)
+{
+    for (uint8_t ch = 0; ch < 4; ch++)
+    {
+        sum[ch] = 0;
+    }
+    count = 0;
+    frames = num_frames;
+}
+
+
+/** @brief   Add a reading to the average.
+ *  @param   reading The raw reading to be added
+ *  @return  True when all the readings wanted have been added
+ */
+bool FrameAverager::add (const RGBCSample& reading)
+{
+    if (count < frames)
+    {
+        sum[0] += reading.r;
+        sum[1] += reading.g;
+        sum[2] += reading.b;
+        sum[3] += reading.c;
+        count++;
+    }
+    return (count >= frames);
+}
+
+
+/** @brief   Get the average of the readings which have been added.
+ *  @param   mean Reference to the place where the average is put
+ */
+void FrameAverager::get_mean (RGBCSample& mean) const
+{
+    uint16_t divisor = count ? count : 1;
+
+    mean.r = (sum[0] + divisor / 2) / divisor;
+    mean.g = (sum[1] + divisor / 2) / divisor;
+    mean.b = (sum[2] + divisor / 2) / divisor;
+    mean.c = (sum[3] + divisor / 2) / divisor;
+}
+
+
+/** @brief   Create an identity calibration which doesn't change readings.
+ */
+ColorCalibration::ColorCalibration (void)
+{
+    clear ();
+}
+
+
+/** @brief   Go back to the identity calibration.
+ *  @details Offsets are set to zero and gains to one, so readings pass
+ *           through unchanged. The stored copy isn't touched.
+ */
+void ColorCalibration::clear (void)
+{
+    record.magic = CAL_MAGIC;
+    record.version = CAL_VERSION;
+    record.reserved = 0;
+    for (uint8_t ch = 0; ch < 4; ch++)
+    {
+        record.offset[ch] = 0;
+        active_offset[ch] = 0;
+    }
+    for (uint8_t ch = 0; ch < 3; ch++)
+    {
+        record.gain[ch] = CAL_GAIN_ONE;
+    }
+    record.sensitivity = 1;
+    exposure = 1;
+    have_dark = false;
+}
+
+
+/** @brief   Load the calibration from emulated EEPROM.
+ *  @details The record is read in one operation. If it's missing, from a
+ *           different version of this program or corrupted, the identity
+ *           calibration is used instead.
+ *  @return  True if a good calibration was loaded, false if not
+ */
+bool ColorCalibration::load (void)
+{
+    CalibrationRecord stored;
+
+    nv_read (NV_CALIBRATION_ADDR, &stored, sizeof (stored));
+    if (stored.magic != CAL_MAGIC || stored.version != CAL_VERSION
+        || stored.sensitivity == 0
+        || stored.crc != nv_crc16 (&stored, sizeof (stored) - sizeof (stored.crc)))
+    {
+        clear ();
+        return false;
+    }
+
+    record = stored;
+    have_dark = true;
+    set_exposure (exposure);
+    return true;
+}
+
+
+/** @brief   Save the calibration to emulated EEPROM.
+ *  @details Writing to flash stalls the processor for a while, so this should
+ *           only be done while the sorter is idle, as during calibration.
+ */
+void ColorCalibration::save (void)
+{
+    record.crc = nv_crc16 (&record, sizeof (record) - sizeof (record.crc));
+    nv_write (NV_CALIBRATION_ADDR, &record, sizeof (record));
+}
+
+
+/** @brief   Set offsets from the average of readings taken in the dark.
+ *  @param   dark The average of many readings with no light on the sensor
+ *  @param   sensitivity The sensor's sensitivity when the readings were taken
+ */
+void ColorCalibration::set_dark (const RGBCSample& dark, uint16_t sensitivity)
+{
+    record.offset[0] = dark.r;
+    record.offset[1] = dark.g;
+    record.offset[2] = dark.b;
+    record.offset[3] = dark.c;
+    record.sensitivity = sensitivity ? sensitivity : 1;
+    have_dark = true;
+    set_exposure (sensitivity);
+}
+
+
+/** @brief   Set gains from the average of readings of a white target.
+ *  @details After the dark offsets are taken away, each color channel gets a
+ *           gain which brings it to the average of the three color channels.
+ *           A white target then reads as equal red, green and blue while the
+ *           overall scale of readings stays about the same. The dark frame
+ *           should be taken first; without one the offsets are zero.
+ *  @param   white The average of many readings of a white target
+ *  @param   sensitivity The sensor's sensitivity when the readings were taken
+ *  @return  True if the gains were set, false if the white reference was too
+ *           dim or the gains would be out of range
+ */
+bool ColorCalibration::set_white (const RGBCSample& white, uint16_t sensitivity)
+{
+    set_exposure (sensitivity);
+
+    const uint16_t raw[3] = {white.r, white.g, white.b};
+    uint32_t signal[3];
+    uint32_t total = 0;
+
+    for (uint8_t ch = 0; ch < 3; ch++)
+    {
+        if (raw[ch] < active_offset[ch] + CAL_MIN_SIGNAL)
+        {
+            return false;
+        }
+        signal[ch] = raw[ch] - active_offset[ch];
+        total += signal[ch];
+    }
+
+    // Compute all gains before changing any so a failure leaves them alone
+    uint32_t target = total / 3;
+    uint32_t gains[3];
+    for (uint8_t ch = 0; ch < 3; ch++)
+    {
+        gains[ch] = ((target << CAL_GAIN_BITS) + signal[ch] / 2) / signal[ch];
+        if (gains[ch] > 0xFFFF)
+        {
+            return false;
+        }
+    }
+    for (uint8_t ch = 0; ch < 3; ch++)
+    {
+        record.gain[ch] = gains[ch];
+    }
+    return true;
+}
+
+
+/** @brief   Scale the offsets for a new sensor sensitivity.
+ *  @details This should be called whenever the sensor's gain or integration
+ *           time is changed.
+ *  @param   sensitivity The sensor's sensitivity, gain times integration
+ *           cycles, as given by @c AutoExposure::get_sensitivity()
+ */
+void ColorCalibration::set_exposure (uint16_t sensitivity)
+{
+    exposure = sensitivity ? sensitivity : 1;
+    if (!have_dark)
+    {
+        return;
+    }
+    for (uint8_t ch = 0; ch < 4; ch++)
+    {
+        uint32_t scaled = ((uint32_t)record.offset[ch] * exposure)
+                          / record.sensitivity;
+        active_offset[ch] = (scaled > 0xFFFF) ? 0xFFFF : scaled;
+    }
+}
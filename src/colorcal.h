@@ -0,0 +1,171 @@
+//*****************************************************************************
+/** @file    colorcal.h
+ *  @brief   Dark frame and white reference calibration of the color sensor.
+ *  @details Each color sensor, lamp and housing gives slightly different raw
+ *           counts for the same ball. This file contains a calibration which
+ *           removes those differences: a dark frame, taken with nothing lit
+ *           under the sensor, gives an offset to subtract from each channel,
+ *           and a white reference, taken with a white target under the
+ *           sensor, gives a gain for each color channel which makes white read
+ *           as equal red, green and blue. The results are kept in emulated
+ *           EEPROM and loaded at startup.
+ *
+ *           Correcting a reading uses only integer subtraction, multiplication
+ *           and shifts so that it can be done for every reading. Gains are
+ *           stored in fixed point with @c CAL_GAIN_BITS fraction bits.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _COLORCAL_H_
+#define _COLORCAL_H_
+
+#include <stdint.h>
+#include "colorsample.h"
+
+
+/// Number of fraction bits in the fixed point channel gains
+#define CAL_GAIN_BITS 12
+
+/// A gain of exactly one in fixed point
+#define CAL_GAIN_ONE (1U << CAL_GAIN_BITS)
+
+/// Number of readings averaged to make a dark frame or white reference
+#define CAL_FRAMES 64
+
+
+/** @brief   Calibration steps which may be requested of the color sensor task.
+ *  @details Besides the dark frame and white reference, the task trains the
+ *           color classifier's centroids: @c CAL_TRAIN plus a bin number asks
+ *           for readings of a ball of that bin held under the sensor.
+ */
+enum CalibrationRequest
+{
+    CAL_NONE = 0,                           ///< No calibration requested
+    CAL_DARK,                               ///< Capture a dark frame
+    CAL_WHITE,                              ///< Capture a white reference
+    CAL_TRAIN_CLEAR,                        ///< Forget the training readings
+    CAL_TRAIN_SAVE,                         ///< Make and save the centroids
+    CAL_TRAIN                               ///< Train a bin, added to this
+};
+
+
+/** @brief   Class which averages a number of readings into one.
+ *  @details This is used to make dark frames and white references, which are
+ *           averages of many readings so that noise doesn't end up in the
+ *           calibration.
+ */
+class FrameAverager
+{
+protected:
+    uint32_t sum[4];                        ///< Sums of the R G B C counts
+    uint16_t count;                         ///< Readings added so far
+    uint16_t frames;                        ///< Readings wanted in the average
+
+public:
+    /// Create an averager which isn't yet averaging anything
+    FrameAverager (void) : count (0), frames (0)
+    {
+    }
+
+    // Begin averaging the given number of readings
+    void start (uint16_t num_frames = CAL_FRAMES);
+
+    // Add a reading; return true when enough readings have been added
+    bool add (const RGBCSample& reading);
+
+    // Get the average of the readings which have been added
+    void get_mean (RGBCSample& mean) const;
+
+    /// Return true if readings are still wanted
+    bool busy (void) const
+    {
+        return count < frames;
+    }
+};
+
+
+/** @brief   Calibration record as it is kept in emulated EEPROM.
+ */
+struct CalibrationRecord
+{
+    uint16_t magic;                         ///< Marks a calibration record
+    uint8_t version;                        ///< Layout version of the record
+    uint8_t reserved;                       ///< Unused, kept zero
+    uint16_t offset[4];                     ///< Dark counts for R G B C
+    uint16_t gain[3];                       ///< Fixed point gains for R G B
+    uint16_t sensitivity;                   ///< Exposure of the dark frame
+    uint16_t crc;                           ///< CRC of all the above
+};
+
+
+/** @brief   Class which holds and applies the color sensor's calibration.
+ *  @details Dark counts grow with integration time and gain, so the offsets
+ *           are recorded along with the sensor's sensitivity (gain times
+ *           integration cycles, as given by @c AutoExposure) at the time of
+ *           the dark frame. When the sensitivity changes, @c set_exposure()
+ *           scales the offsets to match; this is done once per change rather
+ *           than for every reading.
+ */
+class ColorCalibration
+{
+protected:
+    CalibrationRecord record;               ///< Calibration as stored
+    uint16_t active_offset[4];              ///< Offsets at current exposure
+    uint16_t exposure;                      ///< Current sensor sensitivity
+    bool have_dark;                         ///< True if a dark frame is known
+
+public:
+    // Create an identity calibration which doesn't change readings
+    ColorCalibration (void);
+
+    // Go back to the identity calibration
+    void clear (void);
+
+    // Load the calibration from emulated EEPROM
+    bool load (void);
+
+    // Save the calibration to emulated EEPROM
+    void save (void);
+
+    // Set offsets from the average of readings taken in the dark
+    void set_dark (const RGBCSample& dark, uint16_t sensitivity);
+
+    // Set gains from the average of readings of a white target
+    bool set_white (const RGBCSample& white, uint16_t sensitivity);
+
+    // Scale the offsets for a new sensor sensitivity
+    void set_exposure (uint16_t sensitivity);
+
+    /// Return the stored calibration record
+    const CalibrationRecord& get_record (void) const
+    {
+        return record;
+    }
+
+    /** @brief   Correct a raw reading using the calibration.
+     *  @details The dark offset is subtracted from each channel, then the
+     *           color channels are multiplied by their gains. Results are
+     *           limited to the range of a 16 bit count.
+     *  @param   reading The reading, which is corrected in place
+     */
+    void correct (RGBCSample& reading) const
+    {
+        uint16_t* channel[4] = {&reading.r, &reading.g, &reading.b,
+                                &reading.c};
+        for (uint8_t ch = 0; ch < 4; ch++)
+        {
+            uint32_t value = (*channel[ch] > active_offset[ch])
+                             ? *channel[ch] - active_offset[ch] : 0;
+            if (ch < 3)
+            {
+                value = (value * record.gain[ch]) >> CAL_GAIN_BITS;
+            }
+            *channel[ch] = (value > 0xFFFF) ? 0xFFFF : value;
+        }
+    }
+};
+
+#endif // _COLORCAL_H_
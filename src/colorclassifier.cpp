@@ -0,0 +1,351 @@
+//*****************************************************************************
+/** @file    colorclassifier.cpp
+ *  @brief   Source code of the chromaticity color classifier and trainer.
+ *  @details This file contains the methods of classes @c ColorClassifier and
+ *           @c CentroidTrainer.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <string.h>
+#include "colorclassifier.h"                // Header for these classes
+#include "nvstore.h"                        // Emulated EEPROM storage
+
+
+/// Default farthest distance, squared, from a centroid which is accepted
+#define DEFAULT_MAX_DISTANCE (400UL * 400UL)
+
+/// Default least margin, squared distance units, between two bins
+#define DEFAULT_MIN_MARGIN (100UL * 100UL)
+
+/// Default dimmest R + G + B sum which is classified
+#define DEFAULT_MIN_SUM 32
+
+/// Least distance limit set by the trainer, so tight clusters aren't too strict
+#define MIN_TRAINED_DISTANCE (80UL * 80UL)
+
+/// The trainer's distance limit is this many times the largest bin variance
+#define TRAINED_DISTANCE_FACTOR 6
+
+/// Value which marks a classifier record in emulated EEPROM ("CK")
+#define CLASSIFIER_MAGIC 0x434B
+
+/// Layout version of the classifier record
+#define CLASSIFIER_VERSION 1
+
+static_assert (sizeof (ClassifierRecord) <= NV_CLASSIFIER_SIZE,
+               "Centroids don't fit in the space reserved for them");
+
+
+/** @brief   Create a classifier with no centroids, which rejects everything.
+ */
+ColorClassifier::ColorClassifier (void)
+{
+    clear ();
+    set_limits (DEFAULT_MAX_DISTANCE, DEFAULT_MIN_MARGIN, DEFAULT_MIN_SUM);
+}
+
+
+/** @brief   Remove all the centroids.
+ */
+void ColorClassifier::clear (void)
+{
+    num_centroids = 0;
+}
+
+
+/** @brief   Add a centroid.
+ *  @param   centroid The centroid to be added
+ *  @return  True if the centroid was added, false if there's no more room
+ */
+bool ColorClassifier::add_centroid (const Centroid& centroid)
+{
+    if (num_centroids >= MAX_CENTROIDS || centroid.bin == BIN_REJECT)
+    {
+        return false;
+    }
+    centroids[num_centroids++] = centroid;
+    return true;
+}
+
+
+/** @brief   Set the limits used to reject readings.
+ *  @param   a_max_distance The farthest squared distance from the nearest
+ *           centroid at which a reading is accepted
+ *  @param   a_min_margin The least difference in squared distance between
+ *           the nearest centroid and the nearest one of another bin
+ *  @param   a_min_sum The least R + G + B count which is classified; dimmer
+ *           readings are mostly noise and are rejected
+ */
+void ColorClassifier::set_limits (uint32_t a_max_distance,
+                                  uint32_t a_min_margin, uint16_t a_min_sum)
+{
+    max_distance = a_max_distance;
+    min_margin = a_min_margin;
+    min_sum = a_min_sum;
+}
+
+
+/** @brief   Convert a reading to chromaticity coordinates.
+ *  @param   reading The raw or calibrated reading
+ *  @param   chroma Reference to the place where the coordinates are put
+ *  @return  True if the conversion worked, false if R + G + B is zero
+ */
+bool ColorClassifier::to_chroma (const RGBCSample& reading, Chroma& chroma)
+{
+    uint32_t sum = (uint32_t)reading.r + reading.g + reading.b;
+    if (sum == 0)
+    {
+        chroma.r = chroma.g = 0;
+        return false;
+    }
+    chroma.r = ((uint32_t)reading.r << CHROMA_BITS) / sum;
+    chroma.g = ((uint32_t)reading.g << CHROMA_BITS) / sum;
+    return true;
+}
+
+
+/** @brief   Find the squared distance between two chromaticity points.
+ *  @param   a The first point
+ *  @param   b The second point
+ *  @return  The squared distance, which fits easily in 32 bits
+ */
+uint32_t ColorClassifier::distance (const Chroma& a, const Chroma& b)
+{
+    int32_t dr = (int32_t)a.r - b.r;
+    int32_t dg = (int32_t)a.g - b.g;
+    return (uint32_t)(dr * dr) + (uint32_t)(dg * dg);
+}
+
+
+/** @brief   Classify a point in chromaticity space.
+ *  @details Every centroid is looked at once, so the time taken depends only
+ *           on the number of centroids.
+ *  @param   chroma The point to be classified
+ *  @return  The chosen bin, or @c BIN_REJECT, with the distance and margin
+ */
+Classification ColorClassifier::classify (const Chroma& chroma) const
+{
+    Classification result;
+    uint32_t best = UINT32_MAX;
+    uint32_t runner_up = UINT32_MAX;
+    uint8_t best_bin = BIN_REJECT;
+
+    for (uint8_t index = 0; index < num_centroids; index++)
+    {
+        uint32_t dist = distance (chroma, centroids[index].where);
+        uint8_t bin = centroids[index].bin;
+
+        if (dist < best)
+        {
+            // The old best becomes the runner-up only if it's another bin
+            if (bin != best_bin)
+            {
+                runner_up = best;
+            }
+            best = dist;
+            best_bin = bin;
+        }
+        else if (dist < runner_up && bin != best_bin)
+        {
+            runner_up = dist;
+        }
+    }
+
+    result.distance = best;
+    result.margin = runner_up - best;
+    result.bin = (best <= max_distance && result.margin >= min_margin)
+                 ? best_bin : BIN_REJECT;
+    return result;
+}
+
+
+/** @brief   Classify a reading.
+ *  @param   reading The raw or calibrated reading
+ *  @return  The chosen bin, or @c BIN_REJECT, with the distance and margin
+ */
+Classification ColorClassifier::classify (const RGBCSample& reading) const
+{
+    Chroma chroma;
+
+    if ((uint32_t)reading.r + reading.g + reading.b < min_sum
+        || !to_chroma (reading, chroma))
+    {
+        Classification result = {BIN_REJECT, UINT32_MAX, 0};
+        return result;
+    }
+    return classify (chroma);
+}
+
+
+/** @brief   Load trained centroids and limits from emulated EEPROM.
+ *  @details If the record is missing, from a different version of this
+ *           program or corrupted, the classifier is left as it was, so the
+ *           centroids it was given beforehand serve as defaults.
+ *  @return  True if trained centroids were loaded, false if not
+ */
+bool ColorClassifier::load (void)
+{
+    ClassifierRecord stored;
+
+    nv_read (NV_CLASSIFIER_ADDR, &stored, sizeof (stored));
+    if (stored.magic != CLASSIFIER_MAGIC || stored.version != CLASSIFIER_VERSION
+        || stored.num_centroids == 0 || stored.num_centroids > MAX_CENTROIDS
+        || stored.crc != nv_crc16 (&stored, sizeof (stored) - sizeof (stored.crc)))
+    {
+        return false;
+    }
+
+    clear ();
+    for (uint8_t index = 0; index < stored.num_centroids; index++)
+    {
+        add_centroid (stored.centroids[index]);
+    }
+    set_limits (stored.max_distance, stored.min_margin, stored.min_sum);
+    return true;
+}
+
+
+/** @brief   Save the centroids and limits to emulated EEPROM.
+ *  @details Writing to flash stalls the processor for a while, so this should
+ *           only be done while the sorter is idle, as during training.
+ */
+void ColorClassifier::save (void) const
+{
+    ClassifierRecord record;
+
+    // Zero the unused centroids and padding so the CRC covers known bytes
+    memset (&record, 0, sizeof (record));
+    record.magic = CLASSIFIER_MAGIC;
+    record.version = CLASSIFIER_VERSION;
+    record.num_centroids = num_centroids;
+    for (uint8_t index = 0; index < num_centroids; index++)
+    {
+        record.centroids[index].where = centroids[index].where;
+        record.centroids[index].bin = centroids[index].bin;
+    }
+    record.max_distance = max_distance;
+    record.min_margin = min_margin;
+    record.min_sum = min_sum;
+    record.crc = nv_crc16 (&record, sizeof (record) - sizeof (record.crc));
+    nv_write (NV_CLASSIFIER_ADDR, &record, sizeof (record));
+}
+
+
+/** @brief   Create a trainer which has seen no readings.
+ */
+CentroidTrainer::CentroidTrainer (void)
+{
+    clear ();
+}
+
+
+/** @brief   Forget all the readings which have been added.
+ */
+void CentroidTrainer::clear (void)
+{
+    for (uint8_t bin = 0; bin < MAX_TRAINED_BINS; bin++)
+    {
+        sum_r[bin] = 0;
+        sum_g[bin] = 0;
+        sum_sq[bin] = 0;
+        count[bin] = 0;
+    }
+}
+
+
+/** @brief   Add a labeled reading.
+ *  @param   reading A reading of a ball whose bin is known
+ *  @param   bin The bin to which the ball belongs
+ *  @return  True if the reading was used, false if the bin number is too big
+ *           or the reading is black
+ */
+bool CentroidTrainer::add (const RGBCSample& reading, uint8_t bin)
+{
+    Chroma chroma;
+
+    if (bin >= MAX_TRAINED_BINS || !ColorClassifier::to_chroma (reading, chroma))
+    {
+        return false;
+    }
+    sum_r[bin] += chroma.r;
+    sum_g[bin] += chroma.g;
+    sum_sq[bin] += (uint32_t)chroma.r * chroma.r + (uint32_t)chroma.g * chroma.g;
+    count[bin]++;
+    return true;
+}
+
+
+/** @brief   Get the centroid of one bin.
+ *  @param   bin The bin whose centroid is wanted
+ *  @param   centroid Reference to the place where the centroid is put
+ *  @return  True if the bin has readings, false if not
+ */
+bool CentroidTrainer::get_centroid (uint8_t bin, Centroid& centroid) const
+{
+    if (bin >= MAX_TRAINED_BINS || count[bin] == 0)
+    {
+        return false;
+    }
+    centroid.where.r = (sum_r[bin] + count[bin] / 2) / count[bin];
+    centroid.where.g = (sum_g[bin] + count[bin] / 2) / count[bin];
+    centroid.bin = bin;
+    return true;
+}
+
+
+/** @brief   Get the mean squared distance of a bin's readings from its centroid.
+ *  @param   bin The bin whose spread is wanted
+ *  @return  The mean squared distance, or zero if the bin has no readings
+ */
+uint32_t CentroidTrainer::get_variance (uint8_t bin) const
+{
+    if (bin >= MAX_TRAINED_BINS || count[bin] == 0)
+    {
+        return 0;
+    }
+
+    // E[x^2] - E[x]^2, summed over both coordinates
+    uint64_t n = count[bin];
+    uint64_t mean_sq = sum_sq[bin] / n;
+    uint64_t sq_mean = ((uint64_t)sum_r[bin] * sum_r[bin]
+                        + (uint64_t)sum_g[bin] * sum_g[bin]) / (n * n);
+    return (mean_sq > sq_mean) ? (uint32_t)(mean_sq - sq_mean) : 0;
+}
+
+
+/** @brief   Make centroids and put them into a classifier.
+ *  @details The classifier's old centroids are removed. Its distance limit is
+ *           set to a few times the largest spread of any bin's readings, which
+ *           accepts nearly all good readings while rejecting ones which look
+ *           like nothing that was trained.
+ *  @param   classifier The classifier which is to get the centroids
+ *  @param   min_margin The least margin between bins the classifier accepts
+ *  @param   min_sum The dimmest R + G + B sum the classifier accepts
+ *  @return  The number of centroids made
+ */
+uint8_t CentroidTrainer::train (ColorClassifier& classifier,
+                                uint32_t min_margin, uint16_t min_sum) const
+{
+    uint32_t largest = 0;
+    uint8_t made = 0;
+
+    classifier.clear ();
+    for (uint8_t bin = 0; bin < MAX_TRAINED_BINS; bin++)
+    {
+        Centroid centroid;
+        if (get_centroid (bin, centroid) && classifier.add_centroid (centroid))
+        {
+            made++;
+            uint32_t variance = get_variance (bin);
+            largest = (variance > largest) ? variance : largest;
+        }
+    }
+
+    uint32_t limit = largest * TRAINED_DISTANCE_FACTOR;
+    classifier.set_limits ((limit > MIN_TRAINED_DISTANCE) ? limit
+                                                          : MIN_TRAINED_DISTANCE,
+                           min_margin, min_sum);
+    return made;
+}
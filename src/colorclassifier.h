@@ -0,0 +1,219 @@
+//*****************************************************************************
+/** @file    colorclassifier.h
+ *  @brief   Chromaticity based color classifier and its centroid trainer.
+ *  @details Raw color counts change with the brightness of the light and the
+ *           distance to the ball, so thresholds on them work poorly. This
+ *           file contains a classifier which first converts a reading into
+ *           rg chromaticity, the fractions of the total red + green + blue
+ *           count which are red and green. Chromaticity stays nearly the same
+ *           when the light gets brighter or dimmer. The reading is assigned to
+ *           the bin whose trained centroid is nearest in chromaticity, unless
+ *           it is too far from every centroid or too close to be sure which
+ *           of two bins it belongs to, in which case it's rejected.
+ *
+ *           Classifying uses only integer math and looks at a fixed number of
+ *           centroids, so its run time is bounded. Centroids are made by the
+ *           @c CentroidTrainer class from labeled readings; it has no Arduino
+ *           or RTOS dependencies so that it can be compiled into a program on
+ *           a PC which reads recorded traces. Trained centroids and limits are
+ *           kept in emulated EEPROM and loaded at startup.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _COLORCLASSIFIER_H_
+#define _COLORCLASSIFIER_H_
+
+#include <stdint.h>
+#include "colorsample.h"
+
+
+/// Number of fraction bits in chromaticity coordinates
+#define CHROMA_BITS 12
+
+/// The most centroids a classifier can hold
+#define MAX_CENTROIDS 8
+
+/// The most different bins which a trainer can learn
+#define MAX_TRAINED_BINS 4
+
+/// Bin number returned when a reading can't be classified with confidence
+#define BIN_REJECT 0xFF
+
+
+/** @brief   A point in rg chromaticity space.
+ *  @details Coordinates are fractions with @c CHROMA_BITS fraction bits, so a
+ *           pure red reading would have @c r equal to 1 << @c CHROMA_BITS.
+ */
+struct Chroma
+{
+    uint16_t r;                             ///< Red fraction of R + G + B
+    uint16_t g;                             ///< Green fraction of R + G + B
+};
+
+
+/** @brief   A trained point in chromaticity space and the bin it stands for.
+ */
+struct Centroid
+{
+    Chroma where;                           ///< Location of the centroid
+    uint8_t bin;                            ///< Bin which readings here go to
+};
+
+
+/** @brief   Result of classifying one reading.
+ */
+struct Classification
+{
+    uint8_t bin;                            ///< Chosen bin or @c BIN_REJECT
+    uint32_t distance;                      ///< Squared distance to nearest
+    uint32_t margin;                        ///< Runner-up minus nearest
+};
+
+
+/** @brief   Trained centroids and limits as they are kept in emulated EEPROM.
+ */
+struct ClassifierRecord
+{
+    uint16_t magic;                         ///< Marks a classifier record
+    uint8_t version;                        ///< Layout version of the record
+    uint8_t num_centroids;                  ///< How many centroids are used
+    Centroid centroids[MAX_CENTROIDS];      ///< The trained centroids
+    uint32_t max_distance;                  ///< Farthest accepted distance
+    uint32_t min_margin;                    ///< Least accepted margin
+    uint16_t min_sum;                       ///< Least R + G + B accepted
+    uint16_t crc;                           ///< CRC of all the above
+};
+
+
+/** @brief   Class which assigns readings to bins by nearest centroid.
+ *  @details Distances are squared distances in chromaticity units. A reading
+ *           is rejected if it is dimmer than @c min_sum counts, if its nearest
+ *           centroid is farther than @c max_distance away, or if the nearest
+ *           centroid of a different bin is less than @c min_margin farther
+ *           away than the nearest one.
+ */
+class ColorClassifier
+{
+protected:
+    Centroid centroids[MAX_CENTROIDS];      ///< Trained centroids
+    uint8_t num_centroids;                  ///< How many centroids are used
+    uint32_t max_distance;                  ///< Farthest accepted distance
+    uint32_t min_margin;                    ///< Least accepted margin
+    uint16_t min_sum;                       ///< Least R + G + B accepted
+
+public:
+    // Create a classifier with no centroids, which rejects everything
+    ColorClassifier (void);
+
+    // Remove all the centroids
+    void clear (void);
+
+    // Add a centroid
+    bool add_centroid (const Centroid& centroid);
+
+    // Set the limits used to reject readings
+    void set_limits (uint32_t a_max_distance, uint32_t a_min_margin,
+                     uint16_t a_min_sum);
+
+    // Convert a reading to chromaticity coordinates
+    static bool to_chroma (const RGBCSample& reading, Chroma& chroma);
+
+    // Find the squared distance between two chromaticity points
+    static uint32_t distance (const Chroma& a, const Chroma& b);
+
+    // Classify a point in chromaticity space
+    Classification classify (const Chroma& chroma) const;
+
+    // Classify a reading
+    Classification classify (const RGBCSample& reading) const;
+
+    // Load trained centroids and limits from emulated EEPROM
+    bool load (void);
+
+    // Save the centroids and limits to emulated EEPROM
+    void save (void) const;
+
+    /** @brief   Find whether a classified reading looks like a ball at all.
+     *  @details A reading which is bright enough and near some centroid is of
+     *           a ball, even if it lies too close to two bins to be sorted;
+     *           one which is dim or far from every centroid is of whatever is
+     *           behind the ball, such as an empty slot.
+     *  @param   result The classification of the reading
+     *  @return  True if the reading could be of a ball
+     */
+    bool is_ball (const Classification& result) const
+    {
+        return result.distance <= max_distance;
+    }
+
+    /// Return the number of centroids in use
+    uint8_t get_num_centroids (void) const
+    {
+        return num_centroids;
+    }
+
+    /// Return one of the centroids in use
+    const Centroid& get_centroid (uint8_t index) const
+    {
+        return centroids[index];
+    }
+
+    /// Return the farthest squared distance from a centroid accepted
+    uint32_t get_max_distance (void) const
+    {
+        return max_distance;
+    }
+
+    /// Return the least margin between two bins accepted
+    uint32_t get_min_margin (void) const
+    {
+        return min_margin;
+    }
+
+    /// Return the dimmest R + G + B sum classified
+    uint16_t get_min_sum (void) const
+    {
+        return min_sum;
+    }
+};
+
+
+/** @brief   Class which makes centroids from labeled readings.
+ *  @details Readings of balls whose bins are known are given to @c add(). The
+ *           centroid of each bin is the mean chromaticity of its readings.
+ *           @c train() puts the centroids into a classifier and sets its
+ *           distance limit from the spread of the readings seen.
+ */
+class CentroidTrainer
+{
+protected:
+    uint32_t sum_r[MAX_TRAINED_BINS];       ///< Sums of red chromaticity
+    uint32_t sum_g[MAX_TRAINED_BINS];       ///< Sums of green chromaticity
+    uint32_t count[MAX_TRAINED_BINS];       ///< Readings added for each bin
+    uint64_t sum_sq[MAX_TRAINED_BINS];      ///< Sums of squared coordinates
+
+public:
+    // Create a trainer which has seen no readings
+    CentroidTrainer (void);
+
+    // Add a labeled reading
+    bool add (const RGBCSample& reading, uint8_t bin);
+
+    // Make centroids and put them into a classifier
+    uint8_t train (ColorClassifier& classifier, uint32_t min_margin,
+                   uint16_t min_sum) const;
+
+    // Forget all the readings which have been added
+    void clear (void);
+
+    // Get the centroid of one bin
+    bool get_centroid (uint8_t bin, Centroid& centroid) const;
+
+    // Get the mean squared distance of one bin's readings from its centroid
+    uint32_t get_variance (uint8_t bin) const;
+};
+
+#endif // _COLORCLASSIFIER_H_
@@ -0,0 +1,141 @@
+//*****************************************************************************
+/** @file    colorfilter.cpp
+ *  @brief   Source code of the mains ripple rejecting color reading filter.
+ *  @details This file contains the methods of class @c RippleFilter.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include "colorfilter.h"                    // Header for this class
+
+
+/// Number of fraction bits kept in the exponential filter's averages
+#define EXP_FRACTION_BITS 8
+
+
+/** @brief   Create a filter of the given kind.
+ *  @param   a_mode Whether to use boxcar or exponential filtering
+ *  @param   a_window_us The length of a window in microseconds; a filtered
+ *           reading is produced once per window. The default of 50 ms rejects
+ *           both 50 Hz and 60 Hz ripple
+ *  @param   a_shift For exponential filtering, the weight given to each new
+ *           reading is 1 / 2<sup>shift</sup>
+ */
+RippleFilter::RippleFilter (Mode a_mode, uint32_t a_window_us, uint8_t a_shift)
+{
+    mode = a_mode;
+    window_us = a_window_us;
+    shift = a_shift;
+    reset ();
+}
+
+
+/** @brief   Discard readings so that the next window starts fresh.
+ *  @details This should be called when the sensor's gain or integration time
+ *           changes or when a new object arrives under the sensor, so that
+ *           readings of different things aren't mixed together.
+ */
+void RippleFilter::reset (void)
+{
+    started = false;
+    primed = false;
+    count = 0;
+    window_count = 0;
+    for (uint8_t ch = 0; ch < 4; ch++)
+    {
+        sum[ch] = 0;
+    }
+}
+
+
+/** @brief   Add a reading to the filter, possibly producing a filtered one.
+ *  @details The first reading begins a window. When a reading arrives one
+ *           window length or more after the window began, the window is
+ *           complete: its filtered value is put in @c result and the new
+ *           reading begins the next window. Each window thus covers readings
+ *           taken during exactly one window length, which is what rejects
+ *           the ripple.
+ *  @param   reading The raw reading from the sensor
+ *  @param   time_us The time at which the reading was taken, from @c micros()
+ *  @param   result Reference to a place where the filtered reading is put
+ *           when a window has been completed
+ *  @return  True if a window was completed and @c result was filled in
+ */
+bool RippleFilter::add (const RGBCSample& reading, uint32_t time_us,
+                        RGBCSample& result)
+{
+    const uint16_t channels[4] = {reading.r, reading.g, reading.b, reading.c};
+    bool done = false;
+
+    if (!started)
+    {
+        started = true;
+        window_start = time_us;
+    }
+
+    // Unsigned subtraction handles the wrapping of the microsecond timer
+    uint32_t elapsed = time_us - window_start;
+    if (elapsed >= window_us && count > 0)
+    {
+        if (mode == BOXCAR)
+        {
+            result.r = (sum[0] + count / 2) / count;
+            result.g = (sum[1] + count / 2) / count;
+            result.b = (sum[2] + count / 2) / count;
+            result.c = (sum[3] + count / 2) / count;
+            for (uint8_t ch = 0; ch < 4; ch++)
+            {
+                sum[ch] = 0;
+            }
+        }
+        else
+        {
+            // The averages carry over into the next window
+            result.r = sum[0] >> EXP_FRACTION_BITS;
+            result.g = sum[1] >> EXP_FRACTION_BITS;
+            result.b = sum[2] >> EXP_FRACTION_BITS;
+            result.c = sum[3] >> EXP_FRACTION_BITS;
+        }
+        window_count = count;
+        count = 0;
+        done = true;
+
+        // Keep windows back to back unless readings stopped for a while
+        window_start = (elapsed < 2 * window_us) ? window_start + window_us
+                                                 : time_us;
+    }
+
+    if (mode == BOXCAR)
+    {
+        for (uint8_t ch = 0; ch < 4; ch++)
+        {
+            sum[ch] += channels[ch];
+        }
+    }
+    else
+    {
+        // Exponential filtering keeps averages with some fraction bits; the
+        // first reading after a reset initializes the averages
+        for (uint8_t ch = 0; ch < 4; ch++)
+        {
+            uint32_t scaled = (uint32_t)channels[ch] << EXP_FRACTION_BITS;
+            if (!primed)
+            {
+                sum[ch] = scaled;
+            }
+            else if (scaled >= sum[ch])
+            {
+                sum[ch] += (scaled - sum[ch]) >> shift;
+            }
+            else
+            {
+                sum[ch] -= (sum[ch] - scaled) >> shift;
+            }
+        }
+        primed = true;
+    }
+    count++;
+
+    return done;
+}
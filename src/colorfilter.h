@@ -0,0 +1,87 @@
+//*****************************************************************************
+/** @file    colorfilter.h
+ *  @brief   Streaming filter which rejects mains ripple from color readings.
+ *  @details Light from fluorescent and incandescent lamps flickers at twice
+ *           the mains frequency, 100 Hz or 120 Hz. The TCS34725 rejects this
+ *           ripple by itself only when its integration time is a multiple of
+ *           50 ms. This file contains a filter which instead takes readings at
+ *           the shortest integration time, 2.4 ms, and combines all readings
+ *           taken during each 50 ms window into one ripple free reading.
+ *           Since 50 ms holds a whole number of ripple periods at both mains
+ *           frequencies, the ripple averages out.
+ *
+ *           Two kinds of filtering are available. The boxcar filter gives the
+ *           plain average of the readings in each window. The exponential
+ *           filter keeps a running weighted average which reacts smoothly
+ *           across windows; it rejects less ripple but needs no reset when a
+ *           new ball arrives.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _COLORFILTER_H_
+#define _COLORFILTER_H_
+
+#include <stdint.h>
+#include "colorsample.h"
+
+
+/// Window length in microseconds which rejects both 50 Hz and 60 Hz ripple
+#define RIPPLE_WINDOW_US 50000UL
+
+
+/** @brief   Class which averages raw color readings over ripple windows.
+ *  @details Each reading is given to @c add() with the time at which it was
+ *           taken. When a whole window has gone by, @c add() returns true and
+ *           fills in one filtered reading. The filter uses only integer math
+ *           and needs no knowledge of the sample rate, so it works whether
+ *           the sensor is read every 2.4 ms or somewhat more slowly.
+ */
+class RippleFilter
+{
+public:
+    /// The kinds of filtering which this class can do
+    enum Mode
+    {
+        BOXCAR,                             ///< Plain average of each window
+        EXPONENTIAL                         ///< Running exponential average
+    };
+
+protected:
+    Mode mode;                              ///< Which kind of filter this is
+    uint32_t window_us;                     ///< Window length in microseconds
+    uint8_t shift;                          ///< Exponential weight is 2^-shift
+    bool started;                           ///< True once a window has begun
+    bool primed;                            ///< True once averages are set
+    uint32_t window_start;                  ///< Time the current window began
+    uint16_t count;                         ///< Readings in the current window
+    uint16_t window_count;                  ///< Readings in the last window
+    uint32_t sum[4];                        ///< Running sums or averages, R G B C
+
+public:
+    // Create a filter of the given kind
+    RippleFilter (Mode a_mode = BOXCAR, uint32_t a_window_us = RIPPLE_WINDOW_US,
+                  uint8_t a_shift = 3);
+
+    // Add a reading to the filter, possibly producing a filtered reading
+    bool add (const RGBCSample& reading, uint32_t time_us, RGBCSample& result);
+
+    // Discard readings so that the next window starts fresh
+    void reset (void);
+
+    /// Return the number of readings taken so far in the current window
+    uint16_t get_count (void) const
+    {
+        return count;
+    }
+
+    /// Return the number of readings in the last window which was completed
+    uint16_t get_window_count (void) const
+    {
+        return window_count;
+    }
+};
+
+#endif // _COLORFILTER_H_
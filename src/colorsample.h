@@ -0,0 +1,29 @@
+//*****************************************************************************
+/** @file    colorsample.h
+ *  @brief   Raw red, green, blue and clear readings from the color sensor.
+ *  @details This file contains a small structure which holds one set of raw
+ *           channel counts from the TCS34725 so that readings can be passed
+ *           between the driver, filters and classifiers as a single item.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _COLORSAMPLE_H_
+#define _COLORSAMPLE_H_
+
+#include <stdint.h>
+
+
+/** @brief   One set of raw channel counts from the color sensor.
+ */
+struct RGBCSample
+{
+    uint16_t r;                             ///< Red channel count
+    uint16_t g;                             ///< Green channel count
+    uint16_t b;                             ///< Blue channel count
+    uint16_t c;                             ///< Clear channel count
+};
+
+#endif // _COLORSAMPLE_H_
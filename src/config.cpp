@@ -0,0 +1,234 @@
+//*****************************************************************************
+/** @file    config.cpp
+ *  @brief   Source code of the sorter's stored settings.
+ *  @details This file contains the table of settings and the methods of class
+ *           @c SorterConfig.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <string.h>
+#include <PrintStream.h>
+#include "config.h"                         // Header for this class
+
+
+/// Value which marks a configuration record in emulated EEPROM ("SC")
+#define CONFIG_MAGIC 0x5343
+
+/// Version of the list of settings, raised whenever a setting is added
+#define CONFIG_VERSION 3
+
+/// Number of bytes in the record before the values
+#define CONFIG_HEADER_SIZE (sizeof (ConfigRecord) - sizeof (uint32_t) \
+                            * CONFIG_MAX_ITEMS)
+
+
+/** @brief   Name, default and range of one setting.
+ */
+struct ConfigItemInfo
+{
+    const char* name;                       ///< Name used to find it
+    uint32_t initial;                       ///< Default value
+    uint32_t least;                         ///< Smallest value allowed
+    uint32_t most;                          ///< Largest value allowed
+    bool at_boot;                           ///< Only used when tasks start
+};
+
+
+/// The settings, in the order of @c ConfigItem
+static const ConfigItemInfo config_items[CFG_NUM_ITEMS] =
+{
+    {"step_ms",     11,      2,    100,      false},
+    {"load_ms",     250,     0,    5000,     false},
+    {"lead_us",     20000,   0,    200000,   false},
+    {"pulse_us",    1000000, 1000, 2000000,  false},
+    {"max_wait_ms", 6000,    0,    60000,    true},
+    {"high_water",  2,       1,    4,        true},
+    {"low_water",   0,       0,    3,        true},
+    {"idle_ms",     30000,   1000, 3600000,  true},
+    {"window_us",   50000,   2400, 1000000,  true},
+    {"early_exit",  200000,  1000, 10000000, true},
+    {"index",       0,       0,    1,        true},
+    {"home_steps",  0,       0,    349,      false},
+    {"home_fast_ms", 4,      CFG_MIN_STEP_MS, 100, false},
+    {"home_slow_ms", 20,     CFG_MIN_STEP_MS, 200, false}
+};
+
+static_assert (CFG_NUM_ITEMS <= CONFIG_MAX_ITEMS,
+               "Settings don't fit in the space reserved for them");
+
+
+/** @brief   Compute the CRC of a configuration record.
+ *  @param   a_record The record, whose @c num_items must not be too large
+ *  @return  The CRC of the header, taken with the CRC zero, and the values
+ */
+static uint16_t record_crc (const ConfigRecord& a_record)
+{
+    ConfigRecord copy = a_record;
+
+    copy.crc = 0;
+    return nv_crc16 (&copy, CONFIG_HEADER_SIZE
+                            + sizeof (uint32_t) * copy.num_items);
+}
+
+
+/** @brief   Create a configuration holding the default settings.
+ *  @param   p_name A name for the configuration, used when it's printed
+ */
+SorterConfig::SorterConfig (const char* p_name)
+    : BaseShare (p_name)
+{
+    clear ();
+}
+
+
+/** @brief   Go back to the default settings.
+ *  @details The stored copy isn't touched.
+ */
+void SorterConfig::clear (void)
+{
+    memset (&record, 0, sizeof (record));
+    record.magic = CONFIG_MAGIC;
+    record.version = CONFIG_VERSION;
+    record.num_items = CFG_NUM_ITEMS;
+    for (uint8_t item = 0; item < CFG_NUM_ITEMS; item++)
+    {
+        record.value[item] = config_items[item].initial;
+    }
+    changed = true;
+}
+
+
+/** @brief   Load the settings from emulated EEPROM.
+ *  @details The whole reserved space is read in one operation. If it holds
+ *           no record, or a corrupted one, the defaults are used. Settings
+ *           which a record from an older version doesn't have, and stored
+ *           values out of range, get their defaults; settings which a newer
+ *           version added are ignored.
+ *  @return  Whether the settings were all loaded, partly defaulted, or all
+ *           defaulted
+ */
+SorterConfig::LoadResult SorterConfig::load (void)
+{
+    ConfigRecord stored;
+
+    nv_read (NV_CONFIG_ADDR, &stored, sizeof (stored));
+    clear ();
+    if (stored.magic != CONFIG_MAGIC || stored.num_items == 0
+        || stored.num_items > CONFIG_MAX_ITEMS
+        || stored.crc != record_crc (stored))
+    {
+        return DEFAULTS;
+    }
+
+    LoadResult result = (stored.version == CONFIG_VERSION
+                         && stored.num_items == CFG_NUM_ITEMS) ? LOADED
+                                                               : MIGRATED;
+    for (uint8_t item = 0; item < CFG_NUM_ITEMS; item++)
+    {
+        if (item >= stored.num_items || !set (item, stored.value[item]))
+        {
+            result = MIGRATED;
+        }
+    }
+    changed = (result != LOADED);
+    return result;
+}
+
+
+/** @brief   Save the settings to emulated EEPROM.
+ *  @details Writing to flash stalls the processor for a while, so this should
+ *           only be done while the sorter is idle.
+ */
+void SorterConfig::save (void)
+{
+    record.crc = record_crc (record);
+    nv_write (NV_CONFIG_ADDR, &record, sizeof (record));
+    changed = false;
+}
+
+
+/** @brief   Find a setting by its name.
+ *  @param   p_item_name The name of the setting
+ *  @return  The setting's @c ConfigItem, or -1 if there's none of that name
+ */
+int8_t SorterConfig::find (const char* p_item_name) const
+{
+    for (uint8_t item = 0; item < CFG_NUM_ITEMS; item++)
+    {
+        if (strcmp (p_item_name, config_items[item].name) == 0)
+        {
+            return (int8_t)item;
+        }
+    }
+    return -1;
+}
+
+
+/** @brief   Change a setting if the new value is in its range.
+ *  @param   item The setting, a @c ConfigItem
+ *  @param   value The new value
+ *  @return  True if the setting was changed, false if there's no such
+ *           setting or the value is out of its range
+ */
+bool SorterConfig::set (uint8_t item, uint32_t value)
+{
+    if (item >= CFG_NUM_ITEMS || value < config_items[item].least
+        || value > config_items[item].most)
+    {
+        return false;
+    }
+    if (record.value[item] != value)
+    {
+        record.value[item] = value;
+        changed = true;
+    }
+    return true;
+}
+
+
+/** @brief   Get the name of a setting.
+ *  @param   item The setting, a @c ConfigItem
+ *  @return  The setting's name, or @c NULL if there's no such setting
+ */
+const char* SorterConfig::get_name (uint8_t item)
+{
+    return (item < CFG_NUM_ITEMS) ? config_items[item].name : NULL;
+}
+
+
+/** @brief   Find out whether a setting is only used when the tasks start.
+ *  @param   item The setting, a @c ConfigItem
+ *  @return  True if a change takes effect only after a reset
+ */
+bool SorterConfig::is_at_boot (uint8_t item)
+{
+    return (item < CFG_NUM_ITEMS) && config_items[item].at_boot;
+}
+
+
+/** @brief   Print the settings within the list of shares.
+ *  @details Settings used only when the tasks start are marked with a star.
+ *  @param   printer Reference to a serial device on which to print
+ */
+void SorterConfig::print_in_list (Print& printer)
+{
+    // Print this configuration's name and pad it to 16 characters
+    printer.printf ("%-16sconfig\t", name);
+    printer << "version " << record.version
+            << (changed ? ", not saved" : ", saved") << endl;
+    for (uint8_t item = 0; item < CFG_NUM_ITEMS; item++)
+    {
+        printer.printf ("%-16s", "");
+        printer << config_items[item].name
+                << (config_items[item].at_boot ? "* " : " ")
+                << record.value[item] << endl;
+    }
+
+    // Call the next item
+    if (p_next != NULL)
+    {
+        p_next->print_in_list (printer);
+    }
+}
@@ -0,0 +1,139 @@
+//*****************************************************************************
+/** @file    config.h
+ *  @brief   Tunable settings of the sorter, kept in emulated EEPROM.
+ *  @details Step rate, load time, solenoid timing, the ball queue's limits and
+ *           other settings used to be constants compiled into the program,
+ *           so trying a new value meant a rebuild and reflash. This file
+ *           contains a configuration record holding them which is loaded at
+ *           startup, in one read, from emulated EEPROM, and can be changed
+ *           and saved again by name while the program runs.
+ *
+ *           Each setting has a name, a default and a range. The record is
+ *           checked with a CRC; if it's missing or corrupted the defaults are
+ *           used, and a setting whose stored value is out of range gets its
+ *           default. Settings are only ever added at the end of the list, and
+ *           the record says how many it holds, so a record saved by an older
+ *           version of the program is loaded by taking the settings it has
+ *           and giving the new ones their defaults.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _CONFIG_H_
+#define _CONFIG_H_
+
+#include <Arduino.h>
+#include "baseshare.h"                      // Base class for shared data items
+#include "nvstore.h"                        // Emulated EEPROM storage
+
+
+/** @brief   The settings in the configuration record.
+ *  @details New settings go at the end, just before @c CFG_NUM_ITEMS, and
+ *           the version in config.cpp is raised.
+ */
+enum ConfigItem
+{
+    CFG_STEP_MS,                            ///< Milliseconds per motor step
+    CFG_LOAD_MS,                            ///< Time at each section, ms
+    CFG_LEAD_US,                            ///< Solenoid's time to the ball
+    CFG_PULSE_US,                           ///< How long solenoids stay on
+    CFG_MAX_WAIT_MS,                        ///< Longest a ball may wait
+    CFG_HIGH_WATER,                         ///< Balls waiting to stop feeder
+    CFG_LOW_WATER,                          ///< Balls waiting to restart it
+    CFG_IDLE_MS,                            ///< Quiet time before idling
+    CFG_WINDOW_US,                          ///< Ripple filter window
+    CFG_EARLY_EXIT,                         ///< Evidence to classify a ball
+    CFG_INDEX,                              ///< 1 if the index is fitted
+    CFG_HOME_STEPS,                         ///< Steps from index to section 0
+    CFG_HOME_FAST_MS,                       ///< Milliseconds per search step
+    CFG_HOME_SLOW_MS,                       ///< Milliseconds per edge step
+    CFG_NUM_ITEMS                           ///< Number of settings
+};
+
+/// Fewest milliseconds between motor steps which any step setting allows,
+/// one run of the stepper task
+#define CFG_MIN_STEP_MS 1
+
+/// The most settings which fit in the space reserved for the record
+#define CONFIG_MAX_ITEMS ((NV_CONFIG_SIZE - 8) / 4)
+
+
+/** @brief   Configuration record as it is kept in emulated EEPROM.
+ *  @details The CRC is computed with the @c crc field zero, over the header
+ *           and the @c num_items values which are in use.
+ */
+struct ConfigRecord
+{
+    uint16_t magic;                         ///< Marks a configuration record
+    uint8_t version;                        ///< Version which saved it
+    uint8_t num_items;                      ///< Number of values in use
+    uint16_t crc;                           ///< CRC of the record
+    uint16_t reserved;                      ///< Unused, kept zero
+    uint32_t value[CONFIG_MAX_ITEMS];       ///< Settings, by @c ConfigItem
+};
+
+
+/** @brief   Class which holds the sorter's settings and loads and saves them.
+ *  @details Settings are read with @c get() wherever they're used, which
+ *           is a single word read, so a change made with @c set() takes
+ *           effect the next time the setting is used. A few settings are
+ *           only used when the tasks start; those take effect after a reset.
+ */
+class SorterConfig : public BaseShare
+{
+protected:
+    ConfigRecord record;                    ///< Settings as stored
+    bool changed;                           ///< True if changed since saved
+
+public:
+    /// How the settings were found by @c load()
+    enum LoadResult
+    {
+        LOADED,                             ///< All settings were loaded
+        MIGRATED,                           ///< Some settings were defaulted
+        DEFAULTS                            ///< No good record was found
+    };
+
+    // Create a configuration holding the default settings
+    SorterConfig (const char* p_name = NULL);
+
+    // Go back to the default settings
+    void clear (void);
+
+    // Load the settings from emulated EEPROM
+    LoadResult load (void);
+
+    // Save the settings to emulated EEPROM
+    void save (void);
+
+    // Find a setting by its name
+    int8_t find (const char* p_item_name) const;
+
+    // Change a setting if the new value is in its range
+    bool set (uint8_t item, uint32_t value);
+
+    // Get the name of a setting
+    static const char* get_name (uint8_t item);
+
+    // Find out whether a setting is only used when the tasks start
+    static bool is_at_boot (uint8_t item);
+
+    /// Return the value of a setting
+    uint32_t get (ConfigItem item) const
+    {
+        return record.value[item];
+    }
+
+    /// Return true if settings have been changed since they were saved
+    bool is_changed (void) const
+    {
+        return changed;
+    }
+
+    // Print the settings within the list of shares
+    void print_in_list (Print& printer);
+};
+
+#endif // _CONFIG_H_
@@ -0,0 +1,257 @@
+//*****************************************************************************
+/** @file    console.cpp
+ *  @brief   Source code of the serial command console.
+ *  @details This file contains the methods of classes @c LineParser and
+ *           @c SerialConsole.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <string.h>
+#include <PrintStream.h>
+#include "console.h"                        // Header for these classes
+
+
+/** @brief   Create a parser with an empty line.
+ */
+LineParser::LineParser (void)
+{
+    length = 0;
+    overflow = false;
+    num_words = 0;
+    buffer[0] = '\0';
+}
+
+
+/** @brief   Add a character; return true when a line is finished.
+ *  @details Empty lines, including the second half of a carriage return and
+ *           line feed, are skipped. Once a line is finished its words are
+ *           kept until the next line begins.
+ *  @param   character The character which was received
+ *  @return  True if the character finished a line, which may be one which
+ *           was too long
+ */
+bool LineParser::add (char character)
+{
+    if (character == '\r' || character == '\n')
+    {
+        if (length == 0)
+        {
+            return false;
+        }
+        buffer[length] = '\0';
+        length = 0;
+        if (overflow)
+        {
+            return true;
+        }
+        split ();
+        return num_words > 0;
+    }
+
+    // A finished line is forgotten when the next one begins
+    if (length == 0)
+    {
+        overflow = false;
+        num_words = 0;
+    }
+
+    if (character == '\b' || character == 0x7F)
+    {
+        if (length > 0 && !overflow)
+        {
+            length--;
+        }
+    }
+    else if (character >= ' ' || character == '\t')
+    {
+        if (length < CONSOLE_LINE_SIZE)
+        {
+            buffer[length++] = character;
+        }
+        else
+        {
+            overflow = true;
+        }
+    }
+    return false;
+}
+
+
+/** @brief   Split the finished line into words.
+ *  @details Each space or tab after a word is replaced with a terminator.
+ *           Once the most words have been found the rest of the line,
+ *           spaces and all, is left as the last word.
+ */
+void LineParser::split (void)
+{
+    char* p_char = buffer;
+
+    num_words = 0;
+    while (*p_char != '\0')
+    {
+        if (*p_char == ' ' || *p_char == '\t')
+        {
+            p_char++;
+            continue;
+        }
+        words[num_words++] = p_char;
+        if (num_words == CONSOLE_MAX_WORDS)
+        {
+            break;
+        }
+        while (*p_char != '\0' && *p_char != ' ' && *p_char != '\t')
+        {
+            p_char++;
+        }
+        if (*p_char != '\0')
+        {
+            *p_char++ = '\0';
+        }
+    }
+}
+
+
+/** @brief   Get one word of the finished line.
+ *  @param   index The number of the word, 0 being the first
+ *  @return  The word, or an empty string if the line has no such word
+ */
+const char* LineParser::get_word (uint8_t index) const
+{
+    return (index < num_words) ? words[index] : "";
+}
+
+
+/** @brief   Convert a word to a number.
+ *  @param   p_word The word, which must be made only of decimal digits
+ *  @param   number Reference to the place where the number is put
+ *  @return  True if the word is a number which fits in 32 bits
+ */
+bool LineParser::to_number (const char* p_word, uint32_t& number)
+{
+    uint32_t value = 0;
+
+    if (*p_word == '\0')
+    {
+        return false;
+    }
+    for (; *p_word != '\0'; p_word++)
+    {
+        if (*p_word < '0' || *p_word > '9')
+        {
+            return false;
+        }
+        uint32_t digit = (uint32_t)(*p_word - '0');
+        if (value > (UINT32_MAX - digit) / 10)
+        {
+            return false;
+        }
+        value = value * 10 + digit;
+    }
+    number = value;
+    return true;
+}
+
+
+/** @brief   Create a console which runs commands from a table.
+ *  @param   p_name A name for the console, used when it's printed
+ *  @param   a_p_commands The table of commands, which must last as long as
+ *           the console
+ *  @param   a_num_commands The number of commands in the table
+ */
+SerialConsole::SerialConsole (const char* p_name,
+                              const ConsoleCommand* a_p_commands,
+                              uint8_t a_num_commands)
+    : BaseShare (p_name)
+{
+    p_commands = a_p_commands;
+    num_commands = a_num_commands;
+    num_lines = 0;
+    num_errors = 0;
+}
+
+
+/** @brief   Read the characters which have arrived and run any finished
+ *           commands.
+ *  @details Only characters which @c input already holds are read, so this
+ *           returns at once when nothing has been typed.
+ *  @param   input The device from which commands are read
+ *  @param   output The device on which commands answer
+ */
+void SerialConsole::poll (Stream& input, Print& output)
+{
+    while (input.available () > 0)
+    {
+        int character = input.read ();
+        if (character >= 0 && parser.add ((char)character))
+        {
+            execute (output);
+        }
+    }
+}
+
+
+/** @brief   Run the command in a finished line.
+ *  @param   output The device on which the command answers
+ */
+void SerialConsole::execute (Print& output)
+{
+    if (parser.is_overflow ())
+    {
+        num_errors++;
+        output << "Line too long" << endl;
+        return;
+    }
+
+    const char* p_name = parser.get_word (0);
+    if (strcmp (p_name, "help") == 0)
+    {
+        num_lines++;
+        for (uint8_t index = 0; index < num_commands; index++)
+        {
+            output << p_commands[index].name << ' '
+                   << p_commands[index].usage << endl;
+        }
+        return;
+    }
+
+    for (uint8_t index = 0; index < num_commands; index++)
+    {
+        const ConsoleCommand& command = p_commands[index];
+        if (strcmp (p_name, command.name) == 0)
+        {
+            if (command.p_function (parser, output))
+            {
+                num_lines++;
+            }
+            else
+            {
+                num_errors++;
+                output << "Usage: " << command.name << ' ' << command.usage
+                       << endl;
+            }
+            return;
+        }
+    }
+    num_errors++;
+    output << "Unknown command " << p_name << "; type help for a list"
+           << endl;
+}
+
+
+/** @brief   Print the console's counts within the list of shares.
+ *  @param   printer Reference to a serial device on which to print
+ */
+void SerialConsole::print_in_list (Print& printer)
+{
+    // Print this console's name and pad it to 16 characters
+    printer.printf ("%-16sconsole\t", name);
+    printer << num_lines << " commands, " << num_errors << " errors" << endl;
+
+    // Call the next item
+    if (p_next != NULL)
+    {
+        p_next->print_in_list (printer);
+    }
+}
@@ -0,0 +1,125 @@
+//*****************************************************************************
+/** @file    console.h
+ *  @brief   Command console which reads commands from the serial port.
+ *  @details Commands are typed a line at a time. A @c LineParser collects
+ *           characters into a fixed buffer and, at the end of each line,
+ *           splits it in place into words, so no memory is allocated. A
+ *           @c SerialConsole takes whatever characters have arrived without
+ *           waiting for more, gives them to its parser, and runs a command
+ *           from its table for each line. The commands themselves are
+ *           functions written by the program which uses the console.
+ *
+ *           Nothing here touches the serial port directly; the console is
+ *           given a @c Stream to read and a @c Print to answer on, so the
+ *           parser and console can be run with scripted input.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _CONSOLE_H_
+#define _CONSOLE_H_
+
+#include <Arduino.h>
+#include "baseshare.h"                      // Base class for shared data items
+
+
+/// The longest line which can be typed, not counting the line ending
+#define CONSOLE_LINE_SIZE 63
+
+/// The most words in a line, including the command's name
+#define CONSOLE_MAX_WORDS 4
+
+
+/** @brief   Class which collects characters into lines and splits them into
+ *           words.
+ *  @details Lines end with a carriage return, a line feed, or both. Words are
+ *           separated by spaces or tabs. Backspace takes away the last
+ *           character. A line which is too long is thrown away whole; one
+ *           with too many words has its extra words joined to the last.
+ */
+class LineParser
+{
+protected:
+    char buffer[CONSOLE_LINE_SIZE + 1];     ///< The line, split in place
+    uint8_t length;                         ///< Characters in the buffer
+    bool overflow;                          ///< True if the line is too long
+    uint8_t num_words;                      ///< Words in the finished line
+    const char* words[CONSOLE_MAX_WORDS];   ///< Start of each word
+
+    // Split the finished line into words
+    void split (void);
+
+public:
+    // Create a parser with an empty line
+    LineParser (void);
+
+    // Add a character; return true when a line is finished
+    bool add (char character);
+
+    // Get one word of the finished line
+    const char* get_word (uint8_t index) const;
+
+    // Convert a word to a number
+    static bool to_number (const char* p_word, uint32_t& number);
+
+    /// Return the number of words in the finished line
+    uint8_t get_num_words (void) const
+    {
+        return num_words;
+    }
+
+    /// Return true if the finished line was too long and was thrown away
+    bool is_overflow (void) const
+    {
+        return overflow;
+    }
+};
+
+
+/** @brief   A command which the console can run.
+ *  @details The function is given the parser holding the line, whose word 0
+ *           is the command's name, and the device on which to answer. It
+ *           returns false if the words after the name don't make sense, and
+ *           the console then prints the command's usage.
+ */
+struct ConsoleCommand
+{
+    const char* name;                       ///< Word which runs the command
+    const char* usage;                      ///< Words which follow the name
+    bool (*p_function) (const LineParser& line, Print& output);
+};
+
+
+/** @brief   Class which runs commands typed on a serial port.
+ *  @details Call @c poll() from a low priority task. It reads only the
+ *           characters which have already arrived, so it never waits; a
+ *           command is run as soon as the line holding it is finished. The
+ *           command @c help, which lists the commands, is built in.
+ */
+class SerialConsole : public BaseShare
+{
+protected:
+    LineParser parser;                      ///< Collects the current line
+    const ConsoleCommand* p_commands;       ///< Table of commands
+    uint8_t num_commands;                   ///< Number of commands in table
+    uint32_t num_lines;                     ///< Lines which ran commands
+    uint32_t num_errors;                    ///< Lines which couldn't be run
+
+    // Run the command in a finished line
+    void execute (Print& output);
+
+public:
+    // Create a console which runs commands from a table
+    SerialConsole (const char* p_name, const ConsoleCommand* a_p_commands,
+                   uint8_t a_num_commands);
+
+    // Read the characters which have arrived and run any finished commands
+    void poll (Stream& input, Print& output);
+
+    // Print the console's counts within the list of shares
+    void print_in_list (Print& printer);
+};
+
+#endif // _CONSOLE_H_
@@ -0,0 +1,211 @@
+//*****************************************************************************
+/** @file    coscheduler.cpp
+ *  @brief   Source code of the coroutine scheduler and its frame pool.
+ *  @details This file contains the methods of classes @c CoTask and
+ *           @c CoScheduler.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include "coscheduler.h"                    // Header for these classes
+
+
+/// Memory for coroutine frames, aligned for any type the frames may hold
+alignas (8) static uint8_t frame_pool[CO_MAX_TASKS][CO_FRAME_SIZE];
+
+/// Which frames in the pool are in use
+static bool frame_used[CO_MAX_TASKS];
+
+
+/** @brief   Get a coroutine frame from the pool.
+ *  @param   size The size of the frame needed, in bytes
+ *  @return  A pointer to the frame, or @c NULL if none is free or the frame
+ *           needed is too big
+ */
+void* CoTask::promise_type::operator new (size_t size) noexcept
+{
+    if (size > CO_FRAME_SIZE)
+    {
+        return NULL;
+    }
+
+    void* p_frame = NULL;
+    CO_ENTER_CRITICAL ();
+    for (uint8_t index = 0; index < CO_MAX_TASKS; index++)
+    {
+        if (!frame_used[index])
+        {
+            frame_used[index] = true;
+            p_frame = frame_pool[index];
+            break;
+        }
+    }
+    CO_EXIT_CRITICAL ();
+    return p_frame;
+}
+
+
+/** @brief   Give a coroutine frame back to the pool.
+ *  @param   p_frame Pointer to the frame
+ */
+void CoTask::promise_type::operator delete (void* p_frame) noexcept
+{
+    for (uint8_t index = 0; index < CO_MAX_TASKS; index++)
+    {
+        if (p_frame == frame_pool[index])
+        {
+            frame_used[index] = false;
+        }
+    }
+}
+
+
+/** @brief   Create a scheduler with no coroutines.
+ */
+CoScheduler::CoScheduler (void)
+{
+    ready_head = 0;
+    num_ready = 0;
+    p_sleepers = NULL;
+    now = 0;
+    p_waker = NULL;
+    p_waker_context = NULL;
+}
+
+
+/** @brief   Start a coroutine, which will run at the next call to @c run().
+ *  @param   task The coroutine, as returned by calling a coroutine function
+ *  @return  True if the coroutine was started, false if it couldn't be made
+ *           or there was no room in the ready queue
+ */
+bool CoScheduler::spawn (CoTask task)
+{
+    if (!task.valid ())
+    {
+        return false;
+    }
+    std::coroutine_handle<> handle = task.release ();
+    if (!make_ready (handle))
+    {
+        handle.destroy ();
+        return false;
+    }
+    return true;
+}
+
+
+/** @brief   Put a coroutine in the queue to be resumed.
+ *  @details This may be called from any task. The waker, if one has been
+ *           set, is called so the scheduler's task looks at the queue.
+ *  @param   handle The coroutine
+ *  @return  True if the coroutine was queued, false if the queue was full
+ */
+bool CoScheduler::make_ready (std::coroutine_handle<> handle)
+{
+    bool queued = false;
+
+    CO_ENTER_CRITICAL ();
+    if (num_ready < CO_MAX_READY)
+    {
+        ready[(ready_head + num_ready) % CO_MAX_READY] = handle;
+        num_ready++;
+        queued = true;
+    }
+    CO_EXIT_CRITICAL ();
+
+    if (queued && p_waker != NULL)
+    {
+        p_waker (p_waker_context);
+    }
+    return queued;
+}
+
+
+/** @brief   Put a sleeper into the list in the order of waking.
+ *  @details Sleepers which wake at the same tick are woken in the order they
+ *           went to sleep. Ticks are compared by their difference, so the
+ *           order is right across the wraparound of the tick count as long
+ *           as no sleep is longer than half its range.
+ *  @param   sleeper The awaitable of the coroutine which is going to sleep
+ */
+void CoScheduler::add_sleeper (SleepAwaiter& sleeper)
+{
+    CO_ENTER_CRITICAL ();
+    SleepAwaiter** pp_link = &p_sleepers;
+    while (*pp_link != NULL && (int32_t)((*pp_link)->due - sleeper.due) <= 0)
+    {
+        pp_link = &(*pp_link)->p_next;
+    }
+    sleeper.p_next = *pp_link;
+    *pp_link = &sleeper;
+    CO_EXIT_CRITICAL ();
+}
+
+
+/** @brief   Resume every coroutine which is ready or whose sleep is over.
+ *  @details Coroutines made ready while this runs are resumed too, so the
+ *           queue is empty when it returns. A coroutine which has finished is
+ *           destroyed and its frame goes back to the pool.
+ *  @param   a_now The tick count now
+ *  @return  The number of times a coroutine was resumed
+ */
+uint8_t CoScheduler::run (uint32_t a_now)
+{
+    uint8_t resumed = 0;
+    now = a_now;
+
+    // Wake the sleepers whose time has come, which are at the list's head
+    while (p_sleepers != NULL && (int32_t)(now - p_sleepers->due) >= 0
+           && make_ready (p_sleepers->handle))
+    {
+        CO_ENTER_CRITICAL ();
+        p_sleepers = p_sleepers->p_next;
+        CO_EXIT_CRITICAL ();
+    }
+
+    for (;;)
+    {
+        std::coroutine_handle<> handle;
+
+        CO_ENTER_CRITICAL ();
+        bool got_one = (num_ready > 0);
+        if (got_one)
+        {
+            handle = ready[ready_head];
+            ready_head = (ready_head + 1) % CO_MAX_READY;
+            num_ready--;
+        }
+        CO_EXIT_CRITICAL ();
+
+        if (!got_one)
+        {
+            break;
+        }
+        handle.resume ();
+        resumed++;
+        if (handle.done ())
+        {
+            handle.destroy ();
+        }
+    }
+    return resumed;
+}
+
+
+/** @brief   Find how many ticks it will be until a sleeping coroutine wakes.
+ *  @param   a_now The tick count now
+ *  @param   wait Reference to the place where the number of ticks is put
+ *  @return  True if a coroutine is asleep, false if none is
+ */
+bool CoScheduler::time_to_next (uint32_t a_now, uint32_t& wait) const
+{
+    if (p_sleepers == NULL)
+    {
+        return false;
+    }
+
+    int32_t soonest = (int32_t)(p_sleepers->due - a_now);
+    wait = (soonest > 0) ? (uint32_t)soonest : 0;
+    return true;
+}
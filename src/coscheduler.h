@@ -0,0 +1,235 @@
+//*****************************************************************************
+/** @file    coscheduler.h
+ *  @brief   C++20 coroutine scheduler which runs inside one RTOS task.
+ *  @details A sequence of steps which each wait for something, such as the
+ *           sorting of one ball, is easiest to read when it's written as one
+ *           straight run of code. This file contains a small scheduler for
+ *           C++20 coroutines which lets such a sequence be written that way:
+ *           each @c co_await suspends the coroutine, which costs only its
+ *           frame rather than a whole task stack, and the scheduler resumes it
+ *           when the thing it waited for has happened. Many coroutines can
+ *           be in flight at once in one RTOS task.
+ *
+ *           The scheduler keeps a queue of coroutines which are ready to run
+ *           and a list of sleeping ones in the order they wake. Each sleeper's
+ *           place in that list is kept in its own frame, so a coroutine can
+ *           always go to sleep. The scheduler doesn't call the RTOS; the task which owns it calls @c run() with
+ *           the tick count and then sleeps for @c time_to_next() ticks or
+ *           until the waker function, called when other tasks make a
+ *           coroutine ready, wakes it up. The scheduler therefore runs on a
+ *           PC just as well, with a simulated clock.
+ *
+ *           Coroutine frames come from a small fixed pool rather than the
+ *           heap. A coroutine whose frame doesn't fit isn't started, and
+ *           @c spawn() returns false.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _COSCHEDULER_H_
+#define _COSCHEDULER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <coroutine>
+
+// Coroutines are made ready by other tasks, so the scheduler's lists are
+// protected by critical sections under the RTOS; on a PC they're not needed
+#ifdef ARDUINO
+    #include "FreeRTOS.h"                   // Main header for FreeRTOS
+    #define CO_ENTER_CRITICAL() portENTER_CRITICAL ()
+    #define CO_EXIT_CRITICAL() portEXIT_CRITICAL ()
+#else
+    #define CO_ENTER_CRITICAL()
+    #define CO_EXIT_CRITICAL()
+#endif
+
+
+/// The most coroutines which can be in existence at once
+#define CO_MAX_TASKS 4
+
+/// The size in bytes of each coroutine frame in the pool
+#define CO_FRAME_SIZE 256
+
+/// The most coroutines which can be waiting to be resumed at once
+#define CO_MAX_READY 8
+
+
+/** @brief   Return type of a coroutine which is run by a @c CoScheduler.
+ *  @details A function which returns @c CoTask and uses @c co_await is a
+ *           coroutine. Calling it makes the coroutine but doesn't start it;
+ *           the @c CoTask is then given to @c CoScheduler::spawn(), which
+ *           starts it and frees its frame when it returns.
+ */
+class CoTask
+{
+public:
+    /// The promise type, which the compiler uses to run the coroutine
+    struct promise_type
+    {
+        /// Make the @c CoTask which the coroutine function returns
+        CoTask get_return_object (void)
+        {
+            return CoTask (
+                std::coroutine_handle<promise_type>::from_promise (*this));
+        }
+
+        /// Make the @c CoTask returned when no frame could be had
+        static CoTask get_return_object_on_allocation_failure (void)
+        {
+            return CoTask (nullptr);
+        }
+
+        /// Don't run until the scheduler starts the coroutine
+        std::suspend_always initial_suspend (void) noexcept
+        {
+            return {};
+        }
+
+        /// Stay in existence when finished so the scheduler can free it
+        std::suspend_always final_suspend (void) noexcept
+        {
+            return {};
+        }
+
+        /// Nothing is returned by a coroutine
+        void return_void (void)
+        {
+        }
+
+        /// Exceptions aren't used in this program
+        void unhandled_exception (void)
+        {
+        }
+
+        // Get a coroutine frame from the pool
+        static void* operator new (size_t size) noexcept;
+
+        // Give a coroutine frame back to the pool
+        static void operator delete (void* p_frame) noexcept;
+    };
+
+protected:
+    std::coroutine_handle<> handle;         ///< The coroutine, or null
+
+public:
+    /// Make a task object which holds the given coroutine
+    explicit CoTask (std::coroutine_handle<> a_handle) : handle (a_handle)
+    {
+    }
+
+    /// Return true if the coroutine was made, false if no frame could be had
+    bool valid (void) const
+    {
+        return (bool)handle;
+    }
+
+    /// Give up the coroutine, as when it's handed to a scheduler
+    std::coroutine_handle<> release (void)
+    {
+        std::coroutine_handle<> released = handle;
+        handle = nullptr;
+        return released;
+    }
+};
+
+
+/** @brief   Class which runs coroutines in one task.
+ *  @details Times are in ticks, which are RTOS ticks on the microcontroller.
+ */
+class CoScheduler
+{
+public:
+    /** @brief   Awaitable which puts a coroutine to sleep for a number of ticks.
+     *  @details The awaitable stays in the coroutine's frame while it sleeps,
+     *           and is the coroutine's entry in the scheduler's list of
+     *           sleepers.
+     */
+    struct SleepAwaiter
+    {
+        CoScheduler& scheduler;             ///< Scheduler which wakes it
+        uint32_t ticks;                     ///< How long to sleep
+        std::coroutine_handle<> handle;     ///< The sleeping coroutine
+        uint32_t due;                       ///< Tick at which it wakes
+        SleepAwaiter* p_next;               ///< Sleeper which wakes next
+
+        /// Don't suspend for a sleep of no time
+        bool await_ready (void) const
+        {
+            return ticks == 0;
+        }
+
+        /// Go to sleep until the ticks have passed
+        void await_suspend (std::coroutine_handle<> a_handle)
+        {
+            handle = a_handle;
+            due = scheduler.now + ticks;
+            scheduler.add_sleeper (*this);
+        }
+
+        /// Nothing is returned by a sleep
+        void await_resume (void)
+        {
+        }
+    };
+
+protected:
+    std::coroutine_handle<> ready[CO_MAX_READY];  ///< Ring of ready ones
+    uint8_t ready_head;                     ///< Index of the next to run
+    uint8_t num_ready;                      ///< Number of ready coroutines
+    SleepAwaiter* p_sleepers;               ///< Sleepers, soonest first
+    uint32_t now;                           ///< Tick given to @c run()
+    void (*p_waker) (void* p_context);      ///< Wakes the scheduler's task
+    void* p_waker_context;                  ///< Passed to the waker
+
+    // Put a sleeper into the list in the order of waking
+    void add_sleeper (SleepAwaiter& sleeper);
+
+public:
+
+    // Create a scheduler with no coroutines
+    CoScheduler (void);
+
+    /** @brief   Set a function which wakes the task that runs the scheduler.
+     *  @details The function is called whenever a coroutine is made ready,
+     *           which may be from another task.
+     *  @param   a_p_waker The function, or @c NULL for none
+     *  @param   a_p_context A pointer given to the function
+     */
+    void set_waker (void (*a_p_waker) (void*), void* a_p_context)
+    {
+        p_waker = a_p_waker;
+        p_waker_context = a_p_context;
+    }
+
+    // Start a coroutine, which will run at the next call to run()
+    bool spawn (CoTask task);
+
+    // Put a coroutine in the queue to be resumed
+    bool make_ready (std::coroutine_handle<> handle);
+
+    // Resume every coroutine which is ready or whose sleep is over
+    uint8_t run (uint32_t a_now);
+
+    // Find how many ticks it will be until a sleeping coroutine wakes
+    bool time_to_next (uint32_t a_now, uint32_t& wait) const;
+
+    /** @brief   Make an awaitable which sleeps for a number of ticks.
+     *  @param   ticks The number of ticks to sleep
+     *  @return  The awaitable, for use with @c co_await
+     */
+    SleepAwaiter sleep (uint32_t ticks)
+    {
+        return SleepAwaiter {*this, ticks, nullptr, 0, NULL};
+    }
+
+    /// Return the tick count given to the latest call to @c run()
+    uint32_t get_now (void) const
+    {
+        return now;
+    }
+};
+
+#endif // _COSCHEDULER_H_
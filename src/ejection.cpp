@@ -0,0 +1,208 @@
+//*****************************************************************************
+/** @file    ejection.cpp
+ *  @brief   Source code of the scheduler which fires the ejectors on time.
+ *  @details This file contains the methods of class @c EjectionScheduler.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <PrintStream.h>
+#include "ejection.h"                       // Header for this class
+
+
+/** @brief   Create a scheduler with no ejections.
+ *  @param   p_name A name for the scheduler, used when it's printed
+ *  @param   a_lead_us The time from turning a solenoid on until its plunger
+ *           reaches the ball
+ *  @param   a_pulse_us How long the solenoids are left on
+ *  @param   a_resolution_us The time between calls to @c service()
+ */
+EjectionScheduler::EjectionScheduler (const char* p_name, uint32_t a_lead_us,
+                                      uint32_t a_pulse_us,
+                                      uint32_t a_resolution_us)
+    : BaseShare (p_name)
+{
+    num_ejections = 0;
+    lead_us = a_lead_us;
+    pulse_us = a_pulse_us;
+    resolution_us = a_resolution_us;
+    position = 0;
+    step_us = 0;
+    step_time_us = 0;
+    num_fired = 0;
+    num_measured = 0;
+    total_error_us = 0;
+    max_error_us = 0;
+    last_error_us = 0;
+}
+
+
+/** @brief   Ask for solenoids to be fired when the table reaches a position.
+ *  @param   mask A mask with bit @c k set to fire solenoid @c k
+ *  @param   target The table position at which the balls line up with their
+ *           ejectors
+ *  @return  True if the ejection was scheduled, false if there's no room
+ */
+bool EjectionScheduler::schedule (uint8_t mask, uint32_t target)
+{
+    bool scheduled = false;
+
+    CO_ENTER_CRITICAL ();
+    if (num_ejections < EJECT_MAX_PENDING && mask != 0)
+    {
+        Ejection& ejection = ejections[num_ejections++];
+        ejection.mask = mask;
+        ejection.target = target;
+        ejection.fired = false;
+        ejection.aligned = (int32_t)(position - target) >= 0;
+        ejection.aligned_us = step_time_us;
+        ejection.on = false;
+        scheduled = true;
+    }
+    CO_EXIT_CRITICAL ();
+    return scheduled;
+}
+
+
+/** @brief   Note the table's position and speed.
+ *  @details This is called by the step generator just after each step, with
+ *           the time between steps while the table moves or zero once it has
+ *           stopped. An ejection whose position has been reached is marked
+ *           as lined up at this time.
+ *  @param   a_position The table position in steps
+ *  @param   a_step_us The time until the next step, or 0 if there won't be one
+ *  @param   now_us The time now
+ */
+void EjectionScheduler::track (uint32_t a_position, uint32_t a_step_us,
+                               uint32_t now_us)
+{
+    CO_ENTER_CRITICAL ();
+    if (a_position != position)
+    {
+        step_time_us = now_us;
+    }
+    position = a_position;
+    step_us = a_step_us;
+
+    for (uint8_t index = 0; index < num_ejections; index++)
+    {
+        Ejection& ejection = ejections[index];
+        if (!ejection.aligned && (int32_t)(position - ejection.target) >= 0)
+        {
+            ejection.aligned = true;
+            ejection.aligned_us = step_time_us;
+            if (ejection.fired)
+            {
+                measure (ejection);
+            }
+        }
+    }
+    CO_EXIT_CRITICAL ();
+}
+
+
+/** @brief   Record how far an ejection was from the ball lining up.
+ *  @details The plunger reaches the ball the lead time after the solenoid is
+ *           turned on; the error is how long after the ball lined up that was.
+ *  @param   ejection The ejection, which has both fired and lined up
+ */
+void EjectionScheduler::measure (const Ejection& ejection)
+{
+    last_error_us = (int32_t)(ejection.fired_us + lead_us
+                              - ejection.aligned_us);
+    uint32_t size = (last_error_us < 0) ? (uint32_t)(-last_error_us)
+                                        : (uint32_t)last_error_us;
+    max_error_us = (size > max_error_us) ? size : max_error_us;
+    total_error_us += size;
+    num_measured++;
+}
+
+
+/** @brief   Fire the solenoids whose time has come and end finished pulses.
+ *  @details The time at which each ball lines up is found from the time of
+ *           the last step and the time per step. An ejection whose ball is
+ *           already there, as when the table has stopped at it, fires at
+ *           once. An ejection is done with once its pulse has ended and its
+ *           ball has lined up.
+ *  @param   now_us The time now
+ *  @param   on Reference to a mask in which the solenoids to turn on are set
+ *  @param   off Reference to a mask in which the solenoids to turn off are set
+ *  @return  True if any solenoid is to be turned on or off
+ */
+bool EjectionScheduler::service (uint32_t now_us, uint8_t& on, uint8_t& off)
+{
+    on = 0;
+    off = 0;
+
+    CO_ENTER_CRITICAL ();
+    uint8_t index = 0;
+    while (index < num_ejections)
+    {
+        Ejection& ejection = ejections[index];
+
+        if (!ejection.fired)
+        {
+            bool due = ejection.aligned;
+            if (!due && step_us != 0)
+            {
+                uint32_t fire_us = step_time_us
+                    + (ejection.target - position) * step_us - lead_us;
+                int32_t wait = (int32_t)(fire_us - now_us);
+                due = wait <= (int32_t)(resolution_us / 2);
+            }
+            if (due)
+            {
+                ejection.fired = true;
+                ejection.on = true;
+                ejection.fired_us = now_us;
+                ejection.off_us = now_us + pulse_us;
+                on |= ejection.mask;
+                num_fired++;
+                if (ejection.aligned)
+                {
+                    measure (ejection);
+                }
+            }
+        }
+        else if (ejection.on && (int32_t)(now_us - ejection.off_us) >= 0)
+        {
+            ejection.on = false;
+            off |= ejection.mask;
+        }
+
+        // Fill the gap left by a finished ejection with the last one
+        if (ejection.fired && !ejection.on && ejection.aligned)
+        {
+            ejections[index] = ejections[--num_ejections];
+        }
+        else
+        {
+            index++;
+        }
+    }
+    CO_EXIT_CRITICAL ();
+    return (on | off) != 0;
+}
+
+
+/** @brief   Print the ejection counts and timing errors within the list of
+ *           shares.
+ *  @param   printer Reference to a serial device on which to print
+ */
+void EjectionScheduler::print_in_list (Print& printer)
+{
+    // Print this scheduler's name and pad it to 16 characters
+    printer.printf ("%-16seject\t", name);
+    printer << num_ejections << " pending, " << num_fired
+            << " fired, error "
+            << (uint32_t)(num_measured ? total_error_us / num_measured : 0)
+            << '/' << max_error_us << " us, last " << last_error_us
+            << " us" << endl;
+
+    // Call the next item
+    if (p_next != NULL)
+    {
+        p_next->print_in_list (printer);
+    }
+}
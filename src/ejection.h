@@ -0,0 +1,124 @@
+//*****************************************************************************
+/** @file    ejection.h
+ *  @brief   Fires the ejectors when balls on the moving table reach them.
+ *  @details Each ejection is asked for with the table position, in steps,
+ *           at which a ball's slot lines up with its ejector. The step
+ *           generator tells the scheduler the table's position and speed
+ *           after every step, from which the time each ball lines up is
+ *           worked out. The solenoid is fired that time less its lead time,
+ *           the time the plunger takes to reach the ball, so the ball is
+ *           pushed as it arrives even though the table is still moving.
+ *
+ *           Times are in microseconds. The scheduler is polled rather than
+ *           driven by a timer; when it's polled every @c resolution
+ *           microseconds, each solenoid is fired on the poll nearest its
+ *           firing time. The error between when each ball was pushed and
+ *           when it lined up is measured, and printed with the other shares
+ *           by @c print_all_shares().
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _EJECTION_H_
+#define _EJECTION_H_
+
+#include <Arduino.h>
+#include "baseshare.h"                      // Base class for shared data items
+#include "coscheduler.h"                    // For the critical section macros
+
+
+/// The most ejections which can be waiting or firing at once
+#define EJECT_MAX_PENDING 4
+
+
+/** @brief   Class which fires ejectors at the time balls reach them.
+ *  @details Call @c schedule() for each ejection, @c track() after every step
+ *           and whenever the table stops, and @c service() often, turning
+ *           the solenoids on and off as it says. Positions are counted in
+ *           steps forwards since the program started; they wrap around, and
+ *           are compared by their difference.
+ */
+class EjectionScheduler : public BaseShare
+{
+protected:
+    /// An ejection which is waiting to fire or is firing
+    struct Ejection
+    {
+        uint8_t mask;                       ///< Solenoids to fire
+        uint32_t target;                    ///< Position at which it lines up
+        bool fired;                         ///< True once the solenoids fired
+        bool aligned;                       ///< True once the table got there
+        uint32_t fired_us;                  ///< Time at which they fired
+        uint32_t aligned_us;                ///< Time at which it lined up
+        uint32_t off_us;                    ///< Time to turn them off
+        bool on;                            ///< True while they're on
+    };
+
+    Ejection ejections[EJECT_MAX_PENDING];  ///< Ejections in no order
+    uint8_t num_ejections;                  ///< Number of ejections
+    uint32_t lead_us;                       ///< Solenoid's time to the ball
+    uint32_t pulse_us;                      ///< How long solenoids stay on
+    uint32_t resolution_us;                 ///< Time between polls
+    uint32_t position;                      ///< Table position last given
+    uint32_t step_us;                       ///< Time per step, 0 if stopped
+    uint32_t step_time_us;                  ///< Time of the last step
+    uint32_t num_fired;                     ///< Ejections fired so far
+    uint32_t num_measured;                  ///< Ejections whose error is known
+    uint32_t total_error_us;                ///< Size of the errors, summed
+    uint32_t max_error_us;                  ///< Largest error
+    int32_t last_error_us;                  ///< Error of the latest ejection
+
+    // Record how far an ejection was from the ball lining up
+    void measure (const Ejection& ejection);
+
+public:
+    // Create a scheduler with no ejections
+    EjectionScheduler (const char* p_name, uint32_t a_lead_us,
+                       uint32_t a_pulse_us, uint32_t a_resolution_us);
+
+    // Ask for solenoids to be fired when the table reaches a position
+    bool schedule (uint8_t mask, uint32_t target);
+
+    // Note the table's position and speed
+    void track (uint32_t a_position, uint32_t a_step_us, uint32_t now_us);
+
+    // Fire the solenoids whose time has come and end finished pulses
+    bool service (uint32_t now_us, uint8_t& on, uint8_t& off);
+
+    /** @brief   Change the solenoids' lead time and pulse length.
+     *  @details Ejections already scheduled use the new times from now on.
+     *  @param   a_lead_us The time from turning a solenoid on until its
+     *           plunger reaches the ball
+     *  @param   a_pulse_us How long the solenoids are left on
+     */
+    void set_timing (uint32_t a_lead_us, uint32_t a_pulse_us)
+    {
+        lead_us = a_lead_us;
+        pulse_us = a_pulse_us;
+    }
+
+    /// Return true while any ejection is waiting to fire or is firing
+    bool is_busy (void) const
+    {
+        return num_ejections > 0;
+    }
+
+    /// Return the error of the latest ejection, positive if it was late
+    int32_t get_last_error_us (void) const
+    {
+        return last_error_us;
+    }
+
+    /// Return the largest error of any ejection
+    uint32_t get_max_error_us (void) const
+    {
+        return max_error_us;
+    }
+
+    // Print the ejection counts and timing errors within the list of shares
+    void print_in_list (Print& printer);
+};
+
+#endif // _EJECTION_H_
@@ -0,0 +1,204 @@
+//*****************************************************************************
+/** @file    homing.cpp
+ *  @brief   Source code of the turntable homing state machine.
+ *  @details This file contains the methods of class @c TableHoming.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <PrintStream.h>
+#include "homing.h"                         // Header for this class
+
+
+/** @brief   Create a state machine for a table with the given steps per
+ *           revolution.
+ *  @param   p_name A name for the state machine, used when it's printed
+ *  @param   a_steps_per_rev The number of motor steps in one turn of the
+ *           table
+ *  @param   a_fast_ms Milliseconds per step while turning quickly
+ *  @param   a_slow_ms Milliseconds per step while finding the edge
+ */
+TableHoming::TableHoming (const char* p_name, uint16_t a_steps_per_rev,
+                          uint16_t a_fast_ms, uint16_t a_slow_ms)
+    : BaseShare (p_name)
+{
+    steps_per_rev = a_steps_per_rev ? a_steps_per_rev : 1;
+    set_speeds (a_fast_ms, a_slow_ms);
+    state = HOME_IDLE;
+    target = 0;
+    believed = 0;
+    edge_position = 0;
+    state_steps = 0;
+    net_steps = 0;
+    num_steps = 0;
+    last_offset = 0;
+    num_homes = 0;
+    num_failures = 0;
+}
+
+
+/** @brief   Begin a search which ends where the table is thought to be.
+ *  @param   a_believed The position the table is thought to be at
+ *  @param   a_edge_position The position at which the index edge is seen
+ */
+void TableHoming::start (uint16_t a_believed, uint16_t a_edge_position)
+{
+    believed = a_believed % steps_per_rev;
+    edge_position = a_edge_position % steps_per_rev;
+    target = (believed + steps_per_rev - edge_position) % steps_per_rev;
+    net_steps = 0;
+    num_steps = 0;
+    enter (HOME_FAST);
+}
+
+
+/** @brief   Find which way to make the next step.
+ *  @details Once the edge has been found, the offset is worked out from the
+ *           steps made to reach it: the table started that many steps before
+ *           the edge, which is compared with where it was thought to be.
+ *  @param   index True if the index input is active
+ *  @return  1 for a step forwards, -1 for a step back, or 0 if the search is
+ *           over
+ */
+int8_t TableHoming::next_step (bool index)
+{
+    int8_t direction = 0;
+
+    switch (state)
+    {
+        case HOME_FAST:
+            if (index)
+            {
+                enter (HOME_BACK);
+                direction = -1;
+            }
+            else if (state_steps < steps_per_rev + steps_per_rev / 2)
+            {
+                direction = 1;
+            }
+            break;
+
+        case HOME_BACK:
+            if (index)
+            {
+                state_steps = 0;
+            }
+            if (state_steps >= HOME_BACK_OFF)
+            {
+                enter (HOME_SLOW);
+                direction = 1;
+            }
+            else if (num_steps < 2UL * steps_per_rev)
+            {
+                direction = -1;
+            }
+            break;
+
+        case HOME_SLOW:
+            if (index)
+            {
+                int32_t offset = ((int32_t)believed - edge_position
+                                  + net_steps) % steps_per_rev;
+                if (offset < 0)
+                {
+                    offset += steps_per_rev;
+                }
+                if (offset >= steps_per_rev / 2)
+                {
+                    offset -= steps_per_rev;
+                }
+                last_offset = (int16_t)offset;
+                enter (HOME_TARGET);
+            }
+            else if (state_steps <= 2 * HOME_BACK_OFF)
+            {
+                direction = 1;
+                break;
+            }
+            else
+            {
+                break;
+            }
+            // Once the edge is found, go straight on to the target
+            // fall through
+
+        case HOME_TARGET:
+            if (state_steps < target)
+            {
+                direction = 1;
+            }
+            else
+            {
+                num_homes++;
+                enter (HOME_DONE);
+            }
+            break;
+
+        default:
+            return 0;
+    }
+
+    if (direction == 0 && state != HOME_DONE)
+    {
+        num_failures++;
+        enter (HOME_FAILED);
+        return 0;
+    }
+    if (direction != 0)
+    {
+        state_steps++;
+        num_steps++;
+        if (state != HOME_TARGET)
+        {
+            net_steps += direction;
+        }
+    }
+    return direction;
+}
+
+
+/** @brief   Find how long to wait before the next step.
+ *  @details The edge is approached slowly so that it's found at the same
+ *           step each time; the rest is done quickly.
+ *  @return  The time in milliseconds
+ */
+uint16_t TableHoming::get_step_ms (void) const
+{
+    return (state == HOME_BACK || state == HOME_SLOW) ? slow_ms : fast_ms;
+}
+
+
+/** @brief   Move on to another state.
+ *  @param   new_state The state
+ */
+void TableHoming::enter (State new_state)
+{
+    state = new_state;
+    state_steps = 0;
+}
+
+
+/** @brief   Print the searches and the last offset within the list of
+ *           shares.
+ *  @param   printer Reference to a serial device on which to print
+ */
+void TableHoming::print_in_list (Print& printer)
+{
+    static const char* state_names[] = {"not homed", "fast search",
+                                        "backing off", "slow search",
+                                        "turning to target", "homed",
+                                        "index not found"};
+
+    // Print this state machine's name and pad it to 16 characters
+    printer.printf ("%-16shome\t", name);
+    printer << state_names[state] << ", " << num_homes << " homes, "
+            << num_failures << " failed, last offset " << last_offset
+            << " steps" << endl;
+
+    // Call the next item
+    if (p_next != NULL)
+    {
+        p_next->print_in_list (printer);
+    }
+}
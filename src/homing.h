@@ -0,0 +1,146 @@
+//*****************************************************************************
+/** @file    homing.h
+ *  @brief   State machine which finds the turntable's home from its index.
+ *  @details The sorter used to assume that the table was lined up by hand
+ *           before it was turned on. With an index sensor fitted, this file's
+ *           state machine finds the index edge and brings the table to a
+ *           given number of steps past it:
+ *           - The table is turned forwards quickly until the index is seen.
+ *           - It's backed off slowly until the index has been clear for a
+ *             few steps.
+ *           - It's turned forwards slowly until the index is seen again, so
+ *             the edge is found at the same point whichever way the table
+ *             came to it.
+ *           - It's turned forwards to the target.
+ *
+ *           The state machine doesn't drive the motor; it says which way to
+ *           make each step and how fast, and is given the index input, so it
+ *           can be run on the host with a simulated index.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _HOMING_H_
+#define _HOMING_H_
+
+#include <Arduino.h>
+#include "baseshare.h"                      // Base class for shared data items
+
+
+/// Steps the index must be clear before the slow search begins
+#define HOME_BACK_OFF 8
+
+
+/** @brief   Class which finds the index and brings the table to a target.
+ *  @details Positions are in steps forward from section 0, within one
+ *           revolution. Call @c start() with the position the table is
+ *           thought to be at and the position of the index edge; the search
+ *           brings the table to where it's thought to be. Then call
+ *           @c next_step() each time @c get_step_ms() milliseconds have
+ *           passed, with the index input, and make the step it asks for. When it returns zero the
+ *           search is over; @c is_done() or @c has_failed() says how it
+ *           went. If the index isn't found within a revolution and a half,
+ *           or the table can't get clear of it, the search has failed.
+ */
+class TableHoming : public BaseShare
+{
+public:
+    /// How far the search has got
+    enum State
+    {
+        HOME_IDLE,                          ///< Not started
+        HOME_FAST,                          ///< Turning quickly to the index
+        HOME_BACK,                          ///< Backing off the index
+        HOME_SLOW,                          ///< Turning slowly to the index
+        HOME_TARGET,                        ///< Turning on to the target
+        HOME_DONE,                          ///< At the target
+        HOME_FAILED                         ///< The index wasn't found
+    };
+
+protected:
+    uint16_t steps_per_rev;                 ///< Motor steps per revolution
+    uint16_t fast_ms;                       ///< Milliseconds per fast step
+    uint16_t slow_ms;                       ///< Milliseconds per slow step
+    State state;                            ///< How far the search has got
+    uint16_t target;                        ///< Steps from edge to target
+    uint16_t believed;                      ///< Position it was thought at
+    uint16_t edge_position;                 ///< Position of the index edge
+    uint16_t state_steps;                   ///< Steps made in this state
+    int32_t net_steps;                      ///< Steps forward to the edge
+    uint32_t num_steps;                     ///< Steps made in this search
+    int16_t last_offset;                    ///< Steps it was behind, last
+    uint32_t num_homes;                     ///< Searches which found it
+    uint32_t num_failures;                  ///< Searches which didn't
+
+    // Move on to another state
+    void enter (State new_state);
+
+public:
+    // Create a state machine for a table with the given steps per revolution
+    TableHoming (const char* p_name, uint16_t a_steps_per_rev,
+                 uint16_t a_fast_ms = 4, uint16_t a_slow_ms = 20);
+
+    // Begin a search which ends where the table is thought to be
+    void start (uint16_t a_believed, uint16_t a_edge_position);
+
+    // Find which way to make the next step
+    int8_t next_step (bool index);
+
+    // Find how long to wait before the next step
+    uint16_t get_step_ms (void) const;
+
+    /** @brief   Set how fast the table turns while searching.
+     *  @param   fast Milliseconds per step while turning quickly
+     *  @param   slow Milliseconds per step while finding the edge
+     */
+    void set_speeds (uint16_t fast, uint16_t slow)
+    {
+        fast_ms = fast ? fast : 1;
+        slow_ms = slow ? slow : 1;
+    }
+
+    /// Forget the last search so another can be started
+    void reset (void)
+    {
+        state = HOME_IDLE;
+    }
+
+    /// Return how far the search has got
+    State get_state (void) const
+    {
+        return state;
+    }
+
+    /// Return true while a search is going on
+    bool is_busy (void) const
+    {
+        return state != HOME_IDLE && state != HOME_DONE
+               && state != HOME_FAILED;
+    }
+
+    /// Return true if the last search brought the table to its target
+    bool is_done (void) const
+    {
+        return state == HOME_DONE;
+    }
+
+    /// Return true if the last search didn't find the index
+    bool has_failed (void) const
+    {
+        return state == HOME_FAILED;
+    }
+
+    /// Return the steps by which the table was behind where it was thought
+    /// to be when the last search began, negative if it was ahead
+    int16_t get_last_offset (void) const
+    {
+        return last_offset;
+    }
+
+    // Print the searches and the last offset within the list of shares
+    void print_in_list (Print& printer);
+};
+
+#endif // _HOMING_H_
@@ -0,0 +1,507 @@
+//*****************************************************************************
+/** @file    i2cscheduler.cpp
+ *  @brief   Source code of the scheduler which shares I2C buses among sensors.
+ *  @details This file contains the methods of classes @c I2CLanePort and
+ *           @c I2CBusScheduler.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <PrintStream.h>
+#include "i2cscheduler.h"                   // Header for these classes
+
+
+/// Mux channel number which means no channel is known to be selected
+#define NO_CHANNEL_SELECTED 0xFE
+
+
+/** @brief   Get the lane's bus ready for use.
+ */
+void I2CLanePort::begin (void)
+{
+    if (p_scheduler != NULL)
+    {
+        p_scheduler->buses[p_scheduler->lanes[lane].bus].p_transport->begin ();
+    }
+}
+
+
+/** @brief   Free the lane's bus if it's stuck.
+ *  @details The mux may have been reset along with the bus, so the channel
+ *           it has selected is forgotten and will be selected again.
+ *  @return  True if the bus is free
+ */
+bool I2CLanePort::recover (void)
+{
+    if (p_scheduler == NULL)
+    {
+        return false;
+    }
+    I2CBusScheduler::Bus& bus
+        = p_scheduler->buses[p_scheduler->lanes[lane].bus];
+    bus.selected = NO_CHANNEL_SELECTED;
+    return bus.p_transport->recover ();
+}
+
+
+/** @brief   Do a transfer on the lane's bus, selecting its mux channel first.
+ *  @param   address The 7 bit I2C address of the device
+ *  @param   p_tx Pointer to the bytes to be written
+ *  @param   tx_len The number of bytes to be written
+ *  @param   p_rx Pointer to where bytes read are put, or @c NULL
+ *  @param   rx_len The number of bytes to be read, or zero
+ *  @return  True if the device acknowledged and sent all the bytes
+ */
+bool I2CLanePort::transfer (uint8_t address, const uint8_t* p_tx,
+                            uint8_t tx_len, uint8_t* p_rx, uint8_t rx_len)
+{
+    if (p_scheduler == NULL)
+    {
+        return false;
+    }
+    return p_scheduler->lane_transfer (lane, address, p_tx, tx_len,
+                                       p_rx, rx_len);
+}
+
+
+/** @brief   Create a scheduler with no buses and no sensors.
+ *  @param   p_name A name for the scheduler, used when it's printed
+ */
+I2CBusScheduler::I2CBusScheduler (const char* p_name)
+    : BaseShare (p_name)
+{
+    num_buses = 0;
+    num_lanes = 0;
+    num_reads = 0;
+    num_failed = 0;
+    num_long = 0;
+    last_long = false;
+    p_fault_handler = NULL;
+    p_fault_context = NULL;
+}
+
+
+/** @brief   Add a bus, with or without a multiplexer on it.
+ *  @param   transport The transport which carries the bus's transfers
+ *  @param   mux_address The address of a TCA9548A on the bus, or
+ *           @c I2C_NO_MUX if sensors are wired straight to the bus
+ *  @return  The number of the new bus, or -1 if there's no more room
+ */
+int8_t I2CBusScheduler::add_bus (I2CTransport& transport, uint8_t mux_address)
+{
+    if (num_buses >= I2C_MAX_BUSES)
+    {
+        return -1;
+    }
+    buses[num_buses].p_transport = &transport;
+    buses[num_buses].mux_address = mux_address;
+    buses[num_buses].selected = NO_CHANNEL_SELECTED;
+    return num_buses++;
+}
+
+
+/** @brief   Add a sensor on one of the buses.
+ *  @details The sensor isn't started here; call @c begin_lane() to do so.
+ *  @param   sensor The sensor's driver
+ *  @param   bus The number of the bus, as returned by @c add_bus()
+ *  @param   channel The mux channel, 0 to 7, or @c I2C_NO_MUX if the sensor
+ *           is wired straight to the bus
+ *  @return  The number of the new lane, or -1 if there's no more room or the
+ *           bus or channel isn't valid
+ */
+int8_t I2CBusScheduler::add_sensor (Adafruit_TCS34725& sensor, uint8_t bus,
+                                    uint8_t channel)
+{
+    if (num_lanes >= I2C_MAX_LANES || bus >= num_buses
+        || (channel != I2C_NO_MUX
+            && (channel > 7 || buses[bus].mux_address == I2C_NO_MUX)))
+    {
+        return -1;
+    }
+
+    Lane& new_lane = lanes[num_lanes];
+    new_lane.p_sensor = &sensor;
+    new_lane.bus = bus;
+    new_lane.channel = channel;
+    new_lane.running = false;
+    new_lane.deadline = 0;
+    new_lane.long_pending = false;
+    new_lane.usual = sensor.getIntegrationTime ();
+    new_lane.port.attach (this, num_lanes);
+    new_lane.up = true;
+    new_lane.recovery = RECOVER_READ;
+    new_lane.failures = 0;
+    new_lane.fault_us = 0;
+    new_lane.num_faults = 0;
+    new_lane.num_recoveries = 0;
+    new_lane.last_recovery_us = 0;
+    new_lane.max_recovery_us = 0;
+    return num_lanes++;
+}
+
+
+/** @brief   Start up a sensor and its first integration.
+ *  @details The lane is scheduled even if the sensor doesn't answer, as the
+ *           driver tries to start the sensor again each time it's read.
+ *  @param   lane The number of the sensor's lane
+ *  @param   now_us The time now, in microseconds
+ *  @return  True if the sensor answered, false if not
+ */
+bool I2CBusScheduler::begin_lane (uint8_t lane, uint32_t now_us)
+{
+    if (lane >= num_lanes)
+    {
+        return false;
+    }
+    bool found = lanes[lane].p_sensor->begin (TCS34725_ADDRESS,
+                                              &lanes[lane].port);
+    start_lane (lane, now_us);
+    return found;
+}
+
+
+/** @brief   Schedule a sensor which has been started some other way, as by
+ *           a @c SensorStartup.
+ *  @details Like @c begin_lane(), the lane is scheduled whether or not the
+ *           sensor answered.
+ *  @param   lane The number of the sensor's lane
+ *  @param   now_us The time now, in microseconds
+ */
+void I2CBusScheduler::start_lane (uint8_t lane, uint32_t now_us)
+{
+    if (lane < num_lanes)
+    {
+        lanes[lane].running = true;
+        restart (lane, now_us);
+    }
+}
+
+
+/** @brief   Start timing a new integration, as after the sensor's settings
+ *           change.
+ *  @param   lane The number of the sensor's lane
+ *  @param   now_us The time now, in microseconds
+ */
+void I2CBusScheduler::restart (uint8_t lane, uint32_t now_us)
+{
+    if (lane < num_lanes)
+    {
+        lanes[lane].deadline = now_us
+            + integration_us (lanes[lane].p_sensor->getIntegrationTime ());
+    }
+}
+
+
+/** @brief   Take one reading of a sensor with a longer integration time.
+ *  @details The sensor's ADC is stopped and started again with the longer
+ *           time, so the whole reading uses it. The reading is given by
+ *           @c read_next() like any other, with @c is_long_reading() true,
+ *           and then the sensor goes back to the time it had before. Nothing
+ *           waits, so the other lanes are read while the sensor integrates.
+ *  @param   lane The number of the sensor's lane
+ *  @param   atime The integration time setting for the long reading
+ *  @param   now_us The time now, in microseconds
+ *  @return  True if the long reading was begun, false if the lane isn't in
+ *           service or is already taking a long reading
+ */
+bool I2CBusScheduler::start_long (uint8_t lane, tcs34725IntegrationTime_t atime,
+                                  uint32_t now_us)
+{
+    if (lane >= num_lanes || !lanes[lane].running || !lanes[lane].up
+        || lanes[lane].recovery != RECOVER_READ || lanes[lane].long_pending)
+    {
+        return false;
+    }
+    lanes[lane].usual = lanes[lane].p_sensor->getIntegrationTime ();
+    lanes[lane].long_pending = true;
+    restart_adc (lane, atime, now_us);
+    return true;
+}
+
+
+/** @brief   Begin a fresh integration of a sensor with the given time.
+ *  @details Once the ADC is started it takes one cycle, as long as the
+ *           oscillator's warm up, before integrating.
+ *  @param   lane The number of the sensor's lane
+ *  @param   atime The integration time setting
+ *  @param   now_us The time now, in microseconds
+ */
+void I2CBusScheduler::restart_adc (uint8_t lane,
+                                   tcs34725IntegrationTime_t atime,
+                                   uint32_t now_us)
+{
+    Adafruit_TCS34725* p_sensor = lanes[lane].p_sensor;
+
+    p_sensor->stopADC ();
+    p_sensor->setIntegrationTime (atime);
+    p_sensor->startADC ();
+    lanes[lane].deadline = now_us + I2C_WARM_UP_US + integration_us (atime);
+}
+
+
+/** @brief   Find the running lane whose deadline comes first.
+ *  @return  The number of the lane, or -1 if no lane is running
+ */
+int8_t I2CBusScheduler::earliest (void) const
+{
+    int8_t first = -1;
+
+    for (uint8_t index = 0; index < num_lanes; index++)
+    {
+        if (lanes[index].running
+            && (first < 0 || (int32_t)(lanes[index].deadline
+                                       - lanes[first].deadline) < 0))
+        {
+            first = index;
+        }
+    }
+    return first;
+}
+
+
+/** @brief   Read the sensor whose integration finished first, if any has
+ *           finished.
+ *  @details The lane's next deadline is one integration time from now, so a
+ *           sensor is never read twice during one integration even if the
+ *           reading task falls behind. A reading whose transfers failed is
+ *           thrown away. When a lane which is out of service comes due, the
+ *           next step of starting its sensor again is done instead of a
+ *           reading.
+ *  @param   now_us The time now, in microseconds
+ *  @param   lane Reference to the place where the lane number is put
+ *  @param   sample Reference to the place where the raw reading is put
+ *  @return  True if a sensor was read, false if none was ready or the
+ *           reading failed
+ */
+bool I2CBusScheduler::read_next (uint32_t now_us, uint8_t& lane,
+                                 RGBCSample& sample)
+{
+    int8_t first = earliest ();
+
+    if (first < 0 || (int32_t)(now_us - lanes[first].deadline) < 0)
+    {
+        return false;
+    }
+
+    Lane& the_lane = lanes[first];
+    if (the_lane.recovery != RECOVER_READ)
+    {
+        recover_lane (first, now_us);
+        return false;
+    }
+
+    // After a long reading the sensor goes back to its usual time. If the
+    // reading failed, so may this, but the driver keeps the time, which is
+    // set again when the sensor is started after a fault
+    bool ok = the_lane.p_sensor->getRawDataNoDelay (&sample.r, &sample.g,
+                                                    &sample.b, &sample.c);
+    last_long = the_lane.long_pending;
+    if (the_lane.long_pending)
+    {
+        the_lane.long_pending = false;
+        restart_adc (first, the_lane.usual, now_us);
+    }
+    else
+    {
+        restart (first, now_us);
+    }
+    if (!ok)
+    {
+        num_failed++;
+        fail_lane (first, now_us);
+        return false;
+    }
+
+    the_lane.failures = 0;
+    if (!the_lane.up)
+    {
+        the_lane.up = true;
+        the_lane.num_recoveries++;
+        the_lane.last_recovery_us = now_us - the_lane.fault_us;
+        if (the_lane.last_recovery_us > the_lane.max_recovery_us)
+        {
+            the_lane.max_recovery_us = the_lane.last_recovery_us;
+        }
+        if (p_fault_handler != NULL)
+        {
+            p_fault_handler (first, true, p_fault_context);
+        }
+    }
+    num_reads++;
+    if (last_long)
+    {
+        num_long++;
+    }
+    lane = first;
+    return true;
+}
+
+
+/** @brief   Note a reading of a lane which failed.
+ *  @details After @c I2C_FAULT_LIMIT failures in a row the lane is taken out
+ *           of service and its recovery begins at once. A failure while the
+ *           lane is out of service means its sensor wasn't really back, so
+ *           recovery begins again after @c I2C_RETRY_US.
+ *  @param   lane The number of the lane
+ *  @param   now_us The time now, in microseconds
+ */
+void I2CBusScheduler::fail_lane (uint8_t lane, uint32_t now_us)
+{
+    Lane& the_lane = lanes[lane];
+
+    if (!the_lane.up)
+    {
+        the_lane.recovery = RECOVER_PROBE;
+        the_lane.deadline = now_us + I2C_RETRY_US;
+        return;
+    }
+    if (the_lane.failures == 0)
+    {
+        the_lane.fault_us = now_us;
+    }
+    if (++the_lane.failures >= I2C_FAULT_LIMIT)
+    {
+        the_lane.up = false;
+        the_lane.num_faults++;
+        the_lane.recovery = RECOVER_PROBE;
+        the_lane.deadline = now_us;
+        if (p_fault_handler != NULL)
+        {
+            p_fault_handler (lane, false, p_fault_context);
+        }
+    }
+}
+
+
+/** @brief   Do the next step of starting a sensor which is out of service.
+ *  @details The bus is freed and the sensor is asked for its ID and set up
+ *           as by @c begin(); if it doesn't answer, this is tried again after
+ *           @c I2C_RETRY_US. Then its oscillator is turned on and, once it
+ *           has warmed up, its ADC is started. No step waits, so the other
+ *           lanes are read as usual meanwhile. The lane is back in service
+ *           at its first good reading.
+ *  @param   lane The number of the lane
+ *  @param   now_us The time now, in microseconds
+ */
+void I2CBusScheduler::recover_lane (uint8_t lane, uint32_t now_us)
+{
+    Lane& the_lane = lanes[lane];
+
+    switch (the_lane.recovery)
+    {
+        case RECOVER_PROBE:
+            if (the_lane.port.recover ()
+                && the_lane.p_sensor->probe (TCS34725_ADDRESS,
+                                             &the_lane.port))
+            {
+                the_lane.p_sensor->powerOn ();
+                the_lane.recovery = RECOVER_WARM_UP;
+                the_lane.deadline = now_us + I2C_WARM_UP_US;
+            }
+            else
+            {
+                the_lane.deadline = now_us + I2C_RETRY_US;
+            }
+            break;
+
+        case RECOVER_WARM_UP:
+            the_lane.p_sensor->startADC ();
+            the_lane.recovery = RECOVER_READ;
+            restart (lane, now_us);
+            break;
+
+        case RECOVER_READ:
+            break;
+    }
+}
+
+
+/** @brief   Find how long it will be until a sensor is ready to be read.
+ *  @param   now_us The time now, in microseconds
+ *  @return  The time in microseconds, zero if a sensor is ready now, or
+ *           @c UINT32_MAX if no sensor is running
+ */
+uint32_t I2CBusScheduler::time_to_next (uint32_t now_us) const
+{
+    int8_t first = earliest ();
+
+    if (first < 0)
+    {
+        return UINT32_MAX;
+    }
+    int32_t wait = (int32_t)(lanes[first].deadline - now_us);
+    return (wait > 0) ? (uint32_t)wait : 0;
+}
+
+
+/** @brief   Find the time taken by one integration of a sensor.
+ *  @param   atime The sensor's integration time setting
+ *  @return  The integration time in microseconds, 2400 per ADC cycle
+ */
+uint32_t I2CBusScheduler::integration_us (tcs34725IntegrationTime_t atime)
+{
+    return (256UL - (uint8_t)atime) * 2400UL;
+}
+
+
+/** @brief   Do a transfer for a lane, selecting its mux channel first.
+ *  @details The channel selected on each bus is remembered, so the mux is
+ *           only written when a different sensor is read. If selecting the
+ *           channel fails, the selection is forgotten so it's tried again.
+ *  @param   lane The number of the lane whose sensor is being accessed
+ *  @param   address The 7 bit I2C address of the device
+ *  @param   p_tx Pointer to the bytes to be written
+ *  @param   tx_len The number of bytes to be written
+ *  @param   p_rx Pointer to where bytes read are put, or @c NULL
+ *  @param   rx_len The number of bytes to be read, or zero
+ *  @return  True if the mux and the device acknowledged and sent all the bytes
+ */
+bool I2CBusScheduler::lane_transfer (uint8_t lane, uint8_t address,
+                                     const uint8_t* p_tx, uint8_t tx_len,
+                                     uint8_t* p_rx, uint8_t rx_len)
+{
+    const Lane& the_lane = lanes[lane];
+    Bus& bus = buses[the_lane.bus];
+
+    if (the_lane.channel != I2C_NO_MUX && bus.selected != the_lane.channel)
+    {
+        uint8_t select = 1 << the_lane.channel;
+        if (!bus.p_transport->transfer (bus.mux_address, &select, 1, NULL, 0))
+        {
+            bus.selected = NO_CHANNEL_SELECTED;
+            return false;
+        }
+        bus.selected = the_lane.channel;
+    }
+    return bus.p_transport->transfer (address, p_tx, tx_len, p_rx, rx_len);
+}
+
+
+/** @brief   Print the readings and faults of each lane within the list of
+ *           shares.
+ *  @param   printer Reference to a serial device on which to print
+ */
+void I2CBusScheduler::print_in_list (Print& printer)
+{
+    // Print this scheduler's name and pad it to 16 characters
+    printer.printf ("%-16si2c\t", name);
+    printer << num_reads << " reads, " << num_long << " long, "
+            << num_failed << " failed" << endl;
+    for (uint8_t index = 0; index < num_lanes; index++)
+    {
+        const Lane& the_lane = lanes[index];
+        printer.printf ("%-16s", "");
+        printer << "lane " << index << (the_lane.up ? " up, " : " DOWN, ")
+                << the_lane.num_faults << " faults, "
+                << the_lane.num_recoveries << " recoveries, last "
+                << the_lane.last_recovery_us << " us, max "
+                << the_lane.max_recovery_us << " us" << endl;
+    }
+
+    // Call the next item
+    if (p_next != NULL)
+    {
+        p_next->print_in_list (printer);
+    }
+}
@@ -0,0 +1,302 @@
+//*****************************************************************************
+/** @file    i2cscheduler.h
+ *  @brief   Scheduler which shares I2C buses among several color sensors.
+ *  @details Every TCS34725 has the same fixed address, 0x29, so more than one
+ *           sensor must be put on separate I2C buses or behind a TCA9548A
+ *           multiplexer. This file contains a scheduler which owns one or
+ *           more buses and any number of sensors, up to a fixed limit, on
+ *           them. Each sensor is given its own @c I2CLanePort, a transport
+ *           which selects the sensor's multiplexer channel before passing each
+ *           transfer on to the bus, so the driver needn't know about the mux.
+ *
+ *           The sensors integrate continuously and all at once; only reading
+ *           the results uses the bus. The scheduler keeps a deadline for each
+ *           sensor, the time at which its current integration is finished,
+ *           and reads whichever sensor's deadline came first. Because the
+ *           integrations overlap while the short transfers take turns, the
+ *           number of readings per second grows with the number of sensors
+ *           until the bus is full.
+ *
+ *           All the sensors on one scheduler must be read from the same task,
+ *           since selecting a mux channel and then reading the sensor are two
+ *           separate transfers.
+ *
+ *           A lane can be asked for one reading with a longer integration
+ *           time, as for a ball whose short readings are ambiguous; its
+ *           sensor goes back to its usual time afterwards, and the other
+ *           lanes are read as usual meanwhile.
+ *
+ *           A reading whose transfers fail is thrown away. After several in a
+ *           row the sensor's lane is taken out of service, and the scheduler
+ *           tries now and then to free the bus and start the sensor again
+ *           until it answers. The time from the first failure to the first
+ *           good reading after it is measured, and the counts are printed by
+ *           @c print_all_shares().
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _I2CSCHEDULER_H_
+#define _I2CSCHEDULER_H_
+
+#include <Arduino.h>
+#include "baseshare.h"                      // Base class for shared data items
+#include "i2ctransport.h"
+#include "colorsample.h"
+#include "Adafruit_TCS34725.h"
+
+
+/// The largest number of buses a scheduler can own
+#define I2C_MAX_BUSES 2
+
+/// The largest number of sensors a scheduler can read
+#define I2C_MAX_LANES 4
+
+/// Multiplexer address or channel used for a sensor wired straight to a bus
+#define I2C_NO_MUX 0xFF
+
+/// The usual address of a TCA9548A I2C multiplexer
+#define TCA9548A_ADDRESS 0x70
+
+/// Failed readings in a row after which a sensor is out of service
+#define I2C_FAULT_LIMIT 3
+
+/// Microseconds between tries at starting a sensor which is out of service
+#define I2C_RETRY_US 50000UL
+
+/// Microseconds the sensor's oscillator needs after it's turned on
+#define I2C_WARM_UP_US 2400UL
+
+
+class I2CBusScheduler;
+
+
+/** @brief   Transport through which one sensor's driver reaches its bus.
+ *  @details Each transfer is handed to the scheduler, which selects the
+ *           sensor's multiplexer channel if need be and then does the
+ *           transfer on the sensor's bus.
+ */
+class I2CLanePort : public I2CTransport
+{
+protected:
+    I2CBusScheduler* p_scheduler;           ///< Scheduler which owns the lane
+    uint8_t lane;                           ///< Number of this sensor's lane
+
+public:
+    /// Create a port which isn't connected to a lane yet
+    I2CLanePort (void) : p_scheduler (NULL), lane (0)
+    {
+    }
+
+    /// Connect this port to a lane of a scheduler
+    void attach (I2CBusScheduler* a_p_scheduler, uint8_t a_lane)
+    {
+        p_scheduler = a_p_scheduler;
+        lane = a_lane;
+    }
+
+    // Get the lane's bus ready for use
+    void begin (void);
+
+    // Free the lane's bus if it's stuck
+    bool recover (void);
+
+    // Do a transfer on the lane's bus, selecting its mux channel first
+    bool transfer (uint8_t address, const uint8_t* p_tx, uint8_t tx_len,
+                   uint8_t* p_rx, uint8_t rx_len);
+};
+
+
+/** @brief   Class which reads several color sensors on shared I2C buses.
+ *  @details Buses are added with @c add_bus() and sensors with
+ *           @c add_sensor(); then @c begin_lane() starts each sensor. The
+ *           reading task calls @c read_next() with the time; when a sensor's
+ *           integration has finished, the one which finished first is read.
+ *           @c time_to_next() tells how long the task can sleep before any
+ *           sensor will be ready. Times are in microseconds from @c micros(),
+ *           and are passed in so that the scheduler can be run without
+ *           hardware. A function given to @c set_fault_handler() is called
+ *           when a sensor goes out of service and when it's back.
+ */
+class I2CBusScheduler : public BaseShare
+{
+protected:
+    /// One I2C bus and the multiplexer, if any, on it
+    struct Bus
+    {
+        I2CTransport* p_transport;          ///< Carries this bus's transfers
+        uint8_t mux_address;                ///< Mux address or @c I2C_NO_MUX
+        uint8_t selected;                   ///< Mux channel now selected
+    };
+
+    /// Steps in starting a sensor again after it went out of service
+    enum Recovery
+    {
+        RECOVER_PROBE,                      ///< Freeing the bus, asking for ID
+        RECOVER_WARM_UP,                    ///< Waiting for the oscillator
+        RECOVER_READ                        ///< Waiting for a good reading
+    };
+
+    /// One sensor and when its current integration will be finished
+    struct Lane
+    {
+        Adafruit_TCS34725* p_sensor;        ///< The sensor's driver
+        uint8_t bus;                        ///< Which bus the sensor is on
+        uint8_t channel;                    ///< Mux channel or @c I2C_NO_MUX
+        bool running;                       ///< True once the lane is begun
+        uint32_t deadline;                  ///< Time the integration is done
+        bool long_pending;                  ///< Taking a long reading now
+        tcs34725IntegrationTime_t usual;    ///< Time to go back to after it
+        I2CLanePort port;                   ///< Transport given to the driver
+        bool up;                            ///< False while out of service
+        Recovery recovery;                  ///< How far recovery has got
+        uint8_t failures;                   ///< Failed readings in a row
+        uint32_t fault_us;                  ///< Time of the first failure
+        uint32_t num_faults;                ///< Times it went out of service
+        uint32_t num_recoveries;            ///< Times it came back
+        uint32_t last_recovery_us;          ///< Time to get it back, latest
+        uint32_t max_recovery_us;           ///< Time to get it back, longest
+    };
+
+    Bus buses[I2C_MAX_BUSES];               ///< The buses which are owned
+    uint8_t num_buses;                      ///< How many buses have been added
+    Lane lanes[I2C_MAX_LANES];              ///< The sensors which are read
+    uint8_t num_lanes;                      ///< How many sensors were added
+    uint32_t num_reads;                     ///< Readings taken since creation
+    uint32_t num_failed;                    ///< Readings thrown away
+    uint32_t num_long;                      ///< Long readings taken
+    bool last_long;                         ///< True if the last was long
+
+    /// Function called when a lane goes out of service or comes back
+    void (*p_fault_handler) (uint8_t lane, bool up, void* p_context);
+    void* p_fault_context;                  ///< Passed to the fault handler
+
+    // Find the running lane whose deadline comes first
+    int8_t earliest (void) const;
+
+    // Note a reading of a lane which failed
+    void fail_lane (uint8_t lane, uint32_t now_us);
+
+    // Do the next step of starting a sensor which is out of service
+    void recover_lane (uint8_t lane, uint32_t now_us);
+
+    // Begin a fresh integration of a sensor with the given time
+    void restart_adc (uint8_t lane, tcs34725IntegrationTime_t atime,
+                      uint32_t now_us);
+
+    friend class I2CLanePort;
+
+    // Do a transfer for a lane, selecting its mux channel first
+    bool lane_transfer (uint8_t lane, uint8_t address, const uint8_t* p_tx,
+                        uint8_t tx_len, uint8_t* p_rx, uint8_t rx_len);
+
+public:
+    // Create a scheduler with no buses and no sensors
+    I2CBusScheduler (const char* p_name = NULL);
+
+    // Add a bus, with or without a multiplexer on it
+    int8_t add_bus (I2CTransport& transport, uint8_t mux_address = I2C_NO_MUX);
+
+    // Add a sensor on one of the buses
+    int8_t add_sensor (Adafruit_TCS34725& sensor, uint8_t bus,
+                       uint8_t channel = I2C_NO_MUX);
+
+    // Start up a sensor and its first integration
+    bool begin_lane (uint8_t lane, uint32_t now_us);
+
+    // Schedule a sensor which has been started some other way
+    void start_lane (uint8_t lane, uint32_t now_us);
+
+    // Start timing a new integration, as after the sensor's settings change
+    void restart (uint8_t lane, uint32_t now_us);
+
+    // Take one reading of a sensor with a longer integration time
+    bool start_long (uint8_t lane, tcs34725IntegrationTime_t atime,
+                     uint32_t now_us);
+
+    // Read the sensor whose integration finished first, if any has finished
+    bool read_next (uint32_t now_us, uint8_t& lane, RGBCSample& sample);
+
+    // Find how long it will be until a sensor is ready to be read
+    uint32_t time_to_next (uint32_t now_us) const;
+
+    // Find the time taken by one integration of a sensor
+    static uint32_t integration_us (tcs34725IntegrationTime_t atime);
+
+    /** @brief   Set a function which is told when sensors fail and recover.
+     *  @details The function is called from the task which reads the
+     *           sensors, with @c false when a lane goes out of service and
+     *           @c true at its first good reading after that.
+     *  @param   a_p_handler The function, or @c NULL for none
+     *  @param   a_p_context A pointer given to the function
+     */
+    void set_fault_handler (void (*a_p_handler) (uint8_t lane, bool up,
+                                                 void* p_context),
+                            void* a_p_context)
+    {
+        p_fault_handler = a_p_handler;
+        p_fault_context = a_p_context;
+    }
+
+    /// Return true unless a lane is out of service or doesn't exist
+    bool is_up (uint8_t lane) const
+    {
+        return (lane < num_lanes) && lanes[lane].up;
+    }
+
+    /// Return the time taken to get a lane back into service, the latest time
+    uint32_t get_last_recovery_us (uint8_t lane) const
+    {
+        return (lane < num_lanes) ? lanes[lane].last_recovery_us : 0;
+    }
+
+    /// Return true if the reading last given by @c read_next() was a long
+    /// reading asked for with @c start_long()
+    bool is_long_reading (void) const
+    {
+        return last_long;
+    }
+
+    /// Return true while a lane is taking a long reading
+    bool is_long_pending (uint8_t lane) const
+    {
+        return (lane < num_lanes) && lanes[lane].long_pending;
+    }
+
+    /// Return the number of readings thrown away because transfers failed
+    uint32_t get_num_failed (void) const
+    {
+        return num_failed;
+    }
+
+    /// Return the transport which a lane's driver should be given
+    I2CLanePort* get_port (uint8_t lane)
+    {
+        return (lane < num_lanes) ? &lanes[lane].port : NULL;
+    }
+
+    /// Return the driver of the sensor in a lane
+    Adafruit_TCS34725* get_sensor (uint8_t lane) const
+    {
+        return (lane < num_lanes) ? lanes[lane].p_sensor : NULL;
+    }
+
+    /// Return the number of sensors which have been added
+    uint8_t get_num_lanes (void) const
+    {
+        return num_lanes;
+    }
+
+    /// Return the number of readings taken from all the sensors
+    uint32_t get_num_reads (void) const
+    {
+        return num_reads;
+    }
+
+    // Print the readings and faults of each lane within the list of shares
+    void print_in_list (Print& printer);
+};
+
+#endif // _I2CSCHEDULER_H_
@@ -0,0 +1,308 @@
+//*****************************************************************************
+/** @file    i2ctransport.cpp
+ *  @brief   Source code of the I2C transports used by the color sensor.
+ *  @details This file contains the methods of classes @c TwoWireTransport
+ *           and @c AsyncI2CTransport.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include "i2ctransport.h"                   // Header for these classes
+#ifdef ARDUINO
+    #include "task.h"                       // FreeRTOS task functions
+    #include "queue.h"                      // FreeRTOS queue functions
+#endif
+
+
+/** @brief   Start up the I2C port.
+ */
+void TwoWireTransport::begin (void)
+{
+    p_wire->begin ();
+}
+
+
+/** @brief   Write and read bytes with blocking calls.
+ *  @param   address The 7 bit I2C address of the device
+ *  @param   p_tx Pointer to the bytes to be written
+ *  @param   tx_len The number of bytes to be written
+ *  @param   p_rx Pointer to where bytes read are put, or @c NULL
+ *  @param   rx_len The number of bytes to be read, or zero
+ *  @return  True if the device acknowledged and sent all the bytes
+ */
+bool TwoWireTransport::transfer (uint8_t address, const uint8_t* p_tx,
+                                 uint8_t tx_len, uint8_t* p_rx, uint8_t rx_len)
+{
+    p_wire->beginTransmission (address);
+    for (uint8_t index = 0; index < tx_len; index++)
+    {
+#if ARDUINO >= 100
+        p_wire->write (p_tx[index]);
+#else
+        p_wire->send (p_tx[index]);
+#endif
+    }
+    if (p_wire->endTransmission () != 0)
+    {
+        return false;
+    }
+    if (rx_len == 0)
+    {
+        return true;
+    }
+
+    if (p_wire->requestFrom (address, rx_len) != rx_len)
+    {
+        return false;
+    }
+    for (uint8_t index = 0; index < rx_len; index++)
+    {
+#if ARDUINO >= 100
+        p_rx[index] = p_wire->read ();
+#else
+        p_rx[index] = p_wire->receive ();
+#endif
+    }
+    return true;
+}
+
+
+/** @brief   Clock out a device which holds the data line low, then restart.
+ *  @details A device which was reset or lost a clock edge part way through
+ *           sending a byte may hold SDA low while it waits for clocks which
+ *           never come, and the I2C peripheral then can't start a transfer.
+ *           The port is stopped and SCL is pulsed, up to nine times, until
+ *           the device lets SDA go; a stop condition is sent and the port is
+ *           started again.
+ *  @return  True if SDA was high, so the bus is free
+ */
+bool TwoWireTransport::recover (void)
+{
+    p_wire->end ();
+    pinMode (sda_pin, INPUT_PULLUP);
+    digitalWrite (scl_pin, HIGH);
+    pinMode (scl_pin, OUTPUT_OPEN_DRAIN);
+    for (uint8_t clock = 0; clock < 9 && digitalRead (sda_pin) == LOW; clock++)
+    {
+        digitalWrite (scl_pin, LOW);
+        delayMicroseconds (5);
+        digitalWrite (scl_pin, HIGH);
+        delayMicroseconds (5);
+    }
+    bool freed = (digitalRead (sda_pin) == HIGH);
+
+    // With SCL high, SDA going low and then high is a start and a stop,
+    // which puts every device back to waiting for a start
+    digitalWrite (sda_pin, LOW);
+    pinMode (sda_pin, OUTPUT_OPEN_DRAIN);
+    delayMicroseconds (5);
+    digitalWrite (sda_pin, HIGH);
+    delayMicroseconds (5);
+
+    p_wire->begin ();
+    return freed;
+}
+
+
+#ifdef ARDUINO
+
+/** @brief   Create an asynchronous transport on the given I2C port.
+ *  @details The queue is made here; the bus task is made by @c begin().
+ *  @param   p_wire Pointer to the I2C port, usually @c &Wire
+ *  @param   queue_size The most transfers which can wait in the queue
+ */
+AsyncI2CTransport::AsyncI2CTransport (TwoWire* p_wire, uint8_t queue_size)
+    : wire (p_wire)
+{
+    queue = xQueueCreate (queue_size, sizeof (I2CTransfer*));
+    bus_task = NULL;
+    blocking.done = true;
+    pending = false;
+    num_timeouts = 0;
+}
+
+
+/** @brief   Create the bus task at a low priority and start up the I2C port.
+ */
+void AsyncI2CTransport::begin (void)
+{
+    begin (1, 256);
+}
+
+
+/** @brief   Create the bus task and start up the I2C port.
+ *  @details Calling this more than once does no harm.
+ *  @param   priority The RTOS priority of the bus task
+ *  @param   stack_size The stack size, in words, of the bus task
+ *  @param   p_task_name The bus task's name, as shown in printouts
+ */
+void AsyncI2CTransport::begin (UBaseType_t priority, uint16_t stack_size,
+                               const char* p_task_name)
+{
+    wire.begin ();
+    if (bus_task == NULL)
+    {
+        xTaskCreate (run, p_task_name, stack_size, this, priority, &bus_task);
+    }
+}
+
+
+/** @brief   The bus task's function.
+ *  @details This task waits for transfers to appear in the queue and does
+ *           them one at a time. A transfer's callback, if any, is called
+ *           from this task, so callbacks must be short and must not do
+ *           blocking transfers on this same transport.
+ *  @param   p_params Pointer to the transport which owns this task
+ */
+void AsyncI2CTransport::run (void* p_params)
+{
+    AsyncI2CTransport* p_bus = (AsyncI2CTransport*)p_params;
+    I2CTransfer* p_xfer;
+
+    for (;;)
+    {
+        if (xQueueReceive (p_bus->queue, &p_xfer, portMAX_DELAY) != pdTRUE)
+        {
+            continue;
+        }
+
+        p_xfer->ok = p_bus->wire.transfer (p_xfer->address, p_xfer->tx,
+                                           p_xfer->tx_len, p_xfer->p_rx,
+                                           p_xfer->rx_len);
+
+        // Once done is set the owner may throw the transfer away, so the
+        // callback is called first and the waiting task is saved beforehand
+        TaskHandle_t waiter = p_xfer->waiter;
+        if (p_xfer->p_callback != NULL)
+        {
+            p_xfer->p_callback (*p_xfer, p_xfer->p_context);
+        }
+        p_xfer->done = true;
+        if (waiter != NULL)
+        {
+            xTaskNotifyGive (waiter);
+        }
+    }
+}
+
+
+/** @brief   Free a stuck bus; call only while no transfers are waiting.
+ *  @details The recovery is done by the calling task rather than the bus
+ *           task. The bus task is only busy while a transfer is waiting, so
+ *           when the only task using this bus calls this, the port is idle.
+ *           If a blocking transfer timed out and the bus task still has it,
+ *           nothing is done.
+ *  @return  True if the bus is free
+ */
+bool AsyncI2CTransport::recover (void)
+{
+    if (pending && !blocking.done)
+    {
+        return false;
+    }
+    return wire.recover ();
+}
+
+
+/** @brief   Put a transfer into the queue without waiting for it.
+ *  @details The transfer's @c done flag is cleared here and set by the bus
+ *           task when the transfer is over. If the queue is full, this method
+ *           returns false at once rather than waiting.
+ *  @param   transfer The transfer, which must stay in existence until done
+ *  @return  True if the transfer was queued, false if not
+ */
+bool AsyncI2CTransport::submit (I2CTransfer& transfer)
+{
+    I2CTransfer* p_xfer = &transfer;
+
+    if (transfer.tx_len > I2C_MAX_TRANSFER || bus_task == NULL)
+    {
+        return false;
+    }
+    transfer.done = false;
+    transfer.ok = false;
+    return (xQueueSendToBack (queue, &p_xfer, 0) == pdTRUE);
+}
+
+
+/** @brief   Do a transfer, sleeping until the bus task has finished it.
+ *  @details Before the RTOS scheduler has started there is no bus task to do
+ *           the work, so the transfer is done directly. Only one task at a
+ *           time may call this method on a transport.
+ *
+ *           The transfer and the bytes read are kept in this object rather
+ *           than in the caller's memory, so a transfer which times out can
+ *           be left to the bus task safely. Until the bus task is done with
+ *           it, further transfers fail without waiting.
+ *  @param   address The 7 bit I2C address of the device
+ *  @param   p_tx Pointer to the bytes to be written
+ *  @param   tx_len The number of bytes to be written
+ *  @param   p_rx Pointer to where bytes read are put, or @c NULL
+ *  @param   rx_len The number of bytes to be read, or zero
+ *  @return  True if the device acknowledged and sent all the bytes
+ */
+bool AsyncI2CTransport::transfer (uint8_t address, const uint8_t* p_tx,
+                                  uint8_t tx_len, uint8_t* p_rx,
+                                  uint8_t rx_len)
+{
+    if (xTaskGetSchedulerState () != taskSCHEDULER_RUNNING)
+    {
+        return wire.transfer (address, p_tx, tx_len, p_rx, rx_len);
+    }
+
+    if (pending)
+    {
+        if (!blocking.done)
+        {
+            return false;
+        }
+        pending = false;
+    }
+    if (bus_task == NULL || tx_len > I2C_MAX_TRANSFER
+        || rx_len > I2C_MAX_TRANSFER)
+    {
+        return false;
+    }
+
+    blocking.address = address;
+    blocking.tx_len = tx_len;
+    memcpy (blocking.tx, p_tx, tx_len);
+    blocking.p_rx = rx;
+    blocking.rx_len = rx_len;
+    blocking.p_callback = NULL;
+    blocking.p_context = NULL;
+    blocking.waiter = xTaskGetCurrentTaskHandle ();
+
+    // Wait in the queue if it's full, then sleep until the bus task is done
+    const TickType_t timeout = pdMS_TO_TICKS (I2C_TRANSFER_TIMEOUT_MS);
+    TickType_t start = xTaskGetTickCount ();
+    blocking.done = false;
+    blocking.ok = false;
+    I2CTransfer* p_xfer = &blocking;
+    if (xQueueSendToBack (queue, &p_xfer, timeout) != pdTRUE)
+    {
+        blocking.done = true;
+        num_timeouts++;
+        return false;
+    }
+    while (!blocking.done)
+    {
+        TickType_t waited = xTaskGetTickCount () - start;
+        if (waited >= timeout)
+        {
+            blocking.waiter = NULL;
+            pending = true;
+            num_timeouts++;
+            return false;
+        }
+        ulTaskNotifyTake (pdTRUE, timeout - waited);
+    }
+    if (blocking.ok && rx_len > 0)
+    {
+        memcpy (p_rx, rx, rx_len);
+    }
+    return blocking.ok;
+}
+
+#endif // ARDUINO
@@ -0,0 +1,233 @@
+//*****************************************************************************
+/** @file    i2ctransport.h
+ *  @brief   I2C transports which carry the color sensor driver's transfers.
+ *  @details The TCS34725 driver doesn't talk to @c TwoWire directly; instead
+ *           it hands each register access to an @c I2CTransport. Two
+ *           transports are provided here:
+ *           - @c TwoWireTransport does each transfer with blocking @c TwoWire
+ *             calls in the calling task, which is how the driver has always
+ *             worked.
+ *           - @c AsyncI2CTransport puts transfers into a queue which is
+ *             serviced by a bus task. A transfer finishes by calling a
+ *             callback or by notifying the task which is waiting for it, so
+ *             the requesting task is blocked rather than spinning while the
+ *             bus is busy.
+ *
+ *           A transport which only records transfers can be given to the
+ *           driver in order to exercise it without a sensor.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _I2CTRANSPORT_H_
+#define _I2CTRANSPORT_H_
+
+#include <Arduino.h>
+#include <Wire.h>
+
+// The asynchronous transport needs a bus task, so it's only there under the
+// RTOS; on a PC the driver is tested with a transport given to it
+#ifdef ARDUINO
+    #include "FreeRTOS.h"                   // Main header for FreeRTOS
+#endif
+
+
+/// The most bytes written or read in one transfer
+#define I2C_MAX_TRANSFER 8
+
+/// Milliseconds a blocking transfer may wait for the bus task
+#define I2C_TRANSFER_TIMEOUT_MS 10
+
+
+/** @brief   Base class for ways of carrying I2C transfers.
+ *  @details A transfer writes some bytes to a device and then, optionally,
+ *           reads some bytes back with a repeated start.
+ */
+class I2CTransport
+{
+public:
+    /// Virtual destructor, as this class is used through pointers
+    virtual ~I2CTransport (void) { }
+
+    /** @brief   Get the bus ready for use.
+     */
+    virtual void begin (void) = 0;
+
+    /** @brief   Write bytes to a device, then optionally read bytes back.
+     *  @param   address The 7 bit I2C address of the device
+     *  @param   p_tx Pointer to the bytes to be written
+     *  @param   tx_len The number of bytes to be written
+     *  @param   p_rx Pointer to where bytes read are put, or @c NULL
+     *  @param   rx_len The number of bytes to be read, or zero
+     *  @return  True if the device acknowledged and sent all the bytes
+     */
+    virtual bool transfer (uint8_t address, const uint8_t* p_tx,
+                           uint8_t tx_len, uint8_t* p_rx, uint8_t rx_len) = 0;
+
+    /** @brief   Free a stuck bus and get it ready for use again.
+     *  @details Transports which can't do more just start the bus again.
+     *  @return  True if the bus is free
+     */
+    virtual bool recover (void)
+    {
+        begin ();
+        return true;
+    }
+};
+
+
+/** @brief   Transport which makes blocking @c TwoWire calls.
+ */
+class TwoWireTransport : public I2CTransport
+{
+protected:
+    TwoWire* p_wire;                        ///< The Arduino I2C port used
+    uint32_t sda_pin;                       ///< The port's data pin
+    uint32_t scl_pin;                       ///< The port's clock pin
+
+public:
+    /** @brief   Create a transport which uses the given I2C port.
+     *  @param   a_p_wire Pointer to the I2C port, usually @c &Wire
+     */
+    TwoWireTransport (TwoWire* a_p_wire = &Wire)
+        : p_wire (a_p_wire), sda_pin (SDA), scl_pin (SCL)
+    {
+    }
+
+    /** @brief   Tell the transport which pins its port uses.
+     *  @details The pins are only used to free a stuck bus. They're @c SDA
+     *           and @c SCL unless they're set otherwise.
+     *  @param   a_sda_pin The data pin
+     *  @param   a_scl_pin The clock pin
+     */
+    void set_pins (uint32_t a_sda_pin, uint32_t a_scl_pin)
+    {
+        sda_pin = a_sda_pin;
+        scl_pin = a_scl_pin;
+    }
+
+    /// Change which I2C port is used
+    void set_wire (TwoWire* a_p_wire)
+    {
+        p_wire = a_p_wire;
+    }
+
+    /// Return the I2C port which is used
+    TwoWire* get_wire (void) const
+    {
+        return p_wire;
+    }
+
+    // Start up the I2C port
+    void begin (void);
+
+    // Write and read bytes with blocking calls
+    bool transfer (uint8_t address, const uint8_t* p_tx, uint8_t tx_len,
+                   uint8_t* p_rx, uint8_t rx_len);
+
+    // Clock out a device which holds the data line low, then restart
+    bool recover (void);
+};
+
+
+#ifdef ARDUINO
+
+/** @brief   One transfer waiting for, or done by, an asynchronous transport.
+ *  @details The requesting code owns this structure and must keep it in
+ *           existence until the transfer is done.
+ */
+struct I2CTransfer
+{
+    uint8_t address;                        ///< 7 bit device address
+    uint8_t tx[I2C_MAX_TRANSFER];           ///< Bytes to be written
+    uint8_t tx_len;                         ///< Number of bytes to write
+    uint8_t* p_rx;                          ///< Where bytes read are put
+    uint8_t rx_len;                         ///< Number of bytes to read
+    volatile bool done;                     ///< Set when the transfer is over
+    bool ok;                                ///< True if the transfer worked
+
+    /// Function called by the bus task when the transfer is over, or @c NULL
+    void (*p_callback) (I2CTransfer& transfer, void* p_context);
+    void* p_context;                        ///< Passed to the callback
+    TaskHandle_t waiter;                    ///< Task to notify, or @c NULL
+};
+
+
+/** @brief   Transport which does transfers in a bus task.
+ *  @details Transfers are put into a FreeRTOS queue. The bus task takes them
+ *           out one at a time, carries them out on a @c TwoWire port, and
+ *           then calls the transfer's callback or notifies the task which is
+ *           waiting for it. The blocking @c transfer() method used by the
+ *           driver submits a transfer and sleeps on a task notification
+ *           until it's done, so other tasks can run while the bus is busy.
+ *           Code which doesn't want to wait at all calls @c submit() with a
+ *           callback. A blocking transfer which isn't done within
+ *           @c I2C_TRANSFER_TIMEOUT_MS fails, and further blocking transfers
+ *           fail at once until the bus task lets it go.
+ *
+ *           The bus task should have a lower priority than the tasks which
+ *           do computation, since the Arduino I2C library waits for each
+ *           transfer to finish inside the bus task.
+ */
+class AsyncI2CTransport : public I2CTransport
+{
+protected:
+    TwoWireTransport wire;                  ///< Carries out the transfers
+    QueueHandle_t queue;                    ///< Transfers waiting to be done
+    TaskHandle_t bus_task;                  ///< Task which does transfers
+    I2CTransfer blocking;                   ///< Used by @c transfer()
+    uint8_t rx[I2C_MAX_TRANSFER];           ///< Bytes read by @c transfer()
+    bool pending;                           ///< True if one was given up on
+    uint32_t num_timeouts;                  ///< Transfers which timed out
+
+    // The bus task's function
+    static void run (void* p_params);
+
+public:
+    // Create an asynchronous transport on the given I2C port
+    AsyncI2CTransport (TwoWire* p_wire = &Wire, uint8_t queue_size = 8);
+
+    // Create the bus task and start up the I2C port
+    void begin (void);
+
+    // Create the bus task with the given priority, stack size and name
+    void begin (UBaseType_t priority, uint16_t stack_size,
+                const char* p_task_name = "I2C bus");
+
+    /** @brief   Tell the transport which pins its port uses.
+     *  @param   a_sda_pin The data pin
+     *  @param   a_scl_pin The clock pin
+     */
+    void set_pins (uint32_t a_sda_pin, uint32_t a_scl_pin)
+    {
+        wire.set_pins (a_sda_pin, a_scl_pin);
+    }
+
+    // Free a stuck bus; call only while no transfers are waiting
+    bool recover (void);
+
+    // Put a transfer into the queue without waiting for it
+    bool submit (I2CTransfer& transfer);
+
+    // Do a transfer, sleeping until the bus task has finished it
+    bool transfer (uint8_t address, const uint8_t* p_tx, uint8_t tx_len,
+                   uint8_t* p_rx, uint8_t rx_len);
+
+    /// Return the number of blocking transfers which timed out
+    uint32_t get_num_timeouts (void) const
+    {
+        return num_timeouts;
+    }
+
+    /// Return the bus task's handle, or @c NULL if it hasn't been created
+    TaskHandle_t get_task (void) const
+    {
+        return bus_task;
+    }
+};
+
+#endif // ARDUINO
+
+#endif // _I2CTRANSPORT_H_
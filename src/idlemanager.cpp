@@ -0,0 +1,56 @@
+//*****************************************************************************
+/** @file    idlemanager.cpp
+ *  @brief   Source code of the low power idle state machine.
+ *  @details This file contains the methods of class @c IdleManager.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include "idlemanager.h"                    // Header for this class
+
+
+/** @brief   Create an idle manager which starts out active.
+ *  @param   a_idle_after The time in milliseconds with no activity after
+ *           which the sorter should go idle
+ *  @param   now_ms The time now, in milliseconds
+ */
+IdleManager::IdleManager (uint32_t a_idle_after, uint32_t now_ms)
+{
+    state = ACTIVE;
+    idle_after = a_idle_after;
+    last_activity = now_ms;
+    num_wakes = 0;
+}
+
+
+/** @brief   Note that a ball has been seen or the sensor has seen a change.
+ *  @param   now_ms The time now, in milliseconds
+ *  @return  @c WAKE if the sorter was idle and should wake up, or @c STAY
+ */
+IdleManager::Action IdleManager::activity (uint32_t now_ms)
+{
+    last_activity = now_ms;
+    if (state == IDLE)
+    {
+        state = ACTIVE;
+        num_wakes++;
+        return WAKE;
+    }
+    return STAY;
+}
+
+
+/** @brief   See if the sorter has been quiet long enough to go idle.
+ *  @param   now_ms The time now, in milliseconds
+ *  @return  @c SLEEP if the sorter should go idle now, or @c STAY
+ */
+IdleManager::Action IdleManager::update (uint32_t now_ms)
+{
+    if (state == ACTIVE && now_ms - last_activity >= idle_after)
+    {
+        state = IDLE;
+        return SLEEP;
+    }
+    return STAY;
+}
@@ -0,0 +1,94 @@
+//*****************************************************************************
+/** @file    idlemanager.h
+ *  @brief   State machine which puts the color sorter into a low power idle.
+ *  @details When no ball has been seen for a while there's no reason for the
+ *           color sensor to convert continuously or for the tasks to wake up
+ *           every few milliseconds. This file contains a small state machine
+ *           which decides when to go idle and when to wake up; the code which
+ *           uses it does the actual work of putting the sensor into its wait
+ *           state, arming the sensor's clear channel interrupt, and letting
+ *           the tasks block so FreeRTOS tickless idle can stop the tick.
+ *
+ *           Times are given to the state machine rather than read from the
+ *           clock, so it can be run with a simulated clock.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _IDLEMANAGER_H_
+#define _IDLEMANAGER_H_
+
+#include <stdint.h>
+
+
+/// Default time in milliseconds with no balls after which the sorter idles
+#define IDLE_AFTER_MS 30000UL
+
+
+/** @brief   Class which decides when the sorter should go idle and wake up.
+ *  @details Call @c activity() whenever a ball is seen or the sensor's
+ *           interrupt fires, and @c update() now and then. Each returns what,
+ *           if anything, the caller should do about the power state.
+ */
+class IdleManager
+{
+public:
+    /// The power state of the sorter
+    enum State
+    {
+        ACTIVE,                             ///< Running normally
+        IDLE                                ///< Waiting for a ball to arrive
+    };
+
+    /// What the caller should do after a call to @c activity() or @c update()
+    enum Action
+    {
+        STAY,                               ///< Nothing has changed
+        SLEEP,                              ///< Go into the idle state
+        WAKE                                ///< Leave the idle state
+    };
+
+protected:
+    State state;                            ///< The present power state
+    uint32_t idle_after;                    ///< Quiet time before idling, ms
+    uint32_t last_activity;                 ///< Time of the last activity, ms
+    uint16_t num_wakes;                     ///< Times the sorter has woken
+
+public:
+    // Create an idle manager which starts out active
+    IdleManager (uint32_t a_idle_after = IDLE_AFTER_MS, uint32_t now_ms = 0);
+
+    // Note that a ball has been seen or the sensor has seen a change
+    Action activity (uint32_t now_ms);
+
+    // See if the sorter has been quiet long enough to go idle
+    Action update (uint32_t now_ms);
+
+    /// Change how long the sorter must be quiet before it goes idle
+    void set_idle_after (uint32_t a_idle_after)
+    {
+        idle_after = a_idle_after;
+    }
+
+    /// Return how long the sorter must be quiet before it goes idle
+    uint32_t get_idle_after (void) const
+    {
+        return idle_after;
+    }
+
+    /// Return the present power state
+    State get_state (void) const
+    {
+        return state;
+    }
+
+    /// Return the number of times the sorter has woken from idle
+    uint16_t get_num_wakes (void) const
+    {
+        return num_wakes;
+    }
+};
+
+#endif // _IDLEMANAGER_H_
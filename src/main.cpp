@@ -16,6 +16,38 @@
  * @date   2020-Nov-27 Tried fixing solenoid task
  * @date   2020-Nov-28 Finally fixed solenoid task
  * @date   2020-Nov-29 Added Color Sensor task
+ * @date   2026-Oct-19 Added task stack and CPU usage monitor
+ * @date   2026-Oct-19 Averaged color readings over ripple windows
+ * @date   2026-Oct-19 Added automatic gain and integration time control
+ * @date   2026-Oct-19 Added dark and white calibration of the color sensor
+ * @date   2026-Oct-19 Added chromaticity classifier for choosing bins
+ * @date   2026-Oct-19 Classifier's centroids trained from the console and
+ *                     loaded from emulated EEPROM
+ * @date   2026-Oct-19 Classify balls from as few short readings as possible
+ * @date   2026-Oct-19 Moved color sensor I2C transfers into a bus task
+ * @date   2026-Oct-19 Read the color sensor through a shared bus scheduler
+ * @date   2026-Oct-19 Added low power idle when no balls arrive
+ * @date   2026-Oct-19 Periodic tasks measure their own timing; no delays in them
+ * @date   2026-Oct-19 Rate monotonic priorities and response time analysis
+ * @date   2026-Oct-19 Sorting sequence written as a coroutine which waits on
+ *                     the sensor, turntable and solenoids in turn
+ * @date   2026-Oct-19 Balls in every slot of the table are sorted at once
+ * @date   2026-Oct-19 Feeder is stopped when balls back up; late balls rejected
+ * @date   2026-Oct-19 Ejectors fire as balls arrive, from the table's position
+ *                     and speed, rather than after the table settles
+ * @date   2026-Oct-19 Second color sensor checks each ball's bin on the way
+ *                     to its ejector and counts mis-sorts
+ * @date   2026-Oct-19 Tunable settings loaded from emulated EEPROM at startup
+ *                     rather than compiled in
+ * @date   2026-Oct-19 Added a serial command console
+ * @date   2026-Oct-19 Devices started side by side at boot, without fixed
+ *                     delays, and the time each took is reported
+ * @date   2026-Oct-19 Color sensors which stop answering are restarted, and
+ *                     the sorter is parked until the first one is back
+ * @date   2026-Oct-19 Stalls of the table are found from an index sensor or
+ *                     the color sensor, and the sorter is stopped
+ * @date   2026-Oct-19 Table homed from its index at startup and after stalls,
+ *                     and small slips made up on the fly each turn
  */
 //
 #include <Arduino.h>
@@ -26,15 +58,150 @@
 #include <Stepper.h>
 #include "Adafruit_TCS34725.h"
 #include "taskshare.h"
+#include "taskmonitor.h"
+#include "colorfilter.h"
+#include "autoexposure.h"
+#include "colorcal.h"
+#include "colorclassifier.h"
+#include "seqclassifier.h"
+#include "i2ctransport.h"
+#include "i2cscheduler.h"
+#include "idlemanager.h"
+#include "periodictask.h"
+#include "taskset.h"
+#include "coscheduler.h"
+#include "sortdevices.h"
+#include "slotmap.h"
+#include "ejection.h"
+#include "verifier.h"
+#include "config.h"
+#include "console.h"
+#include "bootseq.h"
+#include "stalldetect.h"
+#include "homing.h"
 //#include "taskqueue.h"
 
-// share for communicating between solenoid/stepper tasks
-Share<bool> turn_complete ("Indicator that stepper motor turn is complete");
 //Queue<uint8_t> Color (10, "Color queue");
 
+// Step rate, load time, solenoid timing and other tunable settings, loaded
+// from emulated EEPROM in setup() and changed while the program runs
+SorterConfig sorter_config ("Config");
+
+// Asks the color sensor task to take a calibration frame (a CalibrationRequest)
+Share<uint8_t> calibration_request ("Calibration request");
+
+// Asks the stepper motor task to home the table again
+Share<bool> home_request ("Home request");
+
+// True while the sorter is idle; the stepper task runs less often
+Share<bool> sorter_idle ("Sorter idle");
+
+// True while the color sensor task prints each color and bin it finds
+Share<bool> trace_on ("Trace");
+
+// Brings up the devices at startup and keeps the time each one took
+BootSequence boot_sequence ("Boot");
+
+// Keeps track of stack and CPU use of the tasks created in setup()
+TaskMonitor task_monitor ("Task monitor");
+
+// Run the periodic tasks and measure their execution time, jitter and overruns
+PeriodicTask<> stepper_timing ("Stepper", 1);
+PeriodicTask<> monitor_timing ("Monitor", 5000);
+PeriodicTask<> console_timing ("Console", 20);
+
+// Measure the execution time of the tasks which are woken by events
+ExecutionTimer<> sorter_timing ("Sort sequence");
+ExecutionTimer<> sensor_timing ("Color sensor");
+
+// Periods, WCETs and deadlines of the tasks, from which their priorities are
+// worked out and their worst case response times found
+TaskSet task_set ("Task set");
+int8_t sorter_index;
+int8_t stepper_index;
+int8_t sensor_index;
+int8_t monitor_index;
+int8_t console_index;
+
+// Runs the coroutine which sorts each ball, inside the sort sequence task
+CoScheduler co_scheduler;
+
+// Hands each ball the color sensor task classifies to the sorting coroutine.
+// It never blocks the color sensor task; when balls back up it stops the
+// feeder, and it rejects balls which have waited too long
+BallSensor ball_sensor ("Ball sensor", co_scheduler);
+
+// Tells the feeder whether to feed balls onto the table; the feeder reads it
+Share<bool> feeder_open ("Feeder open");
+
+// Motor steps in one turn of the table, and sections (bins) around it. A turn
+// is 350 steps, so moves between sections alternate between 88 and 87 steps
+const uint16_t TABLE_STEPS_PER_REV = 350;
+const uint8_t TABLE_SECTIONS = 4;
+
+// Passes the sorting coroutine's moves to the stepper motor task
+Turntable turntable (co_scheduler, TABLE_STEPS_PER_REV, TABLE_SECTIONS);
+
+// Checks that the table is where the motor put it, from an index sensor
+// which pulls PA1 low once a turn, if the configuration says one is fitted,
+// and from the color sensor's view of the empty slot
+StallDetector stall_detector ("Stall", TABLE_STEPS_PER_REV);
+const uint8_t INDEX_PIN = PA1;
+
+// Finds the index and brings the table back into line, at startup and after
+// a stall. It's run by the stepper motor task
+TableHoming homing ("Homing", TABLE_STEPS_PER_REV);
+
+// Which ball is in each slot of the table, so that a ball can be loaded at
+// the sensor while others are on their way to their ejectors
+SlotMap slot_map ("Slot map", TABLE_SECTIONS);
+
+// Fires the solenoids as the balls on the moving table reach them. It's
+// serviced by the stepper motor task, once a millisecond. Its lead time and
+// pulse length are set from the configuration before each turn
+EjectionScheduler ejector ("Ejector", sorter_config.get (CFG_LEAD_US),
+                           sorter_config.get (CFG_PULSE_US), 1000);
+extern SolenoidBank solenoids;
+
+// I2C transfers for the color sensor are done by a low priority bus task,
+// so the color sensor task sleeps rather than spins while the bus is busy
+AsyncI2CTransport sensor_bus (&Wire);
+
 // Create an object for the color sensor class
 Adafruit_TCS34725 my_ColorSensor;
 
+// Reads each color sensor when its integration is done. More sensors, on a
+// second bus or behind a TCA9548A mux, can be added to it in setup(). A sensor
+// which stops answering is taken out of service and restarted
+I2CBusScheduler sensor_scheduler ("Sensors");
+int8_t sensor_lane = -1;
+int8_t check_lane = -1;
+
+// A second color sensor, at a checkpoint halfway from the load station to the
+// first ejector, reads each ball again as the table carries it past. It has
+// the same address as the first, so it's on a bus of its own, I2C3 on PC1
+// (SDA) and PC0 (SCL)
+TwoWire check_wire (PC1, PC0);
+AsyncI2CTransport check_bus (&check_wire);
+Adafruit_TCS34725 check_sensor;
+
+// Compares the checkpoint's reading of each ball with the bin it was loaded
+// for, and counts the results in a confusion matrix
+SortVerifier verifier ("Verifier", 3);
+
+// The color sensor's open drain interrupt output wakes the sorter from idle
+const uint8_t SENSOR_INT_PIN = PA0;
+
+// Set by the interrupt, so the color sensor task can tell its wake up call
+// from notifications sent by the I2C bus task
+volatile bool sensor_interrupted = false;
+volatile uint32_t sensor_interrupt_time = 0;
+TaskHandle_t color_sensor_task = NULL;
+
+// RTOS ticks (ms) between looks at the console's requests while idle, in case
+// the console's notification came before the color sensor task was waiting
+const TickType_t IDLE_POLL_TIME = 100;
+
 
 
     /* Ain pins are:
@@ -59,8 +226,9 @@ Adafruit_TCS34725 my_ColorSensor;
 
 /** @brief   Function used to control the stepper motor
  *  @details The input for the stepper motor will come from the color sensor. Depending 
- *           on which color is registered the stepper motor will turn until it has 
- *           reached the correct spot and stop
+ *           on which color is registered the sorting sequence asks for a move,
+ *           and the stepper motor will turn until it has reached the correct
+ *           spot and stop
  *           
  *          
  *  @param   PWMA the input pin to the H-bridge chip for pulse modulation for the A side 
@@ -83,49 +251,136 @@ void steppermotor (void* p_params)
 
     // setting up the input pins for the motor driver
     Stepper myStepper(STEPS_PER_TURN,Ain2,Ain1,Bin1,Bin2);
-    //  set PWMA and PWMB to VCC 
-    digitalWrite(PWMA,HIGH);
-    digitalWrite(PWMB,HIGH);
-    myStepper.setSpeed(60);
-    const TickType_t stepper_period = 10;         // RTOS ticks (ms) between runs
-
-    // Initialise the xLastWakeTime variable with the current time.
-    // It will be used to run the task at precise intervals
-    TickType_t xLastWakeTime = xTaskGetTickCount();
-
-    // init variable to pull from share and init share as off
-    bool sol_on_1;
-    turn_complete.put(false);
-    // make turns alternate (steps required is a non-integer)
-    bool turn = false;
-
-    for(;;)
-    {
-      // check solenoid share
-      turn_complete.get(sol_on_1);
-      // if share is off, drive stepper motor by designated number of steps and set share to on.
-      if (sol_on_1== false)
+    // PWMA and PWMB were set to VCC at startup
+    const TickType_t stepper_period = 1;          // RTOS ticks (ms) per run
+
+    // step() spins until the Stepper's step delay has passed since the last
+    // step. The task times the steps itself, so the delay is set to half a
+    // run of the task, shorter than the fastest step the settings allow,
+    // and step() never waits
+    const uint32_t step_delay_us = 500;
+    static_assert(stepper_period <= CFG_MIN_STEP_MS
+                  && step_delay_us < CFG_MIN_STEP_MS * 1000,
+                  "Stepper would spin between steps of the stepper task");
+    myStepper.setSpeed(60000000UL / STEPS_PER_TURN / step_delay_us);
+    const TickType_t stepper_idle_period = 100;   // RTOS ticks between idle runs
+
+    bool idle;
+    uint16_t steps_left = 0;
+    uint32_t ticks = 0;
+    uint32_t step_ms = 0;
+    uint32_t position = 0;
+    bool rehome = false;
+    uint8_t on;
+    uint8_t off;
+
+    stepper_timing.run([&]()
+    {
+      sorter_idle.get(idle);
+
+      // the console can ask for the table to be homed again
+      home_request.get(rehome);
+      if (rehome)
+      {
+        home_request.put(false);
+        homing.reset();
+        stall_detector.need_homing();
+      }
+      bool stalled = stall_detector.is_stalled();
+
+      // start the next move the sorting sequence has asked for, at the step
+      // rate configured now. No new turns are started while the sorter is idle
+      // or the table has stalled
+      if (steps_left == 0 && idle == false && !stalled
+          && turntable.get_move(steps_left))
+      {
+        step_ms = sorter_config.get(CFG_STEP_MS);
+        ticks = step_ms;
+        if (steps_left == 0)
+        {
+          turntable.move_done();
+        }
+      }
+
+      // make one step every step_ms runs, telling the ejector where the
+      // table is and how fast it's going, and checking the index. When the
+      // index showed the table slipped a little, make up the steps on the
+      // way, an uncounted step for each it's behind or a counted step not
+      // made for each it's ahead. Once the move is done, let the sorting
+      // sequence know the table is there
+      if (steps_left > 0 && !stalled && ++ticks >= step_ms)
       {
-        if (turn == false)
+        ticks = 0;
+        int8_t resync = stall_detector.resync_step();
+        if (resync > 0)
         {
-        myStepper.step(STEPS_PER_TURN);
-        delay(1000);
-        turn_complete.put(true);
+          myStepper.step(1);
         }
-        if (turn == true)
+        else
         {
-        myStepper.step(87);
-        delay(1000);
-        turn_complete.put(true);
+          if (resync == 0)
+          {
+            myStepper.step(1);
+          }
+          position++;
+          steps_left--;
+          ejector.track(position, steps_left ? step_ms * 1000UL : 0,
+                        micros());
+        }
+        stall_detector.step(position, digitalRead(INDEX_PIN) == LOW);
+        if (resync <= 0 && steps_left == 0)
+        {
+          turntable.move_done();
         }
       }
-      else
+
+      // while the table is out of line or hasn't been homed, find the index
+      // and bring the table to where the sorter thinks it is, without
+      // counting the steps. Without an index, or if homing failed, the
+      // sorter waits for the console's rehome command
+      if (stalled && stall_detector.has_index() && !homing.has_failed()
+          && ++ticks >= homing.get_step_ms())
       {
+        ticks = 0;
+        uint16_t edge = TABLE_STEPS_PER_REV
+                        - sorter_config.get(CFG_HOME_STEPS);
+        if (!homing.is_busy())
+        {
+          ejector.track(position, 0, micros());
+          homing.set_speeds(sorter_config.get(CFG_HOME_FAST_MS),
+                            sorter_config.get(CFG_HOME_SLOW_MS));
+          homing.start(position % TABLE_STEPS_PER_REV, edge);
+        }
+        bool index = (digitalRead(INDEX_PIN) == LOW);
+        int8_t direction = homing.next_step(index);
+        if (direction != 0)
+        {
+          myStepper.step(direction);
+        }
+        else if (homing.is_done())
+        {
+          stall_detector.homed(edge, index);
+        }
+        else
+        {
+          Serial << "Index not found; type rehome to try again" << endl;
+        }
       }
-      
-        // Delay task by 10 ms since task began
-        vTaskDelayUntil (&xLastWakeTime, stepper_period);
-    }
+
+      // fire the ejectors whose balls are about to line up, and end pulses
+      if (ejector.service(micros(), on, off))
+      {
+        solenoids.set(on, true);
+        solenoids.set(off, false);
+      }
+
+      // Run every millisecond, or less often while idle and at rest so that
+      // the RTOS can stop its tick
+      bool at_rest = idle && steps_left == 0 && !homing.is_busy()
+                     && !ejector.is_busy();
+      stepper_timing.set_period(at_rest ? stepper_idle_period
+                                        : stepper_period);
+    });
 }
 
 
@@ -144,61 +399,307 @@ void steppermotor (void* p_params)
     const int8_t PWMA_sol = PA6;
     const int8_t PWMB_sol = PB5;
 
-/** @brief   This code controls the solenoids to open and close
- *  @details The signal to open comes depending on what color the color sensor has 
- *           registered. The solenoid will wait until the stepper motor has turned 
- *           to the correct location before opening up. (*NOTE: do not keep solenoid 
- *           on for prolonged peroids of time this will burn it out)
- *          
- *  @param   PWMA the input pin to the H-bridge chip for pulse modulation for the A side 
- *  @param   PWMB the input pin to the H-bridge chip for pulse modulation for the A side 
- * 
- *           Because the we are using not using a DC motor we have no use for this, but 
- *           the according to the datasheet they must be set to high.
- *  @param   Ain2 controls the 1st solenoid 
- *  @param   Ain1 controls the 2nd solenoid
- *  @param   Bin1 controls the 3rd solenoid
- *  @param   Bin2 controls the 4th solenoid
- * 
+// The TB6612FNG's Ain2, Ain1, Bin1 and Bin2 pins control the 1st, 2nd, 3rd
+// and 4th solenoids. The 1st is one section on from the color sensor and
+// pushes balls into bin 0, the 2nd two sections on for bin 1, and so on
+const uint8_t solenoid_pins[] = {Ain2_sol, Ain1_sol, Bin1_sol, Bin2_sol};
+SolenoidBank solenoids (solenoid_pins, 4);
+
+// RTOS ticks (ms) between checks that the ejectors have finished
+const TickType_t EJECT_POLL_TIME = 10;
+
+
+/** @brief   Coroutine which sorts the balls as a pipeline
+ *  @details The ball under the color sensor is loaded into the slot map, then
+ *           the table turns one section. The ejection scheduler fires the
+ *           solenoids for the balls which that turn brings to their bins as
+ *           they arrive, while the table is still moving, so there's no wait
+ *           for the table to settle. The table stays long enough for the next
+ *           ball to be loaded and the solenoids to finish. It keeps turning
+ *           while there are balls on it, taking a new ball at the sensor on
+ *           each turn, and waits for a ball only when it's empty. Each step
+ *           waits without blocking a task, so the steps are written in the
+ *           order they happen rather than spread across tasks and shares.
+ *           (*NOTE: do not keep solenoid on for prolonged peroids of time
+ *           this will burn it out)
+ */
+static CoTask sort_sequence (void)
+{
+  uint8_t bin;
+
+  for (;;)
+  {
+    // load the ball at the sensor, waiting for one only if the table is empty.
+    // A ball whose bin has no ejector isn't loaded; the table still turns, so
+    // it rides round unsorted and is classified again when it comes back
+    bool have_ball;
+    if (slot_map.get_num_balls() == 0)
+    {
+      bin = co_await ball_sensor.sample();
+      have_ball = true;
+    }
+    else
+    {
+      have_ball = slot_map.can_load() && ball_sensor.take(bin);
+    }
+    if (have_ball && !slot_map.load(bin, co_scheduler.get_now()))
+    {
+      Serial << "No ejector for bin " << bin << "; ball not loaded" << endl;
+    }
+
+    // the ball at the sensor passes the checkpoint during the turn, and is
+    // checked there unless the checkpoint sensor is out of service
+    SlotBall passing;
+    if (slot_map.get_ball(0, passing) && sensor_scheduler.is_up(check_lane))
+    {
+      verifier.expect(passing.bin);
+    }
+
+    // before turning, have the ejectors fire for the balls which the turn
+    // brings to them; the ejector at station k is solenoid k - 1
+    ejector.set_timing(sorter_config.get(CFG_LEAD_US),
+                       sorter_config.get(CFG_PULSE_US));
+    uint8_t section = (slot_map.get_rotation() + 1) % TABLE_SECTIONS;
+    uint32_t target = turntable.get_odometer() + turntable.steps_to(section);
+    slot_map.advance();
+    uint8_t stations = slot_map.get_ejections();
+    ejector.schedule(stations >> 1, target);
+
+    // carry every ball one section on, then give the next ball time to load
+    // and the solenoids time to finish
+    co_await turntable.move_to(section);
+    verifier.finish();
+    co_await co_scheduler.sleep(sorter_config.get(CFG_LOAD_MS));
+    while (ejector.is_busy())
+    {
+      co_await co_scheduler.sleep(EJECT_POLL_TIME);
+    }
+    for (uint8_t station = 1; station < TABLE_SECTIONS; station++)
+    {
+      if (stations & (1 << station))
+      {
+        slot_map.eject(station, co_scheduler.get_now());
+      }
+    }
+  }
+}
+
+
+// Whether the ball sensor wants the feeder open. It's only opened while the
+// color sensor is in service and the table hasn't stalled as well
+static bool feeder_wanted = true;
+
+
+/** @brief   Opens the feeder if the ball sensor wants it open and the sorter
+ *           can sort, else shuts it
+ */
+static void update_feeder (void)
+{
+  feeder_open.put(feeder_wanted && sensor_scheduler.is_up(sensor_lane)
+                  && !stall_detector.is_stalled());
+}
+
+
+/** @brief   Opens or shuts the feeder gate as balls back up or drain
+ *
+ *  @param   open true to let the feeder feed balls, false to stop it
+ *  @param   p_context Not used
+ */
+static void feeder_gate (bool open, void* p_context)
+{
+  (void)p_context;            // Does nothing but shut up a compiler warning
+
+  feeder_wanted = open;
+  update_feeder();
+}
+
+
+/** @brief   Parks the sorter while the color sensor is out of service
+ *  @details The feeder is shut so no balls come which can't be classified,
+ *           and opened again, if the ball sensor wants it open, at the
+ *           sensor's first good reading. While the checkpoint sensor is out
+ *           of service, balls are sorted without being checked.
+ *
+ *  @param   lane the sensor's lane in the bus scheduler
+ *  @param   up true when the sensor is back, false when it's lost
+ *  @param   p_context Not used
+ */
+static void sensor_fault (uint8_t lane, bool up, void* p_context)
+{
+  (void)p_context;            // Does nothing but shut up a compiler warning
+
+  bool is_color = (lane == sensor_lane);
+  update_feeder();
+  Serial << (is_color ? "Color sensor " : "Checkpoint sensor ");
+  if (up)
+  {
+    Serial << "back after " << sensor_scheduler.get_last_recovery_us(lane)
+           << " us" << endl;
+  }
+  else
+  {
+    Serial << (is_color ? "lost; sorter parked" : "lost; bins not checked")
+           << endl;
+  }
+}
+
+
+/** @brief   Stops the sorter while the table is out of line
+ *  @details Called from the stepper motor task when the index shows a stall,
+ *           from the color sensor task when the empty slot looks wrong, and
+ *           from whichever task clears the stall. The stepper motor task
+ *           starts no moves meanwhile.
+ *
+ *  @param   cause what showed the stall, or STALL_NONE once it's cleared
+ *  @param   error the steps by which the table was behind, if known
+ *  @param   p_context Not used
+ */
+static void table_stalled (StallCause cause, int16_t error, void* p_context)
+{
+  (void)p_context;            // Does nothing but shut up a compiler warning
+
+  update_feeder();
+  const char* p_then = stall_detector.has_index() ? "; homing"
+                       : "; type rehome once it's lined up";
+  switch (cause)
+  {
+    case STALL_NONE:
+      Serial << "Table back in line";
+      if (homing.is_done())
+      {
+        Serial << "; it was " << homing.get_last_offset() << " steps behind";
+      }
+      Serial << endl;
+      break;
+    case STALL_INDEX:
+      Serial << "Table " << error << " steps off at the index" << p_then
+             << endl;
+      break;
+    case STALL_NO_INDEX:
+      Serial << "Table jammed" << p_then << endl;
+      break;
+    case STALL_BACKGROUND:
+      Serial << "Table out of line" << p_then << endl;
+      break;
+    case STALL_NOT_HOMED:
+      Serial << "Homing the table" << endl;
+      break;
+  }
+}
+
+
+/** @brief   Wakes the sort sequence task when a coroutine is made ready
+ *
+ *  @param   p_context the handle of the sort sequence task
+ */
+static void sorter_wake (void* p_context)
+{
+  xTaskNotifyGive((TaskHandle_t)p_context);
+}
+
+
+/** @brief   Task which runs the sorting sequence coroutine
+ *  @details The task resumes the coroutine whenever the sensor, turntable or
+ *           solenoids have finished what it waited for, and otherwise sleeps
+ *           until it's woken or the coroutine's next sleep is over.
+ *           
+ *           The TB6612FNG's PWMA and PWMB pins aren't used with solenoids,
+ *           but according to the datasheet they must be set high; that's
+ *           done in setup().
+ *
+ *  @param   p_params Not used
  */
-void solenoid (void* p_params)
- {
-   (void)p_params;            // Does nothing but shut up a compiler warning
-  
-     const TickType_t solenoid_period = 50;         // RTOS ticks (ms) between runs  
-     // Initialise the xLastWakeTime variable with the current time.
-     // It will be used to run the task at precise intervals
-     TickType_t xLastWakeTime = xTaskGetTickCount();
-    digitalWrite(PWMA_sol,HIGH);
-    digitalWrite(PWMB_sol,HIGH);
-     // init variable to pull from share
-     bool sol_on;
-     for(;;)
-     {
-         // check solenoid share
-         turn_complete.get(sol_on);
-         
-         // if share is on, turn on solenoid, leave on for 1 sec, then turn off
-         if (sol_on == 1)
-         {
-           digitalWrite(Ain1_sol, HIGH);
-           delay(1000);
-           turn_complete.put(false);
-         }
-         // if share is off, turn off solenoid
-         else
-         {
-           digitalWrite(Ain1_sol, LOW);
-         }
-             // Delay task by 50 ms since task began
-         vTaskDelayUntil (&xLastWakeTime, solenoid_period);
-    }
- }
+void sorter (void* p_params)
+{
+  (void)p_params;            // Does nothing but shut up a compiler warning
+
+  co_scheduler.set_waker(sorter_wake, xTaskGetCurrentTaskHandle());
+  if (!co_scheduler.spawn(sort_sequence()))
+  {
+    Serial << "Sort sequence couldn't be started" << endl;
+  }
+
+  for (;;)
+  {
+    sorter_timing.begin();
+    co_scheduler.run(xTaskGetTickCount());
+    sorter_timing.end();
+
+    uint32_t wait;
+    if (!co_scheduler.time_to_next(xTaskGetTickCount(), wait))
+    {
+      wait = portMAX_DELAY;
+    }
+    ulTaskNotifyTake(pdTRUE, wait);
+  }
+}
+
+/** @brief   Interrupt service routine for the color sensor's interrupt pin
+ *  @details The sensor pulls its interrupt pin low when the clear channel
+ *           leaves the limits set by sensor_sleep(). This wakes the color
+ *           sensor task.
+ */
+static void sensor_interrupt (void)
+{
+  BaseType_t woken = pdFALSE;
+
+  sensor_interrupt_time = micros();
+  sensor_interrupted = true;
+  if (color_sensor_task != NULL)
+  {
+    vTaskNotifyGiveFromISR(color_sensor_task, &woken);
+  }
+  portYIELD_FROM_ISR(woken);
+}
+
+
+/** @brief   Puts the color sensor into its low power wait state sampling
+ *  @details The sensor converts once every 200 ms or so and interrupts when 
+ *           the clear channel moves a quarter away from its level with no 
+ *           ball present, two readings in a row.
+ *
+ *  @param   clear the raw clear count with no ball in front of the sensor
+ */
+static void sensor_sleep (uint16_t clear)
+{
+  uint16_t band = clear / 4 + 16;
+  uint16_t low = (clear > band) ? clear - band : 0;
+  uint16_t high = (clear < 0xFFFF - band) ? clear + band : 0xFFFF;
+
+  my_ColorSensor.setIntLimits(low, high);
+  my_ColorSensor.setPersistence(TCS34725_PERS_2_CYCLE);
+  my_ColorSensor.setWaitTime(TCS34725_WTIME_204MS, false);
+  my_ColorSensor.setWait(true);
+  my_ColorSensor.clearInterrupt();
+  sensor_interrupted = false;
+  my_ColorSensor.setInterrupt(true);
+}
+
+
+/** @brief   Takes the color sensor out of its wait state sampling
+ */
+static void sensor_wake (void)
+{
+  my_ColorSensor.setInterrupt(false);
+  my_ColorSensor.setWait(false);
+  my_ColorSensor.clearInterrupt();
+}
+
 
 /** @brief   This function reads the color sensor 
  *  @details This function reads the color sensor and send a signal 
  *           to the stepper motor to turn until it has reached the 
- *           correct location.            
+ *           correct location. The sensor is normally read at its shortest 
+ *           integration time of 2.4 ms. Gain, and in dim light the 
+ *           integration time, are raised automatically when the readings 
+ *           are too small and lowered when they saturate. Each ball is 
+ *           classified from as few short readings as give a confident 
+ *           answer, with one long reading only for balls whose color is 
+ *           ambiguous. The readings taken during each 50 ms window are also
+ *           averaged, which rejects ripple from mains powered lights, for
+ *           the trace and for checking the empty slot's brightness. When no ball has been seen for a while the
+ *           sensor samples slowly and the task sleeps until the sensor's
+ *           interrupt says something has arrived.
  *          
  *  @param   r used to store a value of the red detected 
  *  @param   g used to store a value of the green detected 
@@ -213,47 +714,906 @@ void ColorSensor (void* p_params)
   float g;
   float b;
 
+  // raw readings and the filter which averages them over ripple windows for
+  // the trace and the stall detector's view of the empty slot
+  RGBCSample raw;
+  RGBCSample filtered;
+  RippleFilter ripple_filter (RippleFilter::BOXCAR,
+                              sorter_config.get(CFG_WINDOW_US));
+
+  // chooses gain and integration time to keep the clear channel in range
+  AutoExposure auto_exposure;
+  bool settings_changed = false;
+
+  // offsets and gains which correct the raw readings, loaded from emulated
+  // EEPROM if a calibration has been saved
+  ColorCalibration calibration;
+  FrameAverager cal_frames;
+  uint8_t cal_step = CAL_NONE;
+  calibration_request.put(CAL_NONE);
+  calibration.load();
+  calibration.set_exposure(auto_exposure.get_sensitivity());
+
+  // assigns each reading to a bin. These starting centroids for red,
+  // green and blue balls are rough; centroids trained from readings of the
+  // actual balls replace them once they've been saved to emulated EEPROM
+  ColorClassifier classifier;
+  const Centroid default_centroids[] = {{{2458, 1024}, 0},   // red
+                                        {{1229, 2048}, 1},   // green
+                                        {{ 819, 1229}, 2}};  // blue
+  for (const Centroid& centroid : default_centroids)
+  {
+    classifier.add_centroid(centroid);
+  }
+  classifier.load();
+  CentroidTrainer trainer;
+  Classification color;
+
+  // classifies each ball from its short readings as soon as they're
+  // convincing, without waiting for a ripple window to fill. The lights'
+  // ripple changes how bright a reading is far more than its chromaticity,
+  // on which the classifier works, and the evidence is summed over the
+  // readings. A ball gets two windows' worth of readings before a long
+  // reading is taken
+  const uint32_t early_exit_threshold = sorter_config.get(CFG_EARLY_EXIT);
+  uint32_t window_readings = sorter_config.get(CFG_WINDOW_US) / 2400 + 1;
+  SequentialClassifier sequential (classifier, early_exit_threshold, 2,
+                                   (window_readings < 127)
+                                   ? 2 * window_readings : 255);
+  SequentialClassifier::Decision decision;
+  tcs34725IntegrationTime_t long_atime = TCS34725_INTEGRATIONTIME_50MS;
+  uint32_t ball_start = micros();
+
+  // whether colors and bins are printed, as set from the console
+  bool tracing;
+
+  // a ball is handed to the sorting sequence when it arrives, and not again
+  // until something which isn't a ball has been seen
+  bool ball_present = false;
+
+  // true once the readings have shown the slot under the sensor is empty,
+  // until the next ball; its ripple windows then show if the table's in line
+  bool slot_empty = false;
+
+  // the scheduler's lane which was read, that of the color sensor or of the
+  // checkpoint sensor
+  uint8_t lane;
+
+  // classifies readings from the checkpoint sensor. They aren't calibrated,
+  // which matters little as the classifier works on chromaticity
+  SequentialClassifier check_sequential (classifier, early_exit_threshold);
+  SequentialClassifier::Decision check_decision;
+
+  // decides when to go idle because no balls are arriving
+  IdleManager idle_manager (sorter_config.get(CFG_IDLE_MS), millis());
+  sorter_idle.put(false);
+  color_sensor_task = xTaskGetCurrentTaskHandle();
+
+  // prints the bin chosen for a ball if tracing is on, hands the ball to the
+  // sorting sequence, and gets ready for the next ball
+  auto finish_ball = [&] ()
+  {
+    if (tracing)
+    {
+      Serial << "Bin: " << color.bin << " after " << (micros() - ball_start) << " us" << endl;
+    }
+    if (color.bin != BIN_REJECT)
+    {
+      idle_manager.activity(millis());
+      slot_empty = false;
+      if (!ball_present)
+      {
+        ball_present = true;
+        ball_sensor.deliver(color.bin, xTaskGetTickCount());
+      }
+    }
+    else
+    {
+      ball_present = false;
+    }
+    sequential.start();
+    ball_start = micros();
+  };
+
   for(;;)
   {
-    // get color and print individual RGB values
-    my_ColorSensor.getRGB(&r, &g, &b);
-    Serial << "R: " << r << endl << "G: " << g << endl << "B: " << b << "\r" << endl;
-    delay(500);
+    // sleep until the sensor's integration is done, then get raw counts. A
+    // run of the task is timed from then until it sleeps again
+    sensor_timing.end();
+    while (!sensor_scheduler.read_next(micros(), lane, raw))
+    {
+      delay((sensor_scheduler.time_to_next(micros()) + 999) / 1000);
+    }
+    sensor_timing.begin();
+
+    // the checkpoint sensor's readings are only used to check the bin of
+    // each ball passing it; readings which can't be classified, as when
+    // there's no ball there, aren't counted
+    if (lane == check_lane)
+    {
+      check_decision = check_sequential.add(raw);
+      if (check_decision != SequentialClassifier::PENDING)
+      {
+        verifier.observe(check_decision == SequentialClassifier::AMBIGUOUS
+                         ? BIN_REJECT : check_sequential.get_result().bin);
+        check_sequential.start();
+      }
+      continue;
+    }
+
+    // a long reading asked for because a ball's windows were ambiguous
+    // decides its bin. It's corrected for its own integration time; the
+    // sensor has already gone back to its usual time
+    trace_on.get(tracing);
+    if (sensor_scheduler.is_long_reading())
+    {
+      calibration.set_exposure(AutoExposure::sensitivity(long_atime, auto_exposure.get_gain()));
+      calibration.correct(raw);
+      calibration.set_exposure(auto_exposure.get_sensitivity());
+      color = classifier.classify(raw);
+      ripple_filter.reset();
+      finish_ball();
+      continue;
+    }
+
+    // the first reading after a change was integrated partly with the old
+    // settings, so throw it away
+    if (settings_changed)
+    {
+      settings_changed = false;
+      continue;
+    }
+
+    // a requested calibration step averages raw readings while the exposure
+    // is held fixed, then sets the offsets or gains; the calibration is saved
+    // once the white reference has been taken. Training a bin gives the
+    // trainer as many corrected readings of a ball of that bin; the centroids
+    // made from them replace the classifier's when they're saved
+    if (cal_step == CAL_NONE)
+    {
+      calibration_request.get(cal_step);
+      if (cal_step != CAL_NONE)
+      {
+        cal_frames.start();
+      }
+    }
+    if (cal_step == CAL_TRAIN_CLEAR || cal_step == CAL_TRAIN_SAVE)
+    {
+      ColorClassifier trained (classifier);
+      if (cal_step == CAL_TRAIN_CLEAR)
+      {
+        trainer.clear();
+        Serial << "Training readings forgotten" << endl;
+      }
+      else if (trainer.train(trained, classifier.get_min_margin(), classifier.get_min_sum()) != 0)
+      {
+        classifier = trained;
+        classifier.save();
+        Serial << classifier.get_num_centroids() << " centroids trained and saved" << endl;
+      }
+      else
+      {
+        Serial << "No bins trained, centroids not changed" << endl;
+      }
+      cal_step = CAL_NONE;
+      calibration_request.put(CAL_NONE);
+    }
+    if (cal_step != CAL_NONE)
+    {
+      if (cal_step >= CAL_TRAIN)
+      {
+        RGBCSample corrected = raw;
+        calibration.correct(corrected);
+        trainer.add(corrected, cal_step - CAL_TRAIN);
+      }
+      if (cal_frames.add(raw))
+      {
+        RGBCSample mean;
+        cal_frames.get_mean(mean);
+        if (cal_step >= CAL_TRAIN)
+        {
+          Serial << "Readings of bin " << (cal_step - CAL_TRAIN) << " taken" << endl;
+        }
+        else if (cal_step == CAL_DARK)
+        {
+          calibration.set_dark(mean, auto_exposure.get_sensitivity());
+          Serial << "Dark frame taken" << endl;
+        }
+        else if (calibration.set_white(mean, auto_exposure.get_sensitivity()))
+        {
+          calibration.save();
+          Serial << "White reference taken, calibration saved" << endl;
+        }
+        else
+        {
+          Serial << "White reference too dim, calibration not changed" << endl;
+        }
+        cal_step = CAL_NONE;
+        calibration_request.put(CAL_NONE);
+        ripple_filter.reset();
+      }
+      continue;
+    }
+
+    // if the reading is saturated or too dim, change the sensor's settings
+    // and start a new window so that readings of different scales aren't
+    // averaged together
+    if (auto_exposure.update(raw.c))
+    {
+      my_ColorSensor.setIntegrationTime(auto_exposure.get_integration_time());
+      my_ColorSensor.setGain(auto_exposure.get_gain());
+      calibration.set_exposure(auto_exposure.get_sensitivity());
+      ripple_filter.reset();
+      sensor_scheduler.restart(lane, micros());
+      settings_changed = true;
+      continue;
+    }
+
+    // the table carries its balls on past the checkpoint sensor until it's
+    // empty, so the sorter doesn't go idle before then
+    if (slot_map.get_num_balls() != 0)
+    {
+      idle_manager.activity(millis());
+    }
+
+    // with no balls for a while, sleep until the sensor sees one arrive or
+    // the console asks for a calibration; this uses the raw clear count,
+    // which is what the sensor's limits compare to
+    if (idle_manager.update(millis()) == IdleManager::SLEEP)
+    {
+      Serial << "Idle" << endl;
+      sorter_idle.put(true);
+      sensor_sleep(raw.c);
+      uint8_t request = CAL_NONE;
+      sensor_timing.end();
+      while (!sensor_interrupted && request == CAL_NONE)
+      {
+        ulTaskNotifyTake(pdTRUE, IDLE_POLL_TIME);
+        calibration_request.get(request);
+      }
+      sensor_timing.begin();
+      sensor_wake();
+      idle_manager.activity(millis());
+      sorter_idle.put(false);
+      if (sensor_interrupted)
+      {
+        Serial << "Awake; resumed in " << (micros() - sensor_interrupt_time) << " us" << endl;
+      }
+      else
+      {
+        Serial << "Awake to calibrate" << endl;
+      }
+
+      // start afresh, as the readings before the sleep are stale
+      ripple_filter.reset();
+      sequential.start();
+      sensor_scheduler.restart(lane, micros());
+      settings_changed = true;
+      ball_start = micros();
+      continue;
+    }
+
+    // take away dark counts and balance the color channels
+    calibration.correct(raw);
+
+    // once per ripple window, normalize the filtered color to the clear
+    // channel and print individual RGB values if tracing is on. A window of
+    // the empty slot, while the table is at rest, shows whether the table is
+    // still in line; the window takes out the ripple in its brightness
+    if (ripple_filter.add(raw, micros(), filtered))
+    {
+      if (filtered.c != 0 && tracing)
+      {
+        r = (float)filtered.r / filtered.c * 255.0;
+        g = (float)filtered.g / filtered.c * 255.0;
+        b = (float)filtered.b / filtered.c * 255.0;
+        Serial << "R: " << r << endl << "G: " << g << endl << "B: " << b << "\r" << endl;
+      }
+      if (slot_empty && turntable.is_at_rest())
+      {
+        stall_detector.check_background(filtered.c, auto_exposure.get_sensitivity());
+      }
+    }
+
+    // choose a bin for the ball from as few readings as possible. When the
+    // readings can't decide, take one long reading of a ball instead, through
+    // the bus scheduler so the checkpoint sensor is still read meanwhile; its
+    // bin is decided when the reading comes. Readings which don't look like a
+    // ball at all are of the empty slot, so no long reading is taken.
+    // BIN_REJECT means it's still not clear which bin the ball belongs to
+    decision = sequential.add(raw);
+    if (decision == SequentialClassifier::PENDING)
+    {
+      continue;
+    }
+    color = sequential.get_result();
+    if (decision == SequentialClassifier::AMBIGUOUS)
+    {
+      if (!classifier.is_ball(color))
+      {
+        ball_present = false;
+        slot_empty = true;
+        sequential.start();
+        ball_start = micros();
+        continue;
+      }
+
+      // larger ATIME values mean shorter integration times
+      long_atime = auto_exposure.get_integration_time();
+      if (long_atime > TCS34725_INTEGRATIONTIME_50MS)
+      {
+        long_atime = TCS34725_INTEGRATIONTIME_50MS;
+      }
+      if (sensor_scheduler.start_long(lane, long_atime, micros()))
+      {
+        continue;
+      }
+    }
+    finish_ball();
+  }
+}
+
+
+/** @brief   Console command which prints the list of shares
+ *
+ *  @param   line the parser holding the command
+ *  @param   output where the answer is printed
+ *  @return  true unless words follow the command
+ */
+static bool command_shares (const LineParser& line, Print& output)
+{
+  if (line.get_num_words() != 1)
+  {
+    return false;
+  }
+  print_all_shares(output);
+  return true;
+}
+
+
+/** @brief   Console command which prints one setting, or all of them
+ *
+ *  @param   line the parser holding the command and perhaps a setting's name
+ *  @param   output where the answer is printed
+ *  @return  true unless the setting doesn't exist
+ */
+static bool command_get (const LineParser& line, Print& output)
+{
+  if (line.get_num_words() == 1)
+  {
+    for (uint8_t item = 0; item < CFG_NUM_ITEMS; item++)
+    {
+      output << SorterConfig::get_name(item) << ' '
+             << sorter_config.get((ConfigItem)item) << endl;
+    }
+    return true;
+  }
+  int8_t item = sorter_config.find(line.get_word(1));
+  if (line.get_num_words() != 2 || item < 0)
+  {
+    return false;
+  }
+  output << line.get_word(1) << ' ' << sorter_config.get((ConfigItem)item)
+         << endl;
+  return true;
+}
+
+
+/** @brief   Console command which changes a setting
+ *  @details The new value is used from the next time the setting is read;
+ *           settings read only when the tasks start need a reset as well.
+ *           The setting isn't saved until the save command is given.
+ *
+ *  @param   line the parser holding the command, a setting's name and value
+ *  @param   output where the answer is printed
+ *  @return  true unless the setting doesn't exist or the value isn't a number
+ */
+static bool command_set (const LineParser& line, Print& output)
+{
+  int8_t item = sorter_config.find(line.get_word(1));
+  uint32_t value;
+  if (line.get_num_words() != 3 || item < 0
+      || !LineParser::to_number(line.get_word(2), value))
+  {
+    return false;
+  }
+  if (!sorter_config.set(item, value))
+  {
+    output << value << " is out of range for " << line.get_word(1) << endl;
+  }
+  else if (SorterConfig::is_at_boot(item))
+  {
+    output << "Set; used after a reset" << endl;
+  }
+  else
+  {
+    output << "Set" << endl;
+  }
+  return true;
+}
+
+
+/** @brief   Console command which saves the settings to emulated EEPROM
+ *  @details Writing flash stalls the processor, which would upset the
+ *           stepper and ejector timing, so the settings are only saved
+ *           while no balls are on the table.
+ *
+ *  @param   line the parser holding the command
+ *  @param   output where the answer is printed
+ *  @return  true unless words follow the command
+ */
+static bool command_save (const LineParser& line, Print& output)
+{
+  if (line.get_num_words() != 1)
+  {
+    return false;
+  }
+  if (slot_map.get_num_balls() != 0 || ejector.is_busy())
+  {
+    output << "Not saved; wait until the table is empty" << endl;
+    return true;
+  }
+  sorter_config.save();
+  output << "Saved" << endl;
+  return true;
+}
+
+
+/** @brief   Console command which starts or stops tracing colors and bins
+ *
+ *  @param   line the parser holding the command and on or off
+ *  @param   output where the answer is printed
+ *  @return  true if the command was followed by on or off
+ */
+static bool command_trace (const LineParser& line, Print& output)
+{
+  (void)output;               // Does nothing but shut up a compiler warning
+
+  if (line.get_num_words() != 2)
+  {
+    return false;
+  }
+  if (strcmp(line.get_word(1), "on") == 0)
+  {
+    trace_on.put(true);
+  }
+  else if (strcmp(line.get_word(1), "off") == 0)
+  {
+    trace_on.put(false);
+  }
+  else
+  {
+    return false;
+  }
+  return true;
+}
+
+
+/** @brief   Console command which asks for a calibration frame
+ *  @details The color sensor task takes the dark frame or white reference
+ *           and prints when it's done.
+ *
+ *  @param   line the parser holding the command and dark or white
+ *  @param   output where the answer is printed
+ *  @return  true if the command was followed by dark or white
+ */
+static bool command_cal (const LineParser& line, Print& output)
+{
+  if (line.get_num_words() != 2)
+  {
+    return false;
+  }
+  if (strcmp(line.get_word(1), "dark") == 0)
+  {
+    calibration_request.put(CAL_DARK);
+  }
+  else if (strcmp(line.get_word(1), "white") == 0)
+  {
+    calibration_request.put(CAL_WHITE);
+  }
+  else
+  {
+    return false;
+  }
+
+  // wake the color sensor task in case it's idle
+  if (color_sensor_task != NULL)
+  {
+    xTaskNotifyGive(color_sensor_task);
+  }
+  output << "Calibrating" << endl;
+  return true;
+}
+
+
+/** @brief   Console command which trains the color classifier
+ *  @details With a bin number, the color sensor task takes readings of a ball
+ *           of that bin held under the sensor; this is repeated with the ball
+ *           turned, and for each bin. Then save makes centroids of the bins
+ *           trained, puts them in use and saves them, or clear forgets the
+ *           readings to start over.
+ *
+ *  @param   line the parser holding the command and a bin, save or clear
+ *  @param   output where the answer is printed
+ *  @return  true if the command was followed by a bin which can be trained,
+ *           save or clear
+ */
+static bool command_train (const LineParser& line, Print& output)
+{
+  uint32_t bin;
+  if (line.get_num_words() != 2)
+  {
+    return false;
+  }
+  if (strcmp(line.get_word(1), "save") == 0)
+  {
+    calibration_request.put(CAL_TRAIN_SAVE);
+  }
+  else if (strcmp(line.get_word(1), "clear") == 0)
+  {
+    calibration_request.put(CAL_TRAIN_CLEAR);
+  }
+  else if (LineParser::to_number(line.get_word(1), bin) && bin < MAX_TRAINED_BINS)
+  {
+    calibration_request.put(CAL_TRAIN + bin);
+  }
+  else
+  {
+    return false;
+  }
+
+  // wake the color sensor task in case it's idle
+  if (color_sensor_task != NULL)
+  {
+    xTaskNotifyGive(color_sensor_task);
+  }
+  output << "Training" << endl;
+  return true;
+}
+
+
+/** @brief   Console command which homes the table again
+ *  @details With an index, the stepper motor task homes the table, which
+ *           also tries again after homing failed. Without one, type it once
+ *           the table has been freed and turned by hand so that the load
+ *           station is at a section, and the sorter goes on.
+ *
+ *  @param   line the parser holding the command
+ *  @param   output where the answer is printed
+ *  @return  true if the command had no other words
+ */
+static bool command_rehome (const LineParser& line, Print& output)
+{
+  if (line.get_num_words() != 1)
+  {
+    return false;
+  }
+  if (stall_detector.has_index())
+  {
+    home_request.put(true);
+  }
+  else
+  {
+    if (!stall_detector.is_stalled())
+    {
+      output << "The table hasn't stalled" << endl;
+    }
+    stall_detector.clear();
+  }
+  return true;
+}
+
+
+// The commands the console understands, besides help
+const ConsoleCommand console_commands[] =
+{
+  {"shares", "", command_shares},
+  {"get", "[name]", command_get},
+  {"set", "<name> <value>", command_set},
+  {"save", "", command_save},
+  {"trace", "on|off", command_trace},
+  {"cal", "dark|white", command_cal},
+  {"train", "<bin>|save|clear", command_train},
+  {"rehome", "", command_rehome}
+};
+SerialConsole console ("Console", console_commands,
+                       sizeof (console_commands) / sizeof (ConsoleCommand));
+
+
+/** @brief   Task which runs commands typed on the serial port
+ *  @details Each run takes the characters which have arrived, without
+ *           waiting for more, and runs a command for each finished line.
+ *           The task has a lower priority than the sensor, stepper and sort
+ *           sequence tasks, so a command which prints a lot doesn't hold
+ *           them up. While the sorter is idle it runs less often so that the
+ *           RTOS can stop its tick.
+ *
+ *  @param   p_params Not used
+ */
+void console_task (void* p_params)
+{
+  (void)p_params;            // Does nothing but shut up a compiler warning
+  const TickType_t console_period = 20;        // RTOS ticks (ms) per run
+  const TickType_t console_idle_period = 100;  // RTOS ticks between idle runs
+
+  bool idle;
+
+  console_timing.run([&]()
+  {
+    console.poll(Serial, Serial);
+
+    sorter_idle.get(idle);
+    console_timing.set_period(idle ? console_idle_period : console_period);
+  });
+}
+
+
+/** @brief   Task which reports stack and CPU usage of the other tasks
+ *  @details Every few seconds this low priority task samples the stack high
+ *           water mark and run time of each task registered with the task 
+ *           monitor, then prints those figures along with the status of all
+ *           shares and queues. The figures are used to size task stacks and to
+ *           find tasks which starve others of processor time.
+ *
+ *  @param   p_params Not used
+ */
+void monitor (void* p_params)
+{
+    (void)p_params;            // Does nothing but shut up a compiler warning
+
+    // The period of 5000 RTOS ticks (ms) is set where monitor_timing is made
+    monitor_timing.run ([] ()
+    {
+        // Check the schedule again with the longest execution times measured
+        task_set.update_wcet (sorter_index, sorter_timing.get_max_exec_us ());
+        task_set.update_wcet (stepper_index, stepper_timing.get_max_exec_us ());
+        task_set.update_wcet (sensor_index, sensor_timing.get_max_exec_us ());
+        task_set.update_wcet (monitor_index, monitor_timing.get_max_exec_us ());
+        task_set.update_wcet (console_index, console_timing.get_max_exec_us ());
+        task_set.analyze ();
+
+        task_monitor.sample ();
+        print_all_shares (Serial);
+    });
+}
+
+
+/** @brief   Startup stage which starts the serial port
+ *
+ *  @param   p_context Not used
+ *  @param   now_us Not used
+ *  @return  BOOT_READY, as the port is ready at once
+ */
+static BootState boot_serial (void* p_context, uint32_t now_us)
+{
+  (void)p_context;            // Does nothing but shut up a compiler warning
+  (void)now_us;
+
+  Serial.begin(115200);
+  return BOOT_READY;
+}
+
+
+/** @brief   Startup stage which loads the settings from emulated EEPROM
+ *
+ *  @param   p_context pointer to where the result of loading is put
+ *  @param   now_us Not used
+ *  @return  BOOT_READY, as defaults are used if no settings were saved
+ */
+static BootState boot_settings (void* p_context, uint32_t now_us)
+{
+  (void)now_us;               // Does nothing but shut up a compiler warning
+
+  *(SorterConfig::LoadResult*)p_context = sorter_config.load();
+  return BOOT_READY;
+}
+
+
+/** @brief   Startup stage which sets up the motor and solenoid drivers
+ *  @details The TB6612FNG's PWM pins aren't used to control the stepper or
+ *           the solenoids, but according to the datasheet they must be set
+ *           high. The solenoids are turned off before anything else runs.
+ *
+ *  @param   p_context Not used
+ *  @param   now_us Not used
+ *  @return  BOOT_READY, as the drivers are ready at once
+ */
+static BootState boot_motors (void* p_context, uint32_t now_us)
+{
+  (void)p_context;            // Does nothing but shut up a compiler warning
+  (void)now_us;
+
+  for (uint8_t pin : solenoid_pins)
+  {
+    digitalWrite(pin, LOW);
+    pinMode(pin, OUTPUT);
   }
+  const int8_t pwm_pins[] = {PWMA, PWMB, PWMA_sol, PWMB_sol};
+  for (int8_t pin : pwm_pins)
+  {
+    pinMode(pin, OUTPUT);
+    digitalWrite(pin, HIGH);
+  }
+  return BOOT_READY;
 }
 
 
 void setup() {
-// Start the serial port, wait a short time, then say hello. Use the
-    // non-RTOS delay() function because the RTOS hasn't been started yet
-    Serial.begin (115200);
-    delay (5000);
+    // Describe the tasks, with times in microseconds, and give them priorities
+    // in rate monotonic order. The color sensor task runs once per 2.4 ms
+    // integration; the sort sequence is resumed a few times for each turn
+    // of the table, which take at least a second. The stepper task makes at
+    // most one step each millisecond. The WCETs are raised as longer times
+    // are measured
+    sorter_index = task_set.add ("Sort sequence", 1000000, 100);
+    stepper_index = task_set.add ("Run stepper", 1000, 100);
+    sensor_index = task_set.add ("Color sensor", 2400, 800);
+    monitor_index = task_set.add ("Monitor tasks", 5000000, 200000);
+
+    // The console polls the serial port every 20 ms, but commands are typed
+    // by hand, no more often than every couple of seconds, and only a run
+    // with a command in it takes long. Its 2 s deadline puts it below the
+    // sort sequence and above the monitor
+    console_index = task_set.add ("Console", 2000000, 100000);
+
+    // Each sensor's I2C bus task reads it once per integration: four
+    // two-byte register reads of about 50 bit times each at 100 kHz. The
+    // Wire library waits for each transfer without yielding, so that's CPU
+    // time. Their deadlines, like the color sensor task's, put them at its
+    // priority. At the shortest integration time the two buses can't keep
+    // up, and the analysis says so; readings then come a few integrations
+    // apart rather than after each one
+    task_set.add ("Sensor I2C bus", 2400, 2000);
+    task_set.add ("Check I2C bus", 2400, 2000);
+    task_set.assign_priorities (1);
+    bool schedulable = task_set.analyze ();
+
+    // The color sensors' transfers go through the bus scheduler and then an
+    // I2C bus task for each bus once the RTOS scheduler is running; until
+    // then they're done at once. The bus tasks share the sensor task's
+    // priority, as the sensor task waits for them. The checkpoint sensor is
+    // read by the same task, through its own bus
+    sensor_bus.begin (task_set.get_priority (sensor_index), 256,
+                      "Sensor I2C bus");
+    task_monitor.add (sensor_bus.get_task (), 256);
+    sensor_scheduler.add_bus (sensor_bus);
+    sensor_lane = sensor_scheduler.add_sensor (my_ColorSensor, 0);
+    check_bus.set_pins (PC1, PC0);
+    check_bus.begin (task_set.get_priority (sensor_index), 256,
+                     "Check I2C bus");
+    task_monitor.add (check_bus.get_task (), 256);
+    int8_t check_bus_index = sensor_scheduler.add_bus (check_bus);
+    check_lane = sensor_scheduler.add_sensor (check_sensor, check_bus_index);
+
+    // Bring up the serial port, settings, motor drivers and both sensors side
+    // by side, waiting only until each says it's ready. The sensors take the
+    // longest, about 5 ms for the oscillator and the first integration
+    SorterConfig::LoadResult settings;
+    SensorStartup sensor_startup (sensor_scheduler, sensor_lane);
+    SensorStartup check_startup (sensor_scheduler, check_lane);
+    boot_sequence.add ("Serial port", boot_serial, NULL, 1000);
+    boot_sequence.add ("Settings", boot_settings, &settings, 1000);
+    boot_sequence.add ("Motor drivers", boot_motors, NULL, 1000);
+    int8_t sensor_stage = boot_sequence.add ("Color sensor",
+        SensorStartup::poll_stage, &sensor_startup, 100000);
+    int8_t check_stage = boot_sequence.add ("Checkpoint",
+        SensorStartup::poll_stage, &check_startup, 100000);
+    while (!boot_sequence.poll (micros ()))
+    {
+    }
+
     Serial << endl << endl << "Starting Color Sorter Demonstration Program" << endl;
+    boot_sequence.print_stages (Serial);
+    if (!schedulable)
+    {
+        Serial << "Some tasks can miss their deadlines" << endl;
+    }
+
+    // A record saved by an older version is brought up to date and saved
+    if (settings == SorterConfig::MIGRATED)
+    {
+        sorter_config.save ();
+        Serial << "Settings updated to this version and saved" << endl;
+    }
+    else if (settings == SorterConfig::DEFAULTS)
+    {
+        Serial << "No saved settings; using defaults" << endl;
+    }
+    ejector.set_timing (sorter_config.get (CFG_LEAD_US),
+                        sorter_config.get (CFG_PULSE_US));
+
+    // The sensors are read even if they didn't answer, as the driver tries to
+    // start them again each time they're read
+    if (boot_sequence.get_state (sensor_stage) != BOOT_READY)
+    {
+        Serial << "Color sensor not found" << endl;
+    }
+    if (boot_sequence.get_state (check_stage) != BOOT_READY)
+    {
+        Serial << "Checkpoint sensor not found" << endl;
+    }
+    sensor_scheduler.start_lane (sensor_lane, micros ());
+    sensor_scheduler.start_lane (check_lane, micros ());
+
+    // The sensor's interrupt output is open drain and active low
+    pinMode (SENSOR_INT_PIN, INPUT_PULLUP);
+    attachInterrupt (digitalPinToInterrupt (SENSOR_INT_PIN), sensor_interrupt,
+                     FALLING);
+
+    // Task handles are kept so the task monitor can sample each task
+    TaskHandle_t task_handle;
+
+    // Stop the feeder when balls back up and start it again once the queue
+    // has drained. By default that's at two balls and when it's empty; a
+    // third ball would wait longer than the 6 s it may wait to be loaded,
+    // after which it can't reach the farthest ejector within 12 s of arriving
+    feeder_open.put (true);
+    trace_on.put (true);
+    if (!ball_sensor.set_watermarks (sorter_config.get (CFG_HIGH_WATER),
+                                     sorter_config.get (CFG_LOW_WATER)))
+    {
+        Serial << "Bad feeder watermarks; using 2 and 0" << endl;
+        ball_sensor.set_watermarks (2, 0);
+    }
+    ball_sensor.set_max_wait (sorter_config.get (CFG_MAX_WAIT_MS));
+    ball_sensor.set_gate (feeder_gate, NULL);
+    sensor_scheduler.set_fault_handler (sensor_fault, NULL);
+
+    // The index sensor is an optical flag or limit switch which pulls its
+    // pin low; without one, only the color sensor can find a stall
+    pinMode (INDEX_PIN, INPUT_PULLUP);
+    stall_detector.set_index (sorter_config.get (CFG_INDEX) != 0);
+    stall_detector.set_stall_handler (table_stalled, NULL);
+
+    // With an index, the stepper motor task homes the table before the first
+    // move, and the feeder stays shut until it has
+    home_request.put (false);
+    if (stall_detector.has_index ())
+    {
+        stall_detector.need_homing ();
+    }
+
+    // The sorting sequence's coroutine frame isn't on the task's stack
+    xTaskCreate (sorter,
+                 "Sort sequence",                 // Name for printouts
+                 256,                             // Stack size
+                 NULL,                            // Parameters for task fn.
+                 task_set.get_priority (sorter_index), // Priority
+                 &task_handle);                   // Task handle
+    task_monitor.add (task_handle, 256);
 
-    //creating the solenoid task
-     xTaskCreate (solenoid,
-                 "Run solenoid",                     // Name for printouts
-                 1024,                            // Stack size
-                 (void*)(&PWMA_sol, &PWMB_sol, &Ain1_sol, &Ain2_sol, &Bin1_sol, &Bin2_sol), // Parameters for task fn.
-                 10,                               // Priority
-                 NULL);                           // Task handle
     //creating the stepper motor task
      xTaskCreate (steppermotor,
                  "Run stepper motor",                  // Name for printouts
                  2048,                            // Stack size
                  (void*)(&PWMA, &PWMB, &Ain1, &Ain2, &Bin1, &Bin2), // Parameters for task fn.
-                 5,                               // Priority
-                 NULL);                           // Task handle
+                 task_set.get_priority (stepper_index), // Priority
+                 &task_handle);                   // Task handle
+     task_monitor.add (task_handle, 2048);
     //creating the color sensor task
      xTaskCreate (ColorSensor,
                  "Get data from color sensor",     // Name for printouts
                  1024,                            // Stack size
                  NULL,                            // Parameters for task fn.
-                 5,                               // Priority
-                 NULL);                           // Task handle
-
-
-
+                 task_set.get_priority (sensor_index), // Priority
+                 &task_handle);                   // Task handle
+     task_monitor.add (task_handle, 1024);
+    //creating the task which monitors stack and CPU use
+     xTaskCreate (monitor,
+                 "Monitor tasks",                 // Name for printouts
+                 512,                             // Stack size
+                 NULL,                            // Parameters for task fn.
+                 task_set.get_priority (monitor_index), // Priority
+                 &task_handle);                   // Task handle
+     task_monitor.add (task_handle, 512);
+    //creating the task which runs commands typed on the serial port
+     xTaskCreate (console_task,
+                 "Console",                       // Name for printouts
+                 512,                             // Stack size
+                 NULL,                            // Parameters for task fn.
+                 task_set.get_priority (console_index), // Priority
+                 &task_handle);                   // Task handle
+     task_monitor.add (task_handle, 512);
 
     // If using an STM32, we need to call the scheduler startup function now;
     // if using an ESP32, it has already been called for us
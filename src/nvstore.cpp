@@ -0,0 +1,93 @@
+//*****************************************************************************
+/** @file    nvstore.cpp
+ *  @brief   Source code for storing records in emulated EEPROM.
+ *  @details This file contains functions which read and write records in the
+ *           emulated EEPROM and compute the CRC which protects them.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include "nvstore.h"                        // Header for these functions
+
+
+/** @brief   Read a record from emulated EEPROM.
+ *  @details On STM32 processors the flash page holding the emulated EEPROM is
+ *           copied into a RAM buffer once, then the record is taken from the
+ *           buffer. On other processors each byte is read separately.
+ *  @param   address The address of the record's first byte
+ *  @param   p_data Pointer to the place where the record is to be put
+ *  @param   size The number of bytes in the record
+ */
+void nv_read (uint16_t address, void* p_data, size_t size)
+{
+    uint8_t* p_byte = (uint8_t*)p_data;
+
+#ifdef ARDUINO_ARCH_STM32
+    eeprom_buffer_fill ();
+    for (size_t index = 0; index < size; index++)
+    {
+        p_byte[index] = eeprom_buffered_read_byte (address + index);
+    }
+#else
+    for (size_t index = 0; index < size; index++)
+    {
+        p_byte[index] = EEPROM.read (address + index);
+    }
+#endif
+}
+
+
+/** @brief   Write a record to emulated EEPROM.
+ *  @details On STM32 processors the record is written into a RAM copy of the
+ *           flash page, then the page is erased and rewritten once. Writing
+ *           takes some milliseconds during which the processor can't read
+ *           flash, so this function should not be called while motors run.
+ *  @param   address The address where the record's first byte goes
+ *  @param   p_data Pointer to the record to be written
+ *  @param   size The number of bytes in the record
+ */
+void nv_write (uint16_t address, const void* p_data, size_t size)
+{
+    const uint8_t* p_byte = (const uint8_t*)p_data;
+
+#ifdef ARDUINO_ARCH_STM32
+    eeprom_buffer_fill ();
+    for (size_t index = 0; index < size; index++)
+    {
+        eeprom_buffered_write_byte (address + index, p_byte[index]);
+    }
+    eeprom_buffer_flush ();
+#else
+    for (size_t index = 0; index < size; index++)
+    {
+        EEPROM.write (address + index, p_byte[index]);
+    }
+#endif
+}
+
+
+/** @brief   Compute a CRC-16/CCITT of a block of data.
+ *  @details This is the common polynomial 0x1021 CRC with an initial value of
+ *           0xFFFF, computed a bit at a time since records are small.
+ *  @param   p_data Pointer to the data to be checked
+ *  @param   size The number of bytes of data
+ *  @return  The CRC of the data
+ */
+uint16_t nv_crc16 (const void* p_data, size_t size)
+{
+    const uint8_t* p_byte = (const uint8_t*)p_data;
+    uint16_t crc = 0xFFFF;
+
+    for (size_t index = 0; index < size; index++)
+    {
+        crc ^= (uint16_t)p_byte[index] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+    }
+    return crc;
+}
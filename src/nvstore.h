@@ -0,0 +1,54 @@
+//*****************************************************************************
+/** @file    nvstore.h
+ *  @brief   Non-volatile storage of records in emulated EEPROM.
+ *  @details The STM32L476 has no EEPROM, so the Arduino core emulates one in
+ *           a page of flash. This file contains functions which read and
+ *           write whole records there and a CRC used to check that a record
+ *           read at startup is intact. On the STM32 core the flash page is
+ *           copied to RAM once per record rather than once per byte, which
+ *           makes loading a record at boot fast.
+ *
+ *           The addresses of the records kept in storage are listed here so
+ *           that records can't overlap.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _NVSTORE_H_
+#define _NVSTORE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+/// Address in emulated EEPROM of the color sensor calibration record
+#define NV_CALIBRATION_ADDR 0
+
+/// Space reserved for the color sensor calibration record
+#define NV_CALIBRATION_SIZE 64
+
+/// Address in emulated EEPROM of the sorter's configuration record
+#define NV_CONFIG_ADDR (NV_CALIBRATION_ADDR + NV_CALIBRATION_SIZE)
+
+/// Space reserved for the configuration record
+#define NV_CONFIG_SIZE 128
+
+/// Address in emulated EEPROM of the color classifier's trained centroids
+#define NV_CLASSIFIER_ADDR (NV_CONFIG_ADDR + NV_CONFIG_SIZE)
+
+/// Space reserved for the trained centroids record
+#define NV_CLASSIFIER_SIZE 64
+
+
+// Read a record from emulated EEPROM
+void nv_read (uint16_t address, void* p_data, size_t size);
+
+// Write a record to emulated EEPROM
+void nv_write (uint16_t address, const void* p_data, size_t size);
+
+// Compute a CRC-16/CCITT of a block of data
+uint16_t nv_crc16 (const void* p_data, size_t size);
+
+#endif // _NVSTORE_H_
@@ -0,0 +1,402 @@
+//*****************************************************************************
+/** @file    periodictask.h
+ *  @brief   Template for RTOS tasks which run at a fixed period.
+ *  @details Most tasks in the color sorter run their bodies once every so
+ *           many RTOS ticks. This file contains a class template which owns
+ *           the timing loop for such a task and measures how well the task
+ *           keeps to its schedule: how long each run of the body takes, how
+ *           late each run starts compared with when it was due (the release
+ *           jitter), and how many runs didn't finish before the next one was
+ *           due (overruns). The figures appear in the list printed by
+ *           @c print_all_shares(), so timing problems show up at once.
+ *           Tasks which are woken by events rather than by the clock use an
+ *           execution timer from this file, which only measures how long
+ *           each run takes.
+ *
+ *           The template parameter is a clock class which supplies the time
+ *           and the delay until the next release. The RTOS clock is used
+ *           normally; a simulated clock can be used to run the timing loop
+ *           without an RTOS, as the native tests do.
+ *
+ *           @section usage_periodic Usage
+ *           The task object is made globally so it's in the list of shares,
+ *           and the task function sets itself up and then hands the body of
+ *           its loop to @c run(), which never returns:
+ *           @code
+ *           PeriodicTask<> blink_timing ("Blink", 100);  // 100 ticks
+ *           ...
+ *           void task_blink (void* p_params)
+ *           {
+ *               bool on = false;
+ *               blink_timing.run ([&] ()
+ *               {
+ *                   on = !on;
+ *                   digitalWrite (LED_BUILTIN, on);
+ *               });
+ *           }
+ *           @endcode
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _PERIODICTASK_H_
+#define _PERIODICTASK_H_
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#include "baseshare.h"                      // Base class for shared data items
+
+// Under the RTOS, periods are counted in RTOS ticks; on a PC, where only a
+// simulated clock can be used, a tick is taken to be a millisecond
+#ifdef ARDUINO
+    #include "FreeRTOS.h"                   // Main header for FreeRTOS
+    #include "task.h"                       // FreeRTOS task functions
+    typedef TickType_t PeriodicTicks;
+    #define PERIODIC_TICK_MS portTICK_PERIOD_MS
+#else
+    typedef uint32_t PeriodicTicks;
+    #define PERIODIC_TICK_MS 1
+#endif
+
+
+#ifdef ARDUINO
+
+/** @brief   Clock used by periodic tasks which run under FreeRTOS.
+ */
+struct RTOSClock
+{
+    /// Return the time now in microseconds
+    static uint32_t now_us (void)
+    {
+        return micros ();
+    }
+
+    /// Return the RTOS tick count now
+    static TickType_t ticks (void)
+    {
+        return xTaskGetTickCount ();
+    }
+
+    /// Sleep until one period after the previous wake time
+    static void delay_until (TickType_t& last_wake, TickType_t period)
+    {
+        vTaskDelayUntil (&last_wake, period);
+    }
+};
+
+#else
+
+struct RTOSClock;                           // Not there without an RTOS
+
+#endif // ARDUINO
+
+
+/** @brief   Class template which runs a task's body at a fixed period and
+ *           measures its timing.
+ *  @details A run overruns if it finishes after the next run was due. After
+ *           an overrun the releases which were missed are skipped and the
+ *           schedule starts again from the end of the late run, rather than
+ *           running the body several times in a row to catch up.
+ *  @tparam  Clock A class like @c RTOSClock which supplies the time
+ */
+template <class Clock = RTOSClock>
+class PeriodicTask : public BaseShare
+{
+protected:
+    PeriodicTicks period;                   ///< Time between runs in ticks
+    uint32_t period_us;                     ///< Time between runs in us
+    PeriodicTicks last_wake;                ///< Tick count of latest release
+    uint32_t release_us;                    ///< Time the next run is due
+    uint32_t num_runs;                      ///< How many times the body ran
+    uint32_t num_overruns;                  ///< Runs which ended too late
+    uint32_t exec_us;                       ///< Length of the latest run
+    uint32_t max_exec_us;                   ///< Longest run
+    uint32_t max_jitter_us;                 ///< Latest start after a release
+
+public:
+    // Create a periodic task timer with the given period
+    PeriodicTask (const char* p_name, PeriodicTicks a_period);
+
+    // Start the schedule, with the first run due now
+    void start (void);
+
+    // Run the body once, then sleep until the next run is due
+    template <class Body> void run_once (Body& body);
+
+    /** @brief   Run the body at the task's period forever.
+     *  @param   body A function or lambda, taking no arguments, which does
+     *           one run of the task's work
+     */
+    template <class Body> void run (Body body)
+    {
+        start ();
+        for (;;)
+        {
+            run_once (body);
+        }
+    }
+
+    // Forget the timing measurements made so far
+    void reset_stats (void);
+
+    /** @brief   Change the time between runs.
+     *  @details The new period is used from the next release onwards.
+     *  @param   a_period The new time between runs in RTOS ticks
+     */
+    void set_period (PeriodicTicks a_period)
+    {
+        period = a_period;
+        period_us = (uint32_t)a_period * PERIODIC_TICK_MS * 1000UL;
+    }
+
+    /// Return the time between runs in ticks
+    PeriodicTicks get_period (void) const
+    {
+        return period;
+    }
+
+    /// Return the number of times the body has run
+    uint32_t get_num_runs (void) const
+    {
+        return num_runs;
+    }
+
+    /// Return the number of runs which didn't finish before the next was due
+    uint32_t get_num_overruns (void) const
+    {
+        return num_overruns;
+    }
+
+    /// Return the time taken by the latest run in microseconds
+    uint32_t get_exec_us (void) const
+    {
+        return exec_us;
+    }
+
+    /// Return the time taken by the longest run in microseconds
+    uint32_t get_max_exec_us (void) const
+    {
+        return max_exec_us;
+    }
+
+    /// Return the latest any run has started after it was due, microseconds
+    uint32_t get_max_jitter_us (void) const
+    {
+        return max_jitter_us;
+    }
+
+    // Print the task's timing figures within the list of shares
+    void print_in_list (Print& printer);
+};
+
+
+/** @brief   Create a periodic task timer with the given period.
+ *  @details The timer doesn't start a task; the task function calls @c run().
+ *  @param   p_name A name for the task, shown in the list of shares
+ *  @param   a_period The time between runs in RTOS ticks
+ */
+template <class Clock>
+PeriodicTask<Clock>::PeriodicTask (const char* p_name,
+                                   PeriodicTicks a_period)
+    : BaseShare (p_name)
+{
+    set_period (a_period);
+    last_wake = 0;
+    release_us = 0;
+    reset_stats ();
+}
+
+
+/** @brief   Start the schedule, with the first run due now.
+ */
+template <class Clock>
+void PeriodicTask<Clock>::start (void)
+{
+    last_wake = Clock::ticks ();
+    release_us = Clock::now_us ();
+}
+
+
+/** @brief   Run the body once, then sleep until the next run is due.
+ *  @param   body A function or lambda, taking no arguments, which does one
+ *           run of the task's work
+ */
+template <class Clock>
+template <class Body>
+void PeriodicTask<Clock>::run_once (Body& body)
+{
+    uint32_t begin_us = Clock::now_us ();
+    int32_t jitter = (int32_t)(begin_us - release_us);
+    if (jitter > 0 && (uint32_t)jitter > max_jitter_us)
+    {
+        max_jitter_us = jitter;
+    }
+
+    body ();
+
+    uint32_t end_us = Clock::now_us ();
+    exec_us = end_us - begin_us;
+    if (exec_us > max_exec_us)
+    {
+        max_exec_us = exec_us;
+    }
+    num_runs++;
+
+    if ((int32_t)(end_us - release_us) > (int32_t)period_us)
+    {
+        // Skip the releases which were missed and start again from now
+        num_overruns++;
+        last_wake = Clock::ticks ();
+        release_us = end_us;
+    }
+    Clock::delay_until (last_wake, period);
+    release_us += period_us;
+}
+
+
+/** @brief   Forget the timing measurements made so far.
+ */
+template <class Clock>
+void PeriodicTask<Clock>::reset_stats (void)
+{
+    num_runs = 0;
+    num_overruns = 0;
+    exec_us = 0;
+    max_exec_us = 0;
+    max_jitter_us = 0;
+}
+
+
+/** @brief   Print the task's timing figures within the list of shares.
+ *  @details The period is shown in ticks and the times in microseconds.
+ *  @param   printer Reference to a serial device on which to print
+ */
+template <class Clock>
+void PeriodicTask<Clock>::print_in_list (Print& printer)
+{
+    // Print this task's name and pad it to 16 characters
+    printer.printf ("%-16speriodic\t", name);
+    printer << period << " ticks, exec " << exec_us << '/' << max_exec_us
+            << " us, jitter " << max_jitter_us << " us, " << num_overruns
+            << '/' << num_runs << " overruns" << endl;
+
+    // Call the next item
+    if (p_next != NULL)
+    {
+        p_next->print_in_list (printer);
+    }
+}
+
+
+/** @brief   Class template which measures how long each run of a task takes,
+ *           for tasks which aren't periodic.
+ *  @details A task which is woken by an event calls @c begin() when it wakes
+ *           and @c end() before it blocks again. The time between includes
+ *           any preemption by tasks of higher priority, so the longest time
+ *           measured is, if anything, more than the task's WCET.
+ *  @tparam  Clock A class like @c RTOSClock which supplies the time
+ */
+template <class Clock = RTOSClock>
+class ExecutionTimer : public BaseShare
+{
+protected:
+    uint32_t begin_us;                      ///< Time the current run began
+    bool running;                           ///< True between begin and end
+    uint32_t num_runs;                      ///< How many runs were timed
+    uint32_t exec_us;                       ///< Length of the latest run
+    uint32_t max_exec_us;                   ///< Longest run
+
+public:
+    /** @brief   Create an execution timer.
+     *  @param   p_name A name for the task, shown in the list of shares
+     */
+    ExecutionTimer (const char* p_name)
+        : BaseShare (p_name)
+    {
+        running = false;
+        reset_stats ();
+    }
+
+    /// Note that a run of the task has begun
+    void begin (void)
+    {
+        begin_us = Clock::now_us ();
+        running = true;
+    }
+
+    // Note that the run has ended, if one was going on
+    void end (void);
+
+    /// Forget the timing measurements made so far
+    void reset_stats (void)
+    {
+        num_runs = 0;
+        exec_us = 0;
+        max_exec_us = 0;
+    }
+
+    /// Return the number of runs timed
+    uint32_t get_num_runs (void) const
+    {
+        return num_runs;
+    }
+
+    /// Return the time taken by the latest run in microseconds
+    uint32_t get_exec_us (void) const
+    {
+        return exec_us;
+    }
+
+    /// Return the time taken by the longest run in microseconds
+    uint32_t get_max_exec_us (void) const
+    {
+        return max_exec_us;
+    }
+
+    // Print the task's timing figures within the list of shares
+    void print_in_list (Print& printer);
+};
+
+
+/** @brief   Note that the run has ended, if one was going on.
+ *  @details Calling this again before @c begin() does nothing, so a task can
+ *           end a run before each place where it blocks.
+ */
+template <class Clock>
+void ExecutionTimer<Clock>::end (void)
+{
+    if (!running)
+    {
+        return;
+    }
+    running = false;
+    exec_us = Clock::now_us () - begin_us;
+    if (exec_us > max_exec_us)
+    {
+        max_exec_us = exec_us;
+    }
+    num_runs++;
+}
+
+
+/** @brief   Print the task's timing figures within the list of shares.
+ *  @param   printer Reference to a serial device on which to print
+ */
+template <class Clock>
+void ExecutionTimer<Clock>::print_in_list (Print& printer)
+{
+    // Print this timer's name and pad it to 16 characters
+    printer.printf ("%-16stimer\t", name);
+    printer << "exec " << exec_us << '/' << max_exec_us << " us, " << num_runs
+            << " runs" << endl;
+
+    // Call the next item
+    if (p_next != NULL)
+    {
+        p_next->print_in_list (printer);
+    }
+}
+
+#endif // _PERIODICTASK_H_
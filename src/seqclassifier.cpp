@@ -0,0 +1,91 @@
+//*****************************************************************************
+/** @file    seqclassifier.cpp
+ *  @brief   Source code of the sequential, early exit color classifier.
+ *  @details This file contains the methods of class @c SequentialClassifier.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include "seqclassifier.h"                  // Header for this class
+
+
+/** @brief   Create a sequential classifier which uses the given classifier.
+ *  @param   a_classifier The classifier, with trained centroids, which is
+ *           used to classify the average of the readings
+ *  @param   a_threshold The margin times number of readings needed to decide
+ *  @param   a_min_readings The fewest readings on which a decision is made
+ *  @param   a_max_readings The number of readings after which the ball is
+ *           called ambiguous if no decision has been made
+ */
+SequentialClassifier::SequentialClassifier (const ColorClassifier& a_classifier,
+                                            uint32_t a_threshold,
+                                            uint8_t a_min_readings,
+                                            uint8_t a_max_readings)
+    : classifier (a_classifier)
+{
+    threshold = a_threshold;
+    min_readings = a_min_readings ? a_min_readings : 1;
+    max_readings = (a_max_readings >= min_readings) ? a_max_readings
+                                                    : min_readings;
+    start ();
+}
+
+
+/** @brief   Forget the readings of the previous ball.
+ */
+void SequentialClassifier::start (void)
+{
+    sum[0] = sum[1] = sum[2] = 0;
+    count = 0;
+    result.bin = BIN_REJECT;
+    result.distance = UINT32_MAX;
+    result.margin = 0;
+}
+
+
+/** @brief   Add a reading and see whether a decision can be made.
+ *  @param   reading A short integration reading of the ball, or the average
+ *           of several of them
+ *  @param   weight The number of short readings averaged into @c reading
+ *  @return  @c DECIDED if the bin in @c get_result() can be trusted,
+ *           @c AMBIGUOUS if the readings gave up without a decision, or
+ *           @c PENDING if another reading is needed
+ */
+SequentialClassifier::Decision SequentialClassifier::add (
+    const RGBCSample& reading, uint16_t weight)
+{
+    // Keep the sums from overflowing however long the windows are
+    if (weight == 0)
+    {
+        weight = 1;
+    }
+    else if (weight > max_readings)
+    {
+        weight = max_readings;
+    }
+    sum[0] += (uint32_t)reading.r * weight;
+    sum[1] += (uint32_t)reading.g * weight;
+    sum[2] += (uint32_t)reading.b * weight;
+    count += weight;
+
+    // Classify the average reading, so that the classifier's dimness check
+    // works just as it does on single readings
+    RGBCSample mean;
+    mean.r = sum[0] / count;
+    mean.g = sum[1] / count;
+    mean.b = sum[2] / count;
+    mean.c = 0;
+    result = classifier.classify (mean);
+
+    if (count >= min_readings && result.bin != BIN_REJECT
+        && (uint64_t)result.margin * count >= threshold)
+    {
+        return DECIDED;
+    }
+    if (count >= max_readings)
+    {
+        return AMBIGUOUS;
+    }
+    return PENDING;
+}
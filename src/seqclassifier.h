@@ -0,0 +1,85 @@
+//*****************************************************************************
+/** @file    seqclassifier.h
+ *  @brief   Sequential classifier which stops as soon as it's confident.
+ *  @details Most balls have colors which are easy to tell apart, and a few
+ *           short readings are enough to classify them; only balls whose
+ *           colors lie between two bins need long, low noise readings. This
+ *           file contains a classifier which adds up short readings one at a
+ *           time and decides as soon as the evidence is strong enough.
+ *
+ *           The evidence after @e n readings is the classifier's margin for
+ *           the average of the readings, the difference in squared distance
+ *           between the nearest bin and the runner-up, multiplied by @e n.
+ *           Averaging makes the margin steadier while multiplying by @e n
+ *           rewards readings which agree, much as a sequential probability
+ *           ratio test adds up log likelihoods. If no decision has been made
+ *           after a set number of readings, the ball is called ambiguous and
+ *           the caller should take a long integration reading instead.
+ *
+ *           A reading may itself be an average of several short readings, as
+ *           given by a @c RippleFilter, in which case it's weighted by the
+ *           number of readings in it.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _SEQCLASSIFIER_H_
+#define _SEQCLASSIFIER_H_
+
+#include <stdint.h>
+#include "colorsample.h"
+#include "colorclassifier.h"
+
+
+/** @brief   Class which classifies a ball from as few readings as it can.
+ *  @details Call @c start() when a new ball arrives, then give each reading to
+ *           @c add() until it returns something other than @c PENDING.
+ */
+class SequentialClassifier
+{
+public:
+    /// What @c add() has decided so far
+    enum Decision
+    {
+        PENDING,                            ///< More readings are needed
+        DECIDED,                            ///< Confident; the bin is known
+        AMBIGUOUS                           ///< Gave up; use a long reading
+    };
+
+protected:
+    const ColorClassifier& classifier;      ///< Classifies averaged readings
+    uint32_t threshold;                     ///< Evidence needed to decide
+    uint8_t min_readings;                   ///< Fewest readings to decide on
+    uint8_t max_readings;                   ///< Most readings before giving up
+    uint32_t sum[3];                        ///< Sums of the R G B counts
+    uint16_t count;                         ///< Readings added for this ball
+    Classification result;                  ///< Latest classification
+
+public:
+    // Create a sequential classifier which uses the given classifier
+    SequentialClassifier (const ColorClassifier& a_classifier,
+                          uint32_t a_threshold, uint8_t a_min_readings = 2,
+                          uint8_t a_max_readings = 20);
+
+    // Forget the readings of the previous ball
+    void start (void);
+
+    // Add a reading and see whether a decision can be made
+    Decision add (const RGBCSample& reading, uint16_t weight = 1);
+
+    /// Return the latest classification of the readings' average
+    const Classification& get_result (void) const
+    {
+        return result;
+    }
+
+    /// Return the number of readings added for this ball
+    uint16_t get_count (void) const
+    {
+        return count;
+    }
+};
+
+#endif // _SEQCLASSIFIER_H_
@@ -0,0 +1,186 @@
+//*****************************************************************************
+/** @file    slotmap.cpp
+ *  @brief   Source code of the map of balls in the turntable's slots.
+ *  @details This file contains the methods of class @c SlotMap.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <PrintStream.h>
+#include "slotmap.h"                        // Header for this class
+
+
+/** @brief   Create a map of an empty table.
+ *  @param   p_name A name for the map, used when it's printed
+ *  @param   a_num_slots The number of slots, one in each section of the table
+ */
+SlotMap::SlotMap (const char* p_name, uint8_t a_num_slots)
+    : BaseShare (p_name)
+{
+    num_slots = (a_num_slots < 2) ? 2 : a_num_slots;
+    num_slots = (num_slots > SLOTMAP_MAX_SLOTS) ? SLOTMAP_MAX_SLOTS
+                                                : num_slots;
+    for (uint8_t slot = 0; slot < SLOTMAP_MAX_SLOTS; slot++)
+    {
+        occupied[slot] = false;
+    }
+    rotation = 0;
+    num_balls = 0;
+    num_loaded = 0;
+    num_ejected = 0;
+    num_refused = 0;
+    total_dwell_ms = 0;
+    max_dwell_ms = 0;
+}
+
+
+/** @brief   Find which slot is at a station.
+ *  @details Slot @c s starts at station @c s, and each section the table
+ *           turns carries it one station further.
+ *  @param   station The station, numbered forwards from the load station
+ *  @return  The slot at that station
+ */
+uint8_t SlotMap::slot_at (uint8_t station) const
+{
+    return (station % num_slots + num_slots - rotation) % num_slots;
+}
+
+
+/** @brief   Put a ball in the slot at the load station.
+ *  @details A ball whose bin has no ejector on this table, such as one
+ *           marked @c BIN_REJECT, is counted and not loaded.
+ *  @param   bin The bin to which the ball goes
+ *  @param   now_ms The time now in milliseconds
+ *  @return  True if the ball was put in the slot, false if the slot is full
+ *           or the bin has no ejector on this table
+ */
+bool SlotMap::load (uint8_t bin, uint32_t now_ms)
+{
+    uint8_t slot = slot_at (0);
+
+    if (occupied[slot])
+    {
+        return false;
+    }
+    if (!has_station (bin))
+    {
+        num_refused++;
+        return false;
+    }
+    balls[slot].bin = bin;
+    balls[slot].entry_ms = now_ms;
+    balls[slot].number = num_loaded++;
+    occupied[slot] = true;
+    num_balls++;
+    return true;
+}
+
+
+/** @brief   Note that the table has turned forwards by one section.
+ */
+void SlotMap::advance (void)
+{
+    rotation = (rotation + 1) % num_slots;
+}
+
+
+/** @brief   Find the stations at which a ball has reached its ejector.
+ *  @return  A mask with bit @c k set if the ball at station @c k is to be
+ *           ejected there
+ */
+uint8_t SlotMap::get_ejections (void) const
+{
+    uint8_t mask = 0;
+
+    for (uint8_t station = 1; station < num_slots; station++)
+    {
+        uint8_t slot = slot_at (station);
+        if (occupied[slot] && station_for (balls[slot].bin) == station)
+        {
+            mask |= (uint8_t)(1 << station);
+        }
+    }
+    return mask;
+}
+
+
+/** @brief   Take the ball at a station out of the map, once it's been pushed
+ *           off.
+ *  @param   station The station at which the ball was ejected
+ *  @param   now_ms The time now in milliseconds
+ *  @return  True if there was a ball there, false if the slot was empty
+ */
+bool SlotMap::eject (uint8_t station, uint32_t now_ms)
+{
+    uint8_t slot = slot_at (station);
+
+    if (!occupied[slot])
+    {
+        return false;
+    }
+    uint32_t dwell = now_ms - balls[slot].entry_ms;
+    total_dwell_ms += dwell;
+    max_dwell_ms = (dwell > max_dwell_ms) ? dwell : max_dwell_ms;
+    occupied[slot] = false;
+    num_balls--;
+    num_ejected++;
+    return true;
+}
+
+
+/** @brief   Get the ball at a station, if there is one.
+ *  @param   station The station, numbered forwards from the load station
+ *  @param   ball Reference to the place where the ball is put
+ *  @return  True if there's a ball at the station, false if not
+ */
+bool SlotMap::get_ball (uint8_t station, SlotBall& ball) const
+{
+    uint8_t slot = slot_at (station);
+
+    if (!occupied[slot])
+    {
+        return false;
+    }
+    ball = balls[slot];
+    return true;
+}
+
+
+/** @brief   Print the contents of the slots within the list of shares.
+ *  @details The bin of the ball at each station is shown, starting at the
+ *           load station, with a dash for an empty slot.
+ *  @param   printer Reference to a serial device on which to print
+ */
+void SlotMap::print_in_list (Print& printer)
+{
+    // Print this map's name and pad it to 16 characters
+    printer.printf ("%-16sslots\t", name);
+    printer << '[';
+    for (uint8_t station = 0; station < num_slots; station++)
+    {
+        uint8_t slot = slot_at (station);
+        if (station > 0)
+        {
+            printer << ' ';
+        }
+        if (occupied[slot])
+        {
+            printer << balls[slot].bin;
+        }
+        else
+        {
+            printer << '-';
+        }
+    }
+    printer << "] " << num_loaded << " loaded, " << num_ejected
+            << " ejected, " << num_refused << " refused, dwell "
+            << (uint32_t)(num_ejected ? total_dwell_ms / num_ejected : 0)
+            << '/' << max_dwell_ms << " ms" << endl;
+
+    // Call the next item
+    if (p_next != NULL)
+    {
+        p_next->print_in_list (printer);
+    }
+}
@@ -0,0 +1,145 @@
+//*****************************************************************************
+/** @file    slotmap.h
+ *  @brief   Map of which ball sits in each slot of the turntable.
+ *  @details The turntable has one slot in each of its sections. Balls are
+ *           loaded into the slot under the color sensor, the load station,
+ *           and each turn of one section carries every slot on to the next
+ *           station. The ejector for a bin sits at that bin's station, so a
+ *           ball is pushed off once its slot reaches the station for its bin.
+ *
+ *           Tracking each slot lets a new ball be loaded at the sensor while
+ *           the balls loaded before it are still on their way to their
+ *           ejectors, so the sorter works as a pipeline rather than sorting
+ *           one ball from start to end before taking the next.
+ *
+ *           Stations are numbered forwards from the load station, which is
+ *           station 0; the ball for bin @c b is ejected at station @c b + 1.
+ *           Slots are numbered around the table, and the slot at a station
+ *           depends on how far the table has turned. The slot map is a
+ *           @c BaseShare, so its contents are printed by
+ *           @c print_all_shares().
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _SLOTMAP_H_
+#define _SLOTMAP_H_
+
+#include <Arduino.h>
+#include "baseshare.h"                      // Base class for shared data items
+
+
+/// The most slots a turntable may have
+#define SLOTMAP_MAX_SLOTS 8
+
+
+/** @brief   A ball in a turntable slot.
+ */
+struct SlotBall
+{
+    uint8_t bin;                            ///< Bin to which the ball goes
+    uint32_t entry_ms;                      ///< Time at which it was loaded
+    uint16_t number;                        ///< Count of balls loaded before
+};
+
+
+/** @brief   Class which keeps track of the ball in each slot of a turntable.
+ *  @details Call @c load() when the sensor has classified a ball at the load
+ *           station, @c advance() each time the table has turned one section,
+ *           then @c get_ejections() to find which ejectors to fire and
+ *           @c eject() for each ball pushed off.
+ */
+class SlotMap : public BaseShare
+{
+protected:
+    SlotBall balls[SLOTMAP_MAX_SLOTS];      ///< The ball in each slot
+    bool occupied[SLOTMAP_MAX_SLOTS];       ///< True if a slot holds a ball
+    uint8_t num_slots;                      ///< Number of slots on the table
+    uint8_t rotation;                       ///< Sections turned, modulo slots
+    uint8_t num_balls;                      ///< Balls on the table now
+    uint16_t num_loaded;                    ///< Balls loaded so far
+    uint16_t num_ejected;                   ///< Balls ejected so far
+    uint16_t num_refused;                   ///< Balls with no station
+    uint32_t total_dwell_ms;                ///< Time on the table, summed
+    uint32_t max_dwell_ms;                  ///< Longest time on the table
+
+    // Find which slot is at a station
+    uint8_t slot_at (uint8_t station) const;
+
+public:
+    // Create a map of an empty table
+    SlotMap (const char* p_name = NULL, uint8_t a_num_slots = 4);
+
+    // Put a ball in the slot at the load station
+    bool load (uint8_t bin, uint32_t now_ms);
+
+    // Note that the table has turned forwards by one section
+    void advance (void);
+
+    // Find the stations at which a ball has reached its ejector
+    uint8_t get_ejections (void) const;
+
+    // Take the ball at a station out of the map, once it's been pushed off
+    bool eject (uint8_t station, uint32_t now_ms);
+
+    // Get the ball at a station, if there is one
+    bool get_ball (uint8_t station, SlotBall& ball) const;
+
+    /** @brief   Find whether the table has a station for a bin.
+     *  @details Every station but the load station has an ejector, so a
+     *           table with @c n slots has stations for bins 0 to @c n - 2.
+     *  @param   bin The bin
+     *  @return  True if balls for the bin can be ejected
+     */
+    bool has_station (uint8_t bin) const
+    {
+        return bin < num_slots - 1;
+    }
+
+    /** @brief   Find the station at which balls for a bin are ejected.
+     *  @param   bin The bin
+     *  @return  The station, numbered forwards from the load station, or 0
+     *           if the table has no station for the bin
+     */
+    uint8_t station_for (uint8_t bin) const
+    {
+        return has_station (bin) ? (uint8_t)(bin + 1) : 0;
+    }
+
+    /// Return true if the slot at the load station can take a ball
+    bool can_load (void) const
+    {
+        return !occupied[slot_at (0)];
+    }
+
+    /// Return the number of sections the table has turned, modulo the slots
+    uint8_t get_rotation (void) const
+    {
+        return rotation;
+    }
+
+    /// Return the number of balls on the table
+    uint8_t get_num_balls (void) const
+    {
+        return num_balls;
+    }
+
+    /// Return the number of balls ejected so far
+    uint16_t get_num_ejected (void) const
+    {
+        return num_ejected;
+    }
+
+    /// Return the number of balls not loaded as they had no station
+    uint16_t get_num_refused (void) const
+    {
+        return num_refused;
+    }
+
+    // Print the contents of the slots within the list of shares
+    void print_in_list (Print& printer);
+};
+
+#endif // _SLOTMAP_H_
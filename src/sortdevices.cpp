@@ -0,0 +1,395 @@
+//*****************************************************************************
+/** @file    sortdevices.cpp
+ *  @brief   Source code of the awaitable devices used for sorting balls.
+ *  @details This file contains the methods of classes @c BallSensor,
+ *           @c Turntable and @c SolenoidBank.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <Arduino.h>
+#include <PrintStream.h>
+#include "sortdevices.h"                    // Header for these classes
+
+
+/** @brief   Create a ball sensor whose coroutines run in the given scheduler.
+ *  @details The feeder is stopped when three balls are waiting and started
+ *           again when one is left, and no ball is too late to sort, until
+ *           other limits are set.
+ *  @param   p_name A name for the ball sensor, used when it's printed
+ *  @param   a_scheduler The scheduler which runs the sorting coroutines
+ */
+BallSensor::BallSensor (const char* p_name, CoScheduler& a_scheduler)
+    : BaseShare (p_name), scheduler (a_scheduler)
+{
+    balls_head = 0;
+    num_balls = 0;
+    num_waiters = 0;
+    high_water = BALL_QUEUE_SIZE - 1;
+    low_water = 1;
+    max_wait = 0;
+    gate_open = true;
+    p_gate = NULL;
+    p_gate_context = NULL;
+    num_dropped = 0;
+    num_late = 0;
+    num_gate_closes = 0;
+}
+
+
+/** @brief   Set the queue lengths at which the feeder is stopped and
+ *           restarted.
+ *  @param   high The number of waiting balls at which the feeder is stopped
+ *  @param   low The number of waiting balls at which it's started again
+ *  @return  True if the watermarks were set, false if @c low isn't below
+ *           @c high or @c high is more than the queue holds
+ */
+bool BallSensor::set_watermarks (uint8_t high, uint8_t low)
+{
+    if (low >= high || high > BALL_QUEUE_SIZE)
+    {
+        return false;
+    }
+    CO_ENTER_CRITICAL ();
+    high_water = high;
+    low_water = low;
+    CO_EXIT_CRITICAL ();
+    return true;
+}
+
+
+/** @brief   Tell the feeder whether to feed balls.
+ *  @param   open True to feed balls, false to stop
+ */
+void BallSensor::signal_gate (bool open)
+{
+    if (p_gate != NULL)
+    {
+        p_gate (open, p_gate_context);
+    }
+}
+
+
+/** @brief   Take the oldest ball which can still be sorted in time.
+ *  @details Balls which have waited longer than the limit are rejected, as
+ *           they would reach their ejectors too late. This must be called
+ *           within a critical section; the caller opens the feeder gate
+ *           afterwards if asked to.
+ *  @param   bin Reference to the place where the ball's bin is put
+ *  @param   open_gate Reference to a flag which is set if the queue has
+ *           drained enough for the feeder to start again
+ *  @return  True if there was a ball, false if not
+ */
+bool BallSensor::take_in_time (uint8_t& bin, bool& open_gate)
+{
+    bool got_one = false;
+    uint32_t now = scheduler.get_now ();
+
+    while (num_balls > 0 && !got_one)
+    {
+        Ball& ball = balls[balls_head];
+        if (max_wait == 0 || now - ball.time <= max_wait)
+        {
+            bin = ball.bin;
+            got_one = true;
+        }
+        else
+        {
+            num_late++;
+        }
+        balls_head = (balls_head + 1) % BALL_QUEUE_SIZE;
+        num_balls--;
+    }
+
+    if (!gate_open && num_balls <= low_water)
+    {
+        gate_open = true;
+        open_gate = true;
+    }
+    return got_one;
+}
+
+
+/** @brief   Take the oldest ball no one was waiting for.
+ *  @param   bin Reference to the place where the ball's bin is put
+ *  @return  True if there was a ball, false if not
+ */
+bool BallSensor::take (uint8_t& bin)
+{
+    bool open_gate = false;
+
+    CO_ENTER_CRITICAL ();
+    bool got_one = take_in_time (bin, open_gate);
+    CO_EXIT_CRITICAL ();
+
+    if (open_gate)
+    {
+        signal_gate (true);
+    }
+    return got_one;
+}
+
+
+/** @brief   Wait for a ball unless one arrived just now.
+ *  @details A ball may be delivered between @c await_ready() and this call,
+ *           so the queue is looked at again with the waiter list locked.
+ *  @param   handle The coroutine which is waiting
+ *  @return  True if the coroutine is waiting, false if it has its ball or
+ *           there was no room to wait, in which case the bin is
+ *           @c 0xFF
+ */
+bool BallSensor::SampleAwaiter::await_suspend (std::coroutine_handle<> handle)
+{
+    bool waiting = false;
+    bool open_gate = false;
+
+    CO_ENTER_CRITICAL ();
+    if (!sensor.take_in_time (bin, open_gate))
+    {
+        if (sensor.num_waiters < CO_MAX_TASKS)
+        {
+            sensor.waiters[sensor.num_waiters].handle = handle;
+            sensor.waiters[sensor.num_waiters].p_bin = &bin;
+            sensor.num_waiters++;
+            waiting = true;
+        }
+        else
+        {
+            bin = 0xFF;
+        }
+    }
+    CO_EXIT_CRITICAL ();
+
+    if (open_gate)
+    {
+        sensor.signal_gate (true);
+    }
+    return waiting;
+}
+
+
+/** @brief   Hand a classified ball to a waiting coroutine, or keep it for
+ *           later.
+ *  @details This is called by the color sensor task, and never blocks. The
+ *           coroutine which has waited longest gets the ball. If none is
+ *           waiting the ball is queued, and the feeder is stopped once the
+ *           queue reaches the high watermark.
+ *  @param   bin The bin to which the ball belongs
+ *  @param   now The tick count now, from which the ball's wait is timed
+ *  @return  True if the ball was handed over or kept, false if it was lost
+ *           because no coroutine was waiting and the queue was full
+ */
+bool BallSensor::deliver (uint8_t bin, uint32_t now)
+{
+    std::coroutine_handle<> handle = nullptr;
+    bool kept = true;
+    bool close_gate = false;
+
+    CO_ENTER_CRITICAL ();
+    if (num_waiters > 0)
+    {
+        handle = waiters[0].handle;
+        *(waiters[0].p_bin) = bin;
+        for (uint8_t index = 1; index < num_waiters; index++)
+        {
+            waiters[index - 1] = waiters[index];
+        }
+        num_waiters--;
+    }
+    else if (num_balls < BALL_QUEUE_SIZE)
+    {
+        Ball& ball = balls[(balls_head + num_balls) % BALL_QUEUE_SIZE];
+        ball.bin = bin;
+        ball.time = now;
+        num_balls++;
+        if (gate_open && num_balls >= high_water)
+        {
+            gate_open = false;
+            close_gate = true;
+            num_gate_closes++;
+        }
+    }
+    else
+    {
+        num_dropped++;
+        kept = false;
+    }
+    CO_EXIT_CRITICAL ();
+
+    if (close_gate)
+    {
+        signal_gate (false);
+    }
+    if (handle)
+    {
+        scheduler.make_ready (handle);
+    }
+    return kept;
+}
+
+
+/** @brief   Print the queue and the feeder gate within the list of shares.
+ *  @param   printer Reference to a serial device on which to print
+ */
+void BallSensor::print_in_list (Print& printer)
+{
+    // Print this ball sensor's name and pad it to 16 characters
+    printer.printf ("%-16sballs\t", name);
+    printer << num_balls << " queued, feeder "
+            << (gate_open ? "open" : "stopped") << " (" << num_gate_closes
+            << " stops), " << num_dropped << " dropped, " << num_late
+            << " late" << endl;
+
+    // Call the next item
+    if (p_next != NULL)
+    {
+        p_next->print_in_list (printer);
+    }
+}
+
+
+/** @brief   Create a turntable whose coroutines run in the given scheduler.
+ *  @details The table is taken to be at section 0 to begin with.
+ *  @param   a_scheduler The scheduler which runs the sorting coroutines
+ *  @param   a_steps_per_rev The number of motor steps in one turn of the table
+ *  @param   a_num_sections The number of sections around the table
+ */
+Turntable::Turntable (CoScheduler& a_scheduler, uint16_t a_steps_per_rev,
+                      uint8_t a_num_sections)
+    : scheduler (a_scheduler)
+{
+    steps_per_rev = a_steps_per_rev;
+    num_sections = a_num_sections ? a_num_sections : 1;
+    position = 0;
+    odometer = 0;
+    move_steps = 0;
+    moving = false;
+    num_waiters = 0;
+}
+
+
+/** @brief   Find the position of a section in steps forward from section 0.
+ *  @details When the steps per revolution don't divide evenly among the
+ *           sections, each position is rounded to the nearest step, so the
+ *           moves alternate between the shorter and longer number of steps.
+ *  @param   section The section
+ *  @return  The position in steps
+ */
+uint16_t Turntable::section_position (uint8_t section) const
+{
+    return ((uint32_t)(section % num_sections) * steps_per_rev
+            + num_sections / 2) / num_sections;
+}
+
+
+/** @brief   Find how many steps forwards it is from here to a section.
+ *  @param   section The section
+ *  @return  The number of steps, less than one revolution
+ */
+uint16_t Turntable::steps_to (uint8_t section) const
+{
+    return (section_position (section) + steps_per_rev - position)
+           % steps_per_rev;
+}
+
+
+/** @brief   Ask for a move and wait for it.
+ *  @param   handle The coroutine which is waiting
+ *  @return  True if the coroutine is waiting, false if the move couldn't be
+ *           queued
+ */
+bool Turntable::MoveAwaiter::await_suspend (std::coroutine_handle<> handle)
+{
+    CO_ENTER_CRITICAL ();
+    if (table.num_waiters < CO_MAX_TASKS)
+    {
+        table.waiters[table.num_waiters].handle = handle;
+        table.waiters[table.num_waiters].section = section;
+        table.num_waiters++;
+        queued = true;
+    }
+    CO_EXIT_CRITICAL ();
+    return queued;
+}
+
+
+/** @brief   Get the next move for the stepper motor task to make.
+ *  @details This is called by the stepper motor task. Once it returns true
+ *           the table counts as moving until @c move_done() is called.
+ *  @param   steps Reference to the place where the number of steps forward
+ *           is put
+ *  @return  True if there's a move to make, false if not
+ */
+bool Turntable::get_move (uint16_t& steps)
+{
+    bool got_one = false;
+
+    CO_ENTER_CRITICAL ();
+    if (!moving && num_waiters > 0)
+    {
+        steps = steps_to (waiters[0].section);
+        move_steps = steps;
+        moving = true;
+        got_one = true;
+    }
+    CO_EXIT_CRITICAL ();
+    return got_one;
+}
+
+
+/** @brief   Note that the stepper motor task has made the move.
+ *  @details The position and odometer are updated and the coroutine which
+ *           asked for the move is resumed.
+ */
+void Turntable::move_done (void)
+{
+    std::coroutine_handle<> handle = nullptr;
+
+    CO_ENTER_CRITICAL ();
+    if (moving && num_waiters > 0)
+    {
+        position = section_position (waiters[0].section);
+        odometer += move_steps;
+        handle = waiters[0].handle;
+        for (uint8_t index = 1; index < num_waiters; index++)
+        {
+            waiters[index - 1] = waiters[index];
+        }
+        num_waiters--;
+    }
+    moving = false;
+    CO_EXIT_CRITICAL ();
+
+    if (handle)
+    {
+        scheduler.make_ready (handle);
+    }
+}
+
+
+/** @brief   Create a bank of solenoids on the given pins.
+ *  @param   a_p_pins Pointer to an array holding each solenoid's output pin
+ *  @param   a_num_channels The number of solenoids
+ */
+SolenoidBank::SolenoidBank (const uint8_t* a_p_pins, uint8_t a_num_channels)
+{
+    p_pins = a_p_pins;
+    num_channels = a_num_channels;
+}
+
+
+/** @brief   Turn solenoids on or off at once.
+ *  @param   mask A mask with bit @c k set for each solenoid @c k to change
+ *  @param   on True to turn the solenoids on, false to turn them off
+ */
+void SolenoidBank::set (uint8_t mask, bool on)
+{
+    for (uint8_t channel = 0; channel < num_channels; channel++)
+    {
+        if (mask & (1 << channel))
+        {
+            digitalWrite (p_pins[channel], on ? HIGH : LOW);
+        }
+    }
+}
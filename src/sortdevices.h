@@ -0,0 +1,298 @@
+//*****************************************************************************
+/** @file    sortdevices.h
+ *  @brief   Awaitable devices used by the coroutine which sorts balls.
+ *  @details The sorting sequence is written as a coroutine which waits on
+ *           three devices in turn:
+ *           - @c BallSensor hands over the bin of each ball the color sensor
+ *             task has classified, with @c co_await @c sensor.sample().
+ *           - @c Turntable passes moves to the stepper motor task and resumes
+ *             the waiting coroutine when the move is done, with
+ *             @c co_await @c table.move_to(section).
+ *
+ *           The solenoids which push the balls off the table are in a
+ *           @c SolenoidBank, which the ejection scheduler switches.
+ *
+ *           Each device queues the coroutines which wait on it, so more than
+ *           one sequence can be in flight at once. The other tasks call the
+ *           devices' methods, which are protected by critical sections, to
+ *           deliver results.
+ *
+ *           The ball sensor never blocks the color sensor task. It controls
+ *           how many balls it admits instead: when its queue reaches a high
+ *           watermark it tells the feeder to stop, and when the queue has
+ *           drained to a low watermark it lets the feeder go again. A ball
+ *           which has waited too long to reach its ejector in time is
+ *           rejected rather than sorted late.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _SORTDEVICES_H_
+#define _SORTDEVICES_H_
+
+#include <stdint.h>
+#include "baseshare.h"                      // Base class for shared data items
+#include "coscheduler.h"
+
+
+/// The most classified balls which can wait for a sorting coroutine
+#define BALL_QUEUE_SIZE 4
+
+
+/** @brief   Class which hands classified balls to sorting coroutines.
+ *  @details The ball sensor is a @c BaseShare, so its queue, the feeder gate
+ *           and the number of balls rejected are printed by
+ *           @c print_all_shares().
+ */
+class BallSensor : public BaseShare
+{
+protected:
+    /// A ball no coroutine was waiting for, and when it was classified
+    struct Ball
+    {
+        uint8_t bin;                        ///< Bin to which the ball goes
+        uint32_t time;                      ///< Tick at which it arrived
+    };
+
+    /// A coroutine waiting for a ball and where its bin is to be put
+    struct Waiter
+    {
+        std::coroutine_handle<> handle;     ///< The coroutine
+        uint8_t* p_bin;                     ///< Where the bin is put
+    };
+
+    CoScheduler& scheduler;                 ///< Resumes the waiting ones
+    Ball balls[BALL_QUEUE_SIZE];            ///< Balls no one is waiting for
+    uint8_t balls_head;                     ///< Index of the oldest ball
+    uint8_t num_balls;                      ///< Number of balls waiting
+    Waiter waiters[CO_MAX_TASKS];           ///< Coroutines waiting, in order
+    uint8_t num_waiters;                    ///< Number of coroutines waiting
+    uint8_t high_water;                     ///< Queue length to stop feeding
+    uint8_t low_water;                      ///< Queue length to feed again
+    uint32_t max_wait;                      ///< Ticks a ball may wait, or 0
+    bool gate_open;                         ///< True while balls may be fed
+    void (*p_gate) (bool open, void* p_context);  ///< Opens or shuts feeder
+    void* p_gate_context;                   ///< Passed to the gate function
+    uint32_t num_dropped;                   ///< Balls lost to a full queue
+    uint32_t num_late;                      ///< Balls which waited too long
+    uint32_t num_gate_closes;               ///< Times the feeder was stopped
+
+    // Take the oldest ball which can still be sorted in time
+    bool take_in_time (uint8_t& bin, bool& open_gate);
+
+    // Tell the feeder whether to feed balls
+    void signal_gate (bool open);
+
+public:
+    /// Awaitable which gives the bin of the next classified ball
+    struct SampleAwaiter
+    {
+        BallSensor& sensor;                 ///< The sensor waited on
+        uint8_t bin;                        ///< The ball's bin, once known
+
+        /// Don't suspend if a ball is already waiting
+        bool await_ready (void)
+        {
+            return sensor.take (bin);
+        }
+
+        // Wait for a ball unless one arrived just now
+        bool await_suspend (std::coroutine_handle<> handle);
+
+        /// Return the ball's bin
+        uint8_t await_resume (void) const
+        {
+            return bin;
+        }
+    };
+
+    // Create a ball sensor whose coroutines run in the given scheduler
+    BallSensor (const char* p_name, CoScheduler& a_scheduler);
+
+    // Set the queue lengths at which the feeder is stopped and restarted
+    bool set_watermarks (uint8_t high, uint8_t low);
+
+    /** @brief   Set how long a ball may wait before it's too late to sort.
+     *  @param   ticks The longest wait, or 0 to sort every ball however late
+     */
+    void set_max_wait (uint32_t ticks)
+    {
+        max_wait = ticks;
+    }
+
+    /** @brief   Set a function which stops and starts the feeder.
+     *  @details The function is called with @c false when the queue reaches
+     *           the high watermark and @c true when it has drained to the low
+     *           watermark. It may be called from any task which delivers or
+     *           takes balls.
+     *  @param   a_p_gate The function, or @c NULL for none
+     *  @param   a_p_context A pointer given to the function
+     */
+    void set_gate (void (*a_p_gate) (bool, void*), void* a_p_context)
+    {
+        p_gate = a_p_gate;
+        p_gate_context = a_p_context;
+    }
+
+    /** @brief   Make an awaitable which gives the bin of the next ball.
+     *  @return  The awaitable, for use with @c co_await
+     */
+    SampleAwaiter sample (void)
+    {
+        return SampleAwaiter {*this, 0};
+    }
+
+    // Take the oldest ball no one was waiting for
+    bool take (uint8_t& bin);
+
+    // Hand a classified ball to a waiting coroutine, or keep it for later
+    bool deliver (uint8_t bin, uint32_t now);
+
+    /// Return true if the feeder may feed balls
+    bool is_gate_open (void) const
+    {
+        return gate_open;
+    }
+
+    /// Return the number of balls lost because the queue was full
+    uint32_t get_num_dropped (void) const
+    {
+        return num_dropped;
+    }
+
+    /// Return the number of balls rejected because they waited too long
+    uint32_t get_num_late (void) const
+    {
+        return num_late;
+    }
+
+    // Print the queue and the feeder gate within the list of shares
+    void print_in_list (Print& printer);
+};
+
+
+/** @brief   Class which passes turntable moves to the stepper motor task.
+ *  @details The table has a number of sections spaced evenly around it; a
+ *           move turns the table forwards to a section. Moves are done one at
+ *           a time in the order asked for. The stepper task calls
+ *           @c get_move() to find the next move and @c move_done() once the
+ *           motor has made it.
+ */
+class Turntable
+{
+protected:
+    /// A coroutine waiting for a move and where to
+    struct Waiter
+    {
+        std::coroutine_handle<> handle;     ///< The coroutine
+        uint8_t section;                    ///< The section to move to
+    };
+
+    CoScheduler& scheduler;                 ///< Resumes the waiting ones
+    uint16_t steps_per_rev;                 ///< Motor steps per revolution
+    uint8_t num_sections;                   ///< Sections around the table
+    uint16_t position;                      ///< Steps forward from section 0
+    uint32_t odometer;                      ///< Steps made since the start
+    uint16_t move_steps;                    ///< Steps in the move being made
+    bool moving;                            ///< True while the motor moves
+    Waiter waiters[CO_MAX_TASKS];           ///< Moves asked for, in order
+    uint8_t num_waiters;                    ///< Number of moves asked for
+
+public:
+    /// Awaitable which turns the table to a section
+    struct MoveAwaiter
+    {
+        Turntable& table;                   ///< The table which is moved
+        uint8_t section;                    ///< The section to move to
+        bool queued;                        ///< True if the move was queued
+
+        /// Don't suspend if the table is already at the section
+        bool await_ready (void) const
+        {
+            return table.at (section);
+        }
+
+        // Ask for the move and wait for it
+        bool await_suspend (std::coroutine_handle<> handle);
+
+        /// Return true if the table is at the section
+        bool await_resume (void) const
+        {
+            return queued || table.at (section);
+        }
+    };
+
+    // Create a turntable whose coroutines run in the given scheduler
+    Turntable (CoScheduler& a_scheduler, uint16_t a_steps_per_rev,
+               uint8_t a_num_sections);
+
+    /** @brief   Make an awaitable which turns the table to a section.
+     *  @param   section The section, numbered forwards from 0
+     *  @return  The awaitable, for use with @c co_await; it gives true if the
+     *           table got there, false if the move couldn't be queued
+     */
+    MoveAwaiter move_to (uint8_t section)
+    {
+        return MoveAwaiter {*this, (uint8_t)(section % num_sections), false};
+    }
+
+    // Find the position of a section in steps forward from section 0
+    uint16_t section_position (uint8_t section) const;
+
+    // Find how many steps forwards it is from here to a section
+    uint16_t steps_to (uint8_t section) const;
+
+    /// Return true if the table is at a section and not moving
+    bool at (uint8_t section) const
+    {
+        return !moving && position == section_position (section);
+    }
+
+    /// Return true if the table isn't moving and no moves are waiting
+    bool is_at_rest (void) const
+    {
+        return !moving && num_waiters == 0;
+    }
+
+    // Get the next move for the stepper motor task to make
+    bool get_move (uint16_t& steps);
+
+    // Note that the stepper motor task has made the move
+    void move_done (void);
+
+    /// Return the table's position in steps forward from section 0
+    uint16_t get_position (void) const
+    {
+        return position;
+    }
+
+    /// Return the number of steps made, up to the end of the last move
+    uint32_t get_odometer (void) const
+    {
+        return odometer;
+    }
+};
+
+
+/** @brief   Class which turns the solenoids on and off.
+ *  @details The solenoids aren't awaited; the ejection scheduler times their
+ *           pulses from the table's position and switches them with
+ *           @c set(). Several solenoids may be switched together.
+ */
+class SolenoidBank
+{
+protected:
+    const uint8_t* p_pins;                  ///< Output pin of each solenoid
+    uint8_t num_channels;                   ///< Number of solenoids
+
+public:
+    // Create a bank of solenoids on the given pins
+    SolenoidBank (const uint8_t* a_p_pins, uint8_t a_num_channels);
+
+    // Turn solenoids on or off at once
+    void set (uint8_t mask, bool on);
+};
+
+#endif // _SORTDEVICES_H_
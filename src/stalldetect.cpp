@@ -0,0 +1,314 @@
+//*****************************************************************************
+/** @file    stalldetect.cpp
+ *  @brief   Source code of the turntable stall detector.
+ *  @details This file contains the methods of class @c StallDetector.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <PrintStream.h>
+#include "stalldetect.h"                    // Header for this class
+
+
+/// Scale of the brightness kept for the empty slot, per unit of sensitivity
+#define STALL_BACKGROUND_SCALE 64
+
+
+/** @brief   Create a detector for a table with the given steps per
+ *           revolution.
+ *  @details The detector starts with no index fitted and no stall.
+ *  @param   p_name A name for the detector, used when it's printed
+ *  @param   a_steps_per_rev The number of motor steps in one turn of the
+ *           table
+ *  @param   a_tolerance The steps by which the index may be off without it
+ *           being made up
+ *  @param   a_resync_limit The steps by which the index may be off without
+ *           it counting as a stall
+ */
+StallDetector::StallDetector (const char* p_name, uint16_t a_steps_per_rev,
+                              uint16_t a_tolerance, uint16_t a_resync_limit)
+    : BaseShare (p_name)
+{
+    steps_per_rev = a_steps_per_rev ? a_steps_per_rev : 1;
+    tolerance = a_tolerance;
+    resync_limit = a_resync_limit;
+    use_index = false;
+    index_level = false;
+    index_found = false;
+    index_position = 0;
+    index_count = 0;
+    last_count = 0;
+    background = 0;
+    background_sum = 0;
+    num_learned = 0;
+    num_outside = 0;
+    cause = STALL_NONE;
+    error = 0;
+    last_error = 0;
+    worst_error = 0;
+    resync = 0;
+    num_revs = 0;
+    num_resyncs = 0;
+    num_stalls = 0;
+    p_handler = NULL;
+    p_handler_context = NULL;
+}
+
+
+/** @brief   Check the index after a step; return true if a stall was just
+ *           found.
+ *  @details The index is seen when its input becomes active. The position,
+ *           which is the step count within a revolution, is compared with
+ *           the index's position; the table is behind by the difference,
+ *           less any steps which are still to be made up from the last
+ *           time. If a revolution and a half go by
+ *           without the index, the table isn't turning; a table which has
+ *           only missed some steps would have reached it by then.
+ *           Nothing is checked while a stall is waiting to be cleared.
+ *  @param   count The number of steps the motor has made since the start
+ *  @param   index True if the index input is active
+ *  @return  True if this step showed a stall, false if not
+ */
+bool StallDetector::step (uint32_t count, bool index)
+{
+    bool edge = index && !index_level;
+
+    index_level = index;
+    last_count = count;
+    if (!use_index || cause != STALL_NONE)
+    {
+        return false;
+    }
+
+    if (!edge)
+    {
+        if (count - index_count > (uint32_t)steps_per_rev * 3 / 2)
+        {
+            stall (STALL_NO_INDEX, 0);
+            return true;
+        }
+        return false;
+    }
+
+    uint16_t position = count % steps_per_rev;
+    index_count = count;
+    if (!index_found)
+    {
+        index_found = true;
+        index_position = position;
+        return false;
+    }
+
+    // The difference, taken the shorter way round the table
+    int32_t diff = (int32_t)position - index_position - resync;
+    if (diff >= steps_per_rev / 2)
+    {
+        diff -= steps_per_rev;
+    }
+    else if (diff < -(int32_t)(steps_per_rev / 2))
+    {
+        diff += steps_per_rev;
+    }
+    num_revs++;
+    last_error = (int16_t)diff;
+    if (abs (last_error) > abs (worst_error))
+    {
+        worst_error = last_error;
+    }
+    if (abs (last_error) > resync_limit)
+    {
+        stall (STALL_INDEX, last_error);
+        return true;
+    }
+    if (abs (last_error) > tolerance)
+    {
+        resync += last_error;
+        num_resyncs++;
+    }
+    return false;
+}
+
+
+/** @brief   Learn or check the color sensor's reading of the empty slot.
+ *  @details Call this only while the table is at rest with no ball at the
+ *           sensor. The brightness is scaled by the sensor's sensitivity so
+ *           that readings taken with different settings can be compared.
+ *           The first few readings after the table is known to be in line
+ *           are averaged. A later reading more than a quarter away from the
+ *           average may mean the sensor is looking at something other than
+ *           the slot; if several in a row are, the table has stalled. One
+ *           odd reading, as of a ball dropping in, isn't enough. Readings
+ *           near the average move it an eighth of the way towards them.
+ *  @param   clear The clear count, less the dark offset
+ *  @param   sensitivity The sensor's gain times its integration cycles
+ *  @return  True if this reading showed a stall, false if not
+ */
+bool StallDetector::check_background (uint16_t clear, uint16_t sensitivity)
+{
+    if (sensitivity == 0 || cause != STALL_NONE)
+    {
+        return false;
+    }
+
+    uint32_t level = (uint32_t)clear * STALL_BACKGROUND_SCALE / sensitivity;
+    if (num_learned < STALL_LEARN_SAMPLES)
+    {
+        background_sum += level;
+        if (++num_learned == STALL_LEARN_SAMPLES)
+        {
+            background = background_sum / STALL_LEARN_SAMPLES;
+        }
+        return false;
+    }
+
+    uint32_t band = background / 4 + STALL_BACKGROUND_SCALE / 4;
+    if (level + band < background || level > background + band)
+    {
+        if (++num_outside >= STALL_BACKGROUND_CONFIRM)
+        {
+            stall (STALL_BACKGROUND, 0);
+            return true;
+        }
+        return false;
+    }
+    num_outside = 0;
+    background = (background * 7 + level) / 8;
+    return false;
+}
+
+
+/** @brief   Find whether to make a step up before the next counted step.
+ *  @details The stepper motor task calls this each time a step is due while
+ *           the table is moving. Steps still to be made up are allowed for
+ *           when the index is next seen.
+ *  @return  1 if the table is behind, so an extra step should be made
+ *           without counting it; -1 if it's ahead, so the step should be
+ *           counted without being made; 0 to make and count it as usual
+ */
+int8_t StallDetector::resync_step (void)
+{
+    if (resync > 0)
+    {
+        resync--;
+        return 1;
+    }
+    if (resync < 0)
+    {
+        resync++;
+        return -1;
+    }
+    return 0;
+}
+
+
+/** @brief   Stop the sorter until the table has been homed.
+ *  @details This is done at startup and when the console asks for it. If
+ *           the table has already stalled, the stall's cause is kept.
+ */
+void StallDetector::need_homing (void)
+{
+    bool stalled;
+
+    CO_ENTER_CRITICAL ();
+    stalled = (cause != STALL_NONE);
+    if (!stalled)
+    {
+        error = 0;
+        cause = STALL_NOT_HOMED;
+    }
+    CO_EXIT_CRITICAL ();
+
+    if (!stalled && p_handler != NULL)
+    {
+        p_handler (STALL_NOT_HOMED, 0, p_handler_context);
+    }
+}
+
+
+/** @brief   Note that homing has put the table back in line.
+ *  @details From now on the index is compared with where homing found it,
+ *           and the stall is cleared.
+ *  @param   a_index_position The position of the index edge, in steps
+ *           forward from section 0
+ *  @param   index True if the index input is active now
+ */
+void StallDetector::homed (uint16_t a_index_position, bool index)
+{
+    index_found = true;
+    index_position = a_index_position % steps_per_rev;
+    index_level = index;
+    resync = 0;
+    clear ();
+}
+
+
+/** @brief   Forget a stall once the table is back in line.
+ *  @details The table has a revolution from the last step to reach the
+ *           index again. The empty slot's brightness is learned again, as
+ *           the one learned before may have been of the table's rim. This
+ *           may be called from a task other than the one which calls
+ *           @c step().
+ */
+void StallDetector::clear (void)
+{
+    bool was_stalled;
+
+    CO_ENTER_CRITICAL ();
+    was_stalled = (cause != STALL_NONE);
+    index_count = last_count;
+    error = 0;
+    background_sum = 0;
+    num_learned = 0;
+    num_outside = 0;
+    cause = STALL_NONE;
+    CO_EXIT_CRITICAL ();
+
+    if (was_stalled && p_handler != NULL)
+    {
+        p_handler (STALL_NONE, 0, p_handler_context);
+    }
+}
+
+
+/** @brief   Note that the table isn't where it should be.
+ *  @param   a_cause What showed the stall
+ *  @param   an_error The steps by which the table is behind, if known
+ */
+void StallDetector::stall (StallCause a_cause, int16_t an_error)
+{
+    error = an_error;
+    cause = a_cause;
+    num_stalls++;
+    if (p_handler != NULL)
+    {
+        p_handler (a_cause, an_error, p_handler_context);
+    }
+}
+
+
+/** @brief   Print the checks and stalls within the list of shares.
+ *  @param   printer Reference to a serial device on which to print
+ */
+void StallDetector::print_in_list (Print& printer)
+{
+    static const char* cause_names[] = {"in line", "index off", "no index",
+                                        "wrong background", "not homed"};
+
+    // Print this detector's name and pad it to 16 characters
+    printer.printf ("%-16sstall\t", name);
+    printer << cause_names[cause] << ", " << num_stalls << " stalls";
+    if (use_index)
+    {
+        printer << ", " << num_revs << " turns checked, last " << last_error
+                << " worst " << worst_error << " steps, " << num_resyncs
+                << " made up";
+    }
+    printer << endl;
+
+    // Call the next item
+    if (p_next != NULL)
+    {
+        p_next->print_in_list (printer);
+    }
+}
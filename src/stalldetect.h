@@ -0,0 +1,204 @@
+//*****************************************************************************
+/** @file    stalldetect.h
+ *  @brief   Checks that the turntable is where the stepper motor put it.
+ *  @details The stepper motor runs open loop, so a move counts as done even
+ *           if the table jammed or the motor missed steps, and every ball
+ *           after that goes to the wrong bin. This file contains a detector
+ *           which compares where the table should be with where it's seen to
+ *           be, in two ways:
+ *           - An index sensor, a limit switch or an optical flag, is passed
+ *             once each revolution. The table's position when the index is
+ *             seen should be the same each time; a difference is the number
+ *             of steps missed since. A small difference is made up on the
+ *             fly, without stopping. If the motor makes a revolution and a
+ *             half of steps without the index being seen, the table isn't
+ *             turning.
+ *           - With no ball at the color sensor, the sensor sees the empty
+ *             slot. If the table is out of line it sees the table's rim
+ *             instead, which is a different brightness.
+ *
+ *           A stall stops the sorter until the table has been brought back
+ *           into line, by homing it if there's an index. Step counts and readings are given to the detector
+ *           rather than read from the hardware, so it can be run with a
+ *           simulated table.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _STALLDETECT_H_
+#define _STALLDETECT_H_
+
+#include <Arduino.h>
+#include "baseshare.h"                      // Base class for shared data items
+#include "coscheduler.h"                    // For the critical section macros
+
+
+/// Default steps by which the index may be off before it's made up
+#define STALL_TOLERANCE 2
+
+/// Default steps by which the index may be off before it counts as a stall
+#define STALL_RESYNC_LIMIT 40
+
+/// Readings of the empty slot averaged to learn its brightness
+#define STALL_LEARN_SAMPLES 4
+
+/// Readings in a row which must differ from the empty slot for a stall
+#define STALL_BACKGROUND_CONFIRM 3
+
+
+/// What showed that the table isn't where it should be
+enum StallCause
+{
+    STALL_NONE,                             ///< The table is in line
+    STALL_INDEX,                            ///< Index seen at the wrong step
+    STALL_NO_INDEX,                         ///< Index not seen in a turn
+    STALL_BACKGROUND,                       ///< Color sensor saw the rim
+    STALL_NOT_HOMED                         ///< Table needs to be homed
+};
+
+
+/** @brief   Class which detects a stalled or slipping turntable.
+ *  @details The stepper motor task calls @c step() after each step with its
+ *           count of steps made and the state of the index input. Each time
+ *           the index is seen, the position at which it was seen is compared
+ *           with the index's position, which is found by homing the table or,
+ *           if it hasn't been homed, is where the index was first seen.
+ *           Differences larger than the tolerance and up to the resync limit
+ *           are made up a step at a time as the table moves, as
+ *           @c resync_step() tells the stepper motor task; larger ones are
+ *           stalls. The color
+ *           sensor task calls @c check_background() with readings of the
+ *           empty slot while the table is at rest. The first few after the
+ *           table is known to be in line, when the detector is made, homed
+ *           or cleared, are averaged to learn the slot's brightness; later
+ *           ones are compared with it, and those which match it keep it up
+ *           to date as the lighting drifts.
+ *
+ *           Once a stall is found it's kept until @c clear() is called. A
+ *           function given to @c set_stall_handler() is called when it's
+ *           found and when it's cleared, from the task which did so.
+ */
+class StallDetector : public BaseShare
+{
+protected:
+    uint16_t steps_per_rev;                 ///< Motor steps per revolution
+    uint16_t tolerance;                     ///< Steps the index may be off
+    uint16_t resync_limit;                  ///< Most steps made up on the fly
+    bool use_index;                         ///< True if there's an index
+    bool index_level;                       ///< Index input at the last step
+    bool index_found;                       ///< True once it's been seen
+    uint16_t index_position;                ///< Position it's first seen at
+    uint32_t index_count;                   ///< Step count when last seen
+    uint32_t last_count;                    ///< Step count at the last step
+    uint32_t background;                    ///< Empty slot's brightness
+    uint32_t background_sum;                ///< Readings summed to learn it
+    uint8_t num_learned;                    ///< Readings summed so far
+    uint8_t num_outside;                    ///< Readings in a row unlike it
+    volatile StallCause cause;              ///< Why the table is stalled
+    int16_t error;                          ///< Steps off at the stall
+    int16_t last_error;                     ///< Steps off at the last index
+    int16_t worst_error;                    ///< Most steps off at the index
+    int16_t resync;                         ///< Steps to be made up
+    uint32_t num_revs;                      ///< Times the index was checked
+    uint32_t num_resyncs;                   ///< Times steps were made up
+    uint32_t num_stalls;                    ///< Stalls found
+
+    /// Function called when a stall is found or cleared
+    void (*p_handler) (StallCause cause, int16_t error, void* p_context);
+    void* p_handler_context;                ///< Passed to the handler
+
+    // Note that the table isn't where it should be
+    void stall (StallCause a_cause, int16_t an_error);
+
+public:
+    // Create a detector for a table with the given steps per revolution
+    StallDetector (const char* p_name, uint16_t a_steps_per_rev,
+                   uint16_t a_tolerance = STALL_TOLERANCE,
+                   uint16_t a_resync_limit = STALL_RESYNC_LIMIT);
+
+    /** @brief   Say whether the table has an index sensor.
+     *  @details Without one, stalls can only be found by the color sensor.
+     *  @param   fitted True if the index is fitted
+     */
+    void set_index (bool fitted)
+    {
+        use_index = fitted;
+    }
+
+    /// Return true if the table has an index sensor
+    bool has_index (void) const
+    {
+        return use_index;
+    }
+
+    /** @brief   Set a function which is told when a stall is found or
+     *           cleared.
+     *  @details The function is given @c STALL_NONE when a stall is cleared.
+     *  @param   a_p_handler The function, or @c NULL for none
+     *  @param   a_p_context A pointer given to the function
+     */
+    void set_stall_handler (void (*a_p_handler) (StallCause cause,
+                                                 int16_t error,
+                                                 void* p_context),
+                            void* a_p_context)
+    {
+        p_handler = a_p_handler;
+        p_handler_context = a_p_context;
+    }
+
+    // Check the index after a step; return true if a stall was just found
+    bool step (uint32_t count, bool index);
+
+    // Learn or check the color sensor's reading of the empty slot
+    bool check_background (uint16_t clear, uint16_t sensitivity);
+
+    // Find whether to make a step up before the next counted step
+    int8_t resync_step (void);
+
+    // Stop the sorter until the table has been homed
+    void need_homing (void);
+
+    // Note that homing has put the table back in line
+    void homed (uint16_t a_index_position, bool index);
+
+    // Forget a stall once the table is back in line
+    void clear (void);
+
+    /// Return why the table is stalled, or @c STALL_NONE if it isn't
+    StallCause get_cause (void) const
+    {
+        return cause;
+    }
+
+    /// Return true if a stall has been found and not cleared
+    bool is_stalled (void) const
+    {
+        return cause != STALL_NONE;
+    }
+
+    /// Return the steps by which the table was off when the index was last
+    /// seen, positive if it was behind
+    int16_t get_last_error (void) const
+    {
+        return last_error;
+    }
+
+    /// Return the number of times steps were made up on the fly
+    uint32_t get_num_resyncs (void) const
+    {
+        return num_resyncs;
+    }
+
+    /// Return the number of stalls found
+    uint32_t get_num_stalls (void) const
+    {
+        return num_stalls;
+    }
+
+    // Print the checks and stalls within the list of shares
+    void print_in_list (Print& printer);
+};
+
+#endif // _STALLDETECT_H_
@@ -0,0 +1,120 @@
+//*****************************************************************************
+/** @file    taskmonitor.cpp
+ *  @brief   Source code of the stack and CPU usage monitor for RTOS tasks.
+ *  @details This file contains the methods of class @c TaskMonitor, which
+ *           samples the stack high water mark and run time counter of each
+ *           registered task and prints them in the list of shared data items.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include "taskmonitor.h"                    // Header for this class
+#include "taskusage.h"                      // Stack and CPU use arithmetic
+#include "task.h"                           // FreeRTOS task functions
+
+
+/** @brief   Create an empty task monitor.
+ *  @details The monitor is installed in the list of shared data items so that
+ *           its statistics are printed by @c print_all_shares().
+ *  @param   p_name The name for the monitor as shown in the list of shares
+ */
+TaskMonitor::TaskMonitor (const char* p_name)
+    : BaseShare (p_name)
+{
+    num_tasks = 0;
+    last_total_time = 0;
+}
+
+
+/** @brief   Add a task which has been created to the list of monitored tasks.
+ *  @param   handle The handle filled in by @c xTaskCreate() for the task
+ *  @param   stack_size The stack size, in words, which was given to
+ *           @c xTaskCreate() for the task
+ *  @return  True if the task was added, false if the list is full or the
+ *           handle is @c NULL because the task couldn't be created
+ */
+bool TaskMonitor::add (TaskHandle_t handle, uint16_t stack_size)
+{
+    if (handle == NULL || num_tasks >= TASKMON_MAX_TASKS)
+    {
+        return false;
+    }
+
+    TaskStats& stats = tasks[num_tasks];
+    stats.handle = handle;
+    stats.stack_size = stack_size;
+    stats.min_free = stack_size;
+    stats.last_run_time = 0;
+    stats.cpu_percent = 0;
+
+    portENTER_CRITICAL ();
+    num_tasks++;
+    portEXIT_CRITICAL ();
+
+    return true;
+}
+
+
+/** @brief   Take a new sample of the stack and CPU usage of every task.
+ *  @details This method should be called from a low priority task every few
+ *           seconds. The CPU usage of each task is computed over the time
+ *           since the previous call.
+ */
+void TaskMonitor::sample (void)
+{
+#if (configGENERATE_RUN_TIME_STATS == 1) && (configUSE_TRACE_FACILITY == 1)
+    uint32_t total_time = portGET_RUN_TIME_COUNTER_VALUE ();
+    uint32_t total_delta = total_time - last_total_time;
+    last_total_time = total_time;
+#endif
+
+    for (uint8_t index = 0; index < num_tasks; index++)
+    {
+        TaskStats& stats = tasks[index];
+
+        // The high water mark is the least free stack since the task started
+        stats.min_free = uxTaskGetStackHighWaterMark (stats.handle);
+
+#if (configGENERATE_RUN_TIME_STATS == 1) && (configUSE_TRACE_FACILITY == 1)
+        TaskStatus_t status;
+        vTaskGetInfo (stats.handle, &status, pdFALSE, eInvalid);
+        stats.cpu_percent = task_cpu_percent (status.ulRunTimeCounter
+                                              - stats.last_run_time,
+                                              total_delta);
+        stats.last_run_time = status.ulRunTimeCounter;
+#endif
+    }
+}
+
+
+/** @brief   Print the statistics of each monitored task in the list of shares.
+ *  @details Each task gets a line showing its name, the least free stack it
+ *           has had and its stack size, the percentage of the stack used, and
+ *           its CPU use during the most recent sampling interval. Then this
+ *           method calls the same method for the next shared data item.
+ *  @param   printer Reference to a serial device on which to print
+ */
+void TaskMonitor::print_in_list (Print& printer)
+{
+#if (configGENERATE_RUN_TIME_STATS == 1) && (configUSE_TRACE_FACILITY == 1)
+    const bool show_cpu = true;
+#else
+    const bool show_cpu = false;
+#endif
+
+    for (uint8_t index = 0; index < num_tasks; index++)
+    {
+        const TaskStats& stats = tasks[index];
+
+        print_task_usage (printer, pcTaskGetName (stats.handle),
+                          stats.min_free, stats.stack_size, show_cpu,
+                          stats.cpu_percent);
+    }
+
+    // Call the next item
+    if (p_next != NULL)
+    {
+        p_next->print_in_list (printer);
+    }
+}
@@ -0,0 +1,91 @@
+//*****************************************************************************
+/** @file    taskmonitor.h
+ *  @brief   Stack and CPU usage monitor for the color sorter's RTOS tasks.
+ *  @details This file contains a class which keeps a list of the tasks that
+ *           were created in @c setup() and periodically samples how much of
+ *           each task's stack has never been used (the FreeRTOS stack "high
+ *           water mark") and, when FreeRTOS run time statistics are enabled,
+ *           what fraction of the CPU each task has used since the previous
+ *           sample. The monitor is a @c BaseShare, so its figures are printed
+ *           along with the shares and queues by @c print_all_shares().
+ *
+ *           CPU usage figures need @c configGENERATE_RUN_TIME_STATS and
+ *           @c configUSE_TRACE_FACILITY set in the FreeRTOS configuration;
+ *           without them only the stack figures are reported.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _TASKMONITOR_H_
+#define _TASKMONITOR_H_
+
+#include <Arduino.h>
+#include "FreeRTOS.h"                       // Main header for FreeRTOS
+#include "baseshare.h"                      // Base class for shared data items
+
+
+/// The largest number of tasks which can be registered with a monitor
+#define TASKMON_MAX_TASKS 8
+
+
+/** @brief   Statistics kept by a @c TaskMonitor for one task.
+ *  @details The figures in this structure are updated each time the monitor's
+ *           @c sample() method runs. Stack sizes are in words, as they are
+ *           given to @c xTaskCreate().
+ */
+struct TaskStats
+{
+    TaskHandle_t handle;                    ///< Handle of the monitored task
+    uint16_t stack_size;                    ///< Stack size given at creation
+    uint16_t min_free;                      ///< Least free stack ever seen
+    uint32_t last_run_time;                 ///< Run time counter at last sample
+    uint8_t cpu_percent;                    ///< CPU use during last interval
+};
+
+
+/** @brief   Class which samples stack and CPU use of a set of RTOS tasks.
+ *  @details Tasks are added to the monitor with @c add() after they have been
+ *           created. A low priority task should then call @c sample() every
+ *           few seconds; @c print_all_shares() will show the latest figures.
+ *           The arithmetic and printing are done by the functions in
+ *           @c taskusage.h so that they can be checked without an RTOS.
+ */
+class TaskMonitor : public BaseShare
+{
+protected:
+    TaskStats tasks[TASKMON_MAX_TASKS];     ///< Statistics for each task
+    uint8_t num_tasks;                      ///< How many tasks are registered
+    uint32_t last_total_time;               ///< Total run time at last sample
+
+public:
+    // Create an empty task monitor
+    TaskMonitor (const char* p_name = NULL);
+
+    // Add a task which has been created to the list of monitored tasks
+    bool add (TaskHandle_t handle, uint16_t stack_size);
+
+    // Take a new sample of the stack and CPU usage of every monitored task
+    void sample (void);
+
+    /** @brief   Get the statistics for one of the monitored tasks.
+     *  @param   index The number of the task, in the order tasks were added
+     *  @return  A pointer to the statistics, or @c NULL if there's no such task
+     */
+    const TaskStats* get_stats (uint8_t index) const
+    {
+        return (index < num_tasks) ? &tasks[index] : NULL;
+    }
+
+    /// Return the number of tasks registered with this monitor
+    uint8_t get_num_tasks (void) const
+    {
+        return num_tasks;
+    }
+
+    // Print the statistics of each monitored task within the list of shares
+    void print_in_list (Print& printer);
+};
+
+#endif // _TASKMONITOR_H_
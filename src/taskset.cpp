@@ -0,0 +1,175 @@
+//*****************************************************************************
+/** @file    taskset.cpp
+ *  @brief   Source code of the rate monotonic task set analysis.
+ *  @details This file contains the methods of class @c TaskSet.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <PrintStream.h>
+#include "taskset.h"                        // Header for this class
+
+
+/** @brief   Create an empty task set.
+ *  @param   p_name A name for the task set, used when it's printed
+ */
+TaskSet::TaskSet (const char* p_name)
+    : BaseShare (p_name)
+{
+    num_tasks = 0;
+}
+
+
+/** @brief   Describe a task.
+ *  @param   p_name A name for the task; the string must stay in existence
+ *  @param   period The shortest time between releases of the task, in us
+ *  @param   wcet An estimate of the task's worst case execution time, in us
+ *  @param   deadline The time after release by which the task must finish,
+ *           in us, or zero if the deadline is the period
+ *  @return  The number of the task, or -1 if there's no more room
+ */
+int8_t TaskSet::add (const char* p_name, uint32_t period, uint32_t wcet,
+                     uint32_t deadline)
+{
+    if (num_tasks >= TASKSET_MAX_TASKS || period == 0)
+    {
+        return -1;
+    }
+
+    TaskTiming& task = tasks[num_tasks];
+    task.p_name = p_name;
+    task.period = period;
+    task.wcet = wcet;
+    task.deadline = (deadline != 0) ? deadline : period;
+    task.priority = 0;
+    task.response = 0;
+    task.schedulable = false;
+    return num_tasks++;
+}
+
+
+/** @brief   Give priorities in deadline monotonic order.
+ *  @details The task with the longest deadline gets the lowest priority and
+ *           each shorter deadline gets a priority one higher. Tasks with
+ *           equal deadlines share a priority.
+ *  @param   lowest The priority given to the task with the longest deadline
+ */
+void TaskSet::assign_priorities (TaskPriority lowest)
+{
+    for (uint8_t index = 0; index < num_tasks; index++)
+    {
+        // Count the distinct deadlines which are longer than this one
+        TaskPriority longer = 0;
+        for (uint8_t other = 0; other < num_tasks; other++)
+        {
+            if (tasks[other].deadline <= tasks[index].deadline)
+            {
+                continue;
+            }
+            bool first = true;
+            for (uint8_t seen = 0; seen < other; seen++)
+            {
+                if (tasks[seen].deadline == tasks[other].deadline)
+                {
+                    first = false;
+                    break;
+                }
+            }
+            if (first)
+            {
+                longer++;
+            }
+        }
+        tasks[index].priority = lowest + longer;
+    }
+}
+
+
+/** @brief   Use a measured execution time if it's longer than the estimate.
+ *  @param   index The number of the task
+ *  @param   measured The longest execution time measured so far, in us
+ */
+void TaskSet::update_wcet (uint8_t index, uint32_t measured)
+{
+    if (index < num_tasks && measured > tasks[index].wcet)
+    {
+        tasks[index].wcet = measured;
+    }
+}
+
+
+/** @brief   Find the worst case response time of one task.
+ *  @details The time is that of the task's own execution plus preemption by
+ *           every task of equal or higher priority which is released during
+ *           it. The iteration stops once the time passes the deadline.
+ *  @param   index The number of the task
+ *  @return  The worst case response time in us; it's larger than the deadline
+ *           if the task can miss its deadline
+ */
+uint32_t TaskSet::response_time (uint8_t index) const
+{
+    const TaskTiming& task = tasks[index];
+    uint64_t response = task.wcet;
+    uint64_t previous = 0;
+
+    while (response != previous && response <= task.deadline)
+    {
+        previous = response;
+        response = task.wcet;
+        for (uint8_t other = 0; other < num_tasks; other++)
+        {
+            if (other != index && tasks[other].priority >= task.priority)
+            {
+                uint64_t releases = (previous + tasks[other].period - 1)
+                                    / tasks[other].period;
+                response += releases * tasks[other].wcet;
+            }
+        }
+    }
+    return (response > UINT32_MAX) ? UINT32_MAX : (uint32_t)response;
+}
+
+
+/** @brief   Find every task's worst case response time.
+ *  @return  True if every task meets its deadline, false if any can miss it
+ */
+bool TaskSet::analyze (void)
+{
+    bool all_ok = true;
+
+    for (uint8_t index = 0; index < num_tasks; index++)
+    {
+        tasks[index].response = response_time (index);
+        tasks[index].schedulable = (tasks[index].response
+                                    <= tasks[index].deadline);
+        all_ok = all_ok && tasks[index].schedulable;
+    }
+    return all_ok;
+}
+
+
+/** @brief   Print each task's response time within the list of shares.
+ *  @details Times are shown in microseconds, from the latest @c analyze().
+ *  @param   printer Reference to a serial device on which to print
+ */
+void TaskSet::print_in_list (Print& printer)
+{
+    for (uint8_t index = 0; index < num_tasks; index++)
+    {
+        const TaskTiming& task = tasks[index];
+
+        // Print the task's name, trimmed or padded to 16 characters
+        printer.printf ("%-16.16srta\t", task.p_name);
+        printer << "prio " << task.priority << ", T " << task.period
+                << ", C " << task.wcet << ", D " << task.deadline << ", R "
+                << task.response << " us"
+                << (task.schedulable ? "" : " MISSES DEADLINE") << endl;
+    }
+
+    // Call the next item
+    if (p_next != NULL)
+    {
+        p_next->print_in_list (printer);
+    }
+}
@@ -0,0 +1,121 @@
+//*****************************************************************************
+/** @file    taskset.h
+ *  @brief   Rate monotonic priorities and response time analysis for tasks.
+ *  @details This file contains a description of the color sorter's task set,
+ *           each task's period, worst case execution time (WCET) and deadline,
+ *           from which RTOS priorities are worked out and the schedule checked.
+ *
+ *           Priorities are given in deadline monotonic order: the shorter a
+ *           task's deadline, the higher its priority. When every deadline
+ *           equals the period, as it does unless one is given, this is rate
+ *           monotonic order. The worst case response time of each task is
+ *           found with the usual response time analysis,
+ *           @f$ R = C_i + \sum_{j \in hp(i)} \lceil R / T_j \rceil C_j @f$,
+ *           iterated until it settles or passes the deadline. Tasks of equal
+ *           priority are counted as interfering with each other, since
+ *           FreeRTOS time slices between them.
+ *
+ *           The WCETs start out as estimates. Measured execution times, such
+ *           as those kept by @c PeriodicTask, can be given to the task set as
+ *           the program runs; the larger of the estimate and the measurement
+ *           is used. The task set is a @c BaseShare, so the response times are
+ *           printed by @c print_all_shares().
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _TASKSET_H_
+#define _TASKSET_H_
+
+#include <Arduino.h>
+#include "baseshare.h"                      // Base class for shared data items
+
+// Under the RTOS, priorities are RTOS priorities; on a PC, where the analysis
+// is tested, they're plain numbers
+#ifdef ARDUINO
+    #include "FreeRTOS.h"                   // Main header for FreeRTOS
+    typedef UBaseType_t TaskPriority;
+#else
+    typedef uint32_t TaskPriority;
+#endif
+
+
+/// The largest number of tasks which can be described in a task set
+#define TASKSET_MAX_TASKS 8
+
+
+/** @brief   Timing of one task in a task set.
+ *  @details All times are in microseconds.
+ */
+struct TaskTiming
+{
+    const char* p_name;                     ///< Name shown in the report
+    uint32_t period;                        ///< Shortest time between releases
+    uint32_t wcet;                          ///< Worst case execution time
+    uint32_t deadline;                      ///< Time allowed after release
+    TaskPriority priority;                  ///< RTOS priority assigned
+    uint32_t response;                      ///< Worst case response time
+    bool schedulable;                       ///< True if response <= deadline
+};
+
+
+/** @brief   Class which assigns priorities to a set of tasks and checks that
+ *           they all meet their deadlines.
+ *  @details Describe the tasks with @c add(), call @c assign_priorities()
+ *           and create each task with the priority from @c get_priority().
+ *           Call @c analyze() whenever the WCETs change.
+ */
+class TaskSet : public BaseShare
+{
+protected:
+    TaskTiming tasks[TASKSET_MAX_TASKS];    ///< Timing of each task
+    uint8_t num_tasks;                      ///< How many tasks are described
+
+    // Find the worst case response time of one task
+    uint32_t response_time (uint8_t index) const;
+
+public:
+    // Create an empty task set
+    TaskSet (const char* p_name = NULL);
+
+    // Describe a task
+    int8_t add (const char* p_name, uint32_t period, uint32_t wcet,
+                uint32_t deadline = 0);
+
+    // Give priorities in deadline monotonic order
+    void assign_priorities (TaskPriority lowest);
+
+    // Use a measured execution time if it's longer than the estimate
+    void update_wcet (uint8_t index, uint32_t measured);
+
+    // Find every task's worst case response time
+    bool analyze (void);
+
+    /** @brief   Get the timing of one of the tasks.
+     *  @param   index The number of the task, in the order tasks were added
+     *  @return  A pointer to the timing, or @c NULL if there's no such task
+     */
+    const TaskTiming* get_timing (uint8_t index) const
+    {
+        return (index < num_tasks) ? &tasks[index] : NULL;
+    }
+
+    /// Return the priority assigned to a task, or 0 if there's no such task
+    TaskPriority get_priority (uint8_t index) const
+    {
+        return (index < num_tasks) ? tasks[index].priority : 0;
+    }
+
+    /// Return the number of tasks in the set
+    uint8_t get_num_tasks (void) const
+    {
+        return num_tasks;
+    }
+
+    // Print each task's response time within the list of shares
+    void print_in_list (Print& printer);
+};
+
+#endif // _TASKSET_H_
@@ -14,6 +14,8 @@
   *  @date 2014-Oct-18 JRR Added linked list of all shares for tracking and 
   *        debugging
   *  @date 2020-Oct-10 JRR Made compatible with Arduino, class name to @c Share
+  *  @date 2026-Oct-19 Constructor named without template arguments, as C++20
+  *        requires
   *
   *  @copyright This file is copyright 2014 -- 2019 by JR Ridgely and released 
   *    under the Lesser GNU Public License, version 2. It intended for 
@@ -111,7 +113,7 @@
           *  @param   p_name A name to be shown in the list of task shares 
           *           (default @c NULL)
           */
-         Share<DataType> (const char* p_name = NULL) : BaseShare (p_name)
+         Share (const char* p_name = NULL) : BaseShare (p_name)
          {
          }
   
@@ -0,0 +1,77 @@
+//*****************************************************************************
+/** @file    taskusage.cpp
+ *  @brief   Source code of the task monitor's arithmetic and printing.
+ *  @details This file contains functions which compute the stack and CPU use
+ *           of a task and print them.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <PrintStream.h>
+#include "taskusage.h"                      // Header for these functions
+
+
+/** @brief   Compute the CPU use of a task from run time counter changes.
+ *  @details The run time counters wrap around, so the deltas are computed by
+ *           the caller with unsigned subtraction.
+ *  @param   task_delta The change in the task's run time counter
+ *  @param   total_delta The change in the total run time counter
+ *  @return  The percentage of CPU time used by the task, 0 to 100
+ */
+uint8_t task_cpu_percent (uint32_t task_delta, uint32_t total_delta)
+{
+    if (total_delta == 0)
+    {
+        return 0;
+    }
+    if (task_delta >= total_delta)
+    {
+        return 100;
+    }
+
+    // Use 64 bits so that large counter deltas don't overflow
+    return (uint8_t)(((uint64_t)task_delta * 100) / total_delta);
+}
+
+
+/** @brief   Compute what percentage of a task's stack has been used.
+ *  @param   stack_size The size of the stack in words
+ *  @param   min_free The least free stack seen, in words
+ *  @return  The percentage of the stack which has been used at some time
+ */
+uint8_t task_stack_used_percent (uint16_t stack_size, uint16_t min_free)
+{
+    if (stack_size == 0 || min_free >= stack_size)
+    {
+        return 0;
+    }
+    return (uint8_t)(((uint32_t)(stack_size - min_free) * 100) / stack_size);
+}
+
+
+/** @brief   Print one task's stack and CPU use within the list of shares.
+ *  @details The line shows the task's name, the least free stack it has had
+ *           and its stack size, the percentage of the stack used, and, if
+ *           run time statistics are kept, its CPU use during the most recent
+ *           sampling interval.
+ *  @param   printer Reference to a serial device on which to print
+ *  @param   p_name The task's name, which is trimmed or padded to 16 characters
+ *  @param   min_free The least free stack seen, in words
+ *  @param   stack_size The size of the stack in words
+ *  @param   show_cpu True if the CPU use is to be printed
+ *  @param   cpu_percent The task's CPU use, as a percentage
+ */
+void print_task_usage (Print& printer, const char* p_name, uint16_t min_free,
+                       uint16_t stack_size, bool show_cpu,
+                       uint8_t cpu_percent)
+{
+    printer.printf ("%-16.16stask\t", p_name);
+    printer << min_free << '/' << stack_size << " free, "
+            << task_stack_used_percent (stack_size, min_free) << "% used";
+    if (show_cpu)
+    {
+        printer << ", " << cpu_percent << "% CPU";
+    }
+    printer << endl;
+}
@@ -0,0 +1,32 @@
+//*****************************************************************************
+/** @file    taskusage.h
+ *  @brief   Arithmetic and printing of the task monitor's figures.
+ *  @details The task monitor reads stack high water marks and run time
+ *           counters from FreeRTOS. This file contains the functions which
+ *           turn those readings into percentages and print a task's line in
+ *           the list of shares. They don't use the RTOS, so they're built and
+ *           tested on a PC as well.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _TASKUSAGE_H_
+#define _TASKUSAGE_H_
+
+#include <Arduino.h>
+
+
+// Compute the CPU use of a task from its and the system's run time deltas
+uint8_t task_cpu_percent (uint32_t task_delta, uint32_t total_delta);
+
+// Compute what percentage of a stack has been used
+uint8_t task_stack_used_percent (uint16_t stack_size, uint16_t min_free);
+
+// Print one task's stack and CPU use within the list of shares
+void print_task_usage (Print& printer, const char* p_name, uint16_t min_free,
+                       uint16_t stack_size, bool show_cpu,
+                       uint8_t cpu_percent);
+
+#endif // _TASKUSAGE_H_
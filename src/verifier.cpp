@@ -0,0 +1,185 @@
+//*****************************************************************************
+/** @file    verifier.cpp
+ *  @brief   Source code of the checkpoint which verifies each ball's bin.
+ *  @details This file contains the methods of class @c SortVerifier.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <PrintStream.h>
+#include "verifier.h"                       // Header for this class
+
+
+/** @brief   Create a verifier with all counts zero.
+ *  @param   p_name A name for the verifier, used when it's printed
+ *  @param   a_num_bins The number of bins in use, which are printed
+ */
+SortVerifier::SortVerifier (const char* p_name, uint8_t a_num_bins)
+    : BaseShare (p_name)
+{
+    num_bins = (a_num_bins > VERIFY_MAX_BINS) ? VERIFY_MAX_BINS : a_num_bins;
+    expecting = false;
+    expected = 0;
+    reset ();
+}
+
+
+/** @brief   Set all the counts to zero.
+ */
+void SortVerifier::reset (void)
+{
+    CO_ENTER_CRITICAL ();
+    for (uint8_t row = 0; row < VERIFY_MAX_BINS; row++)
+    {
+        for (uint8_t column = 0; column <= VERIFY_MAX_BINS; column++)
+        {
+            matrix[row][column] = 0;
+        }
+    }
+    CO_EXIT_CRITICAL ();
+}
+
+
+/** @brief   Note that a ball loaded for a bin is about to pass the
+ *           checkpoint.
+ *  @details A ball still expected from before is counted as unseen.
+ *  @param   bin The bin for which the ball was loaded
+ */
+void SortVerifier::expect (uint8_t bin)
+{
+    finish ();
+    if (bin < VERIFY_MAX_BINS)
+    {
+        CO_ENTER_CRITICAL ();
+        expected = bin;
+        expecting = true;
+        CO_EXIT_CRITICAL ();
+    }
+}
+
+
+/** @brief   Note the bin which the checkpoint sensor decided on.
+ *  @param   bin The bin, or @c BIN_REJECT if the reading couldn't be
+ *           classified
+ *  @return  True if the reading was counted, false if no ball was expected
+ *           or the reading couldn't be classified
+ */
+bool SortVerifier::observe (uint8_t bin)
+{
+    bool counted = false;
+
+    CO_ENTER_CRITICAL ();
+    if (expecting && bin < VERIFY_MAX_BINS)
+    {
+        matrix[expected][bin]++;
+        expecting = false;
+        counted = true;
+    }
+    CO_EXIT_CRITICAL ();
+    return counted;
+}
+
+
+/** @brief   Note that the ball has passed the checkpoint.
+ *  @return  True if the ball was never seen, and has been counted as unseen
+ */
+bool SortVerifier::finish (void)
+{
+    bool unseen = false;
+
+    CO_ENTER_CRITICAL ();
+    if (expecting)
+    {
+        matrix[expected][VERIFY_UNSEEN]++;
+        expecting = false;
+        unseen = true;
+    }
+    CO_EXIT_CRITICAL ();
+    return unseen;
+}
+
+
+/** @brief   Get a count from the confusion matrix.
+ *  @param   expected_bin The bin for which the balls were loaded
+ *  @param   observed The bin the checkpoint saw, or @c VERIFY_UNSEEN
+ *  @return  The number of balls, or 0 if either bin is out of range
+ */
+uint32_t SortVerifier::get_count (uint8_t expected_bin, uint8_t observed) const
+{
+    if (expected_bin >= VERIFY_MAX_BINS || observed > VERIFY_UNSEEN)
+    {
+        return 0;
+    }
+    return matrix[expected_bin][observed];
+}
+
+
+/** @brief   Count the balls checked.
+ *  @return  The number of balls which have passed the checkpoint
+ */
+uint32_t SortVerifier::get_num_checked (void) const
+{
+    uint32_t total = 0;
+
+    for (uint8_t row = 0; row < VERIFY_MAX_BINS; row++)
+    {
+        for (uint8_t column = 0; column <= VERIFY_MAX_BINS; column++)
+        {
+            total += matrix[row][column];
+        }
+    }
+    return total;
+}
+
+
+/** @brief   Count the balls the checkpoint saw in a different bin, or not at
+ *           all.
+ *  @return  The number of balls off the diagonal of the matrix
+ */
+uint32_t SortVerifier::get_num_missorted (void) const
+{
+    uint32_t total = get_num_checked ();
+
+    for (uint8_t bin = 0; bin < VERIFY_MAX_BINS; bin++)
+    {
+        total -= matrix[bin][bin];
+    }
+    return total;
+}
+
+
+/** @brief   Print the mis-sort rate and the matrix within the list of shares.
+ *  @details The rate is in tenths of a percent. Each row of the matrix, one
+ *           per bin, follows on a line of its own, with the unseen balls
+ *           last.
+ *  @param   printer Reference to a serial device on which to print
+ */
+void SortVerifier::print_in_list (Print& printer)
+{
+    uint32_t checked = get_num_checked ();
+    uint32_t missorted = get_num_missorted ();
+    uint32_t permille = checked ? (missorted * 1000 + checked / 2) / checked
+                                : 0;
+
+    // Print this verifier's name and pad it to 16 characters
+    printer.printf ("%-16sverify\t", name);
+    printer << checked << " checked, " << missorted << " mis-sorted ("
+            << permille / 10 << '.' << permille % 10 << "%)" << endl;
+    for (uint8_t row = 0; row < num_bins; row++)
+    {
+        printer.printf ("%-16s", "");
+        printer << "bin " << row << ':';
+        for (uint8_t column = 0; column < num_bins; column++)
+        {
+            printer << ' ' << matrix[row][column];
+        }
+        printer << " | " << matrix[row][VERIFY_UNSEEN] << endl;
+    }
+
+    // Call the next item
+    if (p_next != NULL)
+    {
+        p_next->print_in_list (printer);
+    }
+}
@@ -0,0 +1,80 @@
+//*****************************************************************************
+/** @file    verifier.h
+ *  @brief   Checks each ball's bin again before it's ejected.
+ *  @details A second color sensor at a checkpoint between the load station
+ *           and the first ejector reads each ball as the table carries it
+ *           past. The bin it finds is compared with the bin the ball was
+ *           loaded for, and a confusion matrix counts each pair: row @c e,
+ *           column @c o counts balls loaded for bin @c e which the checkpoint
+ *           saw as bin @c o. Balls the checkpoint couldn't classify are
+ *           counted in a last column of their own.
+ *
+ *           The verifier is a @c BaseShare, so the mis-sort rate and the
+ *           matrix are printed live by @c print_all_shares() while the
+ *           sorter's speed settings are pushed up.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _VERIFIER_H_
+#define _VERIFIER_H_
+
+#include <Arduino.h>
+#include "baseshare.h"                      // Base class for shared data items
+#include "coscheduler.h"                    // For the critical section macros
+
+
+/// The most bins whose balls can be checked
+#define VERIFY_MAX_BINS 4
+
+/// Column of the matrix counting balls the checkpoint couldn't classify
+#define VERIFY_UNSEEN VERIFY_MAX_BINS
+
+
+/** @brief   Class which compares each ball's bin with a second reading.
+ *  @details The sorting sequence calls @c expect() with the bin of the ball
+ *           about to pass the checkpoint and @c finish() once it's past. The
+ *           checkpoint sensor's task calls @c observe() with each bin it
+ *           decides on; the first one after @c expect() counts.
+ */
+class SortVerifier : public BaseShare
+{
+protected:
+    /// Balls loaded for each bin, by what the checkpoint saw
+    uint32_t matrix[VERIFY_MAX_BINS][VERIFY_MAX_BINS + 1];
+    uint8_t expected;                       ///< Bin of the passing ball
+    bool expecting;                         ///< True while a ball passes
+    uint8_t num_bins;                       ///< Bins shown in the printout
+
+public:
+    // Create a verifier with all counts zero
+    SortVerifier (const char* p_name = NULL, uint8_t a_num_bins = 3);
+
+    // Note that a ball loaded for a bin is about to pass the checkpoint
+    void expect (uint8_t bin);
+
+    // Note the bin which the checkpoint sensor decided on
+    bool observe (uint8_t bin);
+
+    // Note that the ball has passed the checkpoint
+    bool finish (void);
+
+    // Set all the counts to zero
+    void reset (void);
+
+    // Get a count from the confusion matrix
+    uint32_t get_count (uint8_t expected_bin, uint8_t observed) const;
+
+    // Count the balls checked
+    uint32_t get_num_checked (void) const;
+
+    // Count the balls the checkpoint saw in a different bin, or not at all
+    uint32_t get_num_missorted (void) const;
+
+    // Print the mis-sort rate and the matrix within the list of shares
+    void print_in_list (Print& printer);
+};
+
+#endif // _VERIFIER_H_
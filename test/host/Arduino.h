@@ -0,0 +1,246 @@
+//*****************************************************************************
+/** @file    Arduino.h
+ *  @brief   Stand-in for the Arduino core when the tests run on the host.
+ *  @details The modules which don't touch the hardware are built for the
+ *           host by the @c native environment. This file gives them the few
+ *           parts of the Arduino core they use. Time doesn't pass by itself:
+ *           it's kept in @c host_us, which the tests move on, and which
+ *           @c delay() moves on as well. Pins are kept in @c host_pins so a
+ *           test can set an input or see what was written to an output.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _HOST_ARDUINO_H_
+#define _HOST_ARDUINO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define OUTPUT_OPEN_DRAIN 3
+
+/// Number of pins kept by the stand-in
+#define HOST_NUM_PINS 64
+
+/// Pins used by the default I2C port
+#define SDA 14
+#define SCL 15
+
+/// Simulated time in microseconds, moved on by the tests
+inline uint32_t host_us = 0;
+
+/// Level of each pin, as last written or as set by a test
+inline uint8_t host_pins[HOST_NUM_PINS];
+
+inline uint32_t micros (void)
+{
+    return host_us;
+}
+
+inline uint32_t millis (void)
+{
+    return host_us / 1000;
+}
+
+inline void delay (uint32_t ms)
+{
+    host_us += ms * 1000;
+}
+
+inline void delayMicroseconds (uint32_t us)
+{
+    host_us += us;
+}
+
+inline void pinMode (uint32_t pin, uint32_t mode)
+{
+    if (pin < HOST_NUM_PINS && mode == INPUT_PULLUP)
+    {
+        host_pins[pin] = HIGH;
+    }
+}
+
+inline void digitalWrite (uint32_t pin, uint32_t level)
+{
+    if (pin < HOST_NUM_PINS)
+    {
+        host_pins[pin] = level ? HIGH : LOW;
+    }
+}
+
+inline int digitalRead (uint32_t pin)
+{
+    return (pin < HOST_NUM_PINS) ? host_pins[pin] : LOW;
+}
+
+
+/** @brief   Stand-in for Arduino's @c Print, which formats into @c write().
+ */
+class Print
+{
+public:
+    virtual ~Print (void) { }
+
+    virtual size_t write (uint8_t a_char) = 0;
+
+    virtual size_t write (const uint8_t* p_buffer, size_t size)
+    {
+        for (size_t index = 0; index < size; index++)
+        {
+            write (p_buffer[index]);
+        }
+        return size;
+    }
+
+    size_t write (const char* p_string)
+    {
+        return write ((const uint8_t*)p_string, strlen (p_string));
+    }
+
+    size_t print (const char* p_string)
+    {
+        return write (p_string);
+    }
+
+    size_t print (char a_char)
+    {
+        return write ((uint8_t)a_char);
+    }
+
+    size_t print (long value)
+    {
+        return printf ("%ld", value);
+    }
+
+    size_t print (unsigned long value)
+    {
+        return printf ("%lu", value);
+    }
+
+    size_t print (long long value)
+    {
+        return printf ("%lld", value);
+    }
+
+    size_t print (unsigned long long value)
+    {
+        return printf ("%llu", value);
+    }
+
+    size_t print (int value)
+    {
+        return print ((long)value);
+    }
+
+    size_t print (unsigned int value)
+    {
+        return print ((unsigned long)value);
+    }
+
+    size_t print (double value, int digits = 2)
+    {
+        return printf ("%.*f", digits, value);
+    }
+
+    size_t println (void)
+    {
+        return write ("\r\n");
+    }
+
+    template <class T> size_t println (T value)
+    {
+        return print (value) + println ();
+    }
+
+    size_t printf (const char* p_format, ...)
+        __attribute__ ((format (printf, 2, 3)))
+    {
+        char buffer[256];
+        va_list args;
+
+        va_start (args, p_format);
+        vsnprintf (buffer, sizeof (buffer), p_format, args);
+        va_end (args);
+        return write (buffer);
+    }
+};
+
+
+/** @brief   Stand-in for Arduino's @c Stream, a @c Print which can be read.
+ */
+class Stream : public Print
+{
+public:
+    virtual int available (void) = 0;
+    virtual int read (void) = 0;
+    virtual int peek (void) = 0;
+};
+
+
+/** @brief   Serial port which keeps what's printed and reads what a test
+ *           has given it.
+ */
+class HostSerial : public Stream
+{
+public:
+    std::string output;                     ///< Everything printed so far
+    std::string input;                      ///< Characters still to be read
+
+    using Print::write;
+
+    size_t write (uint8_t a_char)
+    {
+        output += (char)a_char;
+        return 1;
+    }
+
+    int available (void)
+    {
+        return (int)input.size ();
+    }
+
+    int read (void)
+    {
+        if (input.empty ())
+        {
+            return -1;
+        }
+        int a_char = (uint8_t)input[0];
+        input.erase (0, 1);
+        return a_char;
+    }
+
+    int peek (void)
+    {
+        return input.empty () ? -1 : (uint8_t)input[0];
+    }
+
+    void begin (unsigned long baud)
+    {
+    }
+
+    operator bool (void)
+    {
+        return true;
+    }
+};
+
+inline HostSerial Serial;
+
+#endif // _HOST_ARDUINO_H_
@@ -0,0 +1,54 @@
+//*****************************************************************************
+/** @file    EEPROM.h
+ *  @brief   Stand-in for the emulated EEPROM in host builds.
+ *  @details The bytes are kept in @c host_eeprom, which starts erased, so a
+ *           test can look at what was saved or corrupt it.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _HOST_EEPROM_H_
+#define _HOST_EEPROM_H_
+
+#include "Arduino.h"
+
+/// Size of the stand-in EEPROM in bytes
+#define HOST_EEPROM_SIZE 1024
+
+/** @brief   The bytes of the stand-in EEPROM.
+ */
+struct HostEEPROM
+{
+    uint8_t bytes[HOST_EEPROM_SIZE];        ///< Contents, erased to 0xFF
+
+    HostEEPROM (void)
+    {
+        erase ();
+    }
+
+    void erase (void)
+    {
+        memset (bytes, 0xFF, sizeof (bytes));
+    }
+
+    uint8_t read (int address)
+    {
+        return bytes[address % HOST_EEPROM_SIZE];
+    }
+
+    void write (int address, uint8_t value)
+    {
+        bytes[address % HOST_EEPROM_SIZE] = value;
+    }
+
+    uint16_t length (void)
+    {
+        return HOST_EEPROM_SIZE;
+    }
+};
+
+inline HostEEPROM EEPROM;
+
+#endif // _HOST_EEPROM_H_
@@ -0,0 +1,112 @@
+//*****************************************************************************
+/** @file    PrintStream.h
+ *  @brief   Stand-in for the PrintStream library in host builds.
+ *  @details Gives @c Print the @c << operators which the modules use.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _HOST_PRINTSTREAM_H_
+#define _HOST_PRINTSTREAM_H_
+
+#include "Arduino.h"
+
+inline Print& operator<< (Print& printer, const char* p_string)
+{
+    printer.print (p_string);
+    return printer;
+}
+
+inline Print& operator<< (Print& printer, char a_char)
+{
+    printer.print (a_char);
+    return printer;
+}
+
+inline Print& operator<< (Print& printer, bool value)
+{
+    printer.print (value ? 1 : 0);
+    return printer;
+}
+
+inline Print& operator<< (Print& printer, signed char value)
+{
+    printer.print ((int)value);
+    return printer;
+}
+
+inline Print& operator<< (Print& printer, unsigned char value)
+{
+    printer.print ((unsigned int)value);
+    return printer;
+}
+
+inline Print& operator<< (Print& printer, short value)
+{
+    printer.print ((int)value);
+    return printer;
+}
+
+inline Print& operator<< (Print& printer, unsigned short value)
+{
+    printer.print ((unsigned int)value);
+    return printer;
+}
+
+inline Print& operator<< (Print& printer, int value)
+{
+    printer.print (value);
+    return printer;
+}
+
+inline Print& operator<< (Print& printer, unsigned int value)
+{
+    printer.print (value);
+    return printer;
+}
+
+inline Print& operator<< (Print& printer, long value)
+{
+    printer.print (value);
+    return printer;
+}
+
+inline Print& operator<< (Print& printer, unsigned long value)
+{
+    printer.print (value);
+    return printer;
+}
+
+inline Print& operator<< (Print& printer, long long value)
+{
+    printer.print (value);
+    return printer;
+}
+
+inline Print& operator<< (Print& printer, unsigned long long value)
+{
+    printer.print (value);
+    return printer;
+}
+
+inline Print& operator<< (Print& printer, double value)
+{
+    printer.print (value);
+    return printer;
+}
+
+/// End a line, as @c endl does for @c std::ostream
+inline Print& endl (Print& printer)
+{
+    printer.println ();
+    return printer;
+}
+
+inline Print& operator<< (Print& printer, Print& (*manipulator) (Print&))
+{
+    return manipulator (printer);
+}
+
+#endif // _HOST_PRINTSTREAM_H_
@@ -0,0 +1,3 @@
+// Stand-in for the pre-1.0 Arduino header, which the TCS34725 driver
+// includes when ARDUINO isn't defined, as it isn't in host builds
+#include "Arduino.h"
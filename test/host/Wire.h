@@ -0,0 +1,54 @@
+//*****************************************************************************
+/** @file    Wire.h
+ *  @brief   Stand-in for the Arduino I2C library in host builds.
+ *  @details Tests give the color sensor driver a transport of their own, so
+ *           this port has nothing on its bus: every transfer is refused as
+ *           if no device answered.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _HOST_WIRE_H_
+#define _HOST_WIRE_H_
+
+#include "Arduino.h"
+
+/** @brief   I2C port with no devices on it.
+ */
+class TwoWire
+{
+public:
+    TwoWire (void) { }
+    TwoWire (uint32_t sda, uint32_t scl) { }
+
+    void begin (void) { }
+    void end (void) { }
+    void setClock (uint32_t frequency) { }
+    void beginTransmission (uint8_t address) { }
+
+    uint8_t endTransmission (bool stop = true)
+    {
+        return 2;                           // Address not acknowledged
+    }
+
+    uint8_t requestFrom (uint8_t address, uint8_t quantity)
+    {
+        return 0;
+    }
+
+    size_t send (uint8_t value)
+    {
+        return 1;
+    }
+
+    int receive (void)
+    {
+        return -1;
+    }
+};
+
+inline TwoWire Wire;
+
+#endif // _HOST_WIRE_H_
@@ -0,0 +1,230 @@
+//*****************************************************************************
+/** @file    simi2cbus.h
+ *  @brief   Simulated I2C bus with TCS34725 color sensors on it.
+ *  @details The tests of the color sensor driver, the bus scheduler and the
+ *           startup sequence give this transport to the code under test in
+ *           place of a real bus. Each sensor keeps its registers, starts an
+ *           integration when its ADC is enabled, and sets AVALID once the
+ *           integration time has passed by @c host_us. Sensors can be put
+ *           straight on the bus or behind a simulated TCA9548A multiplexer.
+ *
+ *           Faults are injected by the tests: a number of transfers can be
+ *           refused as if not acknowledged, the bus can be stuck until it's
+ *           recovered, and a sensor can be reset, losing its registers. The
+ *           transfers of each kind are counted. So that throughput can be
+ *           measured, each transfer can be made to take bus time, moving
+ *           @c host_us on by the time its bytes take to send.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+// This define prevents this .h file from being included more than once
+#ifndef _SIMI2CBUS_H_
+#define _SIMI2CBUS_H_
+
+#include <Arduino.h>
+#include "i2ctransport.h"
+#include "Adafruit_TCS34725.h"
+
+
+/// Mux channels the simulated bus has, one more for sensors with no mux
+#define SIM_CHANNELS 9
+
+/// Channel of a sensor which is wired straight to the bus
+#define SIM_NO_MUX 8
+
+
+/** @brief   Registers and readings of one simulated TCS34725.
+ */
+struct SimTCS34725
+{
+    uint8_t regs[0x20];                     ///< The sensor's registers
+    uint32_t adc_start_us;                  ///< When the integration began
+    uint16_t counts[4];                     ///< Clear, red, green, blue seen
+
+    /// Create a sensor which has just been powered up
+    SimTCS34725 (void)
+    {
+        reset ();
+        counts[0] = counts[1] = counts[2] = counts[3] = 0;
+    }
+
+    /// Put the registers back as they are at power up
+    void reset (void)
+    {
+        memset (regs, 0, sizeof (regs));
+        regs[TCS34725_ATIME] = 0xFF;
+        regs[TCS34725_ID] = 0x44;
+        adc_start_us = 0;
+    }
+
+    /// Set the counts which the next integrations will give
+    void set_counts (uint16_t r, uint16_t g, uint16_t b, uint16_t c)
+    {
+        counts[0] = c;
+        counts[1] = r;
+        counts[2] = g;
+        counts[3] = b;
+    }
+
+    /// Return true once an integration has finished since the ADC started
+    bool is_valid (void) const
+    {
+        uint8_t on = TCS34725_ENABLE_PON | TCS34725_ENABLE_AEN;
+        return (regs[TCS34725_ENABLE] & on) == on
+               && host_us - adc_start_us
+                  >= (256UL - regs[TCS34725_ATIME]) * 2400UL;
+    }
+
+    /// Write a register, starting an integration if the ADC is turned on
+    void write (uint8_t reg, uint8_t value)
+    {
+        if (reg == TCS34725_ENABLE && (value & TCS34725_ENABLE_AEN)
+            && !(regs[TCS34725_ENABLE] & TCS34725_ENABLE_AEN))
+        {
+            adc_start_us = host_us;
+        }
+        regs[reg] = value;
+    }
+
+    /// Read registers from the given one on, as the sensor would give them
+    void read (uint8_t reg, uint8_t* p_rx, uint8_t rx_len)
+    {
+        regs[TCS34725_STATUS] = is_valid () ? TCS34725_STATUS_AVALID : 0;
+        for (uint8_t index = 0; index < 4; index++)
+        {
+            uint16_t count = is_valid () ? counts[index] : 0;
+            regs[TCS34725_CDATAL + 2 * index] = count & 0xFF;
+            regs[TCS34725_CDATAH + 2 * index] = count >> 8;
+        }
+        for (uint8_t index = 0; index < rx_len; index++)
+        {
+            p_rx[index] = regs[(reg + index) & 0x1F];
+        }
+    }
+};
+
+
+/** @brief   Transport which carries transfers to simulated sensors.
+ */
+class SimI2CBus : public I2CTransport
+{
+public:
+    SimTCS34725* p_sensors[SIM_CHANNELS];   ///< Sensor on each channel
+    uint8_t mux_address;                    ///< Mux address, if there's one
+    uint8_t selected;                       ///< Mux channels now selected
+    uint16_t nacks;                         ///< Transfers still to refuse
+    bool stuck;                             ///< True until recovered
+    uint32_t num_transfers;                 ///< Transfers tried
+    uint32_t num_reads;                     ///< Register reads which worked
+    uint32_t num_writes;                    ///< Register writes which worked
+    uint32_t num_selects;                   ///< Mux selections which worked
+    uint32_t num_begins;                    ///< Times the bus was begun
+    uint32_t num_recovers;                  ///< Times it was recovered
+    uint32_t us_per_byte;                   ///< Bus time of a byte, if any
+
+    /// Create a bus with no sensors on it
+    SimI2CBus (uint8_t a_mux_address = 0)
+    {
+        for (uint8_t index = 0; index < SIM_CHANNELS; index++)
+        {
+            p_sensors[index] = NULL;
+        }
+        mux_address = a_mux_address;
+        selected = 0;
+        nacks = 0;
+        stuck = false;
+        us_per_byte = 0;
+        clear_counts ();
+    }
+
+    /// Put a sensor on a mux channel, or straight on the bus
+    void attach (SimTCS34725& sensor, uint8_t channel = SIM_NO_MUX)
+    {
+        p_sensors[channel] = &sensor;
+    }
+
+    /// Forget the transfers counted so far
+    void clear_counts (void)
+    {
+        num_transfers = num_reads = num_writes = num_selects = 0;
+        num_begins = num_recovers = 0;
+    }
+
+    void begin (void)
+    {
+        num_begins++;
+    }
+
+    /// Free the bus; a stuck bus is freed, as by clocking out the sensor
+    bool recover (void)
+    {
+        num_recovers++;
+        stuck = false;
+        return true;
+    }
+
+    bool transfer (uint8_t address, const uint8_t* p_tx, uint8_t tx_len,
+                   uint8_t* p_rx, uint8_t rx_len)
+    {
+        // The address is sent again after a repeated start to read
+        num_transfers++;
+        host_us += (1 + tx_len + (rx_len > 0 ? 1 + rx_len : 0)) * us_per_byte;
+        if (stuck)
+        {
+            return false;
+        }
+        if (nacks > 0)
+        {
+            nacks--;
+            return false;
+        }
+        if (mux_address != 0 && address == mux_address)
+        {
+            if (tx_len != 1)
+            {
+                return false;
+            }
+            selected = p_tx[0];
+            num_selects++;
+            return true;
+        }
+
+        // With a mux, the sensor must be on the one channel selected
+        SimTCS34725* p_sensor = p_sensors[SIM_NO_MUX];
+        for (uint8_t channel = 0; channel < 8; channel++)
+        {
+            if (selected == (1 << channel) && p_sensors[channel] != NULL)
+            {
+                p_sensor = p_sensors[channel];
+            }
+        }
+        if (address != TCS34725_ADDRESS || p_sensor == NULL || tx_len == 0
+            || !(p_tx[0] & TCS34725_COMMAND_BIT))
+        {
+            return false;
+        }
+
+        // Special functions, such as clearing the interrupt, write nothing
+        uint8_t reg = p_tx[0] & 0x1F;
+        if ((p_tx[0] & 0x60) == 0x60)
+        {
+            num_writes++;
+            return true;
+        }
+        if (tx_len == 2)
+        {
+            p_sensor->write (reg, p_tx[1]);
+            num_writes++;
+        }
+        if (rx_len > 0)
+        {
+            p_sensor->read (reg, p_rx, rx_len);
+            num_reads++;
+        }
+        return true;
+    }
+};
+
+#endif // _SIMI2CBUS_H_
@@ -0,0 +1,249 @@
+//*****************************************************************************
+/** @file    test_main.cpp
+ *  @brief   Tests of the automatic exposure controller with a simulated
+ *           sensor.
+ *  @details The simulated sensor's clear count is the ambient light times
+ *           the sensitivity of the setting the controller chose, clipped at
+ *           the most the sensor can count in its integration time. The light
+ *           is swept across the whole ladder and held near its boundaries.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <unity.h>
+#include "autoexposure.h"
+
+
+/// The most settings the controller moves through on the way to one
+#define SETTLE_READINGS 3
+
+
+/// Controller whose place on the ladder can be set by the tests
+class LadderStep : public AutoExposure
+{
+public:
+    void set_index (uint8_t an_index)
+    {
+        index = an_index;
+    }
+};
+
+
+/// State of the noise generator
+static uint32_t noise_state;
+
+
+/** @brief   Find the clear count of the simulated sensor.
+ *  @param   exposure The controller, whose setting is used
+ *  @param   light The light level, in counts per 256 units of sensitivity
+ *  @return  The clear count, clipped at the sensor's full scale
+ */
+static uint16_t read_clear (const AutoExposure& exposure, uint32_t light)
+{
+    uint32_t cycles = 256 - exposure.get_integration_time ();
+    uint32_t full_scale = (cycles * 1024 > 65535) ? 65535 : cycles * 1024;
+    uint32_t clear = (uint64_t)light * exposure.get_sensitivity () / 256;
+
+    return (clear > full_scale) ? full_scale : clear;
+}
+
+
+/// Give readings of a light to the controller until its setting is steady
+static void settle (AutoExposure& exposure, uint32_t light)
+{
+    for (uint8_t reading = 0; reading < SETTLE_READINGS; reading++)
+    {
+        if (!exposure.update (read_clear (exposure, light)))
+        {
+            return;
+        }
+    }
+    TEST_FAIL_MESSAGE ("Setting didn't settle");
+}
+
+
+void setUp (void)
+{
+    noise_state = 1;
+}
+
+
+void tearDown (void)
+{
+}
+
+
+void test_sensitivity_of_settings (void)
+{
+    TEST_ASSERT_EQUAL_UINT16 (1, AutoExposure::sensitivity (
+        TCS34725_INTEGRATIONTIME_2_4MS, TCS34725_GAIN_1X));
+    TEST_ASSERT_EQUAL_UINT16 (600, AutoExposure::sensitivity (
+        TCS34725_INTEGRATIONTIME_24MS, TCS34725_GAIN_60X));
+    TEST_ASSERT_EQUAL_UINT16 (15360, AutoExposure::sensitivity (
+        TCS34725_INTEGRATIONTIME_700MS, TCS34725_GAIN_60X));
+}
+
+
+void test_saturation_drops_to_the_bottom (void)
+{
+    AutoExposure exposure;
+
+    // In the dark the controller climbs to the most sensitive setting
+    settle (exposure, 0);
+    TEST_ASSERT_EQUAL_UINT8 (7, exposure.get_index ());
+
+    // A saturated reading says nothing of the light, so start again
+    TEST_ASSERT_TRUE (exposure.update (exposure.get_saturation ()));
+    TEST_ASSERT_EQUAL_UINT8 (0, exposure.get_index ());
+    TEST_ASSERT_EQUAL (TCS34725_INTEGRATIONTIME_2_4MS,
+                       exposure.get_integration_time ());
+    TEST_ASSERT_EQUAL (TCS34725_GAIN_1X, exposure.get_gain ());
+
+    // Saturated at the bottom already, nothing changes
+    TEST_ASSERT_FALSE (exposure.update (65535));
+}
+
+
+void test_least_sensitive_step_with_an_eighth (void)
+{
+    // From the bottom, each light level goes straight to the least
+    // sensitive setting which reads at least an eighth of saturation. The
+    // first reading, at 1x, only measures the light to within a count
+    for (uint32_t light = 256 * 4; light < 256 * 700; light += light / 8)
+    {
+        LadderStep exposure;
+        uint16_t first = read_clear (exposure, light);
+        exposure.update (first);
+        uint8_t chosen = exposure.get_index ();
+        TEST_ASSERT_GREATER_OR_EQUAL (
+            (uint32_t)exposure.get_saturation () / 8 * first / (first + 1),
+            read_clear (exposure, light));
+        if (chosen > 0)
+        {
+            LadderStep less;
+            less.set_index (chosen - 1);
+            TEST_ASSERT_LESS_THAN (
+                ((uint32_t)less.get_saturation () / 8 + 1) * (first + 1)
+                / first, read_clear (less, light));
+        }
+    }
+
+    // A dim light is found from the bottom in one reading too
+    LadderStep exposure;
+    exposure.update (read_clear (exposure, 300));
+    TEST_ASSERT_EQUAL_UINT8 (7, exposure.get_index ());
+}
+
+
+void test_hysteresis_keeps_the_more_sensitive_step (void)
+{
+    LadderStep exposure;
+
+    // This light reads 120 at 1x, enough for an eighth of saturation but
+    // not a quarter, and 480 at 4x, which isn't near saturation; 4x is kept
+    exposure.set_index (1);
+    TEST_ASSERT_FALSE (exposure.update (read_clear (exposure, 256 * 120)));
+    TEST_ASSERT_EQUAL_UINT8 (1, exposure.get_index ());
+
+    // Three quarters of saturation at 4x is near enough to give it up
+    TEST_ASSERT_TRUE (exposure.update (read_clear (exposure, 256 * 150)));
+    TEST_ASSERT_EQUAL_UINT8 (0, exposure.get_index ());
+
+    // Coming back the other way, 1x is kept down to an eighth
+    TEST_ASSERT_FALSE (exposure.update (read_clear (exposure, 256 * 100)));
+    TEST_ASSERT_TRUE (exposure.update (read_clear (exposure, 256 * 90)));
+    TEST_ASSERT_EQUAL_UINT8 (1, exposure.get_index ());
+}
+
+
+void test_sweep_up_and_down_the_ladder (void)
+{
+    AutoExposure exposure;
+    uint8_t last = 0;
+    uint8_t lowest = 7;
+    uint8_t highest = 0;
+
+    // Light fading from bright sunlight to near darkness, then back
+    for (uint32_t light = 256 * 700; light > 16; light -= light / 16)
+    {
+        settle (exposure, light);
+        TEST_ASSERT_GREATER_OR_EQUAL (last, exposure.get_index ());
+        last = exposure.get_index ();
+        highest = (last > highest) ? last : highest;
+        TEST_ASSERT_LESS_THAN (exposure.get_saturation (),
+                               read_clear (exposure, light));
+    }
+    for (uint32_t light = 16; light < 256 * 700; light += light / 16 + 1)
+    {
+        settle (exposure, light);
+        TEST_ASSERT_LESS_OR_EQUAL (last, exposure.get_index ());
+        last = exposure.get_index ();
+        lowest = (last < lowest) ? last : lowest;
+        TEST_ASSERT_LESS_THAN (exposure.get_saturation (),
+                               read_clear (exposure, light));
+    }
+    TEST_ASSERT_EQUAL_UINT8 (7, highest);
+    TEST_ASSERT_EQUAL_UINT8 (0, lowest);
+}
+
+
+/** @brief   Give noisy readings of a light and count the setting changes.
+ *  @param   exposure The controller, already settled near the light
+ *  @param   light The mean light level
+ *  @return  The number of times the setting changed in 1000 readings
+ */
+static uint16_t count_changes (AutoExposure& exposure, uint32_t light)
+{
+    uint16_t changes = 0;
+
+    // Noise of 5% either way
+    for (uint16_t reading = 0; reading < 1000; reading++)
+    {
+        noise_state = noise_state * 1664525UL + 1013904223UL;
+        uint32_t noisy = light - light / 20
+                         + (uint64_t)(noise_state >> 8) * (light / 10)
+                           / 0xFFFFFF;
+        changes += exposure.update (read_clear (exposure, noisy));
+    }
+    return changes;
+}
+
+
+void test_no_flipping_near_a_boundary (void)
+{
+    for (uint8_t step = 1; step < 8; step++)
+    {
+        // Brighten the light slowly until the controller leaves this step
+        LadderStep exposure;
+        exposure.set_index (step);
+        uint32_t light = 16;
+        while (exposure.get_index () > step - 1)
+        {
+            light += light / 64 + 1;
+            settle (exposure, light);
+        }
+        TEST_ASSERT_LESS_OR_EQUAL (1, count_changes (exposure, light));
+
+        // Dim it slowly until it comes back up
+        while (exposure.get_index () < step)
+        {
+            light -= light / 64 + 1;
+            settle (exposure, light);
+        }
+        TEST_ASSERT_LESS_OR_EQUAL (1, count_changes (exposure, light));
+    }
+}
+
+
+int main (int argc, char** argv)
+{
+    UNITY_BEGIN ();
+    RUN_TEST (test_sensitivity_of_settings);
+    RUN_TEST (test_saturation_drops_to_the_bottom);
+    RUN_TEST (test_least_sensitive_step_with_an_eighth);
+    RUN_TEST (test_hysteresis_keeps_the_more_sensitive_step);
+    RUN_TEST (test_sweep_up_and_down_the_ladder);
+    RUN_TEST (test_no_flipping_near_a_boundary);
+    return UNITY_END ();
+}
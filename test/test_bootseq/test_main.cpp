@@ -0,0 +1,204 @@
+//*****************************************************************************
+/** @file    test_main.cpp
+ *  @brief   Tests of the startup sequence with simulated devices.
+ *  @details Each simulated device becomes ready at a set time, or never. The
+ *           color sensors are simulated on a bus behind a multiplexer, as in
+ *           the sorter, and are started side by side through the scheduler.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <unity.h>
+#include "bootseq.h"
+#include "simi2cbus.h"
+
+
+/// Microseconds between polls of the sequence in these tests
+#define POLL_US 100
+
+
+/// A device which is ready once a time has passed
+struct SimDevice
+{
+    uint32_t ready_us;                      ///< When it's ready
+    uint16_t num_polls;                     ///< Times it was polled
+};
+
+
+/// Startup stage of a simulated device
+static BootState poll_device (void* p_context, uint32_t now_us)
+{
+    SimDevice* p_device = (SimDevice*)p_context;
+
+    p_device->num_polls++;
+    return (now_us >= p_device->ready_us) ? BOOT_READY : BOOT_WAITING;
+}
+
+
+/// Poll a sequence until every stage is done, moving the clock on
+static void run (BootSequence& sequence)
+{
+    while (!sequence.poll (host_us))
+    {
+        host_us += POLL_US;
+    }
+}
+
+
+void setUp (void)
+{
+    host_us = 50000;
+    Serial.output.clear ();
+}
+
+
+void tearDown (void)
+{
+}
+
+
+void test_stages_run_side_by_side (void)
+{
+    BootSequence sequence;
+    SimDevice serial = {50000, 0};
+    SimDevice motors = {55000, 0};
+    SimDevice settings = {70000, 0};
+
+    TEST_ASSERT_EQUAL_INT (0, sequence.add ("Serial", poll_device, &serial,
+                                            1000));
+    TEST_ASSERT_EQUAL_INT (1, sequence.add ("Motors", poll_device, &motors,
+                                            10000));
+    TEST_ASSERT_EQUAL_INT (2, sequence.add ("Settings", poll_device,
+                                            &settings, 30000));
+    run (sequence);
+
+    // The sequence took as long as its slowest stage, not their sum
+    TEST_ASSERT_EQUAL_UINT32 (20000, sequence.get_total_us ());
+    TEST_ASSERT_EQUAL_UINT32 (0, sequence.get_time_us (0));
+    TEST_ASSERT_EQUAL_UINT32 (5000, sequence.get_time_us (1));
+    TEST_ASSERT_EQUAL_UINT32 (20000, sequence.get_time_us (2));
+    for (uint8_t stage = 0; stage < 3; stage++)
+    {
+        TEST_ASSERT_EQUAL (BOOT_READY, sequence.get_state (stage));
+    }
+
+    // A stage isn't polled again once it's ready
+    TEST_ASSERT_EQUAL_UINT16 (1, serial.num_polls);
+    TEST_ASSERT_EQUAL_UINT16 (51, motors.num_polls);
+}
+
+
+void test_slow_stage_fails_alone (void)
+{
+    BootSequence sequence;
+    SimDevice quick = {52000, 0};
+    SimDevice dead = {UINT32_MAX, 0};
+
+    sequence.add ("Quick", poll_device, &quick, 10000);
+    sequence.add ("Dead", poll_device, &dead, 10000);
+    run (sequence);
+
+    TEST_ASSERT_EQUAL (BOOT_READY, sequence.get_state (0));
+    TEST_ASSERT_EQUAL (BOOT_FAILED, sequence.get_state (1));
+    TEST_ASSERT_EQUAL_UINT32 (10000, sequence.get_time_us (1));
+    TEST_ASSERT_EQUAL_UINT32 (10000, sequence.get_total_us ());
+
+    sequence.print_stages (Serial);
+    TEST_ASSERT_NOT_NULL (strstr (Serial.output.c_str (),
+                                  "started 50000 us after reset, all done in "
+                                  "10000 us"));
+    TEST_ASSERT_NOT_NULL (strstr (Serial.output.c_str (), "Quick 2000 us\r\n"));
+    TEST_ASSERT_NOT_NULL (strstr (Serial.output.c_str (),
+                                  "Dead 10000 us (failed)\r\n"));
+}
+
+
+void test_stages_are_limited (void)
+{
+    BootSequence sequence;
+    SimDevice device = {0, 0};
+
+    TEST_ASSERT_EQUAL_INT (-1, sequence.add ("None", NULL, NULL, 1000));
+    for (uint8_t stage = 0; stage < BOOT_MAX_STAGES; stage++)
+    {
+        TEST_ASSERT_EQUAL_INT (stage, sequence.add ("Device", poll_device,
+                                                    &device, 1000));
+    }
+    TEST_ASSERT_EQUAL_INT (-1, sequence.add ("Extra", poll_device, &device,
+                                             1000));
+    TEST_ASSERT_EQUAL (BOOT_FAILED, sequence.get_state (BOOT_MAX_STAGES));
+    TEST_ASSERT_EQUAL_UINT32 (0, sequence.get_time_us (BOOT_MAX_STAGES));
+}
+
+
+void test_sensors_start_together (void)
+{
+    SimTCS34725 chips[2];
+    SimI2CBus bus (TCA9548A_ADDRESS);
+    bus.attach (chips[0], 0);
+    bus.attach (chips[1], 1);
+    Adafruit_TCS34725 sensors[2] = {
+        Adafruit_TCS34725 (TCS34725_INTEGRATIONTIME_24MS),
+        Adafruit_TCS34725 (TCS34725_INTEGRATIONTIME_24MS)};
+    I2CBusScheduler scheduler;
+    scheduler.add_bus (bus, TCA9548A_ADDRESS);
+    scheduler.add_sensor (sensors[0], 0, 0);
+    scheduler.add_sensor (sensors[1], 0, 1);
+    SensorStartup first (scheduler, 0);
+    SensorStartup second (scheduler, 1);
+    BootSequence sequence;
+
+    sequence.add ("Sensor", SensorStartup::poll_stage, &first, 100000);
+    sequence.add ("Checkpoint", SensorStartup::poll_stage, &second, 100000);
+    run (sequence);
+
+    TEST_ASSERT_EQUAL (BOOT_READY, sequence.get_state (0));
+    TEST_ASSERT_EQUAL (BOOT_READY, sequence.get_state (1));
+    TEST_ASSERT_TRUE (chips[0].is_valid ());
+    TEST_ASSERT_TRUE (chips[1].is_valid ());
+
+    // Both integrations overlapped, so it took less than two in a row
+    TEST_ASSERT_GREATER_OR_EQUAL (2400 + 24000, sequence.get_total_us ());
+    TEST_ASSERT_LESS_THAN (2 * 24000, sequence.get_total_us ());
+}
+
+
+void test_missing_sensor_times_out (void)
+{
+    SimTCS34725 chip;
+    SimI2CBus bus (TCA9548A_ADDRESS);
+    bus.attach (chip, 0);
+    Adafruit_TCS34725 sensors[2];
+    I2CBusScheduler scheduler;
+    scheduler.add_bus (bus, TCA9548A_ADDRESS);
+    scheduler.add_sensor (sensors[0], 0, 0);
+    scheduler.add_sensor (sensors[1], 0, 1);
+    SensorStartup present (scheduler, 0);
+    SensorStartup missing (scheduler, 1);
+    SensorStartup no_lane (scheduler, 2);
+    BootSequence sequence;
+
+    sequence.add ("Present", SensorStartup::poll_stage, &present, 20000);
+    sequence.add ("Missing", SensorStartup::poll_stage, &missing, 20000);
+    sequence.add ("No lane", SensorStartup::poll_stage, &no_lane, 20000);
+    run (sequence);
+
+    TEST_ASSERT_EQUAL (BOOT_READY, sequence.get_state (0));
+    TEST_ASSERT_EQUAL (BOOT_FAILED, sequence.get_state (1));
+    TEST_ASSERT_EQUAL_UINT32 (20000, sequence.get_time_us (1));
+    TEST_ASSERT_EQUAL (BOOT_FAILED, sequence.get_state (2));
+    TEST_ASSERT_EQUAL_UINT32 (0, sequence.get_time_us (2));
+}
+
+
+int main (int argc, char** argv)
+{
+    UNITY_BEGIN ();
+    RUN_TEST (test_stages_run_side_by_side);
+    RUN_TEST (test_slow_stage_fails_alone);
+    RUN_TEST (test_stages_are_limited);
+    RUN_TEST (test_sensors_start_together);
+    RUN_TEST (test_missing_sensor_times_out);
+    return UNITY_END ();
+}
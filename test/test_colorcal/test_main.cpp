@@ -0,0 +1,261 @@
+//*****************************************************************************
+/** @file    test_main.cpp
+ *  @brief   Tests of the color sensor's dark and white calibration.
+ *  @details Dark frames and white references are given to the calibration,
+ *           readings are corrected with it, and calibrations are saved to,
+ *           corrupted in and loaded from the stand-in EEPROM.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <unity.h>
+#include <stddef.h>
+#include <EEPROM.h>
+#include "colorcal.h"
+#include "nvstore.h"
+
+
+/// Make a reading from its four channel counts
+static RGBCSample sample (uint16_t r, uint16_t g, uint16_t b, uint16_t c)
+{
+    RGBCSample reading = {r, g, b, c};
+    return reading;
+}
+
+
+/// Check that a reading has the given counts
+static void check (const RGBCSample& reading,
+                   uint16_t r, uint16_t g, uint16_t b, uint16_t c)
+{
+    TEST_ASSERT_EQUAL_UINT16 (r, reading.r);
+    TEST_ASSERT_EQUAL_UINT16 (g, reading.g);
+    TEST_ASSERT_EQUAL_UINT16 (b, reading.b);
+    TEST_ASSERT_EQUAL_UINT16 (c, reading.c);
+}
+
+
+void setUp (void)
+{
+    EEPROM.erase ();
+}
+
+
+void tearDown (void)
+{
+}
+
+
+void test_averager_rounds_the_mean (void)
+{
+    FrameAverager averager;
+    RGBCSample mean;
+
+    averager.start (4);
+    TEST_ASSERT_TRUE (averager.busy ());
+    TEST_ASSERT_FALSE (averager.add (sample (10, 0, 1, 65535)));
+    TEST_ASSERT_FALSE (averager.add (sample (11, 0, 1, 65535)));
+    TEST_ASSERT_FALSE (averager.add (sample (11, 0, 0, 65535)));
+    TEST_ASSERT_TRUE (averager.add (sample (11, 1, 0, 65535)));
+    TEST_ASSERT_FALSE (averager.busy ());
+
+    // Readings past the number wanted are ignored
+    TEST_ASSERT_TRUE (averager.add (sample (1000, 1000, 1000, 0)));
+    averager.get_mean (mean);
+    check (mean, 11, 0, 1, 65535);
+}
+
+
+void test_identity_leaves_readings_alone (void)
+{
+    ColorCalibration calibration;
+    RGBCSample reading = sample (0, 123, 4567, 65535);
+
+    calibration.correct (reading);
+    check (reading, 0, 123, 4567, 65535);
+}
+
+
+void test_white_gains_in_fixed_point (void)
+{
+    ColorCalibration calibration;
+
+    // With no dark frame, the gains bring each channel to the mean of 2000
+    TEST_ASSERT_TRUE (calibration.set_white (sample (1000, 2000, 3000, 6000),
+                                             16));
+    const CalibrationRecord& record = calibration.get_record ();
+    TEST_ASSERT_EQUAL_UINT16 (2 * CAL_GAIN_ONE, record.gain[0]);
+    TEST_ASSERT_EQUAL_UINT16 (CAL_GAIN_ONE, record.gain[1]);
+    TEST_ASSERT_EQUAL_UINT16 ((2 * CAL_GAIN_ONE + 1) / 3, record.gain[2]);
+
+    // White reads as gray, and the clear channel isn't scaled
+    RGBCSample reading = sample (1000, 2000, 3000, 6000);
+    calibration.correct (reading);
+    check (reading, 2000, 2000, 2000, 6000);
+
+    // Large counts are limited to 16 bits instead of wrapping
+    reading = sample (40000, 40000, 40000, 40000);
+    calibration.correct (reading);
+    check (reading, 65535, 40000, 26669, 40000);
+}
+
+
+void test_dark_offsets_are_subtracted (void)
+{
+    ColorCalibration calibration;
+
+    calibration.set_dark (sample (10, 20, 30, 40), 16);
+    TEST_ASSERT_TRUE (calibration.set_white (sample (1010, 1020, 1030, 3040),
+                                             16));
+
+    RGBCSample reading = sample (510, 520, 530, 1540);
+    calibration.correct (reading);
+    check (reading, 500, 500, 500, 1500);
+
+    // Readings darker than the dark frame give zero, not a wrapped count
+    reading = sample (5, 20, 29, 0);
+    calibration.correct (reading);
+    check (reading, 0, 0, 0, 0);
+}
+
+
+void test_offsets_scale_with_sensitivity (void)
+{
+    ColorCalibration calibration;
+    RGBCSample reading;
+
+    calibration.set_dark (sample (10, 20, 30, 40), 64);
+
+    // Four times the sensitivity gives four times the dark counts
+    calibration.set_exposure (256);
+    reading = sample (100, 100, 100, 200);
+    calibration.correct (reading);
+    check (reading, 60, 20, 0, 40);
+
+    // A quarter of the sensitivity gives a quarter, rounded down
+    calibration.set_exposure (16);
+    reading = sample (100, 100, 100, 200);
+    calibration.correct (reading);
+    check (reading, 98, 95, 93, 190);
+
+    // The stored offsets stay as they were measured
+    TEST_ASSERT_EQUAL_UINT16 (10, calibration.get_record ().offset[0]);
+    TEST_ASSERT_EQUAL_UINT16 (64, calibration.get_record ().sensitivity);
+
+    // Scaled offsets too large for 16 bits are limited, not wrapped
+    calibration.set_dark (sample (40000, 0, 0, 0), 1);
+    calibration.set_exposure (2);
+    reading = sample (65535, 0, 0, 0);
+    calibration.correct (reading);
+    TEST_ASSERT_EQUAL_UINT16 (0, reading.r);
+}
+
+
+void test_bad_white_leaves_gains_alone (void)
+{
+    ColorCalibration calibration;
+
+    TEST_ASSERT_TRUE (calibration.set_white (sample (1000, 2000, 3000, 0), 1));
+    calibration.set_dark (sample (100, 100, 100, 100), 1);
+
+    // Blue barely above its dark count
+    TEST_ASSERT_FALSE (calibration.set_white (sample (5000, 5000, 115, 0), 1));
+
+    // Red so weak that its gain wouldn't fit in 16 bits
+    TEST_ASSERT_FALSE (calibration.set_white (sample (120, 60000, 60000, 0),
+                                              1));
+
+    const CalibrationRecord& record = calibration.get_record ();
+    TEST_ASSERT_EQUAL_UINT16 (2 * CAL_GAIN_ONE, record.gain[0]);
+    TEST_ASSERT_EQUAL_UINT16 (CAL_GAIN_ONE, record.gain[1]);
+}
+
+
+void test_save_and_load_round_trip (void)
+{
+    ColorCalibration saved;
+
+    saved.set_dark (sample (12, 34, 56, 78), 64);
+    TEST_ASSERT_TRUE (saved.set_white (sample (900, 1500, 2100, 4000), 64));
+    saved.save ();
+
+    ColorCalibration loaded;
+    TEST_ASSERT_TRUE (loaded.load ());
+    const CalibrationRecord& a = saved.get_record ();
+    const CalibrationRecord& b = loaded.get_record ();
+    for (uint8_t ch = 0; ch < 4; ch++)
+    {
+        TEST_ASSERT_EQUAL_UINT16 (a.offset[ch], b.offset[ch]);
+    }
+    for (uint8_t ch = 0; ch < 3; ch++)
+    {
+        TEST_ASSERT_EQUAL_UINT16 (a.gain[ch], b.gain[ch]);
+    }
+    TEST_ASSERT_EQUAL_UINT16 (64, b.sensitivity);
+    TEST_ASSERT_EQUAL_HEX16 (nv_crc16 (&b, offsetof (CalibrationRecord, crc)),
+                             b.crc);
+
+    // Both correct a reading the same way at another sensitivity
+    RGBCSample one = sample (1000, 1000, 1000, 3000);
+    RGBCSample two = one;
+    saved.set_exposure (128);
+    loaded.set_exposure (128);
+    saved.correct (one);
+    loaded.correct (two);
+    check (two, one.r, one.g, one.b, one.c);
+}
+
+
+void test_blank_storage_gives_identity (void)
+{
+    ColorCalibration calibration;
+
+    TEST_ASSERT_FALSE (calibration.load ());
+    RGBCSample reading = sample (100, 200, 300, 400);
+    calibration.correct (reading);
+    check (reading, 100, 200, 300, 400);
+}
+
+
+void test_corrupted_record_gives_identity (void)
+{
+    ColorCalibration saved;
+
+    saved.set_dark (sample (50, 50, 50, 50), 1);
+    TEST_ASSERT_TRUE (saved.set_white (sample (550, 1050, 1550, 3000), 1));
+    saved.save ();
+
+    // A bit flipped in one of the gains is caught by the CRC
+    uint16_t address = NV_CALIBRATION_ADDR + offsetof (CalibrationRecord, gain);
+    EEPROM.write (address, EEPROM.read (address) ^ 0x04);
+
+    ColorCalibration loaded;
+    loaded.set_dark (sample (9, 9, 9, 9), 1);
+    TEST_ASSERT_FALSE (loaded.load ());
+    RGBCSample reading = sample (100, 200, 300, 400);
+    loaded.correct (reading);
+    check (reading, 100, 200, 300, 400);
+
+    // So is a CRC which doesn't match the record
+    saved.save ();
+    address = NV_CALIBRATION_ADDR + offsetof (CalibrationRecord, crc);
+    EEPROM.write (address, EEPROM.read (address) + 1);
+    TEST_ASSERT_FALSE (loaded.load ());
+    TEST_ASSERT_EQUAL_UINT16 (CAL_GAIN_ONE, loaded.get_record ().gain[0]);
+}
+
+
+int main (int argc, char** argv)
+{
+    UNITY_BEGIN ();
+    RUN_TEST (test_averager_rounds_the_mean);
+    RUN_TEST (test_identity_leaves_readings_alone);
+    RUN_TEST (test_white_gains_in_fixed_point);
+    RUN_TEST (test_dark_offsets_are_subtracted);
+    RUN_TEST (test_offsets_scale_with_sensitivity);
+    RUN_TEST (test_bad_white_leaves_gains_alone);
+    RUN_TEST (test_save_and_load_round_trip);
+    RUN_TEST (test_blank_storage_gives_identity);
+    RUN_TEST (test_corrupted_record_gives_identity);
+    return UNITY_END ();
+}
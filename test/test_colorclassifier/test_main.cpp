@@ -0,0 +1,324 @@
+//*****************************************************************************
+/** @file    test_main.cpp
+ *  @brief   Tests of the chromaticity color classifier and its trainer.
+ *  @details Labeled readings of simulated balls, each color seen at several
+ *           brightnesses and with noise, train the classifier; other readings
+ *           then check its choices, the distance and margin rejections, and
+ *           that trained centroids are saved and loaded.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <unity.h>
+#include <stddef.h>
+#include <EEPROM.h>
+#include "colorclassifier.h"
+#include "nvstore.h"
+
+
+/// Red, green and blue counts of the three ball colors in moderate light
+static const uint16_t ball_colors[3][3] = {{3000, 1200, 800},    // red
+                                           {1100, 2600, 1300},   // green
+                                           {700, 1300, 2500}};   // blue
+
+/// State of the pseudorandom noise
+static uint32_t noise_state;
+
+
+/// Return a pseudorandom number from 0 up to but not including @c limit
+static uint32_t noise (uint32_t limit)
+{
+    noise_state = noise_state * 1664525UL + 1013904223UL;
+    return (noise_state >> 8) % limit;
+}
+
+
+/// Make a reading of a color, scaled by brightness in percent, with up to
+/// @c percent of noise in each channel
+static RGBCSample reading_of (const uint16_t* p_color, uint32_t brightness,
+                              uint32_t percent)
+{
+    uint16_t counts[3];
+
+    for (uint8_t ch = 0; ch < 3; ch++)
+    {
+        uint32_t count = p_color[ch] * brightness / 100;
+        int32_t jitter = (int32_t)noise (2 * percent + 1) - (int32_t)percent;
+        counts[ch] = count + (int32_t)count * jitter / 100;
+    }
+    RGBCSample reading = {counts[0], counts[1], counts[2],
+                          (uint16_t)(counts[0] + counts[1] + counts[2])};
+    return reading;
+}
+
+
+/// Train a classifier on readings of the three ball colors
+static uint8_t train_balls (ColorClassifier& classifier, uint32_t percent)
+{
+    CentroidTrainer trainer;
+
+    for (uint8_t bin = 0; bin < 3; bin++)
+    {
+        for (uint16_t index = 0; index < 64; index++)
+        {
+            uint32_t brightness = 40 + noise (160);
+            trainer.add (reading_of (ball_colors[bin], brightness, percent),
+                         bin);
+        }
+    }
+    return trainer.train (classifier, 100UL * 100UL, 32);
+}
+
+
+void setUp (void)
+{
+    noise_state = 12345;
+    EEPROM.erase ();
+}
+
+
+void tearDown (void)
+{
+}
+
+
+void test_chroma_ignores_brightness (void)
+{
+    RGBCSample dim = {100, 200, 100, 0};
+    RGBCSample bright = {10000, 20000, 10000, 0};
+    RGBCSample black = {0, 0, 0, 500};
+    Chroma a;
+    Chroma b;
+
+    TEST_ASSERT_TRUE (ColorClassifier::to_chroma (dim, a));
+    TEST_ASSERT_TRUE (ColorClassifier::to_chroma (bright, b));
+    TEST_ASSERT_EQUAL_UINT16 (1024, a.r);
+    TEST_ASSERT_EQUAL_UINT16 (2048, a.g);
+    TEST_ASSERT_EQUAL_UINT32 (0, ColorClassifier::distance (a, b));
+    TEST_ASSERT_FALSE (ColorClassifier::to_chroma (black, a));
+
+    // The largest distance there can be, from pure red to pure green
+    Chroma red = {4096, 0};
+    Chroma green = {0, 4096};
+    TEST_ASSERT_EQUAL_UINT32 (2UL * 4096 * 4096,
+                              ColorClassifier::distance (red, green));
+}
+
+
+void test_nearest_centroid_and_rejections (void)
+{
+    ColorClassifier classifier;
+    Centroid red = {{2458, 1024}, 0};
+    Centroid green = {{1229, 2048}, 1};
+
+    // With no centroids everything is rejected
+    RGBCSample reading = {3000, 1250, 750, 5000};
+    TEST_ASSERT_EQUAL_UINT8 (BIN_REJECT, classifier.classify (reading).bin);
+
+    classifier.add_centroid (red);
+    classifier.add_centroid (green);
+    classifier.set_limits (300UL * 300UL, 100UL * 100UL, 32);
+    Classification result = classifier.classify (reading);
+    TEST_ASSERT_EQUAL_UINT8 (0, result.bin);
+    TEST_ASSERT_TRUE (classifier.is_ball (result));
+
+    // Too dim to trust, though it's the right color
+    RGBCSample dim = {15, 6, 4, 25};
+    TEST_ASSERT_EQUAL_UINT8 (BIN_REJECT, classifier.classify (dim).bin);
+
+    // Gray is far from both centroids, so it isn't a ball at all
+    RGBCSample gray = {1000, 1000, 1000, 3000};
+    result = classifier.classify (gray);
+    TEST_ASSERT_EQUAL_UINT8 (BIN_REJECT, result.bin);
+    TEST_ASSERT_FALSE (classifier.is_ball (result));
+
+    // Halfway between red and green is a ball, but of neither bin for sure
+    Chroma middle = {(2458 + 1229) / 2, (1024 + 2048) / 2};
+    classifier.set_limits (800UL * 800UL, 100UL * 100UL, 32);
+    result = classifier.classify (middle);
+    TEST_ASSERT_EQUAL_UINT8 (BIN_REJECT, result.bin);
+    TEST_ASSERT_TRUE (classifier.is_ball (result));
+    TEST_ASSERT_LESS_THAN (100UL * 100UL, result.margin);
+}
+
+
+void test_margin_is_to_another_bin (void)
+{
+    ColorClassifier classifier;
+    Centroid near = {{2400, 1000}, 0};
+    Centroid also_red = {{2450, 1050}, 0};
+    Centroid green = {{1229, 2048}, 1};
+
+    // A second centroid of the same bin close by doesn't spoil the margin
+    classifier.add_centroid (near);
+    classifier.add_centroid (also_red);
+    classifier.add_centroid (green);
+    Classification result = classifier.classify (near.where);
+    TEST_ASSERT_EQUAL_UINT8 (0, result.bin);
+    TEST_ASSERT_EQUAL_UINT32 (0, result.distance);
+    TEST_ASSERT_EQUAL_UINT32 (ColorClassifier::distance (near.where,
+                                                         green.where),
+                              result.margin);
+}
+
+
+void test_centroids_are_limited (void)
+{
+    ColorClassifier classifier;
+    Centroid centroid = {{1000, 1000}, BIN_REJECT};
+
+    TEST_ASSERT_FALSE (classifier.add_centroid (centroid));
+    centroid.bin = 0;
+    for (uint8_t index = 0; index < MAX_CENTROIDS; index++)
+    {
+        TEST_ASSERT_TRUE (classifier.add_centroid (centroid));
+    }
+    TEST_ASSERT_FALSE (classifier.add_centroid (centroid));
+    TEST_ASSERT_EQUAL_UINT8 (MAX_CENTROIDS, classifier.get_num_centroids ());
+}
+
+
+void test_trainer_finds_the_means (void)
+{
+    CentroidTrainer trainer;
+    Centroid centroid;
+    RGBCSample black = {0, 0, 0, 0};
+
+    TEST_ASSERT_FALSE (trainer.add (black, 0));
+    TEST_ASSERT_FALSE (trainer.add (reading_of (ball_colors[0], 100, 0),
+                                    MAX_TRAINED_BINS));
+    TEST_ASSERT_FALSE (trainer.get_centroid (0, centroid));
+
+    // Two readings either side of a point average to it, with a spread of
+    // the squared distance of each from it
+    RGBCSample one = {1000, 1000, 2096, 0};   // r = g = 1000
+    RGBCSample two = {1200, 1200, 1696, 0};   // r = g = 1200
+    TEST_ASSERT_TRUE (trainer.add (one, 2));
+    TEST_ASSERT_TRUE (trainer.add (two, 2));
+    TEST_ASSERT_TRUE (trainer.get_centroid (2, centroid));
+    TEST_ASSERT_EQUAL_UINT8 (2, centroid.bin);
+    TEST_ASSERT_EQUAL_UINT16 (1100, centroid.where.r);
+    TEST_ASSERT_EQUAL_UINT16 (1100, centroid.where.g);
+    TEST_ASSERT_EQUAL_UINT32 (2 * 100 * 100, trainer.get_variance (2));
+    TEST_ASSERT_EQUAL_UINT32 (0, trainer.get_variance (1));
+
+    trainer.clear ();
+    TEST_ASSERT_FALSE (trainer.get_centroid (2, centroid));
+}
+
+
+void test_trained_classifier_sorts_new_readings (void)
+{
+    ColorClassifier classifier;
+
+    TEST_ASSERT_EQUAL_UINT8 (3, train_balls (classifier, 5));
+    TEST_ASSERT_EQUAL_UINT8 (3, classifier.get_num_centroids ());
+
+    // Fresh readings over a wider range of brightness all go to their bins
+    uint16_t wrong = 0;
+    for (uint8_t bin = 0; bin < 3; bin++)
+    {
+        for (uint16_t index = 0; index < 200; index++)
+        {
+            uint32_t brightness = 20 + noise (300);
+            RGBCSample reading = reading_of (ball_colors[bin], brightness, 5);
+            if (classifier.classify (reading).bin != bin)
+            {
+                wrong++;
+            }
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT16 (0, wrong);
+}
+
+
+void test_trained_limits_reject_strangers (void)
+{
+    ColorClassifier classifier;
+
+    train_balls (classifier, 2);
+
+    // Tight clusters get the least distance limit, not one too strict
+    TEST_ASSERT_EQUAL_UINT32 (80UL * 80UL, classifier.get_max_distance ());
+    TEST_ASSERT_EQUAL_UINT32 (100UL * 100UL, classifier.get_min_margin ());
+
+    // A yellow ball is like nothing trained, so it isn't a ball of any bin
+    const uint16_t yellow[3] = {2600, 2400, 500};
+    Classification result = classifier.classify (reading_of (yellow, 100, 0));
+    TEST_ASSERT_EQUAL_UINT8 (BIN_REJECT, result.bin);
+    TEST_ASSERT_FALSE (classifier.is_ball (result));
+
+    // Noisier training readings widen the limit to six times the spread
+    train_balls (classifier, 15);
+    TEST_ASSERT_GREATER_THAN (80UL * 80UL, classifier.get_max_distance ());
+    RGBCSample reading = reading_of (ball_colors[2], 100, 0);
+    TEST_ASSERT_EQUAL_UINT8 (2, classifier.classify (reading).bin);
+}
+
+
+void test_trained_centroids_are_saved_and_loaded (void)
+{
+    ColorClassifier trained;
+    train_balls (trained, 5);
+    trained.save ();
+
+    // The defaults given beforehand are replaced by what was saved
+    ColorClassifier loaded;
+    Centroid other = {{1000, 1000}, 3};
+    loaded.add_centroid (other);
+    TEST_ASSERT_TRUE (loaded.load ());
+    TEST_ASSERT_EQUAL_UINT8 (3, loaded.get_num_centroids ());
+    for (uint8_t index = 0; index < 3; index++)
+    {
+        const Centroid& a = trained.get_centroid (index);
+        const Centroid& b = loaded.get_centroid (index);
+        TEST_ASSERT_EQUAL_UINT16 (a.where.r, b.where.r);
+        TEST_ASSERT_EQUAL_UINT16 (a.where.g, b.where.g);
+        TEST_ASSERT_EQUAL_UINT8 (a.bin, b.bin);
+    }
+    TEST_ASSERT_EQUAL_UINT32 (trained.get_max_distance (),
+                              loaded.get_max_distance ());
+    TEST_ASSERT_EQUAL_UINT32 (trained.get_min_margin (),
+                              loaded.get_min_margin ());
+    TEST_ASSERT_EQUAL_UINT16 (trained.get_min_sum (), loaded.get_min_sum ());
+}
+
+
+void test_bad_record_keeps_the_defaults (void)
+{
+    ColorClassifier classifier;
+    Centroid other = {{1000, 1000}, 3};
+
+    // Nothing saved yet
+    classifier.add_centroid (other);
+    TEST_ASSERT_FALSE (classifier.load ());
+    TEST_ASSERT_EQUAL_UINT8 (1, classifier.get_num_centroids ());
+
+    // A bit flipped in a saved centroid is caught by the CRC
+    ColorClassifier trained;
+    train_balls (trained, 5);
+    trained.save ();
+    uint16_t address = NV_CLASSIFIER_ADDR
+                       + offsetof (ClassifierRecord, centroids);
+    EEPROM.write (address, EEPROM.read (address) ^ 0x01);
+    TEST_ASSERT_FALSE (classifier.load ());
+    TEST_ASSERT_EQUAL_UINT8 (1, classifier.get_num_centroids ());
+    TEST_ASSERT_EQUAL_UINT8 (3, classifier.get_centroid (0).bin);
+}
+
+
+int main (int argc, char** argv)
+{
+    UNITY_BEGIN ();
+    RUN_TEST (test_chroma_ignores_brightness);
+    RUN_TEST (test_nearest_centroid_and_rejections);
+    RUN_TEST (test_margin_is_to_another_bin);
+    RUN_TEST (test_centroids_are_limited);
+    RUN_TEST (test_trainer_finds_the_means);
+    RUN_TEST (test_trained_classifier_sorts_new_readings);
+    RUN_TEST (test_trained_limits_reject_strangers);
+    RUN_TEST (test_trained_centroids_are_saved_and_loaded);
+    RUN_TEST (test_bad_record_keeps_the_defaults);
+    return UNITY_END ();
+}
@@ -0,0 +1,234 @@
+//*****************************************************************************
+/** @file    test_main.cpp
+ *  @brief   Tests of the ripple filter.
+ *  @details Readings are made up at the sensor's shortest integration time,
+ *           some of them with the flicker of lamps on 50 Hz and 60 Hz mains,
+ *           and given to the filter with their times.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <unity.h>
+#include <math.h>
+#include "colorfilter.h"
+
+
+/// Microseconds between readings at the shortest integration time
+#define READING_US 2400
+
+
+/// Make a reading with the same count in every channel
+static RGBCSample flat (uint16_t count)
+{
+    RGBCSample reading = {count, count, count, count};
+    return reading;
+}
+
+
+/** @brief   Filter a second of readings of light which flickers.
+ *  @param   filter The filter to be given the readings
+ *  @param   ripple_hz The flicker frequency, twice the mains frequency
+ *  @param   worst Set to the largest error of a filtered clear count, in
+ *           parts per thousand of the steady brightness
+ *  @return  The number of filtered readings
+ */
+static uint16_t filter_flicker (RippleFilter& filter, float ripple_hz,
+                                uint32_t& worst)
+{
+    const float steady = 2000.0;
+    RGBCSample result;
+    uint16_t windows = 0;
+
+    worst = 0;
+    for (uint32_t time = 0; time < 1000000; time += READING_US)
+    {
+        // Each reading integrates the light over its 2.4 ms; the lamp's
+        // brightness swings 40% either way
+        float t0 = time * 1e-6;
+        float t1 = (time + READING_US) * 1e-6;
+        float w = 2.0 * M_PI * ripple_hz;
+        float mean = steady + 0.4 * steady * (cos (w * t0) - cos (w * t1))
+                              / (w * (t1 - t0));
+        uint16_t count = (uint16_t)(mean + 0.5);
+        RGBCSample reading = {count, count, count, count};
+        if (filter.add (reading, time, result))
+        {
+            uint32_t error = fabs (result.c - steady) * 1000 / steady;
+            worst = (error > worst) ? error : worst;
+            windows++;
+        }
+    }
+    return windows;
+}
+
+
+void setUp (void)
+{
+}
+
+
+void tearDown (void)
+{
+}
+
+
+void test_boxcar_averages_each_window (void)
+{
+    RippleFilter filter (RippleFilter::BOXCAR, 10000);
+    RGBCSample result;
+    uint32_t time = 0;
+
+    // Readings at 0, 2400, 4800 and 7200 us make up the first window
+    const uint16_t counts[] = {100, 200, 300, 401};
+    for (uint16_t count : counts)
+    {
+        TEST_ASSERT_FALSE (filter.add (flat (count), time, result));
+        time += READING_US;
+    }
+    TEST_ASSERT_EQUAL_UINT16 (4, filter.get_count ());
+
+    // The reading which ends the window is the first of the next
+    TEST_ASSERT_TRUE (filter.add (flat (1000), 10000, result));
+    TEST_ASSERT_EQUAL_UINT16 (250, result.r);
+    TEST_ASSERT_EQUAL_UINT16 (250, result.c);
+    TEST_ASSERT_EQUAL_UINT16 (4, filter.get_window_count ());
+    TEST_ASSERT_EQUAL_UINT16 (1, filter.get_count ());
+
+    TEST_ASSERT_TRUE (filter.add (flat (0), 20000, result));
+    TEST_ASSERT_EQUAL_UINT16 (1000, result.g);
+}
+
+
+void test_windows_stay_back_to_back (void)
+{
+    RippleFilter filter (RippleFilter::BOXCAR, 10000);
+    RGBCSample result;
+    uint16_t windows = 0;
+
+    // Readings every 3 ms don't fall on the window edges, but the windows
+    // still begin every 10 ms rather than at the reading which ended one
+    for (uint32_t time = 0; time <= 300000; time += 3000)
+    {
+        windows += filter.add (flat (500), time, result);
+    }
+    TEST_ASSERT_EQUAL_UINT16 (30, windows);
+
+    // After a long gap the next window starts at the reading after it
+    filter.add (flat (500), 1000000, result);
+    TEST_ASSERT_FALSE (filter.add (flat (500), 1009000, result));
+    TEST_ASSERT_TRUE (filter.add (flat (500), 1010000, result));
+}
+
+
+void test_window_rolls_over_with_the_clock (void)
+{
+    RippleFilter filter (RippleFilter::BOXCAR, 10000);
+    RGBCSample result;
+    uint32_t time = UINT32_MAX - 5000;
+
+    TEST_ASSERT_FALSE (filter.add (flat (100), time, result));
+    TEST_ASSERT_FALSE (filter.add (flat (300), time + 4000, result));
+    TEST_ASSERT_FALSE (filter.add (flat (900), time + 8000, result));
+    TEST_ASSERT_TRUE (filter.add (flat (900), time + 10000, result));
+    TEST_ASSERT_EQUAL_UINT16 (433, result.c);
+    TEST_ASSERT_EQUAL_UINT16 (3, filter.get_window_count ());
+}
+
+
+void test_reset_starts_a_fresh_window (void)
+{
+    RippleFilter filter (RippleFilter::BOXCAR, 10000);
+    RGBCSample result;
+
+    filter.add (flat (5000), 0, result);
+    filter.add (flat (5000), 2400, result);
+    filter.reset ();
+    TEST_ASSERT_EQUAL_UINT16 (0, filter.get_count ());
+    TEST_ASSERT_FALSE (filter.add (flat (100), 4800, result));
+    TEST_ASSERT_FALSE (filter.add (flat (100), 12000, result));
+    TEST_ASSERT_TRUE (filter.add (flat (100), 14800, result));
+    TEST_ASSERT_EQUAL_UINT16 (100, result.c);
+}
+
+
+void test_exponential_follows_a_step (void)
+{
+    RippleFilter filter (RippleFilter::EXPONENTIAL, 10000, 2);
+    RGBCSample result;
+    uint32_t time = 0;
+
+    // The first reading sets the average at once
+    for (time = 0; !filter.add (flat (1000), time, result); time += READING_US)
+    {
+    }
+    TEST_ASSERT_EQUAL_UINT16 (1000, result.c);
+
+    // A quarter of the way to each new reading; the average carries on
+    // from one window to the next rather than starting again
+    uint16_t last = 1000;
+    uint8_t windows = 0;
+    while (windows < 6)
+    {
+        time += READING_US;
+        if (filter.add (flat (2000), time, result))
+        {
+            TEST_ASSERT_GREATER_THAN (last, result.c);
+            TEST_ASSERT_LESS_OR_EQUAL (2000, result.c);
+            last = result.c;
+            windows++;
+        }
+    }
+    TEST_ASSERT_UINT32_WITHIN (10, 2000, last);
+
+    // And down again
+    for (windows = 0; windows < 6; )
+    {
+        time += READING_US;
+        windows += filter.add (flat (500), time, result);
+    }
+    TEST_ASSERT_UINT32_WITHIN (10, 500, result.c);
+}
+
+
+void test_boxcar_rejects_mains_ripple (void)
+{
+    uint32_t worst;
+
+    // Without the filter a single reading is off by up to 40%
+    RippleFilter single (RippleFilter::BOXCAR, 1);
+    filter_flicker (single, 100.0, worst);
+    TEST_ASSERT_GREATER_THAN (300, worst);
+
+    RippleFilter fifty (RippleFilter::BOXCAR);
+    TEST_ASSERT_EQUAL_UINT16 (19, filter_flicker (fifty, 100.0, worst));
+    TEST_ASSERT_LESS_THAN (30, worst);
+
+    RippleFilter sixty (RippleFilter::BOXCAR);
+    filter_flicker (sixty, 120.0, worst);
+    TEST_ASSERT_LESS_THAN (30, worst);
+}
+
+
+void test_exponential_rejects_some_ripple (void)
+{
+    uint32_t worst;
+
+    RippleFilter filter (RippleFilter::EXPONENTIAL);
+    filter_flicker (filter, 100.0, worst);
+    TEST_ASSERT_LESS_THAN (300, worst);
+}
+
+
+int main (int argc, char** argv)
+{
+    UNITY_BEGIN ();
+    RUN_TEST (test_boxcar_averages_each_window);
+    RUN_TEST (test_windows_stay_back_to_back);
+    RUN_TEST (test_window_rolls_over_with_the_clock);
+    RUN_TEST (test_reset_starts_a_fresh_window);
+    RUN_TEST (test_exponential_follows_a_step);
+    RUN_TEST (test_boxcar_rejects_mains_ripple);
+    RUN_TEST (test_exponential_rejects_some_ripple);
+    return UNITY_END ();
+}
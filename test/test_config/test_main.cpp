@@ -0,0 +1,224 @@
+//*****************************************************************************
+/** @file    test_main.cpp
+ *  @brief   Tests of the configuration record kept in emulated EEPROM.
+ *  @details Records are saved to and corrupted in the stand-in EEPROM, and
+ *           loaded back to check which settings survive.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <unity.h>
+#include <EEPROM.h>
+#include "config.h"
+
+
+/// Copy of the record as it's stored, for tests which change it
+static ConfigRecord stored;
+
+
+/// Read the stored record into @c stored
+static void read_stored (void)
+{
+    nv_read (NV_CONFIG_ADDR, &stored, sizeof (stored));
+}
+
+
+/// Write @c stored back with a good CRC over its header and values
+static void write_stored (void)
+{
+    size_t header = sizeof (ConfigRecord) - sizeof (stored.value);
+
+    stored.crc = 0;
+    stored.crc = nv_crc16 (&stored, header
+                                    + sizeof (uint32_t) * stored.num_items);
+    nv_write (NV_CONFIG_ADDR, &stored, sizeof (stored));
+}
+
+
+void setUp (void)
+{
+    EEPROM.erase ();
+}
+
+
+void tearDown (void)
+{
+}
+
+
+void test_blank_storage_gives_defaults (void)
+{
+    SorterConfig config;
+
+    TEST_ASSERT_EQUAL (SorterConfig::DEFAULTS, config.load ());
+    TEST_ASSERT_EQUAL_UINT32 (11, config.get (CFG_STEP_MS));
+    TEST_ASSERT_EQUAL_UINT32 (50000, config.get (CFG_WINDOW_US));
+    TEST_ASSERT_TRUE (config.is_changed ());
+}
+
+
+void test_saved_settings_load_back (void)
+{
+    SorterConfig config;
+
+    TEST_ASSERT_TRUE (config.set (CFG_STEP_MS, 7));
+    TEST_ASSERT_TRUE (config.set (CFG_HOME_STEPS, 123));
+    config.save ();
+    TEST_ASSERT_FALSE (config.is_changed ());
+
+    SorterConfig loaded;
+    TEST_ASSERT_EQUAL (SorterConfig::LOADED, loaded.load ());
+    TEST_ASSERT_EQUAL_UINT32 (7, loaded.get (CFG_STEP_MS));
+    TEST_ASSERT_EQUAL_UINT32 (123, loaded.get (CFG_HOME_STEPS));
+    TEST_ASSERT_FALSE (loaded.is_changed ());
+}
+
+
+void test_corrupted_value_gives_defaults (void)
+{
+    SorterConfig config;
+
+    config.set (CFG_STEP_MS, 7);
+    config.save ();
+    read_stored ();
+    stored.value[CFG_LOAD_MS] ^= 0x10;      // A bit flipped in flash
+    nv_write (NV_CONFIG_ADDR, &stored, sizeof (stored));
+
+    SorterConfig loaded;
+    TEST_ASSERT_EQUAL (SorterConfig::DEFAULTS, loaded.load ());
+    TEST_ASSERT_EQUAL_UINT32 (11, loaded.get (CFG_STEP_MS));
+}
+
+
+void test_corrupted_crc_gives_defaults (void)
+{
+    SorterConfig config;
+
+    config.save ();
+    read_stored ();
+    stored.crc++;
+    nv_write (NV_CONFIG_ADDR, &stored, sizeof (stored));
+
+    TEST_ASSERT_EQUAL (SorterConfig::DEFAULTS, config.load ());
+}
+
+
+void test_bad_magic_gives_defaults (void)
+{
+    SorterConfig config;
+
+    config.set (CFG_STEP_MS, 7);
+    config.save ();
+    read_stored ();
+    stored.magic = 0x1234;
+    write_stored ();
+
+    TEST_ASSERT_EQUAL (SorterConfig::DEFAULTS, config.load ());
+    TEST_ASSERT_EQUAL_UINT32 (11, config.get (CFG_STEP_MS));
+}
+
+
+void test_too_many_items_gives_defaults (void)
+{
+    SorterConfig config;
+
+    config.save ();
+    read_stored ();
+    stored.num_items = CONFIG_MAX_ITEMS + 1;
+    nv_write (NV_CONFIG_ADDR, &stored, sizeof (stored));
+
+    TEST_ASSERT_EQUAL (SorterConfig::DEFAULTS, config.load ());
+}
+
+
+void test_older_record_is_migrated (void)
+{
+    SorterConfig config;
+
+    // A record from before the homing settings were added
+    config.set (CFG_STEP_MS, 9);
+    config.save ();
+    read_stored ();
+    stored.version = 2;
+    stored.num_items = CFG_INDEX + 1;
+    write_stored ();
+
+    SorterConfig loaded;
+    loaded.set (CFG_HOME_STEPS, 200);
+    TEST_ASSERT_EQUAL (SorterConfig::MIGRATED, loaded.load ());
+    TEST_ASSERT_EQUAL_UINT32 (9, loaded.get (CFG_STEP_MS));
+    TEST_ASSERT_EQUAL_UINT32 (0, loaded.get (CFG_HOME_STEPS));
+    TEST_ASSERT_EQUAL_UINT32 (4, loaded.get (CFG_HOME_FAST_MS));
+    TEST_ASSERT_TRUE (loaded.is_changed ());
+}
+
+
+void test_newer_record_keeps_known_settings (void)
+{
+    SorterConfig config;
+
+    config.set (CFG_HOME_SLOW_MS, 30);
+    config.save ();
+    read_stored ();
+    stored.version = 4;
+    stored.num_items = CFG_NUM_ITEMS + 2;
+    stored.value[CFG_NUM_ITEMS] = 77;
+    stored.value[CFG_NUM_ITEMS + 1] = 88;
+    write_stored ();
+
+    SorterConfig loaded;
+    TEST_ASSERT_EQUAL (SorterConfig::MIGRATED, loaded.load ());
+    TEST_ASSERT_EQUAL_UINT32 (30, loaded.get (CFG_HOME_SLOW_MS));
+}
+
+
+void test_out_of_range_value_gets_default (void)
+{
+    SorterConfig config;
+
+    config.set (CFG_LOAD_MS, 400);
+    config.save ();
+    read_stored ();
+    stored.value[CFG_STEP_MS] = 1000;       // Above step_ms's limit of 100
+    write_stored ();
+
+    SorterConfig loaded;
+    TEST_ASSERT_EQUAL (SorterConfig::MIGRATED, loaded.load ());
+    TEST_ASSERT_EQUAL_UINT32 (11, loaded.get (CFG_STEP_MS));
+    TEST_ASSERT_EQUAL_UINT32 (400, loaded.get (CFG_LOAD_MS));
+}
+
+
+void test_set_checks_range_and_name (void)
+{
+    SorterConfig config;
+
+    TEST_ASSERT_FALSE (config.set (CFG_STEP_MS, 1));
+    TEST_ASSERT_FALSE (config.set (CFG_NUM_ITEMS, 1));
+    TEST_ASSERT_EQUAL_UINT32 (11, config.get (CFG_STEP_MS));
+    TEST_ASSERT_EQUAL (CFG_PULSE_US, config.find ("pulse_us"));
+    TEST_ASSERT_EQUAL (-1, config.find ("no_such_setting"));
+    TEST_ASSERT_EQUAL_STRING ("home_slow_ms",
+                              SorterConfig::get_name (CFG_HOME_SLOW_MS));
+    TEST_ASSERT_NULL (SorterConfig::get_name (CFG_NUM_ITEMS));
+    TEST_ASSERT_TRUE (SorterConfig::is_at_boot (CFG_IDLE_MS));
+    TEST_ASSERT_FALSE (SorterConfig::is_at_boot (CFG_STEP_MS));
+}
+
+
+int main (int argc, char** argv)
+{
+    UNITY_BEGIN ();
+    RUN_TEST (test_blank_storage_gives_defaults);
+    RUN_TEST (test_saved_settings_load_back);
+    RUN_TEST (test_corrupted_value_gives_defaults);
+    RUN_TEST (test_corrupted_crc_gives_defaults);
+    RUN_TEST (test_bad_magic_gives_defaults);
+    RUN_TEST (test_too_many_items_gives_defaults);
+    RUN_TEST (test_older_record_is_migrated);
+    RUN_TEST (test_newer_record_keeps_known_settings);
+    RUN_TEST (test_out_of_range_value_gets_default);
+    RUN_TEST (test_set_checks_range_and_name);
+    return UNITY_END ();
+}
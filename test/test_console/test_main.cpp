@@ -0,0 +1,236 @@
+//*****************************************************************************
+/** @file    test_main.cpp
+ *  @brief   Tests of the console's line parser and command table.
+ *  @details Characters are typed into the stand-in serial port, as a
+ *           terminal sends them, and what the console prints is checked.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <unity.h>
+#include <PrintStream.h>
+#include "console.h"
+
+
+/// Number given to the last run of the @c set command
+static uint32_t set_value;
+
+
+/// Command which takes a number
+static bool command_set (const LineParser& line, Print& output)
+{
+    if (line.get_num_words () != 2
+        || !LineParser::to_number (line.get_word (1), set_value))
+    {
+        return false;
+    }
+    output << "set " << set_value << endl;
+    return true;
+}
+
+
+/// Command which takes no words
+static bool command_ping (const LineParser& line, Print& output)
+{
+    output << "pong" << endl;
+    return line.get_num_words () == 1;
+}
+
+
+/// The commands the tested console understands
+static const ConsoleCommand commands[] =
+{
+    {"set", "<number>", command_set},
+    {"ping", "", command_ping}
+};
+
+/// The console which is tested; shares are made globally, as they stay in
+/// the list of shares for good
+static SerialConsole console ("Console", commands,
+                              sizeof (commands) / sizeof (commands[0]));
+
+
+/// Give a parser a string; return the number of lines it finished
+static uint8_t type (LineParser& parser, const char* p_text)
+{
+    uint8_t lines = 0;
+
+    for (; *p_text != '\0'; p_text++)
+    {
+        if (parser.add (*p_text))
+        {
+            lines++;
+        }
+    }
+    return lines;
+}
+
+
+void setUp (void)
+{
+    Serial.input.clear ();
+    Serial.output.clear ();
+    set_value = 0;
+}
+
+
+void tearDown (void)
+{
+}
+
+
+void test_line_is_split_into_words (void)
+{
+    LineParser parser;
+
+    TEST_ASSERT_EQUAL (0, type (parser, "  get \t step_ms  "));
+    TEST_ASSERT_EQUAL (1, type (parser, "\r"));
+    TEST_ASSERT_EQUAL (2, parser.get_num_words ());
+    TEST_ASSERT_EQUAL_STRING ("get", parser.get_word (0));
+    TEST_ASSERT_EQUAL_STRING ("step_ms", parser.get_word (1));
+    TEST_ASSERT_EQUAL_STRING ("", parser.get_word (2));
+}
+
+
+void test_crlf_and_blank_lines_finish_once (void)
+{
+    LineParser parser;
+
+    TEST_ASSERT_EQUAL (1, type (parser, "ping\r\n"));
+    TEST_ASSERT_EQUAL (0, type (parser, "\r\n\n\r"));
+    TEST_ASSERT_EQUAL (0, type (parser, "   \r"));
+    TEST_ASSERT_EQUAL (2, type (parser, "a\nb\n"));
+    TEST_ASSERT_EQUAL_STRING ("b", parser.get_word (0));
+}
+
+
+void test_backspace_and_control_characters (void)
+{
+    LineParser parser;
+
+    TEST_ASSERT_EQUAL (1, type (parser, "sx\bex\x7Ft 5\x01\r"));
+    TEST_ASSERT_EQUAL (2, parser.get_num_words ());
+    TEST_ASSERT_EQUAL_STRING ("set", parser.get_word (0));
+    TEST_ASSERT_EQUAL_STRING ("5", parser.get_word (1));
+
+    // Backspacing past the start does nothing
+    TEST_ASSERT_EQUAL (1, type (parser, "\b\b\bx\r"));
+    TEST_ASSERT_EQUAL_STRING ("x", parser.get_word (0));
+}
+
+
+void test_long_line_is_thrown_away (void)
+{
+    LineParser parser;
+    char line[CONSOLE_LINE_SIZE + 3];
+
+    memset (line, 'a', CONSOLE_LINE_SIZE + 1);
+    line[CONSOLE_LINE_SIZE + 1] = '\r';
+    line[CONSOLE_LINE_SIZE + 2] = '\0';
+    TEST_ASSERT_EQUAL (1, type (parser, line));
+    TEST_ASSERT_TRUE (parser.is_overflow ());
+
+    // The next line is parsed as usual, and one just short enough fits
+    line[CONSOLE_LINE_SIZE] = '\r';
+    line[CONSOLE_LINE_SIZE + 1] = '\0';
+    TEST_ASSERT_EQUAL (1, type (parser, line));
+    TEST_ASSERT_FALSE (parser.is_overflow ());
+    TEST_ASSERT_EQUAL (CONSOLE_LINE_SIZE, strlen (parser.get_word (0)));
+}
+
+
+void test_extra_words_join_the_last (void)
+{
+    LineParser parser;
+
+    type (parser, "a b c d e f\r");
+    TEST_ASSERT_EQUAL (CONSOLE_MAX_WORDS, parser.get_num_words ());
+    TEST_ASSERT_EQUAL_STRING ("a", parser.get_word (0));
+    TEST_ASSERT_EQUAL_STRING ("d e f", parser.get_word (CONSOLE_MAX_WORDS - 1));
+}
+
+
+void test_numbers_are_checked (void)
+{
+    uint32_t number = 7;
+
+    TEST_ASSERT_TRUE (LineParser::to_number ("0", number));
+    TEST_ASSERT_EQUAL_UINT32 (0, number);
+    TEST_ASSERT_TRUE (LineParser::to_number ("4294967295", number));
+    TEST_ASSERT_EQUAL_UINT32 (4294967295UL, number);
+    TEST_ASSERT_FALSE (LineParser::to_number ("4294967296", number));
+    TEST_ASSERT_FALSE (LineParser::to_number ("", number));
+    TEST_ASSERT_FALSE (LineParser::to_number ("-1", number));
+    TEST_ASSERT_FALSE (LineParser::to_number ("12x", number));
+    TEST_ASSERT_EQUAL_UINT32 (4294967295UL, number);
+}
+
+
+void test_console_runs_commands (void)
+{
+    Serial.input = "set 42\r\nping\r\n";
+    console.poll (Serial, Serial);
+    TEST_ASSERT_EQUAL_UINT32 (42, set_value);
+    TEST_ASSERT_EQUAL_STRING ("set 42\r\npong\r\n", Serial.output.c_str ());
+    TEST_ASSERT_EQUAL (0, Serial.available ());
+}
+
+
+void test_console_reads_without_waiting (void)
+{
+    // Half a command is kept until the rest of it arrives
+    Serial.input = "se";
+    console.poll (Serial, Serial);
+    TEST_ASSERT_EQUAL_STRING ("", Serial.output.c_str ());
+    Serial.input = "t 9\r";
+    console.poll (Serial, Serial);
+    TEST_ASSERT_EQUAL_UINT32 (9, set_value);
+}
+
+
+void test_console_reports_errors (void)
+{
+    Serial.input = "set many\rbogus\rping extra\r";
+    console.poll (Serial, Serial);
+    TEST_ASSERT_TRUE (Serial.output.find ("Usage: set <number>")
+                      != std::string::npos);
+    TEST_ASSERT_TRUE (Serial.output.find ("Unknown command bogus")
+                      != std::string::npos);
+    TEST_ASSERT_TRUE (Serial.output.find ("Usage: ping ")
+                      != std::string::npos);
+
+    Serial.output.clear ();
+    Serial.input = "help\r";
+    console.poll (Serial, Serial);
+    TEST_ASSERT_EQUAL_STRING ("set <number>\r\nping \r\n",
+                              Serial.output.c_str ());
+}
+
+
+void test_console_counts_in_share_list (void)
+{
+    Serial.input = "ping\rnope\r";
+    console.poll (Serial, Serial);
+    Serial.output.clear ();
+    console.print_in_list (Serial);
+    TEST_ASSERT_TRUE (Serial.output.find ("console\t") != std::string::npos);
+    TEST_ASSERT_TRUE (Serial.output.find (" errors") != std::string::npos);
+}
+
+
+int main (int argc, char** argv)
+{
+    UNITY_BEGIN ();
+    RUN_TEST (test_line_is_split_into_words);
+    RUN_TEST (test_crlf_and_blank_lines_finish_once);
+    RUN_TEST (test_backspace_and_control_characters);
+    RUN_TEST (test_long_line_is_thrown_away);
+    RUN_TEST (test_extra_words_join_the_last);
+    RUN_TEST (test_numbers_are_checked);
+    RUN_TEST (test_console_runs_commands);
+    RUN_TEST (test_console_reads_without_waiting);
+    RUN_TEST (test_console_reports_errors);
+    RUN_TEST (test_console_counts_in_share_list);
+    return UNITY_END ();
+}
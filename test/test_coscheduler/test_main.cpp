@@ -0,0 +1,247 @@
+//*****************************************************************************
+/** @file    test_main.cpp
+ *  @brief   Tests of the coroutine scheduler and its frame pool.
+ *  @details Coroutines which sleep and then note that they've woken are run
+ *           by a scheduler given simulated tick counts, including counts
+ *           which wrap around, and the fixed pool of frames is used up and
+ *           given back.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <unity.h>
+#include <string>
+#include "coscheduler.h"
+
+
+/// Names of the coroutines in the order they woke
+static std::string woken;
+
+/// Number of times the scheduler's waker was called
+static uint32_t num_wakes;
+
+
+/// Coroutine which sleeps for a number of ticks, then notes its name
+static CoTask sleeper (CoScheduler& scheduler, uint32_t ticks, char name)
+{
+    co_await scheduler.sleep (ticks);
+    woken += name;
+}
+
+
+/// Coroutine which sleeps twice, noting its name each time it wakes
+static CoTask twice (CoScheduler& scheduler, uint32_t first, uint32_t second,
+                     char name)
+{
+    co_await scheduler.sleep (first);
+    woken += name;
+    co_await scheduler.sleep (second);
+    woken += name;
+}
+
+
+/// Coroutine whose frame is too big for the pool
+static CoTask too_big (CoScheduler& scheduler)
+{
+    volatile uint8_t buffer[CO_FRAME_SIZE + 16];
+
+    buffer[0] = 1;
+    co_await scheduler.sleep (1);
+    buffer[1] = buffer[0];
+}
+
+
+/// Waker which counts the times it's called
+static void count_wakes (void* p_context)
+{
+    (*(uint32_t*)p_context)++;
+}
+
+
+void setUp (void)
+{
+    woken.clear ();
+    num_wakes = 0;
+}
+
+
+void tearDown (void)
+{
+}
+
+
+void test_sleepers_wake_in_order (void)
+{
+    CoScheduler scheduler;
+    uint32_t wait;
+
+    TEST_ASSERT_FALSE (scheduler.time_to_next (0, wait));
+    TEST_ASSERT_TRUE (scheduler.spawn (sleeper (scheduler, 30, 'c')));
+    TEST_ASSERT_TRUE (scheduler.spawn (sleeper (scheduler, 10, 'a')));
+    TEST_ASSERT_TRUE (scheduler.spawn (sleeper (scheduler, 20, 'b')));
+    TEST_ASSERT_TRUE (scheduler.spawn (sleeper (scheduler, 10, 'A')));
+    TEST_ASSERT_EQUAL_UINT8 (4, scheduler.run (100));
+    TEST_ASSERT_TRUE (scheduler.time_to_next (100, wait));
+    TEST_ASSERT_EQUAL_UINT32 (10, wait);
+
+    // Nothing wakes early; those due at once wake in the order they slept
+    TEST_ASSERT_EQUAL_UINT8 (0, scheduler.run (109));
+    TEST_ASSERT_EQUAL_UINT8 (2, scheduler.run (110));
+    TEST_ASSERT_EQUAL_STRING ("aA", woken.c_str ());
+    TEST_ASSERT_TRUE (scheduler.time_to_next (112, wait));
+    TEST_ASSERT_EQUAL_UINT32 (8, wait);
+
+    // A late run wakes all that are due, soonest first
+    TEST_ASSERT_EQUAL_UINT8 (2, scheduler.run (200));
+    TEST_ASSERT_EQUAL_STRING ("aAbc", woken.c_str ());
+    TEST_ASSERT_FALSE (scheduler.time_to_next (200, wait));
+}
+
+
+void test_sleep_from_a_woken_coroutine (void)
+{
+    CoScheduler scheduler;
+    uint32_t wait;
+
+    // One which goes back to sleep is put in its place among the others
+    TEST_ASSERT_TRUE (scheduler.spawn (twice (scheduler, 5, 20, 't')));
+    TEST_ASSERT_TRUE (scheduler.spawn (sleeper (scheduler, 15, 's')));
+    scheduler.run (0);
+    scheduler.run (5);
+    TEST_ASSERT_TRUE (scheduler.time_to_next (5, wait));
+    TEST_ASSERT_EQUAL_UINT32 (10, wait);
+    scheduler.run (15);
+    TEST_ASSERT_EQUAL_STRING ("ts", woken.c_str ());
+    TEST_ASSERT_EQUAL_UINT8 (0, scheduler.run (24));
+    TEST_ASSERT_EQUAL_UINT8 (1, scheduler.run (25));
+    TEST_ASSERT_EQUAL_STRING ("tst", woken.c_str ());
+
+    // A sleep of no time doesn't suspend at all
+    TEST_ASSERT_TRUE (scheduler.spawn (sleeper (scheduler, 0, 'z')));
+    TEST_ASSERT_EQUAL_UINT8 (1, scheduler.run (30));
+    TEST_ASSERT_EQUAL_STRING ("tstz", woken.c_str ());
+}
+
+
+void test_ticks_wrap_around (void)
+{
+    CoScheduler scheduler;
+    uint32_t wait;
+
+    // Sleeps begun just before the tick count wraps end just after it
+    scheduler.run (0xFFFFFFF0UL);
+    TEST_ASSERT_TRUE (scheduler.spawn (sleeper (scheduler, 0x20, 'b')));
+    TEST_ASSERT_TRUE (scheduler.spawn (sleeper (scheduler, 0x0A, 'a')));
+    scheduler.run (0xFFFFFFF0UL);
+    TEST_ASSERT_TRUE (scheduler.time_to_next (0xFFFFFFF8UL, wait));
+    TEST_ASSERT_EQUAL_UINT32 (2, wait);
+
+    TEST_ASSERT_EQUAL_UINT8 (1, scheduler.run (0xFFFFFFFAUL));
+    TEST_ASSERT_EQUAL_STRING ("a", woken.c_str ());
+    TEST_ASSERT_TRUE (scheduler.time_to_next (0xFFFFFFFEUL, wait));
+    TEST_ASSERT_EQUAL_UINT32 (0x12, wait);
+    TEST_ASSERT_TRUE (scheduler.time_to_next (0x00000004UL, wait));
+    TEST_ASSERT_EQUAL_UINT32 (0x0C, wait);
+    TEST_ASSERT_EQUAL_UINT8 (0, scheduler.run (0x0000000FUL));
+    TEST_ASSERT_EQUAL_UINT8 (1, scheduler.run (0x00000010UL));
+    TEST_ASSERT_EQUAL_STRING ("ab", woken.c_str ());
+}
+
+
+void test_overdue_sleeper_waits_no_time (void)
+{
+    CoScheduler scheduler;
+    uint32_t wait;
+
+    scheduler.spawn (sleeper (scheduler, 3, 'x'));
+    scheduler.run (1000);
+    TEST_ASSERT_TRUE (scheduler.time_to_next (1010, wait));
+    TEST_ASSERT_EQUAL_UINT32 (0, wait);
+    scheduler.run (1010);
+    TEST_ASSERT_EQUAL_STRING ("x", woken.c_str ());
+}
+
+
+void test_pool_runs_out (void)
+{
+    CoScheduler scheduler;
+
+    for (uint8_t index = 0; index < CO_MAX_TASKS; index++)
+    {
+        TEST_ASSERT_TRUE (scheduler.spawn (sleeper (scheduler, 10,
+                                                    'a' + index)));
+    }
+    TEST_ASSERT_FALSE (scheduler.spawn (sleeper (scheduler, 10, 'x')));
+    scheduler.run (0);
+
+    // Every coroutine can sleep at once
+    TEST_ASSERT_EQUAL_UINT8 (CO_MAX_TASKS, scheduler.run (10));
+    TEST_ASSERT_EQUAL_UINT32 (CO_MAX_TASKS, woken.size ());
+}
+
+
+void test_frame_too_big_is_refused (void)
+{
+    CoScheduler scheduler;
+
+    TEST_ASSERT_FALSE (scheduler.spawn (too_big (scheduler)));
+
+    // The refusal took no frame from the pool
+    for (uint8_t index = 0; index < CO_MAX_TASKS; index++)
+    {
+        TEST_ASSERT_TRUE (scheduler.spawn (sleeper (scheduler, 1, 'a')));
+    }
+    scheduler.run (0);
+    scheduler.run (1);
+}
+
+
+void test_finished_frames_go_back_to_the_pool (void)
+{
+    CoScheduler scheduler;
+
+    // Many more coroutines than frames are run, a poolful at a time
+    for (uint8_t round = 0; round < 5; round++)
+    {
+        for (uint8_t index = 0; index < CO_MAX_TASKS; index++)
+        {
+            TEST_ASSERT_TRUE (scheduler.spawn (twice (scheduler, 1, 2, 'r')));
+        }
+        TEST_ASSERT_FALSE (scheduler.spawn (sleeper (scheduler, 1, 'x')));
+        scheduler.run (10 * round);
+        scheduler.run (10 * round + 1);
+        scheduler.run (10 * round + 3);
+    }
+    TEST_ASSERT_EQUAL_UINT32 (5 * CO_MAX_TASKS * 2, woken.size ());
+}
+
+
+void test_waker_is_called_when_ready (void)
+{
+    CoScheduler scheduler;
+
+    scheduler.set_waker (count_wakes, &num_wakes);
+    TEST_ASSERT_TRUE (scheduler.spawn (sleeper (scheduler, 5, 'w')));
+    TEST_ASSERT_EQUAL_UINT32 (1, num_wakes);
+    scheduler.run (0);
+    TEST_ASSERT_EQUAL_UINT32 (1, num_wakes);
+    scheduler.run (5);
+    TEST_ASSERT_EQUAL_UINT32 (2, num_wakes);
+    TEST_ASSERT_EQUAL_STRING ("w", woken.c_str ());
+}
+
+
+int main (int argc, char** argv)
+{
+    UNITY_BEGIN ();
+    RUN_TEST (test_sleepers_wake_in_order);
+    RUN_TEST (test_sleep_from_a_woken_coroutine);
+    RUN_TEST (test_ticks_wrap_around);
+    RUN_TEST (test_overdue_sleeper_waits_no_time);
+    RUN_TEST (test_pool_runs_out);
+    RUN_TEST (test_frame_too_big_is_refused);
+    RUN_TEST (test_finished_frames_go_back_to_the_pool);
+    RUN_TEST (test_waker_is_called_when_ready);
+    return UNITY_END ();
+}
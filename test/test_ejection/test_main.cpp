@@ -0,0 +1,223 @@
+//*****************************************************************************
+/** @file    test_main.cpp
+ *  @brief   Tests of the ejection scheduler's timing, with a simulated table.
+ *  @details The table steps at a fixed rate, perhaps with some steps late,
+ *           and the scheduler is polled once a millisecond as the stepper
+ *           motor task does. The tests check when the solenoids fire and the
+ *           timing errors the scheduler measures.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <unity.h>
+#include "ejection.h"
+
+
+/// Time between polls of the scheduler, in microseconds
+#define POLL_US 1000
+
+/// Time per step of the simulated table, in microseconds
+#define STEP_US 11000
+
+/// Solenoid's time to reach the ball, in microseconds
+#define LEAD_US 20000
+
+/// How long the solenoids stay on, in microseconds
+#define PULSE_US 5000
+
+
+/** @brief   Turntable which steps at a fixed rate, and what the scheduler
+ *           did to the solenoids.
+ */
+struct SimTable
+{
+    uint32_t now_us;                        ///< Simulated time
+    uint32_t position;                      ///< Steps made
+    uint32_t next_step_us;                  ///< When the next step is made
+    uint32_t late_step;                     ///< Step which is made late
+    uint32_t late_us;                       ///< How late it is
+    uint8_t solenoids;                      ///< Solenoids which are on
+    uint32_t on_us[8];                      ///< Time each was turned on
+    uint32_t off_us[8];                     ///< Time each was turned off
+
+    SimTable (void)
+    {
+        memset (this, 0, sizeof (*this));
+        next_step_us = STEP_US;
+        late_step = UINT32_MAX;
+    }
+
+    /// Run the table up to the given time, polling the scheduler
+    void run (EjectionScheduler& ejector, uint32_t until_us,
+              uint32_t last_step = UINT32_MAX)
+    {
+        while (now_us < until_us)
+        {
+            now_us += POLL_US;
+            if (position < last_step && now_us >= next_step_us)
+            {
+                position++;
+                ejector.track (position, STEP_US, now_us);
+                next_step_us += STEP_US;
+                if (position + 1 == late_step)
+                {
+                    next_step_us += late_us;
+                }
+            }
+            else if (position == last_step)
+            {
+                ejector.track (position, 0, now_us);
+            }
+
+            uint8_t on, off;
+            if (ejector.service (now_us, on, off))
+            {
+                for (uint8_t channel = 0; channel < 8; channel++)
+                {
+                    if (on & (1 << channel))
+                    {
+                        on_us[channel] = now_us;
+                    }
+                    if (off & (1 << channel))
+                    {
+                        off_us[channel] = now_us;
+                    }
+                }
+                solenoids = (solenoids | on) & ~off;
+            }
+        }
+    }
+};
+
+
+void setUp (void)
+{
+}
+
+
+void tearDown (void)
+{
+}
+
+
+void test_fires_lead_time_before_ball_arrives (void)
+{
+    EjectionScheduler ejector ("Ejector", LEAD_US, PULSE_US, POLL_US);
+    SimTable table;
+
+    TEST_ASSERT_TRUE (ejector.schedule (0x02, 10));
+    table.run (ejector, 200000);
+
+    // Step 10 is made at 110 ms, so the solenoid fires at 90 ms
+    TEST_ASSERT_UINT32_WITHIN (POLL_US / 2, 10 * STEP_US - LEAD_US,
+                               table.on_us[1]);
+    TEST_ASSERT_EQUAL_UINT32 (table.on_us[1] + PULSE_US, table.off_us[1]);
+    TEST_ASSERT_EQUAL_UINT8 (0, table.solenoids);
+    TEST_ASSERT_INT_WITHIN (POLL_US / 2, 0, ejector.get_last_error_us ());
+    TEST_ASSERT_FALSE (ejector.is_busy ());
+}
+
+
+void test_late_step_shows_as_early_firing (void)
+{
+    EjectionScheduler ejector ("Ejector", LEAD_US, PULSE_US, POLL_US);
+    SimTable table;
+
+    // The step onto the target comes 3 ms late, after the solenoid fired
+    table.late_step = 10;
+    table.late_us = 3000;
+    ejector.schedule (0x01, 10);
+    table.run (ejector, 200000);
+
+    TEST_ASSERT_INT_WITHIN (POLL_US / 2, -3000, ejector.get_last_error_us ());
+    TEST_ASSERT_UINT32_WITHIN (POLL_US / 2, 3000,
+                               ejector.get_max_error_us ());
+}
+
+
+void test_step_late_before_firing_is_allowed_for (void)
+{
+    EjectionScheduler ejector ("Ejector", LEAD_US, PULSE_US, POLL_US);
+    SimTable table;
+
+    // A step well before the firing time is late; the firing time is worked
+    // out again from each step, so it's still on time
+    table.late_step = 3;
+    table.late_us = 4000;
+    ejector.schedule (0x04, 10);
+    table.run (ejector, 200000);
+
+    TEST_ASSERT_UINT32_WITHIN (POLL_US / 2, 10 * STEP_US + 4000 - LEAD_US,
+                               table.on_us[2]);
+    TEST_ASSERT_INT_WITHIN (POLL_US / 2, 0, ejector.get_last_error_us ());
+}
+
+
+void test_stopped_table_fires_when_aligned (void)
+{
+    EjectionScheduler ejector ("Ejector", LEAD_US, PULSE_US, POLL_US);
+    SimTable table;
+
+    // The table stops at step 4, so the ball at step 6 never lines up
+    ejector.schedule (0x01, 6);
+    table.run (ejector, 100000, 4);
+    TEST_ASSERT_EQUAL_UINT32 (0, table.on_us[0]);
+    TEST_ASSERT_TRUE (ejector.is_busy ());
+
+    // A target the table has already reached fires on the next poll, a lead
+    // time late
+    ejector.schedule (0x08, 4);
+    table.run (ejector, 101000, 4);
+    TEST_ASSERT_EQUAL_UINT32 (101000, table.on_us[3]);
+    TEST_ASSERT_EQUAL_INT32 (101000 + LEAD_US - 4 * STEP_US,
+                             ejector.get_last_error_us ());
+}
+
+
+void test_schedule_refuses_when_full_or_empty (void)
+{
+    EjectionScheduler ejector ("Ejector", LEAD_US, PULSE_US, POLL_US);
+
+    TEST_ASSERT_FALSE (ejector.schedule (0, 10));
+    for (uint8_t count = 0; count < EJECT_MAX_PENDING; count++)
+    {
+        TEST_ASSERT_TRUE (ejector.schedule (0x01, 10 + count));
+    }
+    TEST_ASSERT_FALSE (ejector.schedule (0x01, 20));
+
+    // Once they've fired and their balls have lined up there's room again
+    SimTable table;
+    table.run (ejector, 200000);
+    TEST_ASSERT_FALSE (ejector.is_busy ());
+    TEST_ASSERT_TRUE (ejector.schedule (0x01, 30));
+}
+
+
+void test_several_ejections_in_one_turn (void)
+{
+    EjectionScheduler ejector ("Ejector", LEAD_US, PULSE_US, POLL_US);
+    SimTable table;
+
+    ejector.schedule (0x01, 5);
+    ejector.schedule (0x02, 8);
+    table.run (ejector, 150000);
+    TEST_ASSERT_UINT32_WITHIN (POLL_US / 2, 5 * STEP_US - LEAD_US,
+                               table.on_us[0]);
+    TEST_ASSERT_UINT32_WITHIN (POLL_US / 2, 8 * STEP_US - LEAD_US,
+                               table.on_us[1]);
+    TEST_ASSERT_LESS_OR_EQUAL (POLL_US / 2, ejector.get_max_error_us ());
+}
+
+
+int main (int argc, char** argv)
+{
+    UNITY_BEGIN ();
+    RUN_TEST (test_fires_lead_time_before_ball_arrives);
+    RUN_TEST (test_late_step_shows_as_early_firing);
+    RUN_TEST (test_step_late_before_firing_is_allowed_for);
+    RUN_TEST (test_stopped_table_fires_when_aligned);
+    RUN_TEST (test_schedule_refuses_when_full_or_empty);
+    RUN_TEST (test_several_ejections_in_one_turn);
+    return UNITY_END ();
+}
@@ -0,0 +1,206 @@
+//*****************************************************************************
+/** @file    test_main.cpp
+ *  @brief   Tests of the homing state machine with a simulated index.
+ *  @details The simulated table has an index flag a few steps wide and
+ *           starts somewhere other than where the sorter thinks it is. The
+ *           state machine's steps are made on it until the search ends.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <unity.h>
+#include "homing.h"
+
+
+/// Motor steps per revolution of the simulated table
+#define STEPS_PER_REV 350
+
+/// Steps for which the index flag is seen
+#define INDEX_WIDTH 6
+
+
+/** @brief   Turntable with an index flag, which may be missing.
+ */
+struct SimTable
+{
+    int32_t position;                       ///< Where the table really is
+    uint16_t index_at;                      ///< First step the flag is seen
+    bool has_flag;                          ///< False if the flag is missing
+    uint32_t num_steps;                     ///< Steps made
+    uint32_t time_ms;                       ///< Time the search has taken
+
+    SimTable (int32_t a_position, uint16_t an_index_at)
+    {
+        position = a_position;
+        index_at = an_index_at;
+        has_flag = true;
+        num_steps = 0;
+        time_ms = 0;
+    }
+
+    /// Return the table's position within a revolution
+    uint16_t at (void) const
+    {
+        return ((position % STEPS_PER_REV) + STEPS_PER_REV) % STEPS_PER_REV;
+    }
+
+    /// Return true while the index flag is in front of its sensor
+    bool index (void) const
+    {
+        return has_flag && at () >= index_at
+               && at () < index_at + INDEX_WIDTH;
+    }
+
+    /// Run the search to its end, as the stepper motor task does
+    void home (TableHoming& homing)
+    {
+        int8_t direction;
+        do
+        {
+            time_ms += homing.get_step_ms ();
+            direction = homing.next_step (index ());
+            position += direction;
+            num_steps++;
+        }
+        while (direction != 0 && num_steps < 10 * STEPS_PER_REV);
+    }
+};
+
+
+void setUp (void)
+{
+}
+
+
+void tearDown (void)
+{
+}
+
+
+void test_homing_reaches_believed_position (void)
+{
+    TableHoming homing ("Home", STEPS_PER_REV);
+
+    // The table is 30 steps behind where the sorter thinks it is
+    for (int32_t believed = 0; believed < STEPS_PER_REV; believed += 25)
+    {
+        SimTable table (believed - 30, 120);
+        homing.start (believed, 120);
+        table.home (homing);
+        TEST_ASSERT_TRUE (homing.is_done ());
+        TEST_ASSERT_EQUAL (believed, table.at ());
+        TEST_ASSERT_EQUAL_INT16 (30, homing.get_last_offset ());
+    }
+}
+
+
+void test_offset_is_negative_when_ahead (void)
+{
+    TableHoming homing ("Home", STEPS_PER_REV);
+    SimTable table (60, 300);
+
+    homing.start (50, 300);
+    table.home (homing);
+    TEST_ASSERT_TRUE (homing.is_done ());
+    TEST_ASSERT_EQUAL (50, table.at ());
+    TEST_ASSERT_EQUAL_INT16 (-10, homing.get_last_offset ());
+}
+
+
+void test_starting_on_the_index_backs_off_first (void)
+{
+    TableHoming homing ("Home", STEPS_PER_REV);
+    SimTable table (202, 200);
+
+    TEST_ASSERT_TRUE (table.index ());
+    homing.start (210, 200);
+    TEST_ASSERT_TRUE (homing.is_busy ());
+    table.home (homing);
+    TEST_ASSERT_TRUE (homing.is_done ());
+    TEST_ASSERT_EQUAL (210, table.at ());
+    TEST_ASSERT_EQUAL_INT16 (8, homing.get_last_offset ());
+}
+
+
+void test_edge_found_from_the_same_side (void)
+{
+    TableHoming homing ("Home", STEPS_PER_REV);
+
+    // Wherever the search begins, the rising edge at 100 is the reference,
+    // not the far end of the flag
+    const int32_t starts[] = {97, 100, 103, 105, 200, 350 + 99};
+    for (int32_t start : starts)
+    {
+        SimTable table (start, 100);
+        homing.start (0, 100);
+        table.home (homing);
+        TEST_ASSERT_TRUE (homing.is_done ());
+        TEST_ASSERT_EQUAL (0, table.at ());
+    }
+}
+
+
+void test_slow_steps_near_the_edge (void)
+{
+    TableHoming homing ("Home", STEPS_PER_REV, 4, 20);
+    SimTable table (0, 175);
+
+    homing.start (0, 175);
+    table.home (homing);
+
+    // About 175 fast steps there, 2 x 14 slow ones, 175 fast ones on
+    TEST_ASSERT_TRUE (homing.is_done ());
+    TEST_ASSERT_LESS_THAN (4 * 2 * STEPS_PER_REV, table.time_ms);
+    TEST_ASSERT_GREATER_THAN (4 * STEPS_PER_REV, table.time_ms);
+}
+
+
+void test_missing_index_fails (void)
+{
+    TableHoming homing ("Home", STEPS_PER_REV);
+    SimTable table (0, 100);
+
+    table.has_flag = false;
+    homing.start (0, 100);
+    table.home (homing);
+    TEST_ASSERT_TRUE (homing.has_failed ());
+    TEST_ASSERT_FALSE (homing.is_busy ());
+
+    // It gave up after a revolution and a half
+    TEST_ASSERT_LESS_OR_EQUAL (STEPS_PER_REV * 3 / 2 + 1, table.num_steps);
+    TEST_ASSERT_EQUAL (0, homing.next_step (false));
+}
+
+
+void test_stuck_index_fails (void)
+{
+    TableHoming homing ("Home", STEPS_PER_REV);
+
+    // The flag's sensor is stuck on, so the table can never get clear
+    homing.start (0, 0);
+    int8_t direction;
+    uint32_t steps = 0;
+    do
+    {
+        direction = homing.next_step (true);
+        steps++;
+    }
+    while (direction != 0 && steps < 10 * STEPS_PER_REV);
+    TEST_ASSERT_TRUE (homing.has_failed ());
+    TEST_ASSERT_LESS_OR_EQUAL (2 * STEPS_PER_REV + 2, steps);
+}
+
+
+int main (int argc, char** argv)
+{
+    UNITY_BEGIN ();
+    RUN_TEST (test_homing_reaches_believed_position);
+    RUN_TEST (test_offset_is_negative_when_ahead);
+    RUN_TEST (test_starting_on_the_index_backs_off_first);
+    RUN_TEST (test_edge_found_from_the_same_side);
+    RUN_TEST (test_slow_steps_near_the_edge);
+    RUN_TEST (test_missing_index_fails);
+    RUN_TEST (test_stuck_index_fails);
+    return UNITY_END ();
+}
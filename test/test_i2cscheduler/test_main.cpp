@@ -0,0 +1,377 @@
+//*****************************************************************************
+/** @file    test_main.cpp
+ *  @brief   Tests of the I2C bus scheduler, with faults injected on the bus.
+ *  @details Simulated color sensors behind a simulated multiplexer are read
+ *           through the scheduler while the clock moves on to each reading's
+ *           deadline. Transfers are refused as if not acknowledged, or the
+ *           bus is stuck until it's recovered, to check that bad readings
+ *           are thrown away, that the sensor is taken out of service and
+ *           started again, and that the recovery time is measured. With bus
+ *           time given to each transfer, the readings per second are counted
+ *           for one to four sensors sharing the bus.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <unity.h>
+#include "i2cscheduler.h"
+#include "simi2cbus.h"
+
+
+/// Microseconds taken by one 24 ms integration
+#define INTEGRATION_24MS_US 24000
+
+/// Microseconds taken by one 2.4 ms integration
+#define INTEGRATION_2_4MS_US 2400
+
+/// Microseconds taken to send a byte and its acknowledge bit at 100 kHz
+#define BYTE_AT_100KHZ_US 90
+
+/// Bus time of one reading: four 16 bit registers, each a five byte transfer
+#define READING_US (4 * 5 * BYTE_AT_100KHZ_US)
+
+/// Bus time of selecting a mux channel, a two byte transfer
+#define SELECT_US (2 * BYTE_AT_100KHZ_US)
+
+
+/// Lane and state given to the fault handler each time it was called
+static uint8_t fault_lanes[8];
+static bool fault_ups[8];
+static uint8_t num_fault_calls;
+
+/// Scheduler printed by the print test; shares must outlive the test
+static I2CBusScheduler printed ("Sensors");
+
+
+/// Note each call to the fault handler
+static void on_fault (uint8_t lane, bool up, void* p_context)
+{
+    if (num_fault_calls < 8)
+    {
+        fault_lanes[num_fault_calls] = lane;
+        fault_ups[num_fault_calls] = up;
+    }
+    num_fault_calls++;
+}
+
+
+/// Move the clock on to the next deadline and try to read a sensor there
+static bool read_at_next (I2CBusScheduler& scheduler, uint8_t& lane,
+                          RGBCSample& sample)
+{
+    host_us += scheduler.time_to_next (host_us);
+    return scheduler.read_next (host_us, lane, sample);
+}
+
+
+/// Read until a reading works, or give up after many tries
+static bool read_good (I2CBusScheduler& scheduler, uint8_t& lane,
+                       RGBCSample& sample)
+{
+    for (uint16_t tries = 0; tries < 100; tries++)
+    {
+        if (read_at_next (scheduler, lane, sample))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/// Count the readings begun in one second of simulated time, starting once
+/// the first sensor is read
+static uint32_t readings_per_second (I2CBusScheduler& scheduler)
+{
+    uint32_t readings = 0;
+    uint8_t lane;
+    RGBCSample sample;
+
+    read_good (scheduler, lane, sample);
+    uint32_t start_us = host_us;
+    host_us += scheduler.time_to_next (host_us);
+    while (host_us - start_us < 1000000UL)
+    {
+        if (scheduler.read_next (host_us, lane, sample))
+        {
+            readings++;
+        }
+        host_us += scheduler.time_to_next (host_us);
+    }
+    return readings;
+}
+
+
+/** @brief   Sensors on a bus behind a mux, started and scheduled.
+ */
+struct Rig
+{
+    SimTCS34725 chips[I2C_MAX_LANES];
+    SimI2CBus bus;
+    Adafruit_TCS34725 sensors[I2C_MAX_LANES];
+    I2CBusScheduler scheduler;
+
+    /// Set up the given number of sensors with the given integration time
+    Rig (uint8_t num_sensors,
+         tcs34725IntegrationTime_t atime = TCS34725_INTEGRATIONTIME_24MS)
+        : bus (TCA9548A_ADDRESS),
+          sensors {Adafruit_TCS34725 (atime), Adafruit_TCS34725 (atime),
+                   Adafruit_TCS34725 (atime), Adafruit_TCS34725 (atime)}
+    {
+        scheduler.add_bus (bus, TCA9548A_ADDRESS);
+        for (uint8_t lane = 0; lane < num_sensors; lane++)
+        {
+            bus.attach (chips[lane], lane);
+            chips[lane].set_counts (100 + lane, 200, 300, 600);
+            scheduler.add_sensor (sensors[lane], 0, lane);
+            scheduler.begin_lane (lane, host_us);
+        }
+        scheduler.set_fault_handler (on_fault, NULL);
+        bus.clear_counts ();
+    }
+};
+
+
+void setUp (void)
+{
+    host_us = 1000;
+    num_fault_calls = 0;
+}
+
+
+void tearDown (void)
+{
+}
+
+
+void test_reads_when_each_integration_is_done (void)
+{
+    Rig rig (2);
+    uint8_t lane;
+    RGBCSample sample;
+
+    for (uint8_t reading = 0; reading < 6; reading++)
+    {
+        TEST_ASSERT_TRUE (read_at_next (rig.scheduler, lane, sample));
+        TEST_ASSERT_EQUAL_UINT16 (100 + lane, sample.r);
+        TEST_ASSERT_EQUAL_UINT16 (600, sample.c);
+    }
+    TEST_ASSERT_EQUAL_UINT32 (6, rig.scheduler.get_num_reads ());
+    TEST_ASSERT_EQUAL_UINT32 (0, rig.scheduler.get_num_failed ());
+    TEST_ASSERT_FALSE (rig.scheduler.read_next (host_us, lane, sample));
+    TEST_ASSERT_EQUAL_UINT32 (INTEGRATION_24MS_US,
+                              rig.scheduler.time_to_next (host_us));
+}
+
+
+void test_one_nack_throws_a_reading_away (void)
+{
+    Rig rig (1);
+    uint8_t lane;
+    RGBCSample sample;
+
+    rig.bus.nacks = 1;
+    TEST_ASSERT_FALSE (read_at_next (rig.scheduler, lane, sample));
+    TEST_ASSERT_EQUAL_UINT32 (1, rig.scheduler.get_num_failed ());
+    TEST_ASSERT_TRUE (rig.scheduler.is_up (0));
+    TEST_ASSERT_TRUE (read_at_next (rig.scheduler, lane, sample));
+    TEST_ASSERT_EQUAL_UINT8 (0, num_fault_calls);
+}
+
+
+void test_stuck_bus_is_recovered (void)
+{
+    Rig rig (1);
+    uint8_t lane;
+    RGBCSample sample;
+
+    read_good (rig.scheduler, lane, sample);
+    rig.bus.stuck = true;
+    uint32_t stuck_us = host_us + INTEGRATION_24MS_US;
+    for (uint8_t reading = 0; reading < I2C_FAULT_LIMIT; reading++)
+    {
+        TEST_ASSERT_TRUE (rig.scheduler.is_up (0));
+        TEST_ASSERT_FALSE (read_at_next (rig.scheduler, lane, sample));
+    }
+    TEST_ASSERT_FALSE (rig.scheduler.is_up (0));
+    TEST_ASSERT_EQUAL_UINT8 (1, num_fault_calls);
+    TEST_ASSERT_FALSE (fault_ups[0]);
+
+    // Recovery frees the bus and starts the sensor again
+    TEST_ASSERT_TRUE (read_good (rig.scheduler, lane, sample));
+    TEST_ASSERT_EQUAL_UINT32 (1, rig.bus.num_recovers);
+    TEST_ASSERT_TRUE (rig.scheduler.is_up (0));
+    TEST_ASSERT_EQUAL_UINT8 (2, num_fault_calls);
+    TEST_ASSERT_TRUE (fault_ups[1]);
+    TEST_ASSERT_EQUAL_UINT32 (host_us - stuck_us,
+                              rig.scheduler.get_last_recovery_us (0));
+}
+
+
+void test_missing_sensor_is_tried_again (void)
+{
+    Rig rig (1);
+    uint8_t lane;
+    RGBCSample sample;
+
+    // The sensor stops answering for a while, then is reset
+    rig.bus.nacks = 60000;
+    for (uint8_t reading = 0; reading < I2C_FAULT_LIMIT + 4; reading++)
+    {
+        TEST_ASSERT_FALSE (read_at_next (rig.scheduler, lane, sample));
+    }
+    uint32_t down_us = host_us;
+    TEST_ASSERT_FALSE (rig.scheduler.is_up (0));
+    TEST_ASSERT_EQUAL_UINT32 (I2C_RETRY_US, rig.scheduler.time_to_next (host_us));
+
+    rig.bus.nacks = 0;
+    rig.chips[0].reset ();
+    TEST_ASSERT_TRUE (read_good (rig.scheduler, lane, sample));
+    TEST_ASSERT_GREATER_OR_EQUAL (down_us + I2C_RETRY_US, host_us);
+
+    // The sensor's settings were written again after its reset
+    TEST_ASSERT_EQUAL_UINT8 (TCS34725_INTEGRATIONTIME_24MS,
+                             rig.chips[0].regs[TCS34725_ATIME]);
+    TEST_ASSERT_EQUAL_UINT16 (100, sample.r);
+    TEST_ASSERT_GREATER_THAN (I2C_RETRY_US,
+                              rig.scheduler.get_last_recovery_us (0));
+}
+
+
+void test_failed_mux_select_fails_the_reading (void)
+{
+    Rig rig (2);
+    uint8_t lane;
+    RGBCSample sample;
+
+    read_good (rig.scheduler, lane, sample);
+    read_good (rig.scheduler, lane, sample);
+    rig.bus.clear_counts ();
+
+    // Changing lanes selects the mux channel first; that's refused
+    rig.bus.nacks = 1;
+    TEST_ASSERT_FALSE (read_at_next (rig.scheduler, lane, sample));
+    TEST_ASSERT_EQUAL_UINT32 (1, rig.scheduler.get_num_failed ());
+    TEST_ASSERT_TRUE (read_good (rig.scheduler, lane, sample));
+    TEST_ASSERT_GREATER_OR_EQUAL (1, rig.bus.num_selects);
+}
+
+
+void test_long_reading_then_usual_time (void)
+{
+    Rig rig (2);
+    uint8_t lane;
+    RGBCSample sample;
+    uint8_t others = 0;
+
+    TEST_ASSERT_TRUE (rig.scheduler.start_long (
+        0, TCS34725_INTEGRATIONTIME_101MS, host_us));
+    TEST_ASSERT_FALSE (rig.scheduler.start_long (
+        0, TCS34725_INTEGRATIONTIME_101MS, host_us));
+    TEST_ASSERT_TRUE (rig.scheduler.is_long_pending (0));
+    TEST_ASSERT_EQUAL_UINT8 (TCS34725_INTEGRATIONTIME_101MS,
+                             rig.chips[0].regs[TCS34725_ATIME]);
+
+    // The other lane is read as usual while the long reading goes on
+    while (read_good (rig.scheduler, lane, sample) && lane != 0)
+    {
+        TEST_ASSERT_FALSE (rig.scheduler.is_long_reading ());
+        others++;
+    }
+    TEST_ASSERT_EQUAL_UINT8 (0, lane);
+    TEST_ASSERT_TRUE (rig.scheduler.is_long_reading ());
+    TEST_ASSERT_GREATER_OR_EQUAL (4, others);
+    TEST_ASSERT_FALSE (rig.scheduler.is_long_pending (0));
+    TEST_ASSERT_EQUAL_UINT8 (TCS34725_INTEGRATIONTIME_24MS,
+                             rig.chips[0].regs[TCS34725_ATIME]);
+}
+
+
+void test_throughput_grows_with_sensors (void)
+{
+    uint32_t rates[I2C_MAX_LANES + 1];
+
+    // Integrations overlap, so while the bus is mostly idle each sensor
+    // added gives another reading every integration time
+    for (uint8_t sensors = 1; sensors <= I2C_MAX_LANES; sensors++)
+    {
+        Rig rig (sensors);
+        rig.bus.us_per_byte = BYTE_AT_100KHZ_US;
+        rates[sensors] = readings_per_second (rig.scheduler);
+        TEST_ASSERT_EQUAL_UINT32 (0, rig.scheduler.get_num_failed ());
+    }
+    TEST_ASSERT_UINT32_WITHIN (1, 1000000UL / INTEGRATION_24MS_US, rates[1]);
+    for (uint8_t sensors = 2; sensors <= I2C_MAX_LANES; sensors++)
+    {
+        TEST_ASSERT_UINT32_WITHIN (sensors, sensors * rates[1],
+                                   rates[sensors]);
+    }
+}
+
+
+void test_throughput_stops_growing_when_the_bus_is_full (void)
+{
+    uint32_t rates[I2C_MAX_LANES + 1];
+
+    // A reading takes most of a short integration's time on the bus
+    for (uint8_t sensors = 1; sensors <= I2C_MAX_LANES; sensors++)
+    {
+        Rig rig (sensors, TCS34725_INTEGRATIONTIME_2_4MS);
+        rig.bus.us_per_byte = BYTE_AT_100KHZ_US;
+        rates[sensors] = readings_per_second (rig.scheduler);
+    }
+    TEST_ASSERT_UINT32_WITHIN (1, 1000000UL / INTEGRATION_2_4MS_US, rates[1]);
+
+    // From two sensors on the bus is always busy, changing mux channels and
+    // reading, so more sensors give no more readings
+    uint32_t full = 1000000UL / (READING_US + SELECT_US);
+    for (uint8_t sensors = 2; sensors <= I2C_MAX_LANES; sensors++)
+    {
+        TEST_ASSERT_UINT32_WITHIN (2, full, rates[sensors]);
+    }
+}
+
+
+void test_print_shows_faults (void)
+{
+    SimTCS34725 chip;
+    SimI2CBus bus;
+    bus.attach (chip);
+    Adafruit_TCS34725 sensor (TCS34725_INTEGRATIONTIME_24MS);
+    uint8_t lane;
+    RGBCSample sample;
+
+    printed.add_bus (bus);
+    printed.add_sensor (sensor, 0);
+    printed.begin_lane (0, host_us);
+    read_good (printed, lane, sample);
+    bus.stuck = true;
+    for (uint8_t reading = 0; reading < I2C_FAULT_LIMIT; reading++)
+    {
+        read_at_next (printed, lane, sample);
+    }
+
+    Serial.output.clear ();
+    printed.print_in_list (Serial);
+    TEST_ASSERT_NOT_NULL (strstr (Serial.output.c_str (),
+                                  "1 reads, 0 long, 3 failed"));
+    TEST_ASSERT_NOT_NULL (strstr (Serial.output.c_str (),
+                                  "lane 0 DOWN, 1 faults, 0 recoveries"));
+}
+
+
+int main (int argc, char** argv)
+{
+    UNITY_BEGIN ();
+    RUN_TEST (test_reads_when_each_integration_is_done);
+    RUN_TEST (test_one_nack_throws_a_reading_away);
+    RUN_TEST (test_stuck_bus_is_recovered);
+    RUN_TEST (test_missing_sensor_is_tried_again);
+    RUN_TEST (test_failed_mux_select_fails_the_reading);
+    RUN_TEST (test_long_reading_then_usual_time);
+    RUN_TEST (test_throughput_grows_with_sensors);
+    RUN_TEST (test_throughput_stops_growing_when_the_bus_is_full);
+    RUN_TEST (test_print_shows_faults);
+    return UNITY_END ();
+}
@@ -0,0 +1,136 @@
+//*****************************************************************************
+/** @file    test_main.cpp
+ *  @brief   Tests of the idle manager with a simulated clock.
+ *  @details Balls arrive at set times while a simulated clock moves on in
+ *           steps of the color sensor task's period, and the manager's
+ *           decisions are checked against them.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <unity.h>
+#include "idlemanager.h"
+
+
+/// Milliseconds between runs of the simulated color sensor task
+#define TASK_PERIOD_MS 10
+
+/// Quiet time before idling used in these tests
+#define QUIET_MS 1000
+
+
+void setUp (void)
+{
+}
+
+
+void tearDown (void)
+{
+}
+
+
+void test_stays_active_while_balls_arrive (void)
+{
+    IdleManager manager (QUIET_MS, 0);
+
+    for (uint32_t now = 0; now < 10 * QUIET_MS; now += TASK_PERIOD_MS)
+    {
+        if (now % (QUIET_MS / 2) == 0)
+        {
+            TEST_ASSERT_EQUAL (IdleManager::STAY, manager.activity (now));
+        }
+        TEST_ASSERT_EQUAL (IdleManager::STAY, manager.update (now));
+    }
+    TEST_ASSERT_EQUAL (IdleManager::ACTIVE, manager.get_state ());
+}
+
+
+void test_sleeps_once_after_the_quiet_time (void)
+{
+    IdleManager manager (QUIET_MS, 0);
+    uint32_t slept_at = 0;
+    uint16_t sleeps = 0;
+
+    for (uint32_t now = 0; now < 5 * QUIET_MS; now += TASK_PERIOD_MS)
+    {
+        if (now == 200)
+        {
+            manager.activity (now);
+        }
+        if (manager.update (now) == IdleManager::SLEEP)
+        {
+            slept_at = now;
+            sleeps++;
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT16 (1, sleeps);
+    TEST_ASSERT_EQUAL_UINT32 (200 + QUIET_MS, slept_at);
+    TEST_ASSERT_EQUAL (IdleManager::IDLE, manager.get_state ());
+}
+
+
+void test_wakes_within_a_ball_interval (void)
+{
+    IdleManager manager (QUIET_MS, 0);
+    const uint32_t ball_ms = 7 * QUIET_MS + 3;
+    const uint32_t ball_interval_ms = 250;
+    uint32_t woke_at = 0;
+
+    for (uint32_t now = 0; now < 8 * QUIET_MS; now += TASK_PERIOD_MS)
+    {
+        // While idle the task only runs when the sensor's interrupt fires
+        if (manager.get_state () == IdleManager::IDLE)
+        {
+            if (now >= ball_ms && woke_at == 0
+                && manager.activity (ball_ms) == IdleManager::WAKE)
+            {
+                woke_at = now;
+            }
+            continue;
+        }
+        manager.update (now);
+    }
+    TEST_ASSERT_EQUAL (IdleManager::ACTIVE, manager.get_state ());
+    TEST_ASSERT_EQUAL_UINT16 (1, manager.get_num_wakes ());
+    TEST_ASSERT_LESS_THAN (ball_interval_ms, woke_at - ball_ms);
+
+    // The quiet time starts again from the ball which woke it
+    TEST_ASSERT_EQUAL (IdleManager::STAY,
+                       manager.update (ball_ms + QUIET_MS - 1));
+    TEST_ASSERT_EQUAL (IdleManager::SLEEP, manager.update (ball_ms + QUIET_MS));
+}
+
+
+void test_clock_wraps_around (void)
+{
+    uint32_t start = UINT32_MAX - QUIET_MS / 2;
+    IdleManager manager (QUIET_MS, start);
+
+    TEST_ASSERT_EQUAL (IdleManager::STAY, manager.update (start + QUIET_MS - 1));
+    TEST_ASSERT_EQUAL (IdleManager::SLEEP, manager.update (start + QUIET_MS));
+}
+
+
+void test_quiet_time_can_be_changed (void)
+{
+    IdleManager manager (QUIET_MS, 0);
+
+    manager.set_idle_after (3 * QUIET_MS);
+    TEST_ASSERT_EQUAL_UINT32 (3 * QUIET_MS, manager.get_idle_after ());
+    TEST_ASSERT_EQUAL (IdleManager::STAY, manager.update (2 * QUIET_MS));
+    TEST_ASSERT_EQUAL (IdleManager::SLEEP, manager.update (3 * QUIET_MS));
+    TEST_ASSERT_EQUAL (IdleManager::STAY, manager.update (4 * QUIET_MS));
+}
+
+
+int main (int argc, char** argv)
+{
+    UNITY_BEGIN ();
+    RUN_TEST (test_stays_active_while_balls_arrive);
+    RUN_TEST (test_sleeps_once_after_the_quiet_time);
+    RUN_TEST (test_wakes_within_a_ball_interval);
+    RUN_TEST (test_clock_wraps_around);
+    RUN_TEST (test_quiet_time_can_be_changed);
+    return UNITY_END ();
+}
@@ -0,0 +1,86 @@
+//*****************************************************************************
+/** @file    test_main.cpp
+ *  @brief   Tests of the record storage and CRC in emulated EEPROM.
+ *  @details The CRC is checked against the published check value of
+ *           CRC-16/CCITT, and records are written to and read from the
+ *           stand-in EEPROM.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <unity.h>
+#include <EEPROM.h>
+#include "nvstore.h"
+
+
+void setUp (void)
+{
+    EEPROM.erase ();
+}
+
+
+void tearDown (void)
+{
+}
+
+
+void test_crc_check_value (void)
+{
+    // The check value of CRC-16/CCITT-FALSE is its CRC of "123456789"
+    TEST_ASSERT_EQUAL_HEX16 (0x29B1, nv_crc16 ("123456789", 9));
+    TEST_ASSERT_EQUAL_HEX16 (0xFFFF, nv_crc16 ("", 0));
+}
+
+
+void test_crc_sees_one_bit_flipped (void)
+{
+    uint8_t data[22];
+
+    for (uint8_t index = 0; index < sizeof (data); index++)
+    {
+        data[index] = index * 37;
+    }
+    uint16_t crc = nv_crc16 (data, sizeof (data));
+    for (uint8_t bit = 0; bit < 8 * sizeof (data); bit++)
+    {
+        data[bit / 8] ^= 1 << (bit % 8);
+        TEST_ASSERT_NOT_EQUAL (crc, nv_crc16 (data, sizeof (data)));
+        data[bit / 8] ^= 1 << (bit % 8);
+    }
+    TEST_ASSERT_EQUAL_HEX16 (crc, nv_crc16 (data, sizeof (data)));
+}
+
+
+void test_record_round_trip (void)
+{
+    const uint8_t written[5] = {1, 2, 3, 0xFF, 0};
+    uint8_t read[5];
+
+    nv_write (NV_CONFIG_ADDR, written, sizeof (written));
+    nv_read (NV_CONFIG_ADDR, read, sizeof (read));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY (written, read, sizeof (written));
+
+    // Bytes on either side of the record are left erased
+    TEST_ASSERT_EQUAL_HEX8 (0xFF, EEPROM.read (NV_CONFIG_ADDR - 1));
+    TEST_ASSERT_EQUAL_HEX8 (0xFF, EEPROM.read (NV_CONFIG_ADDR + 5));
+}
+
+
+void test_records_do_not_overlap (void)
+{
+    TEST_ASSERT_TRUE (NV_CALIBRATION_ADDR + NV_CALIBRATION_SIZE
+                      <= NV_CONFIG_ADDR);
+    TEST_ASSERT_TRUE (NV_CONFIG_ADDR + NV_CONFIG_SIZE <= HOST_EEPROM_SIZE);
+}
+
+
+int main (int argc, char** argv)
+{
+    UNITY_BEGIN ();
+    RUN_TEST (test_crc_check_value);
+    RUN_TEST (test_crc_sees_one_bit_flipped);
+    RUN_TEST (test_record_round_trip);
+    RUN_TEST (test_records_do_not_overlap);
+    return UNITY_END ();
+}
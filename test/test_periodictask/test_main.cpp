@@ -0,0 +1,197 @@
+//*****************************************************************************
+/** @file    test_main.cpp
+ *  @brief   Tests of the periodic task timer, run with a simulated clock.
+ *  @details The clock counts a tick each millisecond of the stand-in core's
+ *           time, and sleeping moves that time on to the wake time, plus a
+ *           wake-up latency which the tests can set.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <unity.h>
+#include "periodictask.h"
+
+
+/// Microseconds late that a sleeping task wakes
+static uint32_t wake_latency_us = 0;
+
+/// Number of times the task has slept
+static uint32_t num_sleeps = 0;
+
+
+/** @brief   Clock which runs on the stand-in core's simulated time.
+ */
+struct SimClock
+{
+    static uint32_t now_us (void)
+    {
+        return micros ();
+    }
+
+    static PeriodicTicks ticks (void)
+    {
+        return millis ();
+    }
+
+    /// Like vTaskDelayUntil(): wake a period after the last wake, or at once
+    /// if that has already gone by
+    static void delay_until (PeriodicTicks& last_wake, PeriodicTicks period)
+    {
+        last_wake += period;
+        if ((int32_t)(last_wake * 1000 - host_us) > 0)
+        {
+            host_us = last_wake * 1000 + wake_latency_us;
+        }
+        num_sleeps++;
+    }
+};
+
+
+/// Timer which is printed; shares are made globally, as they stay in the
+/// list of shares for good
+static PeriodicTask<SimClock> printed ("Printed", 5);
+
+
+void setUp (void)
+{
+    host_us = 0;
+    wake_latency_us = 0;
+    num_sleeps = 0;
+}
+
+
+void tearDown (void)
+{
+}
+
+
+void test_steady_runs_keep_to_period (void)
+{
+    PeriodicTask<SimClock> timing ("Steady", 5);
+    auto body = [] () { host_us += 300; };
+
+    timing.start ();
+    for (uint8_t count = 0; count < 10; count++)
+    {
+        timing.run_once (body);
+    }
+    TEST_ASSERT_EQUAL_UINT32 (10, timing.get_num_runs ());
+    TEST_ASSERT_EQUAL_UINT32 (0, timing.get_num_overruns ());
+    TEST_ASSERT_EQUAL_UINT32 (300, timing.get_max_exec_us ());
+    TEST_ASSERT_EQUAL_UINT32 (0, timing.get_max_jitter_us ());
+    TEST_ASSERT_EQUAL_UINT32 (50000, host_us);
+}
+
+
+void test_wake_latency_shows_as_jitter (void)
+{
+    PeriodicTask<SimClock> timing ("Jittery", 10);
+    auto body = [] () { host_us += 100; };
+
+    timing.start ();
+    timing.run_once (body);
+    wake_latency_us = 250;
+    timing.run_once (body);
+    wake_latency_us = 40;
+    timing.run_once (body);
+    timing.run_once (body);
+    TEST_ASSERT_EQUAL_UINT32 (250, timing.get_max_jitter_us ());
+    TEST_ASSERT_EQUAL_UINT32 (0, timing.get_num_overruns ());
+}
+
+
+void test_overrun_skips_missed_releases (void)
+{
+    PeriodicTask<SimClock> timing ("Late", 5);
+    uint32_t run = 0;
+    auto body = [&] () { host_us += (run++ == 2) ? 12000 : 1000; };
+
+    timing.start ();
+    for (uint8_t count = 0; count < 6; count++)
+    {
+        timing.run_once (body);
+    }
+
+    // The long run began at 10 ms and ended at 22 ms, so the releases at
+    // 15 and 20 ms were skipped and the schedule went on from 22 ms
+    TEST_ASSERT_EQUAL_UINT32 (6, timing.get_num_runs ());
+    TEST_ASSERT_EQUAL_UINT32 (1, timing.get_num_overruns ());
+    TEST_ASSERT_EQUAL_UINT32 (12000, timing.get_max_exec_us ());
+    TEST_ASSERT_EQUAL_UINT32 (1000, timing.get_exec_us ());
+    TEST_ASSERT_EQUAL_UINT32 (0, timing.get_max_jitter_us ());
+    TEST_ASSERT_EQUAL_UINT32 (42000, host_us);
+}
+
+
+void test_reset_stats_and_set_period (void)
+{
+    PeriodicTask<SimClock> timing ("Reset", 2);
+    auto body = [] () { host_us += 3000; };
+
+    timing.start ();
+    timing.run_once (body);
+    TEST_ASSERT_EQUAL_UINT32 (1, timing.get_num_overruns ());
+
+    timing.reset_stats ();
+    TEST_ASSERT_EQUAL_UINT32 (0, timing.get_num_runs ());
+    TEST_ASSERT_EQUAL_UINT32 (0, timing.get_max_exec_us ());
+
+    timing.set_period (4);
+    TEST_ASSERT_EQUAL_UINT32 (4, timing.get_period ());
+    timing.start ();
+    timing.run_once (body);
+    timing.run_once (body);
+    TEST_ASSERT_EQUAL_UINT32 (0, timing.get_num_overruns ());
+}
+
+
+void test_print_in_list_shows_figures (void)
+{
+    auto body = [] () { host_us += 700; };
+
+    printed.start ();
+    printed.run_once (body);
+    Serial.output.clear ();
+    printed.print_in_list (Serial);
+    TEST_ASSERT_TRUE (Serial.output.find ("Printed") == 0);
+    TEST_ASSERT_TRUE (Serial.output.find ("periodic\t5 ticks, exec 700/700 us")
+                      != std::string::npos);
+}
+
+
+void test_execution_timer_times_runs (void)
+{
+    ExecutionTimer<SimClock> timer ("Event task");
+
+    timer.end ();                           // No run going on yet
+    TEST_ASSERT_EQUAL_UINT32 (0, timer.get_num_runs ());
+
+    timer.begin ();
+    host_us += 800;
+    timer.end ();
+    host_us += 5000;                        // Blocked, so not counted
+    timer.end ();
+    timer.begin ();
+    host_us += 300;
+    timer.end ();
+    TEST_ASSERT_EQUAL_UINT32 (2, timer.get_num_runs ());
+    TEST_ASSERT_EQUAL_UINT32 (300, timer.get_exec_us ());
+    TEST_ASSERT_EQUAL_UINT32 (800, timer.get_max_exec_us ());
+
+    timer.reset_stats ();
+    TEST_ASSERT_EQUAL_UINT32 (0, timer.get_max_exec_us ());
+}
+
+
+int main (int argc, char** argv)
+{
+    UNITY_BEGIN ();
+    RUN_TEST (test_steady_runs_keep_to_period);
+    RUN_TEST (test_wake_latency_shows_as_jitter);
+    RUN_TEST (test_overrun_skips_missed_releases);
+    RUN_TEST (test_reset_stats_and_set_period);
+    RUN_TEST (test_print_in_list_shows_figures);
+    RUN_TEST (test_execution_timer_times_runs);
+    return UNITY_END ();
+}
@@ -0,0 +1,186 @@
+//*****************************************************************************
+/** @file    test_main.cpp
+ *  @brief   Tests of the turntable slot map, run as a simulated pipeline.
+ *  @details Balls are loaded at the sensor as the sorting sequence loads
+ *           them, a turn at a time, and the tests check that each one is
+ *           ejected at its own bin's station while others are on the table.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <unity.h>
+#include "slotmap.h"
+#include "colorclassifier.h"
+
+
+/// Sections, and so slots, on the simulated table
+#define SECTIONS 4
+
+/// Map which is printed; shares are made globally, as they stay in the list
+/// of shares for good
+static SlotMap printed ("Printed", SECTIONS);
+
+
+/** @brief   Turn the table one section and eject the balls which reach
+ *           their stations, as the sorting sequence does.
+ *  @param   map The slot map
+ *  @param   now_ms The time of the turn
+ *  @param   p_bins Where the bin of each ball ejected is put, in order of
+ *           station, or @c NULL
+ *  @return  The number of balls ejected
+ */
+static uint8_t turn (SlotMap& map, uint32_t now_ms, uint8_t* p_bins = NULL)
+{
+    uint8_t count = 0;
+
+    map.advance ();
+    uint8_t stations = map.get_ejections ();
+    for (uint8_t station = 1; station < SECTIONS; station++)
+    {
+        if (stations & (1 << station))
+        {
+            SlotBall ball;
+            map.get_ball (station, ball);
+            if (p_bins != NULL)
+            {
+                p_bins[count] = ball.bin;
+            }
+            map.eject (station, now_ms);
+            count++;
+        }
+    }
+    return count;
+}
+
+
+void setUp (void)
+{
+}
+
+
+void tearDown (void)
+{
+}
+
+
+void test_ball_reaches_its_station (void)
+{
+    SlotMap map ("Map", SECTIONS);
+
+    for (uint8_t bin = 0; bin < SECTIONS - 1; bin++)
+    {
+        TEST_ASSERT_TRUE (map.load (bin, 0));
+
+        // A ball for bin b is pushed off after b + 1 turns
+        for (uint8_t count = 0; count < bin; count++)
+        {
+            TEST_ASSERT_EQUAL (0, turn (map, 0));
+        }
+        uint8_t ejected;
+        TEST_ASSERT_EQUAL (1, turn (map, 0, &ejected));
+        TEST_ASSERT_EQUAL_UINT8 (bin, ejected);
+        TEST_ASSERT_EQUAL (0, map.get_num_balls ());
+    }
+}
+
+
+void test_pipeline_sorts_a_ball_each_turn (void)
+{
+    SlotMap map ("Map", SECTIONS);
+    const uint8_t feed[] = {2, 0, 1, 2, 2, 1, 0, 0, 1, 2};
+    const uint8_t num_feed = sizeof (feed);
+    uint8_t sorted[num_feed];
+    uint8_t num_sorted = 0;
+    uint8_t next = 0;
+    uint32_t now_ms = 0;
+
+    // A ball is loaded before each turn if the slot at the sensor is free
+    while (num_sorted < num_feed)
+    {
+        if (next < num_feed && map.can_load ())
+        {
+            TEST_ASSERT_TRUE (map.load (feed[next++], now_ms));
+        }
+        TEST_ASSERT_LESS_OR_EQUAL (SECTIONS - 1, map.get_num_balls ());
+        now_ms += 1000;
+        num_sorted += turn (map, now_ms, &sorted[num_sorted]);
+        TEST_ASSERT_LESS_THAN (100000, now_ms);
+    }
+
+    // Every ball came off, and the table never held up the feed
+    TEST_ASSERT_EQUAL (num_feed, map.get_num_ejected ());
+    TEST_ASSERT_EQUAL (0, map.get_num_balls ());
+    uint8_t counts[SECTIONS - 1] = {0, 0, 0};
+    for (uint8_t index = 0; index < num_feed; index++)
+    {
+        counts[sorted[index]]++;
+    }
+    TEST_ASSERT_EQUAL (3, counts[0]);
+    TEST_ASSERT_EQUAL (3, counts[1]);
+    TEST_ASSERT_EQUAL (4, counts[2]);
+    TEST_ASSERT_LESS_OR_EQUAL ((num_feed + SECTIONS) * 1000, now_ms);
+}
+
+
+void test_bin_without_station_is_refused (void)
+{
+    SlotMap map ("Map", SECTIONS);
+
+    TEST_ASSERT_FALSE (map.has_station (SECTIONS - 1));
+    TEST_ASSERT_FALSE (map.load (SECTIONS - 1, 0));
+    TEST_ASSERT_FALSE (map.load (BIN_REJECT, 0));
+    TEST_ASSERT_EQUAL (0, map.station_for (BIN_REJECT));
+    TEST_ASSERT_EQUAL (0, map.get_num_balls ());
+    TEST_ASSERT_EQUAL (2, map.get_num_refused ());
+    TEST_ASSERT_TRUE (map.can_load ());
+
+    // Nothing is ejected for it, however far the table turns
+    for (uint8_t count = 0; count < 2 * SECTIONS; count++)
+    {
+        TEST_ASSERT_EQUAL (0, turn (map, 0));
+    }
+}
+
+
+void test_full_slot_is_refused (void)
+{
+    SlotMap map ("Map", SECTIONS);
+
+    TEST_ASSERT_TRUE (map.load (1, 0));
+    TEST_ASSERT_FALSE (map.can_load ());
+    TEST_ASSERT_FALSE (map.load (0, 0));
+    TEST_ASSERT_EQUAL (1, map.get_num_balls ());
+    TEST_ASSERT_EQUAL (0, map.get_num_refused ());
+}
+
+
+void test_dwell_and_print (void)
+{
+    printed.load (2, 100);
+    turn (printed, 1100);
+    printed.load (0, 1100);
+    Serial.output.clear ();
+    printed.print_in_list (Serial);
+    TEST_ASSERT_TRUE (Serial.output.find ("slots\t[0 2 - -] 2 loaded")
+                      != std::string::npos);
+    turn (printed, 2100);
+    turn (printed, 3100);
+    Serial.output.clear ();
+    printed.print_in_list (Serial);
+    TEST_ASSERT_TRUE (Serial.output.find ("2 ejected, 0 refused, dwell "
+                                          "2000/3000 ms")
+                      != std::string::npos);
+}
+
+
+int main (int argc, char** argv)
+{
+    UNITY_BEGIN ();
+    RUN_TEST (test_ball_reaches_its_station);
+    RUN_TEST (test_pipeline_sorts_a_ball_each_turn);
+    RUN_TEST (test_bin_without_station_is_refused);
+    RUN_TEST (test_full_slot_is_refused);
+    RUN_TEST (test_dwell_and_print);
+    return UNITY_END ();
+}
@@ -0,0 +1,328 @@
+//*****************************************************************************
+/** @file    test_main.cpp
+ *  @brief   Tests of the ball sensor's admission control.
+ *  @details Classified balls are delivered to the ball sensor faster than a
+ *           sorting coroutine can deal with them. The feeder gate must be
+ *           stopped at the high watermark and started again at the low one,
+ *           delivering must never block, and balls which have waited too
+ *           long must be rejected, so that no ball is sorted later than the
+ *           limit however hard the sensor is driven.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <unity.h>
+#include <string>
+#include "sortdevices.h"
+
+
+/// Bin delivered to tell the sorting coroutine to finish
+#define STOP_BIN 0xFE
+
+/// Balls are numbered modulo this so each number can be a bin
+#define BALL_NUMBERS 200
+
+
+/// Feeder gate signals in the order given, 'S' to stop and 'O' to open
+static std::string gate_signals;
+
+/// Tick at which each numbered ball was delivered
+static uint32_t arrivals[BALL_NUMBERS];
+
+/// Number of balls the sorting coroutine got, and the longest any waited
+static uint32_t num_sorted;
+static uint32_t longest_wait;
+
+/// True once the sorting coroutine has finished
+static bool sorter_done;
+
+/// Scheduler and ball sensor printed by the print test; shares must outlive
+/// the test
+static CoScheduler printed_scheduler;
+static BallSensor printed ("Balls", printed_scheduler);
+
+
+/// Note each signal to the feeder gate
+static void note_gate (bool open, void* p_context)
+{
+    gate_signals += open ? 'O' : 'S';
+}
+
+
+/** @brief   Coroutine which sorts balls, taking a while over each one.
+ *  @details Each ball's wait is measured from its delivery to the time the
+ *           coroutine gets it. The coroutine returns when it gets
+ *           @c STOP_BIN, so its frame goes back to the pool.
+ */
+static CoTask sorter (CoScheduler& scheduler, BallSensor& sensor,
+                      uint32_t service_ticks)
+{
+    uint8_t bin;
+
+    while ((bin = co_await sensor.sample ()) != STOP_BIN)
+    {
+        uint32_t wait = scheduler.get_now () - arrivals[bin];
+        if (wait > longest_wait)
+        {
+            longest_wait = wait;
+        }
+        num_sorted++;
+        co_await scheduler.sleep (service_ticks);
+    }
+    sorter_done = true;
+}
+
+
+/// Deliver stop bins, with no limit on waiting, until the sorter finishes
+static void finish_sorter (CoScheduler& scheduler, BallSensor& sensor,
+                           uint32_t now)
+{
+    sensor.set_max_wait (0);
+    for (uint16_t tries = 0; tries < 1000 && !sorter_done; tries++)
+    {
+        now += 10;
+        scheduler.run (now);
+        sensor.deliver (STOP_BIN, now);
+        scheduler.run (now);
+    }
+}
+
+
+void setUp (void)
+{
+    gate_signals.clear ();
+    num_sorted = 0;
+    longest_wait = 0;
+    sorter_done = false;
+}
+
+
+void tearDown (void)
+{
+}
+
+
+void test_watermarks_must_fit_the_queue (void)
+{
+    CoScheduler scheduler;
+    BallSensor sensor ("Balls", scheduler);
+
+    TEST_ASSERT_FALSE (sensor.set_watermarks (2, 2));
+    TEST_ASSERT_FALSE (sensor.set_watermarks (1, 3));
+    TEST_ASSERT_FALSE (sensor.set_watermarks (BALL_QUEUE_SIZE + 1, 1));
+    TEST_ASSERT_TRUE (sensor.set_watermarks (BALL_QUEUE_SIZE, 0));
+}
+
+
+void test_feeder_stops_at_high_and_starts_at_low (void)
+{
+    CoScheduler scheduler;
+    BallSensor sensor ("Balls", scheduler);
+    uint8_t bin;
+
+    sensor.set_gate (note_gate, NULL);
+    TEST_ASSERT_TRUE (sensor.set_watermarks (3, 1));
+
+    // No coroutine is waiting, so the balls queue up until the feeder stops
+    TEST_ASSERT_TRUE (sensor.deliver (10, 0));
+    TEST_ASSERT_TRUE (sensor.deliver (11, 0));
+    TEST_ASSERT_TRUE (sensor.is_gate_open ());
+    TEST_ASSERT_TRUE (sensor.deliver (12, 0));
+    TEST_ASSERT_FALSE (sensor.is_gate_open ());
+    TEST_ASSERT_EQUAL_STRING ("S", gate_signals.c_str ());
+
+    // A ball already on its way still fits; one more doesn't, and is lost
+    TEST_ASSERT_TRUE (sensor.deliver (13, 0));
+    TEST_ASSERT_FALSE (sensor.deliver (14, 0));
+    TEST_ASSERT_EQUAL_UINT32 (1, sensor.get_num_dropped ());
+    TEST_ASSERT_EQUAL_STRING ("S", gate_signals.c_str ());
+
+    // The feeder starts again once the queue is down to the low watermark
+    TEST_ASSERT_TRUE (sensor.take (bin));
+    TEST_ASSERT_EQUAL_UINT8 (10, bin);
+    TEST_ASSERT_TRUE (sensor.take (bin));
+    TEST_ASSERT_FALSE (sensor.is_gate_open ());
+    TEST_ASSERT_TRUE (sensor.take (bin));
+    TEST_ASSERT_EQUAL_UINT8 (12, bin);
+    TEST_ASSERT_TRUE (sensor.is_gate_open ());
+    TEST_ASSERT_EQUAL_STRING ("SO", gate_signals.c_str ());
+    TEST_ASSERT_TRUE (sensor.take (bin));
+    TEST_ASSERT_EQUAL_UINT8 (13, bin);
+    TEST_ASSERT_FALSE (sensor.take (bin));
+    TEST_ASSERT_EQUAL_STRING ("SO", gate_signals.c_str ());
+}
+
+
+void test_waiting_coroutine_gets_the_ball (void)
+{
+    CoScheduler scheduler;
+    BallSensor sensor ("Balls", scheduler);
+    uint8_t bin;
+
+    // A ball goes straight to a coroutine which is waiting, not to the queue
+    sensor.set_gate (note_gate, NULL);
+    TEST_ASSERT_TRUE (scheduler.spawn (sorter (scheduler, sensor, 5)));
+    scheduler.run (0);
+    arrivals[7] = 3;
+    TEST_ASSERT_TRUE (sensor.deliver (7, 3));
+    TEST_ASSERT_FALSE (sensor.take (bin));
+    scheduler.run (3);
+    TEST_ASSERT_EQUAL_UINT32 (1, num_sorted);
+    TEST_ASSERT_EQUAL_UINT32 (0, longest_wait);
+    TEST_ASSERT_TRUE (sensor.is_gate_open ());
+    TEST_ASSERT_EQUAL_STRING ("", gate_signals.c_str ());
+
+    finish_sorter (scheduler, sensor, 3);
+    TEST_ASSERT_TRUE (sorter_done);
+}
+
+
+void test_late_balls_are_rejected (void)
+{
+    CoScheduler scheduler;
+    BallSensor sensor ("Balls", scheduler);
+    uint8_t bin;
+
+    sensor.set_max_wait (10);
+    sensor.deliver (1, 100);
+    sensor.deliver (2, 105);
+    sensor.deliver (3, 112);
+
+    // At tick 115 the first ball has waited too long; the second hasn't
+    scheduler.run (115);
+    TEST_ASSERT_TRUE (sensor.take (bin));
+    TEST_ASSERT_EQUAL_UINT8 (2, bin);
+    TEST_ASSERT_EQUAL_UINT32 (1, sensor.get_num_late ());
+
+    // By tick 200 the last one is too late as well, so there's no ball
+    scheduler.run (200);
+    TEST_ASSERT_FALSE (sensor.take (bin));
+    TEST_ASSERT_EQUAL_UINT32 (2, sensor.get_num_late ());
+
+    // With no limit, a ball is sorted however late
+    sensor.set_max_wait (0);
+    sensor.deliver (4, 200);
+    scheduler.run (100000);
+    TEST_ASSERT_TRUE (sensor.take (bin));
+    TEST_ASSERT_EQUAL_UINT8 (4, bin);
+}
+
+
+void test_overdriven_feeder_is_held_back (void)
+{
+    CoScheduler scheduler;
+    BallSensor sensor ("Balls", scheduler);
+    uint32_t offered = 0;
+    uint32_t now;
+
+    // Sorting a ball takes 10 ticks; the feeder could give one every 2
+    sensor.set_gate (note_gate, NULL);
+    TEST_ASSERT_TRUE (sensor.set_watermarks (3, 1));
+    TEST_ASSERT_TRUE (scheduler.spawn (sorter (scheduler, sensor, 10)));
+    for (now = 0; now < 1000; now++)
+    {
+        scheduler.run (now);
+        if (sensor.is_gate_open () && now % 2 == 0)
+        {
+            uint8_t number = offered % BALL_NUMBERS;
+            arrivals[number] = now;
+            TEST_ASSERT_TRUE (sensor.deliver (number, now));
+            offered++;
+        }
+    }
+
+    // The feeder was held back to the rate of sorting, and no ball was lost
+    TEST_ASSERT_EQUAL_UINT32 (0, sensor.get_num_dropped ());
+    TEST_ASSERT_EQUAL_UINT32 (0, sensor.get_num_late ());
+    TEST_ASSERT_UINT32_WITHIN (2, 100, num_sorted);
+    TEST_ASSERT_LESS_OR_EQUAL (num_sorted + 3, offered);
+    TEST_ASSERT_GREATER_THAN (10, gate_signals.size ());
+    for (uint16_t index = 0; index < gate_signals.size (); index++)
+    {
+        TEST_ASSERT_EQUAL (index % 2 ? 'O' : 'S', gate_signals[index]);
+    }
+
+    // No ball waited for more than the queue's worth of sorting
+    TEST_ASSERT_LESS_OR_EQUAL (3 * 10, longest_wait);
+
+    finish_sorter (scheduler, sensor, now);
+    TEST_ASSERT_TRUE (sorter_done);
+}
+
+
+void test_ignored_gate_rejects_without_blocking (void)
+{
+    CoScheduler scheduler;
+    BallSensor sensor ("Balls", scheduler);
+    uint32_t offered = 0;
+    uint32_t refused = 0;
+    uint32_t now;
+
+    // The balls keep coming every 2 ticks though the feeder is told to stop
+    sensor.set_max_wait (15);
+    TEST_ASSERT_TRUE (scheduler.spawn (sorter (scheduler, sensor, 10)));
+    for (now = 0; now < 1000; now++)
+    {
+        scheduler.run (now);
+        if (now % 2 == 0)
+        {
+            uint8_t number = offered % BALL_NUMBERS;
+            arrivals[number] = now;
+            if (!sensor.deliver (number, now))
+            {
+                refused++;
+            }
+            offered++;
+        }
+    }
+
+    // Delivering never blocked; the surplus was dropped or rejected as late
+    TEST_ASSERT_EQUAL_UINT32 (500, offered);
+    TEST_ASSERT_EQUAL_UINT32 (refused, sensor.get_num_dropped ());
+    TEST_ASSERT_GREATER_THAN (0, sensor.get_num_dropped ());
+    TEST_ASSERT_GREATER_THAN (0, sensor.get_num_late ());
+    TEST_ASSERT_UINT32_WITHIN (2, 100, num_sorted);
+
+    // Every ball was sorted, dropped or rejected, save those still queued
+    uint32_t accounted = num_sorted + sensor.get_num_dropped ()
+                         + sensor.get_num_late ();
+    TEST_ASSERT_LESS_OR_EQUAL (offered, accounted);
+    TEST_ASSERT_GREATER_OR_EQUAL (offered - BALL_QUEUE_SIZE, accounted);
+
+    // However hard the sensor is driven, no ball is sorted too late
+    TEST_ASSERT_LESS_OR_EQUAL (15, longest_wait);
+
+    finish_sorter (scheduler, sensor, now);
+    TEST_ASSERT_TRUE (sorter_done);
+}
+
+
+void test_print_shows_the_queue (void)
+{
+    printed.deliver (1, 0);
+    printed.deliver (2, 0);
+    printed.deliver (3, 0);
+    printed.deliver (4, 0);
+    printed.deliver (5, 0);
+
+    Serial.output.clear ();
+    printed.print_in_list (Serial);
+    TEST_ASSERT_NOT_NULL (strstr (Serial.output.c_str (),
+                                  "4 queued, feeder stopped (1 stops), "
+                                  "1 dropped, 0 late"));
+}
+
+
+int main (int argc, char** argv)
+{
+    UNITY_BEGIN ();
+    RUN_TEST (test_watermarks_must_fit_the_queue);
+    RUN_TEST (test_feeder_stops_at_high_and_starts_at_low);
+    RUN_TEST (test_waiting_coroutine_gets_the_ball);
+    RUN_TEST (test_late_balls_are_rejected);
+    RUN_TEST (test_overdriven_feeder_is_held_back);
+    RUN_TEST (test_ignored_gate_rejects_without_blocking);
+    RUN_TEST (test_print_shows_the_queue);
+    return UNITY_END ();
+}
@@ -0,0 +1,382 @@
+//*****************************************************************************
+/** @file    test_main.cpp
+ *  @brief   Tests of the stall detector with a simulated turntable.
+ *  @details The simulated table has an index flag a few steps wide. Each
+ *           tick makes a step as the stepper motor task does, with the steps
+ *           the detector asks to be made up, and the table can be made to
+ *           miss steps or jam. The color sensor's view of the empty slot is
+ *           simulated by giving the detector clear counts.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <unity.h>
+#include "stalldetect.h"
+
+
+/// Motor steps per revolution of the simulated table
+#define STEPS_PER_REV 350
+
+/// Steps for which the index flag is seen
+#define INDEX_WIDTH 4
+
+/// Sensitivity given with the clear counts
+#define SENSITIVITY 64
+
+
+/** @brief   Turntable whose motor can miss steps.
+ */
+struct SimTable
+{
+    uint32_t count;                         ///< Steps counted by the task
+    uint32_t physical;                      ///< Steps the table really made
+    uint16_t index_at;                      ///< Position where the flag is
+    uint32_t missed;                        ///< Steps still to be missed
+
+    SimTable (uint16_t an_index_at = 100)
+    {
+        count = 0;
+        physical = 0;
+        index_at = an_index_at;
+        missed = 0;
+    }
+
+    /// Return true while the index flag is in front of its sensor
+    bool index (void) const
+    {
+        uint16_t at = physical % STEPS_PER_REV;
+        return at >= index_at && at < index_at + INDEX_WIDTH;
+    }
+
+    /// Turn the motor one step, unless a step is to be missed
+    void turn_motor (void)
+    {
+        if (missed > 0)
+        {
+            missed--;
+        }
+        else
+        {
+            physical++;
+        }
+    }
+
+    /// Make a step as the stepper motor task does; return true on a stall
+    bool step (StallDetector& detector)
+    {
+        int8_t resync = detector.resync_step ();
+        if (resync >= 0)
+        {
+            turn_motor ();
+        }
+        if (resync <= 0)
+        {
+            count++;
+        }
+        return detector.step (count, index ());
+    }
+
+    /// Make steps until a stall or the given number have been made
+    uint32_t run (StallDetector& detector, uint32_t steps)
+    {
+        for (uint32_t made = 0; made < steps; made++)
+        {
+            if (step (detector))
+            {
+                return made + 1;
+            }
+        }
+        return steps;
+    }
+};
+
+
+/// What the stall handler was last told, and how often it was called
+static StallCause handled_cause;
+static int16_t handled_error;
+static uint8_t num_handled;
+
+
+/// Stall handler which remembers what it was told
+static void handler (StallCause cause, int16_t error, void* p_context)
+{
+    handled_cause = cause;
+    handled_error = error;
+    num_handled++;
+}
+
+
+/// Make a detector with an index and the handler
+static void set_up (StallDetector& detector)
+{
+    detector.set_index (true);
+    detector.set_stall_handler (handler, NULL);
+}
+
+
+void setUp (void)
+{
+    handled_cause = STALL_NONE;
+    handled_error = 0;
+    num_handled = 0;
+}
+
+
+void tearDown (void)
+{
+}
+
+
+void test_steady_table_stays_in_line (void)
+{
+    StallDetector detector ("Stall", STEPS_PER_REV);
+    SimTable table;
+
+    set_up (detector);
+    TEST_ASSERT_EQUAL_UINT32 (10 * STEPS_PER_REV,
+                              table.run (detector, 10 * STEPS_PER_REV));
+    TEST_ASSERT_FALSE (detector.is_stalled ());
+    TEST_ASSERT_EQUAL_INT16 (0, detector.get_last_error ());
+    TEST_ASSERT_EQUAL_UINT32 (0, detector.get_num_resyncs ());
+    TEST_ASSERT_EQUAL (0, num_handled);
+}
+
+
+void test_few_missed_steps_are_tolerated (void)
+{
+    StallDetector detector ("Stall", STEPS_PER_REV);
+    SimTable table;
+
+    set_up (detector);
+    table.run (detector, STEPS_PER_REV);
+    table.missed = STALL_TOLERANCE;
+    table.run (detector, 2 * STEPS_PER_REV);
+    TEST_ASSERT_FALSE (detector.is_stalled ());
+    TEST_ASSERT_EQUAL_INT16 (STALL_TOLERANCE, detector.get_last_error ());
+    TEST_ASSERT_EQUAL_UINT32 (0, detector.get_num_resyncs ());
+}
+
+
+void test_missed_steps_are_made_up (void)
+{
+    StallDetector detector ("Stall", STEPS_PER_REV);
+    SimTable table;
+
+    set_up (detector);
+    table.run (detector, STEPS_PER_REV);
+    table.missed = 12;
+    table.run (detector, STEPS_PER_REV);
+    TEST_ASSERT_EQUAL_INT16 (12, detector.get_last_error ());
+    TEST_ASSERT_EQUAL_UINT32 (1, detector.get_num_resyncs ());
+
+    // The table is back where the count says it is by the next index
+    table.run (detector, 2 * STEPS_PER_REV);
+    TEST_ASSERT_FALSE (detector.is_stalled ());
+    TEST_ASSERT_EQUAL_INT16 (0, detector.get_last_error ());
+    TEST_ASSERT_EQUAL_UINT32 (table.count % STEPS_PER_REV,
+                              table.physical % STEPS_PER_REV);
+}
+
+
+void test_steps_gained_are_taken_back (void)
+{
+    StallDetector detector ("Stall", STEPS_PER_REV);
+    SimTable table;
+
+    set_up (detector);
+    table.run (detector, STEPS_PER_REV);
+    table.physical += 7;                    // Table was pushed forwards
+    table.run (detector, 3 * STEPS_PER_REV);
+    TEST_ASSERT_FALSE (detector.is_stalled ());
+    TEST_ASSERT_EQUAL_UINT32 (1, detector.get_num_resyncs ());
+    TEST_ASSERT_EQUAL_UINT32 (table.count % STEPS_PER_REV,
+                              table.physical % STEPS_PER_REV);
+}
+
+
+void test_many_missed_steps_are_a_stall (void)
+{
+    StallDetector detector ("Stall", STEPS_PER_REV);
+    SimTable table;
+
+    set_up (detector);
+    table.run (detector, STEPS_PER_REV);
+    table.missed = STALL_RESYNC_LIMIT + 10;
+    table.run (detector, 2 * STEPS_PER_REV);
+    TEST_ASSERT_EQUAL (STALL_INDEX, detector.get_cause ());
+    TEST_ASSERT_EQUAL (STALL_INDEX, handled_cause);
+    TEST_ASSERT_EQUAL_INT16 (STALL_RESYNC_LIMIT + 10, handled_error);
+    TEST_ASSERT_EQUAL_UINT32 (1, detector.get_num_stalls ());
+
+    // Nothing more is reported until it's cleared
+    table.run (detector, 2 * STEPS_PER_REV);
+    TEST_ASSERT_EQUAL (1, num_handled);
+}
+
+
+void test_jammed_table_is_a_stall (void)
+{
+    StallDetector detector ("Stall", STEPS_PER_REV);
+    SimTable table;
+
+    set_up (detector);
+    table.run (detector, STEPS_PER_REV);
+    table.missed = UINT32_MAX;
+    uint32_t made = table.run (detector, 3 * STEPS_PER_REV);
+    TEST_ASSERT_EQUAL (STALL_NO_INDEX, detector.get_cause ());
+
+    // It's found a revolution and a half after the index was last seen
+    TEST_ASSERT_LESS_OR_EQUAL (STEPS_PER_REV * 3 / 2, made);
+}
+
+
+void test_homed_table_uses_new_index_position (void)
+{
+    StallDetector detector ("Stall", STEPS_PER_REV);
+    SimTable table (200);
+
+    set_up (detector);
+    detector.need_homing ();
+    TEST_ASSERT_EQUAL (STALL_NOT_HOMED, handled_cause);
+    table.run (detector, 2 * STEPS_PER_REV);
+    TEST_ASSERT_EQUAL (STALL_NOT_HOMED, detector.get_cause ());
+
+    // Homing says the index edge is at 200 steps from section 0
+    table.count = table.physical;
+    detector.homed (200, table.index ());
+    TEST_ASSERT_EQUAL (STALL_NONE, handled_cause);
+    table.run (detector, 3 * STEPS_PER_REV);
+    TEST_ASSERT_FALSE (detector.is_stalled ());
+    TEST_ASSERT_EQUAL_INT16 (0, detector.get_last_error ());
+}
+
+
+void test_background_is_learned_from_several_readings (void)
+{
+    StallDetector detector ("Stall", STEPS_PER_REV);
+
+    // The first readings are averaged, so an odd first one is diluted
+    TEST_ASSERT_FALSE (detector.check_background (2000, SENSITIVITY));
+    for (uint8_t count = 1; count < STALL_LEARN_SAMPLES; count++)
+    {
+        TEST_ASSERT_FALSE (detector.check_background (1000, SENSITIVITY));
+    }
+
+    // Readings near the average, taken with other settings, are in line
+    for (uint8_t count = 0; count < 10; count++)
+    {
+        TEST_ASSERT_FALSE (detector.check_background (2100,
+                                                      2 * SENSITIVITY));
+    }
+    TEST_ASSERT_FALSE (detector.is_stalled ());
+}
+
+
+void test_rim_seen_several_times_is_a_stall (void)
+{
+    StallDetector detector ("Stall", STEPS_PER_REV);
+
+    detector.set_stall_handler (handler, NULL);
+    for (uint8_t count = 0; count < STALL_LEARN_SAMPLES; count++)
+    {
+        detector.check_background (1000, SENSITIVITY);
+    }
+
+    // A ball dropping in gives one odd reading, which isn't a stall
+    TEST_ASSERT_FALSE (detector.check_background (3000, SENSITIVITY));
+    TEST_ASSERT_FALSE (detector.check_background (1000, SENSITIVITY));
+
+    // The rim, seen in reading after reading, is
+    for (uint8_t count = 1; count < STALL_BACKGROUND_CONFIRM; count++)
+    {
+        TEST_ASSERT_FALSE (detector.check_background (400, SENSITIVITY));
+    }
+    TEST_ASSERT_TRUE (detector.check_background (400, SENSITIVITY));
+    TEST_ASSERT_EQUAL (STALL_BACKGROUND, handled_cause);
+}
+
+
+void test_background_is_learned_again_after_clear (void)
+{
+    StallDetector detector ("Stall", STEPS_PER_REV);
+
+    for (uint8_t count = 0; count < STALL_LEARN_SAMPLES; count++)
+    {
+        detector.check_background (1000, SENSITIVITY);
+    }
+    for (uint8_t count = 0; count < STALL_BACKGROUND_CONFIRM; count++)
+    {
+        detector.check_background (400, SENSITIVITY);
+    }
+    TEST_ASSERT_TRUE (detector.is_stalled ());
+    TEST_ASSERT_FALSE (detector.check_background (400, SENSITIVITY));
+
+    // The lights were changed; once cleared, the new level is learned
+    detector.clear ();
+    for (uint8_t count = 0; count < STALL_LEARN_SAMPLES + 10; count++)
+    {
+        TEST_ASSERT_FALSE (detector.check_background (400, SENSITIVITY));
+    }
+    TEST_ASSERT_FALSE (detector.is_stalled ());
+}
+
+
+void test_background_is_learned_again_after_homing (void)
+{
+    StallDetector detector ("Stall", STEPS_PER_REV);
+
+    set_up (detector);
+    for (uint8_t count = 0; count < STALL_LEARN_SAMPLES; count++)
+    {
+        detector.check_background (400, SENSITIVITY);
+    }
+    detector.need_homing ();
+    detector.homed (0, false);
+    for (uint8_t count = 0; count < STALL_LEARN_SAMPLES + 10; count++)
+    {
+        TEST_ASSERT_FALSE (detector.check_background (1000, SENSITIVITY));
+    }
+    TEST_ASSERT_FALSE (detector.is_stalled ());
+}
+
+
+void test_slow_drift_is_followed (void)
+{
+    StallDetector detector ("Stall", STEPS_PER_REV);
+
+    for (uint8_t count = 0; count < STALL_LEARN_SAMPLES; count++)
+    {
+        detector.check_background (1000, SENSITIVITY);
+    }
+
+    // The lights dim by half, a little at a time
+    for (uint16_t clear = 1000; clear >= 500; clear -= 5)
+    {
+        for (uint8_t count = 0; count < 4; count++)
+        {
+            TEST_ASSERT_FALSE (detector.check_background (clear,
+                                                          SENSITIVITY));
+        }
+    }
+    TEST_ASSERT_FALSE (detector.is_stalled ());
+}
+
+
+int main (int argc, char** argv)
+{
+    UNITY_BEGIN ();
+    RUN_TEST (test_steady_table_stays_in_line);
+    RUN_TEST (test_few_missed_steps_are_tolerated);
+    RUN_TEST (test_missed_steps_are_made_up);
+    RUN_TEST (test_steps_gained_are_taken_back);
+    RUN_TEST (test_many_missed_steps_are_a_stall);
+    RUN_TEST (test_jammed_table_is_a_stall);
+    RUN_TEST (test_homed_table_uses_new_index_position);
+    RUN_TEST (test_background_is_learned_from_several_readings);
+    RUN_TEST (test_rim_seen_several_times_is_a_stall);
+    RUN_TEST (test_background_is_learned_again_after_clear);
+    RUN_TEST (test_background_is_learned_again_after_homing);
+    RUN_TEST (test_slow_drift_is_followed);
+    return UNITY_END ();
+}
@@ -0,0 +1,179 @@
+//*****************************************************************************
+/** @file    test_main.cpp
+ *  @brief   Tests of the deadline monotonic priorities and response times.
+ *  @details Task sets whose response times are worked out by hand, among them
+ *           the textbook example, are given to @c TaskSet and its priorities
+ *           and response times checked.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <unity.h>
+#include "taskset.h"
+
+
+/// Task set which is printed; it's the only share, so the list ends with it
+static TaskSet printed ("Tasks");
+
+
+void setUp (void)
+{
+    Serial.output.clear ();
+}
+
+
+void tearDown (void)
+{
+}
+
+
+void test_rate_monotonic_textbook_set (void)
+{
+    TaskSet tasks;
+
+    // T = 7, 12, 20 and C = 3, 3, 5 give R = 3, 6, 20
+    int8_t slow = tasks.add ("Slow", 20, 5);
+    int8_t fast = tasks.add ("Fast", 7, 3);
+    int8_t middle = tasks.add ("Middle", 12, 3);
+    tasks.assign_priorities (1);
+    TEST_ASSERT_EQUAL_UINT32 (3, tasks.get_priority (fast));
+    TEST_ASSERT_EQUAL_UINT32 (2, tasks.get_priority (middle));
+    TEST_ASSERT_EQUAL_UINT32 (1, tasks.get_priority (slow));
+
+    TEST_ASSERT_TRUE (tasks.analyze ());
+    TEST_ASSERT_EQUAL_UINT32 (3, tasks.get_timing (fast)->response);
+    TEST_ASSERT_EQUAL_UINT32 (6, tasks.get_timing (middle)->response);
+    TEST_ASSERT_EQUAL_UINT32 (20, tasks.get_timing (slow)->response);
+    TEST_ASSERT_TRUE (tasks.get_timing (slow)->schedulable);
+}
+
+
+void test_deadline_sets_the_order (void)
+{
+    TaskSet tasks;
+
+    // A deadline shorter than the period puts a task above faster ones
+    int8_t urgent = tasks.add ("Urgent", 1000, 10, 50);
+    int8_t frequent = tasks.add ("Frequent", 100, 20);
+    tasks.assign_priorities (5);
+    TEST_ASSERT_EQUAL_UINT32 (6, tasks.get_priority (urgent));
+    TEST_ASSERT_EQUAL_UINT32 (5, tasks.get_priority (frequent));
+    TEST_ASSERT_EQUAL_UINT32 (50, tasks.get_timing (urgent)->deadline);
+    TEST_ASSERT_EQUAL_UINT32 (100, tasks.get_timing (frequent)->deadline);
+
+    TEST_ASSERT_TRUE (tasks.analyze ());
+    TEST_ASSERT_EQUAL_UINT32 (10, tasks.get_timing (urgent)->response);
+    TEST_ASSERT_EQUAL_UINT32 (30, tasks.get_timing (frequent)->response);
+}
+
+
+void test_tied_deadlines_share_a_priority (void)
+{
+    TaskSet tasks;
+
+    int8_t first = tasks.add ("First", 10, 2);
+    int8_t second = tasks.add ("Second", 10, 3);
+    int8_t slow = tasks.add ("Slow", 20, 4);
+    int8_t slowest = tasks.add ("Slowest", 40, 1);
+    tasks.assign_priorities (1);
+
+    // Tied deadlines count once, so there's no gap below them
+    TEST_ASSERT_EQUAL_UINT32 (3, tasks.get_priority (first));
+    TEST_ASSERT_EQUAL_UINT32 (3, tasks.get_priority (second));
+    TEST_ASSERT_EQUAL_UINT32 (2, tasks.get_priority (slow));
+    TEST_ASSERT_EQUAL_UINT32 (1, tasks.get_priority (slowest));
+
+    // Time slicing lets each of the tied tasks hold up the other
+    TEST_ASSERT_TRUE (tasks.analyze ());
+    TEST_ASSERT_EQUAL_UINT32 (5, tasks.get_timing (first)->response);
+    TEST_ASSERT_EQUAL_UINT32 (5, tasks.get_timing (second)->response);
+    TEST_ASSERT_EQUAL_UINT32 (9, tasks.get_timing (slow)->response);
+    TEST_ASSERT_EQUAL_UINT32 (10, tasks.get_timing (slowest)->response);
+}
+
+
+void test_unschedulable_set (void)
+{
+    TaskSet tasks;
+
+    // Full use of the processor, but the slow task's first job finishes
+    // at 7, after its deadline of 6
+    int8_t fast = tasks.add ("Fast", 4, 2);
+    int8_t slow = tasks.add ("Slow", 6, 3);
+    tasks.assign_priorities (1);
+    TEST_ASSERT_FALSE (tasks.analyze ());
+    TEST_ASSERT_TRUE (tasks.get_timing (fast)->schedulable);
+    TEST_ASSERT_FALSE (tasks.get_timing (slow)->schedulable);
+    TEST_ASSERT_EQUAL_UINT32 (7, tasks.get_timing (slow)->response);
+
+    // Overloaded, the iteration stops once it passes the deadline
+    tasks.update_wcet (fast, 5);
+    TEST_ASSERT_FALSE (tasks.analyze ());
+    TEST_ASSERT_FALSE (tasks.get_timing (fast)->schedulable);
+    TEST_ASSERT_GREATER_THAN (6, tasks.get_timing (slow)->response);
+}
+
+
+void test_measured_wcet_only_raises_the_estimate (void)
+{
+    TaskSet tasks;
+
+    int8_t fast = tasks.add ("Fast", 100, 30);
+    int8_t slow = tasks.add ("Slow", 200, 50);
+    tasks.assign_priorities (1);
+    TEST_ASSERT_TRUE (tasks.analyze ());
+    TEST_ASSERT_EQUAL_UINT32 (80, tasks.get_timing (slow)->response);
+
+    tasks.update_wcet (fast, 10);
+    tasks.update_wcet (slow, 60);
+    tasks.update_wcet (7, 1000);
+    TEST_ASSERT_EQUAL_UINT32 (30, tasks.get_timing (fast)->wcet);
+    TEST_ASSERT_TRUE (tasks.analyze ());
+    TEST_ASSERT_EQUAL_UINT32 (90, tasks.get_timing (slow)->response);
+}
+
+
+void test_set_is_limited (void)
+{
+    TaskSet tasks;
+
+    TEST_ASSERT_EQUAL_INT (-1, tasks.add ("Never", 0, 1));
+    for (uint8_t index = 0; index < TASKSET_MAX_TASKS; index++)
+    {
+        TEST_ASSERT_EQUAL_INT (index, tasks.add ("Task", 1000, 1));
+    }
+    TEST_ASSERT_EQUAL_INT (-1, tasks.add ("Extra", 1000, 1));
+    TEST_ASSERT_EQUAL_UINT8 (TASKSET_MAX_TASKS, tasks.get_num_tasks ());
+    TEST_ASSERT_NULL (tasks.get_timing (TASKSET_MAX_TASKS));
+    TEST_ASSERT_EQUAL_UINT32 (0, tasks.get_priority (TASKSET_MAX_TASKS));
+}
+
+
+void test_print_shows_misses (void)
+{
+    printed.add ("Fast", 4, 2);
+    printed.add ("Slow", 6, 3);
+    printed.assign_priorities (1);
+    printed.analyze ();
+    printed.print_in_list (Serial);
+    TEST_ASSERT_EQUAL_STRING ("Fast            rta\tprio 2, T 4, C 2, D 4, R 2 us"
+                              "\r\n"
+                              "Slow            rta\tprio 1, T 6, C 3, D 6, R 7 us"
+                              " MISSES DEADLINE\r\n",
+                              Serial.output.c_str ());
+}
+
+
+int main (int argc, char** argv)
+{
+    UNITY_BEGIN ();
+    RUN_TEST (test_rate_monotonic_textbook_set);
+    RUN_TEST (test_deadline_sets_the_order);
+    RUN_TEST (test_tied_deadlines_share_a_priority);
+    RUN_TEST (test_unschedulable_set);
+    RUN_TEST (test_measured_wcet_only_raises_the_estimate);
+    RUN_TEST (test_set_is_limited);
+    RUN_TEST (test_print_shows_misses);
+    return UNITY_END ();
+}
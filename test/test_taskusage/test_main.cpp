@@ -0,0 +1,100 @@
+//*****************************************************************************
+/** @file    test_main.cpp
+ *  @brief   Tests of the task monitor's arithmetic and printing.
+ *  @details Run time counter and stack figures such as FreeRTOS gives are
+ *           turned into percentages, and a task's line is printed to the
+ *           stand-in serial port.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <unity.h>
+#include "taskusage.h"
+
+
+void setUp (void)
+{
+    Serial.output.clear ();
+}
+
+
+void tearDown (void)
+{
+}
+
+
+void test_cpu_percent (void)
+{
+    TEST_ASSERT_EQUAL_UINT8 (0, task_cpu_percent (0, 1000));
+    TEST_ASSERT_EQUAL_UINT8 (25, task_cpu_percent (250, 1000));
+    TEST_ASSERT_EQUAL_UINT8 (33, task_cpu_percent (1, 3));
+    TEST_ASSERT_EQUAL_UINT8 (99, task_cpu_percent (999, 1000));
+
+    // Nothing measured yet, and a task counter read just after the total's
+    TEST_ASSERT_EQUAL_UINT8 (0, task_cpu_percent (5, 0));
+    TEST_ASSERT_EQUAL_UINT8 (100, task_cpu_percent (1000, 1000));
+    TEST_ASSERT_EQUAL_UINT8 (100, task_cpu_percent (1001, 1000));
+}
+
+
+void test_cpu_percent_of_large_and_wrapped_counts (void)
+{
+    // Deltas this large would overflow if multiplied by 100 in 32 bits
+    TEST_ASSERT_EQUAL_UINT8 (50, task_cpu_percent (0x7FFFFFFFUL,
+                                                   0xFFFFFFFEUL));
+
+    // Counters which wrapped between samples still give the right deltas
+    uint32_t task_before = 0xFFFFFF00UL;
+    uint32_t task_after = 0x00000100UL;
+    uint32_t total_before = 0xFFFFF000UL;
+    uint32_t total_after = 0x00000C00UL;
+    TEST_ASSERT_EQUAL_UINT8 (7, task_cpu_percent (task_after - task_before,
+                                                  total_after
+                                                  - total_before));
+}
+
+
+void test_stack_used_percent (void)
+{
+    TEST_ASSERT_EQUAL_UINT8 (0, task_stack_used_percent (256, 256));
+    TEST_ASSERT_EQUAL_UINT8 (50, task_stack_used_percent (256, 128));
+    TEST_ASSERT_EQUAL_UINT8 (100, task_stack_used_percent (256, 0));
+    TEST_ASSERT_EQUAL_UINT8 (99, task_stack_used_percent (2048, 1));
+
+    // No stack size known, and more free than the size as when misregistered
+    TEST_ASSERT_EQUAL_UINT8 (0, task_stack_used_percent (0, 0));
+    TEST_ASSERT_EQUAL_UINT8 (0, task_stack_used_percent (256, 300));
+
+    // The largest stack doesn't overflow
+    TEST_ASSERT_EQUAL_UINT8 (99, task_stack_used_percent (65535, 1));
+}
+
+
+void test_print_with_cpu (void)
+{
+    print_task_usage (Serial, "Console", 200, 512, true, 7);
+    TEST_ASSERT_EQUAL_STRING ("Console         task\t200/512 free, 60% used,"
+                              " 7% CPU\r\n", Serial.output.c_str ());
+}
+
+
+void test_print_without_cpu_trims_the_name (void)
+{
+    print_task_usage (Serial, "Get data from color sensor", 1000, 1024,
+                      false, 55);
+    TEST_ASSERT_EQUAL_STRING ("Get data from cotask\t1000/1024 free, 2% used"
+                              "\r\n", Serial.output.c_str ());
+}
+
+
+int main (int argc, char** argv)
+{
+    UNITY_BEGIN ();
+    RUN_TEST (test_cpu_percent);
+    RUN_TEST (test_cpu_percent_of_large_and_wrapped_counts);
+    RUN_TEST (test_stack_used_percent);
+    RUN_TEST (test_print_with_cpu);
+    RUN_TEST (test_print_without_cpu_trims_the_name);
+    return UNITY_END ();
+}
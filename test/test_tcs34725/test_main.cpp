@@ -0,0 +1,242 @@
+//*****************************************************************************
+/** @file    test_main.cpp
+ *  @brief   Tests of the TCS34725 driver through a simulated bus.
+ *  @details The driver is given a transport which carries its transfers to a
+ *           simulated sensor, so that starting the sensor and reading it can
+ *           be checked without hardware. The bus counts its transfers,
+ *           which shows which ones the shadow copies of the configuration
+ *           registers save.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <unity.h>
+#include "Adafruit_TCS34725.h"
+#include "simi2cbus.h"
+
+
+/// Microseconds taken by one 24 ms integration
+#define INTEGRATION_24MS_US 24000
+
+
+void setUp (void)
+{
+    host_us = 1000;
+}
+
+
+void tearDown (void)
+{
+}
+
+
+void test_probe_sets_up_the_sensor (void)
+{
+    SimTCS34725 chip;
+    SimI2CBus bus;
+    bus.attach (chip);
+    Adafruit_TCS34725 sensor (TCS34725_INTEGRATIONTIME_24MS,
+                              TCS34725_GAIN_16X);
+
+    TEST_ASSERT_TRUE (sensor.probe (TCS34725_ADDRESS, &bus));
+    TEST_ASSERT_EQUAL_UINT32 (1, bus.num_begins);
+    TEST_ASSERT_EQUAL_UINT8 (TCS34725_INTEGRATIONTIME_24MS,
+                             chip.regs[TCS34725_ATIME]);
+    TEST_ASSERT_EQUAL_UINT8 (TCS34725_GAIN_16X, chip.regs[TCS34725_CONTROL]);
+
+    // Probing doesn't power the sensor up or wait
+    TEST_ASSERT_EQUAL_UINT8 (0, chip.regs[TCS34725_ENABLE]);
+    TEST_ASSERT_EQUAL_UINT32 (1000, host_us);
+}
+
+
+void test_probe_fails_without_a_sensor (void)
+{
+    SimTCS34725 chip;
+    SimI2CBus empty;
+    SimI2CBus wrong_id;
+    wrong_id.attach (chip);
+    chip.regs[TCS34725_ID] = 0x4D;
+    Adafruit_TCS34725 sensor;
+
+    TEST_ASSERT_FALSE (sensor.probe (TCS34725_ADDRESS, &empty));
+    TEST_ASSERT_FALSE (sensor.probe (TCS34725_ADDRESS, &wrong_id));
+    TEST_ASSERT_FALSE (sensor.probe (0x30, &wrong_id));
+}
+
+
+void test_start_without_waiting (void)
+{
+    SimTCS34725 chip;
+    SimI2CBus bus;
+    bus.attach (chip);
+    chip.set_counts (300, 200, 100, 620);
+    Adafruit_TCS34725 sensor (TCS34725_INTEGRATIONTIME_24MS);
+
+    sensor.probe (TCS34725_ADDRESS, &bus);
+    sensor.powerOn ();
+    TEST_ASSERT_EQUAL_UINT8 (TCS34725_ENABLE_PON, chip.regs[TCS34725_ENABLE]);
+    host_us += 2400;
+    sensor.startADC ();
+    TEST_ASSERT_EQUAL_UINT8 (TCS34725_ENABLE_PON | TCS34725_ENABLE_AEN,
+                             chip.regs[TCS34725_ENABLE]);
+    TEST_ASSERT_FALSE (sensor.dataValid ());
+    host_us += INTEGRATION_24MS_US;
+    TEST_ASSERT_TRUE (sensor.dataValid ());
+
+    uint16_t r, g, b, c;
+    TEST_ASSERT_TRUE (sensor.getRawDataNoDelay (&r, &g, &b, &c));
+    TEST_ASSERT_EQUAL_UINT16 (300, r);
+    TEST_ASSERT_EQUAL_UINT16 (200, g);
+    TEST_ASSERT_EQUAL_UINT16 (100, b);
+    TEST_ASSERT_EQUAL_UINT16 (620, c);
+}
+
+
+void test_begin_waits_for_the_first_integration (void)
+{
+    SimTCS34725 chip;
+    SimI2CBus bus;
+    bus.attach (chip);
+    Adafruit_TCS34725 sensor (TCS34725_INTEGRATIONTIME_24MS);
+
+    TEST_ASSERT_TRUE (sensor.begin (TCS34725_ADDRESS, &bus));
+    TEST_ASSERT_TRUE (chip.is_valid ());
+    TEST_ASSERT_GREATER_OR_EQUAL (1000 + 2400 + INTEGRATION_24MS_US, host_us);
+}
+
+
+void test_failed_transfer_fails_the_reading (void)
+{
+    SimTCS34725 chip;
+    SimI2CBus bus;
+    bus.attach (chip);
+    Adafruit_TCS34725 sensor;
+    uint16_t r, g, b, c;
+
+    // A sensor which was never found can't be read
+    TEST_ASSERT_FALSE (sensor.getRawDataNoDelay (&r, &g, &b, &c));
+
+    sensor.begin (TCS34725_ADDRESS, &bus);
+    TEST_ASSERT_TRUE (sensor.getRawDataNoDelay (&r, &g, &b, &c));
+    bus.nacks = 1;
+    TEST_ASSERT_FALSE (sensor.getRawDataNoDelay (&r, &g, &b, &c));
+    TEST_ASSERT_TRUE (sensor.getRawDataNoDelay (&r, &g, &b, &c));
+}
+
+
+/// Make a sensor which has been started on a bus, and forget the transfers
+static void start (Adafruit_TCS34725& sensor, SimI2CBus& bus)
+{
+    sensor.begin (TCS34725_ADDRESS, &bus);
+    bus.clear_counts ();
+}
+
+
+void test_unchanged_settings_cost_nothing (void)
+{
+    SimTCS34725 chip;
+    SimI2CBus bus;
+    bus.attach (chip);
+    Adafruit_TCS34725 sensor (TCS34725_INTEGRATIONTIME_24MS,
+                              TCS34725_GAIN_4X);
+    start (sensor, bus);
+
+    sensor.setGain (TCS34725_GAIN_4X);
+    sensor.setIntegrationTime (TCS34725_INTEGRATIONTIME_24MS);
+    sensor.enable ();
+    sensor.startADC ();
+    TEST_ASSERT_EQUAL_UINT32 (0, bus.num_transfers);
+
+    sensor.setIntLimits (100, 2000);
+    TEST_ASSERT_EQUAL_UINT32 (4, bus.num_writes);
+    sensor.setIntLimits (100, 2000);
+    TEST_ASSERT_EQUAL_UINT32 (4, bus.num_transfers);
+
+    // A register which was never written is written the first time
+    sensor.setPersistence (TCS34725_PERS_NONE);
+    sensor.setPersistence (TCS34725_PERS_NONE);
+    TEST_ASSERT_EQUAL_UINT32 (5, bus.num_transfers);
+}
+
+
+void test_changes_are_written_without_reading (void)
+{
+    SimTCS34725 chip;
+    SimI2CBus bus;
+    bus.attach (chip);
+    Adafruit_TCS34725 sensor;
+    start (sensor, bus);
+
+    sensor.setGain (TCS34725_GAIN_60X);
+    sensor.setInterrupt (true);
+    sensor.setWait (true);
+    sensor.disable ();
+    TEST_ASSERT_EQUAL_UINT32 (4, bus.num_writes);
+    TEST_ASSERT_EQUAL_UINT32 (0, bus.num_reads);
+    TEST_ASSERT_EQUAL_UINT8 (TCS34725_ENABLE_AIEN | TCS34725_ENABLE_WEN,
+                             chip.regs[TCS34725_ENABLE]);
+    TEST_ASSERT_EQUAL_UINT8 (TCS34725_GAIN_60X, chip.regs[TCS34725_CONTROL]);
+
+    // The data registers aren't shadowed, as the sensor changes them
+    sensor.dataValid ();
+    sensor.dataValid ();
+    TEST_ASSERT_EQUAL_UINT32 (2, bus.num_reads);
+}
+
+
+void test_failed_write_is_tried_again (void)
+{
+    SimTCS34725 chip;
+    SimI2CBus bus;
+    bus.attach (chip);
+    Adafruit_TCS34725 sensor;
+    start (sensor, bus);
+
+    bus.nacks = 1;
+    sensor.setInterrupt (true);
+    TEST_ASSERT_EQUAL_UINT32 (0, bus.num_writes);
+
+    // The register is unknown after the failure, so it's read first
+    sensor.setInterrupt (true);
+    TEST_ASSERT_EQUAL_UINT32 (1, bus.num_reads);
+    TEST_ASSERT_EQUAL_UINT32 (1, bus.num_writes);
+    TEST_ASSERT_TRUE (chip.regs[TCS34725_ENABLE] & TCS34725_ENABLE_AIEN);
+}
+
+
+void test_forgotten_shadow_is_read_again (void)
+{
+    SimTCS34725 chip;
+    SimI2CBus bus;
+    bus.attach (chip);
+    Adafruit_TCS34725 sensor;
+    start (sensor, bus);
+
+    // The sensor was reset behind the driver's back
+    chip.reset ();
+    sensor.invalidateShadow ();
+    TEST_ASSERT_EQUAL_UINT8 (0, sensor.readShadow (TCS34725_ENABLE));
+    TEST_ASSERT_EQUAL_UINT8 (0, sensor.readShadow (TCS34725_ENABLE));
+    TEST_ASSERT_EQUAL_UINT32 (1, bus.num_reads);
+    sensor.startADC ();
+    TEST_ASSERT_EQUAL_UINT8 (TCS34725_ENABLE_PON | TCS34725_ENABLE_AEN,
+                             chip.regs[TCS34725_ENABLE]);
+}
+
+
+int main (int argc, char** argv)
+{
+    UNITY_BEGIN ();
+    RUN_TEST (test_probe_sets_up_the_sensor);
+    RUN_TEST (test_probe_fails_without_a_sensor);
+    RUN_TEST (test_start_without_waiting);
+    RUN_TEST (test_begin_waits_for_the_first_integration);
+    RUN_TEST (test_failed_transfer_fails_the_reading);
+    RUN_TEST (test_unchanged_settings_cost_nothing);
+    RUN_TEST (test_changes_are_written_without_reading);
+    RUN_TEST (test_failed_write_is_tried_again);
+    RUN_TEST (test_forgotten_shadow_is_read_again);
+    return UNITY_END ();
+}
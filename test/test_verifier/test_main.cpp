@@ -0,0 +1,233 @@
+//*****************************************************************************
+/** @file    test_main.cpp
+ *  @brief   Tests of the mis-sort verifier, with noise in the checkpoint
+ *           sensor's readings.
+ *  @details Balls of known colors pass a simulated checkpoint sensor whose
+ *           readings have noise added. The checkpoint's readings are
+ *           classified as the color sensor task does, and the verifier's
+ *           confusion matrix is compared with what really happened.
+ *
+ *  @date 2026-Oct-19 Created file
+ */
+//*****************************************************************************
+
+#include <unity.h>
+#include "verifier.h"
+#include "seqclassifier.h"
+
+
+/// Evidence needed to classify a ball, the configuration's default
+#define EARLY_EXIT 200000
+
+/// Sum of the R, G and B counts in a simulated reading
+#define READING_SUM 3000
+
+/// Balls put through each run
+#define NUM_BALLS 300
+
+
+/// Share of R and G in each bin's balls, in parts per thousand
+static const uint16_t ball_colors[3][2] = {{600, 250},    // red
+                                           {300, 500},    // green
+                                           {200, 300}};   // blue
+
+/// State of the noise generator
+static uint32_t noise_state;
+
+
+/// Return a pseudo-random number from -spread to spread
+static int32_t noise (int32_t spread)
+{
+    noise_state = noise_state * 1664525UL + 1013904223UL;
+    return (int32_t)((noise_state >> 8) % (2 * spread + 1)) - spread;
+}
+
+
+/// Return a count with noise, kept within the sensor's range
+static uint16_t noisy (int32_t count, int32_t spread)
+{
+    count += noise (spread);
+    return (count < 0) ? 0 : (count > 0xFFFF) ? 0xFFFF : count;
+}
+
+
+/// Make a reading of a ball for a bin, with noise of the given spread
+static RGBCSample read_ball (uint8_t bin, int32_t spread)
+{
+    int32_t r = (int32_t)ball_colors[bin][0] * READING_SUM / 1000;
+    int32_t g = (int32_t)ball_colors[bin][1] * READING_SUM / 1000;
+    int32_t b = READING_SUM - r - g;
+    RGBCSample reading = {noisy (r, spread), noisy (g, spread),
+                          noisy (b, spread), noisy (READING_SUM, spread)};
+    return reading;
+}
+
+
+/// Make a classifier with the centroids used by the sorter
+static void set_up (ColorClassifier& classifier)
+{
+    const Centroid centroids[] = {{{2458, 1024}, 0},
+                                  {{1229, 2048}, 1},
+                                  {{ 819, 1229}, 2}};
+    for (const Centroid& centroid : centroids)
+    {
+        classifier.add_centroid (centroid);
+    }
+}
+
+
+/** @brief   Put balls past the checkpoint and count what it really saw.
+ *  @param   verifier The verifier being tested
+ *  @param   spread The noise added to each channel, in counts
+ *  @param   seen Counts of what the checkpoint decided, by bin loaded for,
+ *           with undecided balls in the last column
+ */
+static void run_balls (SortVerifier& verifier, int32_t spread,
+                       uint32_t seen[3][VERIFY_MAX_BINS + 1])
+{
+    ColorClassifier classifier;
+    set_up (classifier);
+    SequentialClassifier sequential (classifier, EARLY_EXIT);
+
+    for (uint16_t ball = 0; ball < NUM_BALLS; ball++)
+    {
+        uint8_t bin = ball % 3;
+        verifier.expect (bin);
+        sequential.start ();
+        SequentialClassifier::Decision decision;
+        do
+        {
+            decision = sequential.add (read_ball (bin, spread));
+        }
+        while (decision == SequentialClassifier::PENDING);
+
+        uint8_t observed = (decision == SequentialClassifier::AMBIGUOUS)
+                           ? BIN_REJECT : sequential.get_result ().bin;
+        verifier.observe (observed);
+        verifier.finish ();
+        seen[bin][(observed < 3) ? observed : VERIFY_UNSEEN]++;
+    }
+}
+
+
+void setUp (void)
+{
+    noise_state = 12345;
+}
+
+
+void tearDown (void)
+{
+}
+
+
+void test_matrix_counts_each_pair (void)
+{
+    SortVerifier verifier ("Verify");
+
+    verifier.expect (0);
+    TEST_ASSERT_TRUE (verifier.observe (0));
+    verifier.expect (1);
+    TEST_ASSERT_TRUE (verifier.observe (2));
+    TEST_ASSERT_FALSE (verifier.observe (1));   // Only the first counts
+    verifier.expect (2);
+    TEST_ASSERT_FALSE (verifier.observe (BIN_REJECT));
+    TEST_ASSERT_TRUE (verifier.finish ());      // Not seen at all
+    TEST_ASSERT_FALSE (verifier.observe (2));   // No ball expected
+
+    TEST_ASSERT_EQUAL_UINT32 (1, verifier.get_count (0, 0));
+    TEST_ASSERT_EQUAL_UINT32 (1, verifier.get_count (1, 2));
+    TEST_ASSERT_EQUAL_UINT32 (1, verifier.get_count (2, VERIFY_UNSEEN));
+    TEST_ASSERT_EQUAL_UINT32 (0, verifier.get_count (VERIFY_MAX_BINS, 0));
+    TEST_ASSERT_EQUAL_UINT32 (3, verifier.get_num_checked ());
+    TEST_ASSERT_EQUAL_UINT32 (2, verifier.get_num_missorted ());
+
+    verifier.reset ();
+    TEST_ASSERT_EQUAL_UINT32 (0, verifier.get_num_checked ());
+}
+
+
+void test_next_ball_finishes_an_unseen_one (void)
+{
+    SortVerifier verifier ("Verify");
+
+    verifier.expect (1);
+    verifier.expect (1);
+    verifier.observe (1);
+    TEST_ASSERT_EQUAL_UINT32 (1, verifier.get_count (1, VERIFY_UNSEEN));
+    TEST_ASSERT_EQUAL_UINT32 (1, verifier.get_count (1, 1));
+}
+
+
+void test_quiet_sensor_finds_no_missorts (void)
+{
+    SortVerifier verifier ("Verify");
+    uint32_t seen[3][VERIFY_MAX_BINS + 1] = {};
+
+    run_balls (verifier, 10, seen);
+    TEST_ASSERT_EQUAL_UINT32 (NUM_BALLS, verifier.get_num_checked ());
+    TEST_ASSERT_EQUAL_UINT32 (0, verifier.get_num_missorted ());
+    for (uint8_t bin = 0; bin < 3; bin++)
+    {
+        TEST_ASSERT_EQUAL_UINT32 (NUM_BALLS / 3, verifier.get_count (bin, bin));
+    }
+}
+
+
+void test_noisy_sensor_matrix_matches_decisions (void)
+{
+    SortVerifier verifier ("Verify");
+    uint32_t seen[3][VERIFY_MAX_BINS + 1] = {};
+
+    // So much noise that some balls are seen in the wrong bin or not at all
+    run_balls (verifier, 900, seen);
+    uint32_t wrong = 0;
+    for (uint8_t bin = 0; bin < 3; bin++)
+    {
+        for (uint8_t column = 0; column <= VERIFY_MAX_BINS; column++)
+        {
+            if (column < 3 || column == VERIFY_UNSEEN)
+            {
+                TEST_ASSERT_EQUAL_UINT32 (seen[bin][column],
+                                          verifier.get_count (bin, column));
+            }
+            if (column != bin)
+            {
+                wrong += seen[bin][column];
+            }
+        }
+    }
+    TEST_ASSERT_GREATER_THAN (0, wrong);
+    TEST_ASSERT_LESS_THAN (NUM_BALLS / 2, wrong);
+    TEST_ASSERT_EQUAL_UINT32 (NUM_BALLS, verifier.get_num_checked ());
+    TEST_ASSERT_EQUAL_UINT32 (wrong, verifier.get_num_missorted ());
+}
+
+
+void test_more_noise_more_missorts (void)
+{
+    uint32_t missorted[3];
+    const int32_t spreads[] = {100, 700, 1400};
+
+    for (uint8_t run = 0; run < 3; run++)
+    {
+        SortVerifier verifier ("Verify");
+        uint32_t seen[3][VERIFY_MAX_BINS + 1] = {};
+        run_balls (verifier, spreads[run], seen);
+        missorted[run] = verifier.get_num_missorted ();
+    }
+    TEST_ASSERT_LESS_OR_EQUAL (missorted[1], missorted[0]);
+    TEST_ASSERT_LESS_THAN (missorted[2], missorted[1]);
+}
+
+
+int main (int argc, char** argv)
+{
+    UNITY_BEGIN ();
+    RUN_TEST (test_matrix_counts_each_pair);
+    RUN_TEST (test_next_ball_finishes_an_unseen_one);
+    RUN_TEST (test_quiet_sensor_finds_no_missorts);
+    RUN_TEST (test_noisy_sensor_matrix_matches_decisions);
+    RUN_TEST (test_more_noise_more_missorts);
+    return UNITY_END ();
+}